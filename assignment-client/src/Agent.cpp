@@ -114,8 +114,10 @@ void Agent::readPendingDatagrams() {
 
                 QByteArray mutablePacket = receivedPacket;
                 ssize_t messageLength = mutablePacket.size();
+                bool wasStatsPacket = false;
 
                 if (datagramPacketType == PacketTypeOctreeStats) {
+                    wasStatsPacket = true;
 
                     int statsMessageLength = OctreeHeadlessViewer::parseOctreeStats(mutablePacket, sourceNode);
                     if (messageLength > statsMessageLength) {
@@ -134,6 +136,8 @@ void Agent::readPendingDatagrams() {
                     datagramPacketType = packetTypeForPacket(mutablePacket);
                 } // fall through to piggyback message
 
+                OctreeHeadlessViewer::trackIncomingOctreePacket(mutablePacket, sourceNode, wasStatsPacket);
+
                 if (datagramPacketType == PacketTypeParticleData || datagramPacketType == PacketTypeParticleErase) {
                     _particleViewer.processDatagram(mutablePacket, sourceNode);
                 }
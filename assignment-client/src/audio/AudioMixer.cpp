@@ -37,11 +37,13 @@
 #include <QtCore/QTimer>
 
 #include <Logging.h>
+#include <Metrics.h>
 #include <NodeList.h>
 #include <Node.h>
 #include <PacketHeaders.h>
 #include <SharedUtil.h>
 #include <StdDev.h>
+#include <Trace.h>
 #include <UUID.h>
 
 #include "AudioRingBuffer.h"
@@ -306,6 +308,7 @@ void AudioMixer::addBufferToMixForListeningNodeWithBuffer(PositionalAudioRingBuf
 }
 
 void AudioMixer::prepareMixForListeningNode(Node* node) {
+    TraceScope trace("AudioMixer::prepareMixForListeningNode");
     AvatarAudioRingBuffer* nodeRingBuffer = ((AudioMixerClientData*) node->getLinkedData())->getAvatarAudioRingBuffer();
 
     // zero out the client mix for this node
@@ -408,7 +411,11 @@ void AudioMixer::run() {
     const int TRAILING_AVERAGE_FRAMES = 100;
     int framesSinceCutoffEvent = TRAILING_AVERAGE_FRAMES;
 
+    MetricsHistogram* frameTimeHistogram = MetricsRegistry::getInstance()->getHistogram("audio_mixer.frame_usecs");
+
     while (!_isFinished) {
+        quint64 frameStart = usecTimestampNow();
+        qint64 frameTraceStart = Trace::now();
         
         foreach (const SharedNodePointer& node, nodeList->getNodeHash()) {
             if (node->getLinkedData()) {
@@ -493,6 +500,9 @@ void AudioMixer::run() {
         
         QCoreApplication::processEvents();
         
+        frameTimeHistogram->record(usecTimestampNow() - frameStart);
+        Trace::record("AudioMixer::run frame", frameTraceStart, Trace::now() - frameTraceStart);
+        
         if (_isFinished) {
             break;
         }
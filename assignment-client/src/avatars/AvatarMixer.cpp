@@ -16,9 +16,11 @@
 #include <QtCore/QThread>
 
 #include <Logging.h>
+#include <Metrics.h>
 #include <NodeList.h>
 #include <PacketHeaders.h>
 #include <SharedUtil.h>
+#include <Trace.h>
 #include <UUID.h>
 
 #include "AvatarMixerClientData.h"
@@ -61,6 +63,10 @@ const float BILLBOARD_AND_IDENTITY_SEND_PROBABILITY = 1.0f / 300.0f;
 //    1) use the view frustum to cull those avatars that are out of view. Since avatar data doesn't need to be present
 //       if the avatar is not in view or in the keyhole.
 void AvatarMixer::broadcastAvatarData() {
+    TraceScope trace("AvatarMixer::broadcastAvatarData");
+    static MetricsHistogram* broadcastTimeHistogram =
+        MetricsRegistry::getInstance()->getHistogram("avatar_mixer.broadcast_usecs");
+    quint64 broadcastStart = usecTimestampNow();
     
     int idleTime = QDateTime::currentMSecsSinceEpoch() - _lastFrameTimestamp;
     
@@ -212,6 +218,8 @@ void AvatarMixer::broadcastAvatarData() {
     }
     
     _lastFrameTimestamp = QDateTime::currentMSecsSinceEpoch();
+    
+    broadcastTimeHistogram->record(usecTimestampNow() - broadcastStart);
 }
 
 void AvatarMixer::nodeKilled(SharedNodePointer killedNode) {
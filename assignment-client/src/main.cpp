@@ -15,6 +15,7 @@
 #include "Assignment.h"
 #include "AssignmentClient.h"
 #include "AssignmentClientMonitor.h"
+#include "swarm/SwarmLoadGenerator.h"
 
 int main(int argc, char* argv[]) {
 #ifndef WIN32
@@ -32,7 +33,12 @@ int main(int argc, char* argv[]) {
         numForks = atoi(numForksString);
     }
     
-    if (numForks) {
+    const char* swarmSizeString = getCmdOption(argc, (const char**)argv, SWARM_SIZE_PARAMETER);
+    
+    if (swarmSizeString) {
+        SwarmLoadGenerator swarm(argc, argv, atoi(swarmSizeString));
+        return swarm.exec();
+    } else if (numForks) {
         AssignmentClientMonitor monitor(argc, argv, numForks);
         return monitor.exec();
     } else {
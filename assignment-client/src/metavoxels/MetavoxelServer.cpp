@@ -10,8 +10,15 @@
 //
 
 #include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonObject>
+#include <QRunnable>
+#include <QThread>
 
 #include <PacketHeaders.h>
+#include <SharedUtil.h>
 
 #include <MetavoxelMessages.h>
 #include <MetavoxelUtil.h>
@@ -20,11 +27,32 @@
 
 const int SEND_INTERVAL = 50;
 
+const int PERSIST_INTERVAL = 30 * 1000;
+
+const QString DEFAULT_PERSIST_FILENAME = "resources/metavoxels.dat";
+
 MetavoxelServer::MetavoxelServer(const QByteArray& packet) :
-    ThreadedAssignment(packet) {
+    ThreadedAssignment(packet),
+    _persistThread(NULL),
+    _persister(NULL),
+    _saving(false),
+    _loadTime(0),
+    _lastSaveTime(0),
+    _lastSaveSize(0),
+    _saveCount(0) {
     
     _sendTimer.setSingleShot(true);
     connect(&_sendTimer, SIGNAL(timeout()), SLOT(sendDeltas()));
+    
+    connect(&_persistTimer, SIGNAL(timeout()), SLOT(maybeSaveData()));
+}
+
+MetavoxelServer::~MetavoxelServer() {
+    if (_persistThread) {
+        _persistThread->quit();
+        _persistThread->wait();
+    }
+    delete _persister;
 }
 
 void MetavoxelServer::applyEdit(const MetavoxelEditMessage& edit) {
@@ -41,6 +69,27 @@ void MetavoxelServer::run() {
     
     connect(nodeList, SIGNAL(nodeAdded(SharedNodePointer)), SLOT(maybeAttachSession(const SharedNodePointer&)));
     
+    // check the payload for persistence options
+    QStringList options = QString(getPayload()).split(" ", QString::SkipEmptyParts);
+    if (!options.contains("--NoPersist")) {
+        int filenameIndex = options.indexOf("--persistFilename");
+        _persistFilename = (filenameIndex != -1 && filenameIndex + 1 < options.size()) ?
+            options.at(filenameIndex + 1) : DEFAULT_PERSIST_FILENAME;
+        qDebug() << "persistFilename=" << _persistFilename;
+        
+        // load the last snapshot before we start sending
+        loadData();
+        _savedData = _data;
+        
+        _persistThread = new QThread(this);
+        _persister = new MetavoxelPersister(_persistFilename, _savedData);
+        _persister->moveToThread(_persistThread);
+        connect(_persister, SIGNAL(saved(qint64, qint64)), SLOT(recordSave(qint64, qint64)));
+        _persistThread->start();
+        
+        _persistTimer.start(PERSIST_INTERVAL);
+    }
+    
     _lastSend = QDateTime::currentMSecsSinceEpoch();
     _sendTimer.start(SEND_INTERVAL);
 }
@@ -66,6 +115,51 @@ void MetavoxelServer::readPendingDatagrams() {
     }
 }
 
+void MetavoxelServer::aboutToFinish() {
+    if (!_persister) {
+        return;
+    }
+    _persistTimer.stop();
+    
+    // wait for any save in progress, then write the final snapshot on this thread.  A save we queued may have been
+    // dropped by quitting before it ran (and if it did run, we won't hear of it), so unless we know the last snapshot
+    // was written, write it again
+    _persistThread->quit();
+    _persistThread->wait();
+    if (_saving || _data != _savedData) {
+        _savedData = _data;
+        _persister->save();
+    }
+}
+
+void MetavoxelServer::sendStatsPacket() {
+    QJsonObject statsObject;
+    if (_persister) {
+        statsObject["persist_load_time_usecs"] = (double)_loadTime;
+        statsObject["persist_last_save_time_usecs"] = (double)_lastSaveTime;
+        statsObject["persist_last_save_bytes"] = (double)_lastSaveSize;
+        statsObject["persist_save_count"] = _saveCount;
+    }
+    
+    // tally the memory used by the current data and by the send records of each session, which mostly share nodes
+    MetavoxelMemoryUsage usage;
+    usage.add(_data);
+    foreach (const SharedNodePointer& node, NodeList::getInstance()->getNodeHash()) {
+        if (node->getType() == NodeType::Agent && node->getLinkedData()) {
+            static_cast<MetavoxelSession*>(node->getLinkedData())->addMemoryUsage(usage);
+        }
+    }
+    statsObject["metavoxel_live_nodes"] = MetavoxelNode::getLiveNodeCount();
+    statsObject["metavoxel_reachable_nodes"] = usage.getNodeCount();
+    statsObject["metavoxel_shared_nodes"] = usage.getSharedNodeCount();
+    statsObject["metavoxel_pool_reserved_bytes"] = (double)MetavoxelNode::getReservedBytes();
+    for (QHash<AttributePointer, qint64>::const_iterator it = usage.getAttributeBytes().constBegin();
+            it != usage.getAttributeBytes().constEnd(); it++) {
+        statsObject["metavoxel_bytes_" + it.key()->getName()] = (double)it.value();
+    }
+    ThreadedAssignment::addPacketStatsAndSendStatsPacket(statsObject);
+}
+
 void MetavoxelServer::maybeAttachSession(const SharedNodePointer& node) {
     if (node->getType() == NodeType::Agent) {
         QMutexLocker locker(&node->getMutex());
@@ -73,13 +167,118 @@ void MetavoxelServer::maybeAttachSession(const SharedNodePointer& node) {
     }
 }
 
+/// Encodes a single delta on behalf of all of the sessions that share the same reference data, LODs, and stream state.
+class DeltaEncoding : public QRunnable {
+public:
+    
+    DeltaEncoding(const MetavoxelData& data, MetavoxelSession* session, Bitstream* out);
+    
+    /// Checks whether encoding the delta for the described session would produce the same bits as this encoding.
+    bool matches(MetavoxelSession* session, const Bitstream* out) const;
+    
+    void addSession(MetavoxelSession* session, Bitstream* out);
+    
+    virtual void run();
+    
+    /// Copies the encoded delta into the packets of all sessions and sends them.
+    void sendDeltas();
+    
+private:
+    
+    class Target {
+    public:
+        MetavoxelSession* session;
+        Bitstream* out;
+    };
+    
+    const MetavoxelData& _data;
+    MetavoxelData _reference;
+    MetavoxelLOD _referenceLOD;
+    MetavoxelLOD _lod;
+    QList<Target> _targets;
+    
+    QByteArray _buffer;
+    QDataStream _bufferStream;
+    Bitstream _stream;
+    int _bits;
+};
+
+DeltaEncoding::DeltaEncoding(const MetavoxelData& data, MetavoxelSession* session, Bitstream* out) :
+    _data(data),
+    _reference(session->getReferenceData()),
+    _referenceLOD(session->getReferenceLOD()),
+    _lod(session->getLOD()),
+    _bufferStream(&_buffer, QIODevice::WriteOnly),
+    _stream(_bufferStream),
+    _bits(0) {
+    
+    setAutoDelete(false);
+    
+    // start with the same mappings as the session, so that we write exactly what it would
+    _stream.copyWriteState(*out);
+    addSession(session, out);
+}
+
+bool DeltaEncoding::matches(MetavoxelSession* session, const Bitstream* out) const {
+    return session->getReferenceData() == _reference && session->getReferenceLOD() == _referenceLOD &&
+        session->getLOD() == _lod && out->hasSameWriteState(_stream);
+}
+
+void DeltaEncoding::addSession(MetavoxelSession* session, Bitstream* out) {
+    Target target = { session, out };
+    _targets.append(target);
+}
+
+void DeltaEncoding::run() {
+    _data.writeDelta(_reference, _referenceLOD, _stream, _lod);
+    _bits = _buffer.size() * BITS_IN_BYTE + _stream.getBitPosition();
+    _stream.flush();
+}
+
+void DeltaEncoding::sendDeltas() {
+    foreach (const Target& target, _targets) {
+        target.out->write(_buffer.constData(), _bits);
+        target.out->copyTransientWriteMappings(_stream);
+        target.session->endDelta();
+    }
+}
+
 void MetavoxelServer::sendDeltas() {
-    // send deltas for all sessions
+    // start packets for all sessions, grouping those that will produce identical deltas
+    QList<DeltaEncoding*> encodings;
     foreach (const SharedNodePointer& node, NodeList::getInstance()->getNodeHash()) {
-        if (node->getType() == NodeType::Agent) {
-            static_cast<MetavoxelSession*>(node->getLinkedData())->sendDelta();
+        if (node->getType() != NodeType::Agent) {
+            continue;
+        }
+        MetavoxelSession* session = static_cast<MetavoxelSession*>(node->getLinkedData());
+        Bitstream* out = session->startDelta();
+        if (!out) {
+            continue;
         }
+        bool matched = false;
+        foreach (DeltaEncoding* encoding, encodings) {
+            if (encoding->matches(session, out)) {
+                encoding->addSession(session, out);
+                matched = true;
+                break;
+            }
+        }
+        if (!matched) {
+            encodings.append(new DeltaEncoding(_data, session, out));
+        }
+    }
+    
+    // encode each distinct delta once, in parallel
+    foreach (DeltaEncoding* encoding, encodings) {
+        _encoderPool.start(encoding);
     }
+    _encoderPool.waitForDone();
+    
+    // copy the results into the session packets and send
+    foreach (DeltaEncoding* encoding, encodings) {
+        encoding->sendDeltas();
+    }
+    qDeleteAll(encodings);
     
     // restart the send timer
     qint64 now = QDateTime::currentMSecsSinceEpoch();
@@ -89,11 +288,86 @@ void MetavoxelServer::sendDeltas() {
     _sendTimer.start(qMax(0, 2 * SEND_INTERVAL - elapsed));
 }
 
+void MetavoxelServer::maybeSaveData() {
+    // copying the data is cheap (it just references the roots), as is the comparison
+    if (_saving || _data == _savedData) {
+        return;
+    }
+    _savedData = _data;
+    _saving = true;
+    QMetaObject::invokeMethod(_persister, "save");
+}
+
+void MetavoxelServer::recordSave(qint64 elapsed, qint64 size) {
+    _saving = false;
+    _lastSaveTime = elapsed;
+    _lastSaveSize = size;
+    _saveCount++;
+}
+
+void MetavoxelServer::loadData() {
+    QFile file(_persistFilename);
+    if (!file.exists()) {
+        return;
+    }
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Failed to open metavoxel persist file:" << _persistFilename;
+        return;
+    }
+    qDebug() << "loading metavoxels from file:" << _persistFilename << "...";
+    quint64 loadStarted = usecTimestampNow();
+    
+    QDataStream inStream(&file);
+    inStream.setByteOrder(QDataStream::LittleEndian);
+    Bitstream in(inStream, Bitstream::FULL_METADATA);
+    in >> _data;
+    
+    _loadTime = usecTimestampNow() - loadStarted;
+    qDebug() << "DONE loading metavoxels in" << _loadTime << "usecs";
+}
+
+MetavoxelPersister::MetavoxelPersister(const QString& filename, const MetavoxelData& data) :
+    _filename(filename),
+    _data(data) {
+}
+
+void MetavoxelPersister::save() {
+    qDebug() << "saving metavoxels to file:" << _filename << "...";
+    quint64 saveStarted = usecTimestampNow();
+    
+    // write to a temporary file first so that a failure mid-save leaves the last snapshot intact
+    QDir().mkpath(QFileInfo(_filename).absolutePath());
+    QString temporaryFilename = _filename + ".tmp";
+    QFile file(temporaryFilename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Failed to open metavoxel persist file for writing:" << temporaryFilename;
+        emit saved(0, 0);
+        return;
+    }
+    QDataStream outStream(&file);
+    outStream.setByteOrder(QDataStream::LittleEndian);
+    Bitstream out(outStream, Bitstream::FULL_METADATA);
+    out << _data;
+    out.flush();
+    qint64 size = file.size();
+    file.close();
+    
+    QFile::remove(_filename);
+    if (!QFile::rename(temporaryFilename, _filename)) {
+        qWarning() << "Failed to replace metavoxel persist file:" << _filename;
+    }
+    qint64 elapsed = usecTimestampNow() - saveStarted;
+    qDebug() << "DONE saving metavoxels in" << elapsed << "usecs";
+    emit saved(elapsed, size);
+}
+
 MetavoxelSession::MetavoxelSession(MetavoxelServer* server, const SharedNodePointer& node) :
     _server(server),
     _sequencer(byteArrayWithPopulatedHeader(PacketTypeMetavoxelData)),
     _node(node) {
     
+    _sequencer.setIntegerEncoding(Bitstream::VARIABLE_INTEGERS);
+    
     connect(&_sequencer, SIGNAL(readyToWrite(const QByteArray&)), SLOT(sendData(const QByteArray&)));
     connect(&_sequencer, SIGNAL(readyToRead(Bitstream&)), SLOT(readPacket(Bitstream&)));
     connect(&_sequencer, SIGNAL(sendAcknowledged(int)), SLOT(clearSendRecordsBefore(int)));
@@ -115,14 +389,17 @@ int MetavoxelSession::parseData(const QByteArray& packet) {
     return packet.size();
 }
 
-void MetavoxelSession::sendDelta() {
+Bitstream* MetavoxelSession::startDelta() {
     // wait until we have a valid lod
     if (!_lod.isValid()) {
-        return;
+        return NULL;
     }
     Bitstream& out = _sequencer.startPacket();
     out << QVariant::fromValue(MetavoxelDeltaMessage());
-    _server->getData().writeDelta(_sendRecords.first().data, _sendRecords.first().lod, out, _lod);
+    return &out;
+}
+
+void MetavoxelSession::endDelta() {
     _sequencer.endPacket();
     
     // record the send
@@ -130,6 +407,12 @@ void MetavoxelSession::sendDelta() {
     _sendRecords.append(record);
 }
 
+void MetavoxelSession::addMemoryUsage(MetavoxelMemoryUsage& usage) const {
+    foreach (const SendRecord& record, _sendRecords) {
+        usage.add(record.data);
+    }
+}
+
 void MetavoxelSession::sendData(const QByteArray& data) {
     NodeList::getInstance()->writeDatagram(data, _node);
 }
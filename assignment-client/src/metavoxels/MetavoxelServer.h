@@ -13,6 +13,7 @@
 #define hifi_MetavoxelServer_h
 
 #include <QList>
+#include <QThreadPool>
 #include <QTimer>
 
 #include <ThreadedAssignment.h>
@@ -21,6 +22,7 @@
 #include <MetavoxelData.h>
 
 class MetavoxelEditMessage;
+class MetavoxelPersister;
 class MetavoxelSession;
 
 /// Maintains a shared metavoxel system, accepting change requests and broadcasting updates.
@@ -30,6 +32,7 @@ class MetavoxelServer : public ThreadedAssignment {
 public:
     
     MetavoxelServer(const QByteArray& packet);
+    virtual ~MetavoxelServer();
 
     void applyEdit(const MetavoxelEditMessage& edit);
 
@@ -39,19 +42,67 @@ public:
     
     virtual void readPendingDatagrams();
     
+    virtual void aboutToFinish();
+
+public slots:
+    
+    virtual void sendStatsPacket();
+    
 private slots:
 
     void maybeAttachSession(const SharedNodePointer& node);
     void sendDeltas();    
+    void maybeSaveData();
+    void recordSave(qint64 elapsed, qint64 size);
     
 private:
     
+    void loadData();
+    
     QTimer _sendTimer;
     qint64 _lastSend;
     
+    QString _persistFilename;
+    QThread* _persistThread;
+    MetavoxelPersister* _persister;
+    QTimer _persistTimer;
+    MetavoxelData _savedData;
+    bool _saving;
+    
+    qint64 _loadTime;
+    qint64 _lastSaveTime;
+    qint64 _lastSaveSize;
+    int _saveCount;
+    
+    QThreadPool _encoderPool;
+    
     MetavoxelData _data;
 };
 
+/// Writes snapshots of the metavoxel data to disk on a separate thread.
+class MetavoxelPersister : public QObject {
+    Q_OBJECT
+
+public:
+    
+    /// Creates a persister that saves the specified data, which the owner must not modify while a save is in progress.
+    /// Because the data is a structurally shared copy, edits to the live data do not affect it.
+    MetavoxelPersister(const QString& filename, const MetavoxelData& data);
+    
+    /// Writes the data to the persist file.
+    Q_INVOKABLE void save();
+
+signals:
+    
+    /// Emitted after each save with the time taken (in microseconds) and the size of the file written.
+    void saved(qint64 elapsed, qint64 size);
+
+private:
+    
+    QString _filename;
+    const MetavoxelData& _data;
+};
+
 /// Contains the state of a single client session.
 class MetavoxelSession : public NodeData {
     Q_OBJECT
@@ -63,7 +114,24 @@ public:
 
     virtual int parseData(const QByteArray& packet);
 
-    void sendDelta();
+    /// Returns a reference to the data acknowledged by the client, against which we encode our deltas.
+    const MetavoxelData& getReferenceData() const { return _sendRecords.first().data; }
+    
+    /// Returns a reference to the LOD with which the reference data was sent.
+    const MetavoxelLOD& getReferenceLOD() const { return _sendRecords.first().lod; }
+    
+    /// Returns a reference to the LOD most recently reported by the client.
+    const MetavoxelLOD& getLOD() const { return _lod; }
+
+    /// Adds the data held for unacknowledged sends to the provided memory tally.
+    void addMemoryUsage(MetavoxelMemoryUsage& usage) const;
+
+    /// Starts a delta packet, if we're ready to send one.
+    /// \return the stream to which the caller should write the delta, or NULL if not ready
+    Bitstream* startDelta();
+    
+    /// Sends the delta packet started with startDelta and records the send.
+    void endDelta();
 
 private slots:
 
@@ -0,0 +1,334 @@
+//
+//  JurisdictionHandoff.cpp
+//  assignment-client/src/octree
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QtCore/QDataStream>
+#include <QtCore/QDebug>
+
+#include <NodeList.h>
+#include <OctalCode.h>
+#include <UUID.h>
+
+#include "OctreeServer.h"
+
+#include "JurisdictionHandoff.h"
+
+const int HANDOFF_PACKETS_PER_SECOND = 500;
+const int HANDOFF_REQUEST_INTERVAL_MSECS = 1000;
+
+// if our parent hasn't shown up in our node list by now it has probably gone away, and we'll run with what we persisted
+const int MAX_HANDOFF_REQUESTS_WITHOUT_PARENT = 30;
+
+// keep the list of missing chunks in a request well inside a single packet
+const int MAX_MISSING_CHUNKS_PER_REQUEST = 256;
+
+JurisdictionHandoff::JurisdictionHandoff(OctreeServer* myServer) :
+    _myServer(myServer),
+    _packetSender(HANDOFF_PACKETS_PER_SECOND),
+    _assignedOwners(),
+    _outgoingChunks(),
+    _parentUUID(),
+    _requestTimer(),
+    _requestsWithoutParent(0),
+    _receivedChunks(),
+    _receivedChunkCount(0),
+    _isComplete(false)
+{
+    _packetSender.initialize(true);
+    connect(&_requestTimer, SIGNAL(timeout()), SLOT(sendRequest()));
+}
+
+JurisdictionHandoff::~JurisdictionHandoff() {
+    _packetSender.terminate();
+}
+
+bool JurisdictionHandoff::handlesPacketType(PacketType packetType) {
+    return packetType == PacketTypeJurisdictionHandoffRequest || packetType == PacketTypeJurisdictionHandoffData
+        || packetType == PacketTypeJurisdictionHandoffComplete;
+}
+
+void JurisdictionHandoff::requestFrom(const QUuid& parentUUID) {
+    _parentUUID = parentUUID;
+    _requestsWithoutParent = 0;
+    _isComplete = false;
+    _requestTimer.start(HANDOFF_REQUEST_INTERVAL_MSECS);
+}
+
+void JurisdictionHandoff::processPacket(const SharedNodePointer& sendingNode, const QByteArray& packet) {
+    // subtrees only ever move between servers of the same type
+    if (!sendingNode || sendingNode->getType() != _myServer->getMyNodeType()) {
+        return;
+    }
+    switch (packetTypeForPacket(packet)) {
+        case PacketTypeJurisdictionHandoffRequest:
+            handleRequest(sendingNode, packet);
+            break;
+
+        case PacketTypeJurisdictionHandoffData:
+            handleData(sendingNode, packet);
+            break;
+
+        case PacketTypeJurisdictionHandoffComplete:
+            handleComplete(sendingNode, packet);
+            break;
+
+        default:
+            break;
+    }
+}
+
+void JurisdictionHandoff::processSplitPacket(const QByteArray& packet) {
+    QDataStream packetStream(packet);
+    packetStream.skipRawData(numBytesForPacketHeader(packet));
+
+    QByteArray octantCodeBytes;
+    QUuid ownerUUID;
+    packetStream >> octantCodeBytes >> ownerUUID;
+
+    const unsigned char* octalCode = reinterpret_cast<const unsigned char*>(octantCodeBytes.constData());
+    if (octantCodeBytes.isEmpty() || ownerUUID.isNull()
+            || numberOfThreeBitSectionsInCode(octalCode, octantCodeBytes.size()) == OVERFLOWED_OCTCODE_BUFFER) {
+        return;
+    }
+
+    QString hexCode = octalCodeToHexString(octalCode);
+    if (_assignedOwners.value(hexCode) != ownerUUID) {
+        qDebug() << "Subtree" << hexCode << "has been assigned to" << uuidStringWithoutCurlyBraces(ownerUUID);
+        _assignedOwners.insert(hexCode, ownerUUID);
+    }
+}
+
+void JurisdictionHandoff::sendRequest() {
+    JurisdictionMap* jurisdiction = _myServer->getJurisdiction();
+    if (_isComplete || !jurisdiction || !jurisdiction->getRootOctalCode()) {
+        _requestTimer.stop();
+        return;
+    }
+
+    NodeList* nodeList = NodeList::getInstance();
+    SharedNodePointer parentNode = nodeList->nodeWithUUID(_parentUUID);
+    if (!parentNode || !parentNode->getActiveSocket()) {
+        if (++_requestsWithoutParent == MAX_HANDOFF_REQUESTS_WITHOUT_PARENT) {
+            qDebug() << "Giving up on jurisdiction handoff from" << uuidStringWithoutCurlyBraces(_parentUUID);
+            _requestTimer.stop();
+        }
+        return;
+    }
+
+    const unsigned char* rootCode = jurisdiction->getRootOctalCode();
+    QByteArray rootCodeBytes(reinterpret_cast<const char*>(rootCode),
+                             bytesRequiredForCodeLength(numberOfThreeBitSectionsInCode(rootCode)));
+
+    // an empty list means we haven't heard anything yet and want all of it
+    QList<quint16> missingChunks;
+    for (int i = 0; i < _receivedChunks.size() && missingChunks.size() < MAX_MISSING_CHUNKS_PER_REQUEST; i++) {
+        if (!_receivedChunks.at(i)) {
+            missingChunks.append(i);
+        }
+    }
+
+    QByteArray requestPacket = byteArrayWithPopulatedHeader(PacketTypeJurisdictionHandoffRequest);
+    QDataStream requestStream(&requestPacket, QIODevice::Append);
+    requestStream << rootCodeBytes << missingChunks;
+
+    nodeList->writeDatagram(requestPacket, parentNode);
+}
+
+void JurisdictionHandoff::handleRequest(const SharedNodePointer& sendingNode, const QByteArray& packet) {
+    QDataStream packetStream(packet);
+    packetStream.skipRawData(numBytesForPacketHeader(packet));
+
+    QByteArray rootCodeBytes;
+    QList<quint16> missingChunks;
+    packetStream >> rootCodeBytes >> missingChunks;
+
+    const unsigned char* octalCode = reinterpret_cast<const unsigned char*>(rootCodeBytes.constData());
+    if (rootCodeBytes.isEmpty()
+            || numberOfThreeBitSectionsInCode(octalCode, rootCodeBytes.size()) == OVERFLOWED_OCTCODE_BUFFER) {
+        return;
+    }
+
+    // carving out a subtree deletes it from our tree, so only its assigned owner gets to ask for it
+    QString hexCode = octalCodeToHexString(octalCode);
+    if (_assignedOwners.value(hexCode) != sendingNode->getUUID()) {
+        qDebug() << "Ignoring request for subtree" << hexCode << "from"
+            << uuidStringWithoutCurlyBraces(sendingNode->getUUID()) << "- it hasn't been assigned to them.";
+        return;
+    }
+    if (!_outgoingChunks.contains(hexCode)) {
+        QVector<QByteArray> chunks;
+        if (!carveOutSubtree(octalCode, chunks)) {
+            return;
+        }
+        qDebug() << "Handing off" << chunks.size() << "chunks of subtree" << hexCode << "to"
+            << uuidStringWithoutCurlyBraces(sendingNode->getUUID());
+        _outgoingChunks.insert(hexCode, chunks);
+    }
+    sendChunks(sendingNode, _outgoingChunks.value(hexCode), missingChunks);
+}
+
+bool JurisdictionHandoff::carveOutSubtree(const unsigned char* octalCode, QVector<QByteArray>& chunks) {
+    Octree* tree = _myServer->getOctree();
+
+    // hold the write lock throughout, so that no edit can land between encoding the subtree and removing it
+    tree->lockForWrite();
+
+    JurisdictionMap* jurisdiction = _myServer->getJurisdiction();
+    JurisdictionMap::Area area = jurisdiction ? jurisdiction->isMyJurisdiction(octalCode, CHECK_NODE_ONLY)
+        : JurisdictionMap::WITHIN;
+    if (area == JurisdictionMap::ABOVE) {
+        // they're asking for more than we have; that's not a split of ours
+        tree->unlock();
+        return false;
+    }
+
+    // if the subtree is already outside our jurisdiction (we handed it off before the requester restarted, say) there's
+    // nothing to send, and the empty chunk list tells the requester so
+    if (area == JurisdictionMap::WITHIN) {
+        VoxelPositionSize details;
+        voxelDetailsForCode(octalCode, details);
+        OctreeElement* subtreeRoot = tree->getOctreeElementAt(details.x, details.y, details.z, details.s);
+
+        if (subtreeRoot) {
+            OctreeElementBag elementBag;
+            elementBag.insert(subtreeRoot);
+            OctreePacketData packetData;
+
+            while (!elementBag.isEmpty()) {
+                OctreeElement* subtree = elementBag.extract();
+                EncodeBitstreamParams params(INT_MAX, IGNORE_VIEW_FRUSTUM, WANT_COLOR, NO_EXISTS_BITS);
+                int bytesWritten = tree->encodeTreeBitstream(subtree, &packetData, elementBag, params);
+
+                if (bytesWritten == 0 && params.stopReason == EncodeBitstreamParams::DIDNT_FIT) {
+                    if (!packetData.hasContent()) {
+                        qDebug() << "Subtree element too large for a handoff packet, dropping it.";
+                        elementBag.remove(subtree);
+                        continue;
+                    }
+                    chunks.append(QByteArray(reinterpret_cast<const char*>(packetData.getFinalizedData()),
+                                             packetData.getFinalizedSize()));
+                    packetData.reset();
+                    elementBag.insert(subtree);
+                }
+            }
+            if (packetData.hasContent()) {
+                chunks.append(QByteArray(reinterpret_cast<const char*>(packetData.getFinalizedData()),
+                                         packetData.getFinalizedSize()));
+            }
+            tree->deleteOctalCodeFromTree(octalCode, COLLAPSE_EMPTY_TREE);
+        }
+        _myServer->addJurisdictionEndNode(octalCode);
+    }
+
+    tree->unlock();
+    return true;
+}
+
+void JurisdictionHandoff::sendChunks(const SharedNodePointer& destinationNode, const QVector<QByteArray>& chunks,
+                                     const QList<quint16>& chunkIndices) {
+    quint16 chunkCount = chunks.size();
+    if (chunkCount == 0) {
+        QByteArray emptyPacket = byteArrayWithPopulatedHeader(PacketTypeJurisdictionHandoffData);
+        QDataStream emptyStream(&emptyPacket, QIODevice::Append);
+        emptyStream << (quint16)0 << chunkCount;
+        _packetSender.queuePacketForSending(destinationNode, emptyPacket);
+        return;
+    }
+
+    QList<quint16> indices = chunkIndices;
+    if (indices.isEmpty()) {
+        for (quint16 i = 0; i < chunkCount; i++) {
+            indices.append(i);
+        }
+    }
+    foreach (quint16 index, indices) {
+        if (index < chunkCount) {
+            QByteArray dataPacket = byteArrayWithPopulatedHeader(PacketTypeJurisdictionHandoffData);
+            QDataStream dataStream(&dataPacket, QIODevice::Append);
+            dataStream << index << chunkCount;
+            dataPacket.append(chunks.at(index));
+            _packetSender.queuePacketForSending(destinationNode, dataPacket);
+        }
+    }
+}
+
+void JurisdictionHandoff::handleData(const SharedNodePointer& sendingNode, const QByteArray& packet) {
+    if (_isComplete || sendingNode->getUUID() != _parentUUID) {
+        return;
+    }
+    QDataStream packetStream(packet);
+    int numBytesPacketHeader = numBytesForPacketHeader(packet);
+    packetStream.skipRawData(numBytesPacketHeader);
+
+    quint16 chunkIndex, chunkCount;
+    packetStream >> chunkIndex >> chunkCount;
+
+    if (chunkCount == 0) {
+        finish();
+        return;
+    }
+    if (_receivedChunks.isEmpty()) {
+        _receivedChunks.fill(false, chunkCount);
+    }
+    if (chunkIndex >= _receivedChunks.size() || _receivedChunks.at(chunkIndex)) {
+        return;
+    }
+
+    int numBytesChunkHeader = numBytesPacketHeader + sizeof(chunkIndex) + sizeof(chunkCount);
+    Octree* tree = _myServer->getOctree();
+    tree->lockForWrite();
+    ReadBitstreamToTreeParams args(WANT_COLOR, NO_EXISTS_BITS, NULL, 0, SharedNodePointer(), false);
+    tree->readBitstreamToTree(reinterpret_cast<const unsigned char*>(packet.constData()) + numBytesChunkHeader,
+                              packet.size() - numBytesChunkHeader, args);
+    tree->setDirtyBit();
+    tree->unlock();
+
+    _receivedChunks[chunkIndex] = true;
+    if (++_receivedChunkCount == _receivedChunks.size()) {
+        finish();
+    }
+}
+
+void JurisdictionHandoff::handleComplete(const SharedNodePointer& sendingNode, const QByteArray& packet) {
+    QDataStream packetStream(packet);
+    packetStream.skipRawData(numBytesForPacketHeader(packet));
+
+    QByteArray rootCodeBytes;
+    packetStream >> rootCodeBytes;
+
+    const unsigned char* octalCode = reinterpret_cast<const unsigned char*>(rootCodeBytes.constData());
+    if (rootCodeBytes.isEmpty()
+            || numberOfThreeBitSectionsInCode(octalCode, rootCodeBytes.size()) == OVERFLOWED_OCTCODE_BUFFER) {
+        return;
+    }
+
+    // only the node we sent the chunks to can tell us that it has them
+    QString hexCode = octalCodeToHexString(octalCode);
+    if (_assignedOwners.value(hexCode) == sendingNode->getUUID()) {
+        _outgoingChunks.remove(hexCode);
+    }
+}
+
+void JurisdictionHandoff::finish() {
+    _isComplete = true;
+    _requestTimer.stop();
+    qDebug() << "Jurisdiction handoff complete," << _receivedChunkCount << "chunks received.";
+
+    // let the parent drop what it was holding for us
+    SharedNodePointer parentNode = NodeList::getInstance()->nodeWithUUID(_parentUUID);
+    JurisdictionMap* jurisdiction = _myServer->getJurisdiction();
+    if (parentNode && jurisdiction) {
+        const unsigned char* rootCode = jurisdiction->getRootOctalCode();
+        QByteArray completePacket = byteArrayWithPopulatedHeader(PacketTypeJurisdictionHandoffComplete);
+        QDataStream completeStream(&completePacket, QIODevice::Append);
+        completeStream << QByteArray(reinterpret_cast<const char*>(rootCode),
+                                     bytesRequiredForCodeLength(numberOfThreeBitSectionsInCode(rootCode)));
+        NodeList::getInstance()->writeDatagram(completePacket, parentNode);
+    }
+}
@@ -0,0 +1,80 @@
+//
+//  JurisdictionHandoff.h
+//  assignment-client/src/octree
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_JurisdictionHandoff_h
+#define hifi_JurisdictionHandoff_h
+
+#include <QtCore/QHash>
+#include <QtCore/QObject>
+#include <QtCore/QTimer>
+#include <QtCore/QUuid>
+#include <QtCore/QVector>
+
+#include <PacketHeaders.h>
+#include <PacketSender.h>
+
+class OctreeServer;
+
+/// Moves a subtree between octree servers when the domain server splits a busy jurisdiction.  The server taking over the
+/// subtree (the child) repeatedly asks the server that owned it (the parent) for its contents.  The parent only answers
+/// the node that the domain server has named as the subtree's new owner.  On the first request the parent carves the
+/// subtree out of its tree and jurisdiction and holds the encoded contents until the child confirms that it has every
+/// chunk, resending whichever chunks the child reports missing.
+class JurisdictionHandoff : public QObject {
+    Q_OBJECT
+public:
+    JurisdictionHandoff(OctreeServer* myServer);
+    ~JurisdictionHandoff();
+
+    static bool handlesPacketType(PacketType packetType);
+
+    /// Starts asking the server with the given session UUID for the subtree at the root of our jurisdiction.
+    void requestFrom(const QUuid& parentUUID);
+
+    bool isComplete() const { return _isComplete; }
+
+    void processPacket(const SharedNodePointer& sendingNode, const QByteArray& packet);
+
+public slots:
+    /// Records which node the domain server has assigned a subtree of our jurisdiction to.
+    void processSplitPacket(const QByteArray& packet);
+
+private slots:
+    void sendRequest();
+
+private:
+    void handleRequest(const SharedNodePointer& sendingNode, const QByteArray& packet);
+    void handleData(const SharedNodePointer& sendingNode, const QByteArray& packet);
+    void handleComplete(const SharedNodePointer& sendingNode, const QByteArray& packet);
+
+    bool carveOutSubtree(const unsigned char* octalCode, QVector<QByteArray>& chunks);
+    void sendChunks(const SharedNodePointer& destinationNode, const QVector<QByteArray>& chunks,
+                    const QList<quint16>& chunkIndices);
+    void finish();
+
+    OctreeServer* _myServer;
+    PacketSender _packetSender;
+
+    // parent side: the session UUIDs of the nodes the domain server has assigned our subtrees to, by hex octal code
+    QHash<QString, QUuid> _assignedOwners;
+
+    // parent side: encoded subtrees we've given up, keyed by hex octal code, until their new owners confirm receipt
+    QHash<QString, QVector<QByteArray> > _outgoingChunks;
+
+    // child side
+    QUuid _parentUUID;
+    QTimer _requestTimer;
+    int _requestsWithoutParent;
+    QVector<bool> _receivedChunks;
+    int _receivedChunkCount;
+    bool _isComplete;
+};
+
+#endif // hifi_JurisdictionHandoff_h
@@ -0,0 +1,103 @@
+//
+//  JurisdictionLoadTracker.cpp
+//  assignment-client/src/octree
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <SharedUtil.h>
+
+#include "JurisdictionLoadTracker.h"
+
+const float JurisdictionLoadTracker::QUERY_PACKET_LOAD_WEIGHT = 0.1f;
+
+JurisdictionLoadTracker::JurisdictionLoadTracker() :
+    _rootCorner(0.0f, 0.0f, 0.0f),
+    _rootSize(1.0f),
+    _lastSample(usecTimestampNow())
+{
+    for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+        _octantCodes[i] = NULL;
+    }
+    setJurisdiction(NULL);
+}
+
+JurisdictionLoadTracker::~JurisdictionLoadTracker() {
+    clearOctantCodes();
+}
+
+void JurisdictionLoadTracker::setJurisdiction(const JurisdictionMap* map) {
+    QMutexLocker locker(&_mutex);
+
+    unsigned char wholeTreeCode = 0;
+    const unsigned char* rootCode = (map && map->getRootOctalCode()) ? map->getRootOctalCode() : &wholeTreeCode;
+
+    VoxelPositionSize rootDetails;
+    voxelDetailsForCode(rootCode, rootDetails);
+    _rootCorner = glm::vec3(rootDetails.x, rootDetails.y, rootDetails.z);
+    _rootSize = rootDetails.s;
+
+    clearOctantCodes();
+    for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+        _octantCodes[i] = childOctalCode(rootCode, i);
+        _editCounts[i] = _queryCounts[i] = 0;
+        _editRates[i] = _queryRates[i] = 0.0f;
+    }
+    _lastSample = usecTimestampNow();
+}
+
+void JurisdictionLoadTracker::recordEdit(const glm::vec3& position) {
+    int octant = octantContaining(position);
+    if (octant != -1) {
+        QMutexLocker locker(&_mutex);
+        _editCounts[octant]++;
+    }
+}
+
+void JurisdictionLoadTracker::recordQuery(const glm::vec3& position, int packets) {
+    int octant = octantContaining(position);
+    if (octant != -1) {
+        QMutexLocker locker(&_mutex);
+        _queryCounts[octant] += packets;
+    }
+}
+
+void JurisdictionLoadTracker::sample() {
+    QMutexLocker locker(&_mutex);
+
+    quint64 now = usecTimestampNow();
+    float elapsedSeconds = (float)(now - _lastSample) / USECS_PER_SECOND;
+    if (elapsedSeconds <= 0.0f) {
+        return;
+    }
+    _lastSample = now;
+
+    for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+        _editRates[i] = _editCounts[i] / elapsedSeconds;
+        _queryRates[i] = _queryCounts[i] / elapsedSeconds;
+        _editCounts[i] = _queryCounts[i] = 0;
+    }
+}
+
+int JurisdictionLoadTracker::octantContaining(const glm::vec3& position) const {
+    // the root bounds are only set before the processing threads start, so we can read them without the mutex
+    glm::vec3 relative = position - _rootCorner;
+    if (relative.x < 0.0f || relative.y < 0.0f || relative.z < 0.0f ||
+            relative.x >= _rootSize || relative.y >= _rootSize || relative.z >= _rootSize) {
+        return -1;
+    }
+
+    // octal code sections order their bits x, y, z
+    float halfSize = _rootSize * 0.5f;
+    return ((relative.x >= halfSize) << 2) | ((relative.y >= halfSize) << 1) | (relative.z >= halfSize);
+}
+
+void JurisdictionLoadTracker::clearOctantCodes() {
+    for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+        delete[] _octantCodes[i];
+        _octantCodes[i] = NULL;
+    }
+}
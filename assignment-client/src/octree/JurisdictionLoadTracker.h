@@ -0,0 +1,73 @@
+//
+//  JurisdictionLoadTracker.h
+//  assignment-client/src/octree
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_JurisdictionLoadTracker_h
+#define hifi_JurisdictionLoadTracker_h
+
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+
+#include <glm/glm.hpp>
+
+#include <JurisdictionMap.h>
+#include <OctalCode.h>
+#include <OctreeConstants.h>
+
+/// Tracks the edit and query load falling in each of the eight child octants of a server's jurisdiction root, so that the
+/// domain server can tell which subtree to split off when a server gets too busy.
+class JurisdictionLoadTracker {
+public:
+    /// Query packets are cheaper for us than edits, which take the tree write lock; weight them down in the combined load.
+    static const float QUERY_PACKET_LOAD_WEIGHT;
+
+    JurisdictionLoadTracker();
+    ~JurisdictionLoadTracker();
+
+    /// Sets the jurisdiction whose octants we track, or the whole tree if map is NULL.  Resets the counts.
+    void setJurisdiction(const JurisdictionMap* map);
+
+    /// Counts an edit at the given position, in tree units.
+    /// \thread any thread
+    void recordEdit(const glm::vec3& position);
+
+    /// Counts packets sent to a viewer at the given position, in tree units.
+    /// \thread any thread
+    void recordQuery(const glm::vec3& position, int packets);
+
+    /// Converts the counts since the last sample into per-second rates and resets them.
+    void sample();
+
+    const unsigned char* getOctantOctalCode(int octant) const { return _octantCodes[octant]; }
+    QString getOctantHexCode(int octant) const { return octalCodeToHexString(_octantCodes[octant]); }
+
+    float getEditRate(int octant) const { return _editRates[octant]; }
+    float getQueryRate(int octant) const { return _queryRates[octant]; }
+
+    /// Returns the combined edit and weighted query load for the octant, per second.
+    float getLoad(int octant) const { return _editRates[octant] + _queryRates[octant] * QUERY_PACKET_LOAD_WEIGHT; }
+
+private:
+    int octantContaining(const glm::vec3& position) const;
+    void clearOctantCodes();
+
+    QMutex _mutex;
+
+    glm::vec3 _rootCorner;
+    float _rootSize;
+    unsigned char* _octantCodes[NUMBER_OF_CHILDREN];
+
+    int _editCounts[NUMBER_OF_CHILDREN];
+    int _queryCounts[NUMBER_OF_CHILDREN];
+    float _editRates[NUMBER_OF_CHILDREN];
+    float _queryRates[NUMBER_OF_CHILDREN];
+    quint64 _lastSample;
+};
+
+#endif // hifi_JurisdictionLoadTracker_h
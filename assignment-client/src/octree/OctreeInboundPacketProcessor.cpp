@@ -11,6 +11,7 @@
 
 #include <PacketHeaders.h>
 #include <PerfStat.h>
+#include <Trace.h>
 
 #include "OctreeServer.h"
 #include "OctreeServerConsts.h"
@@ -19,13 +20,16 @@
 static QUuid DEFAULT_NODE_ID_REF;
 
 OctreeInboundPacketProcessor::OctreeInboundPacketProcessor(OctreeServer* myServer) :
+    ReceivedPacketProcessor("octree_server.inbound_queue_usecs"),
     _myServer(myServer),
     _receivedPacketCount(0),
     _totalTransitTime(0),
     _totalProcessTime(0),
     _totalLockWaitTime(0),
     _totalElementsInPacket(0),
-    _totalPackets(0)
+    _totalPackets(0),
+    _totalLockHoldTime(0),
+    _totalLockHolds(0)
 {
 }
 
@@ -36,11 +40,53 @@ void OctreeInboundPacketProcessor::resetStats() {
     _totalElementsInPacket = 0;
     _totalPackets = 0;
 
+    _totalLockHoldTime = 0;
+    _totalLockHolds = 0;
+    _lockHoldHistogram.reset();
+    _editThroughputHistogram.reset();
+
     _singleSenderStats.clear();
 }
 
-
 void OctreeInboundPacketProcessor::processPacket(const SharedNodePointer& sendingNode, const QByteArray& packet) {
+    std::vector<NetworkPacket> packets(1, NetworkPacket(sendingNode, packet));
+    processPackets(packets);
+}
+
+// the longest we'll hold the write lock before letting the send threads have a turn
+const quint64 MAX_WRITE_LOCK_HOLD_USECS = 10 * USECS_PER_MSEC;
+
+void OctreeInboundPacketProcessor::processPackets(const std::vector<NetworkPacket>& packets) {
+    TraceScope trace("OctreeInboundPacketProcessor::processPackets");
+    Octree* tree = _myServer->getOctree();
+    
+    quint64 startLock = usecTimestampNow();
+    tree->lockForWrite();
+    quint64 lockAcquired = usecTimestampNow();
+    quint64 lockWaitTime = lockAcquired - startLock;
+    int editsApplied = 0;
+    
+    for (std::vector<NetworkPacket>::const_iterator packet = packets.begin(); packet != packets.end(); packet++) {
+        quint64 now = usecTimestampNow();
+        if (now - lockAcquired > MAX_WRITE_LOCK_HOLD_USECS) {
+            tree->unlock();
+            trackLockHold(now - lockAcquired, editsApplied);
+            
+            startLock = usecTimestampNow();
+            tree->lockForWrite();
+            lockAcquired = usecTimestampNow();
+            lockWaitTime += lockAcquired - startLock;
+            editsApplied = 0;
+        }
+        editsApplied += processEditPacket(packet->getDestinationNode(), packet->getByteArray(), lockWaitTime);
+    }
+    
+    tree->unlock();
+    trackLockHold(usecTimestampNow() - lockAcquired, editsApplied);
+}
+
+int OctreeInboundPacketProcessor::processEditPacket(const SharedNodePointer& sendingNode, const QByteArray& packet,
+        quint64& lockWaitTime) {
 
     bool debugProcessPacket = _myServer->wantsVerboseDebug();
 
@@ -65,7 +111,6 @@ void OctreeInboundPacketProcessor::processPacket(const SharedNodePointer& sendin
         quint64 transitTime = arrivedAt - sentAt;
         int editsInPacket = 0;
         quint64 processTime = 0;
-        quint64 lockWaitTime = 0;
 
         if (_myServer->wantsDebugReceiving()) {
             qDebug() << "PROCESSING THREAD: got '" << packetType << "' packet - " << _receivedPacketCount
@@ -83,21 +128,19 @@ void OctreeInboundPacketProcessor::processPacket(const SharedNodePointer& sendin
                         packetType, packetData, packet.size(), editData, atByte, maxSize);
             }
 
-            quint64 startLock = usecTimestampNow();
-            _myServer->getOctree()->lockForWrite();
             quint64 startProcess = usecTimestampNow();
             int editDataBytesRead = _myServer->getOctree()->processEditPacketData(packetType,
                                                                                   reinterpret_cast<const unsigned char*>(packet.data()),
                                                                                   packet.size(),
                                                                                   editData, maxSize, sendingNode);
-            _myServer->getOctree()->unlock();
             quint64 endProcess = usecTimestampNow();
+            
+            if (editDataBytesRead > 0) {
+                _myServer->getLoadTracker().recordEdit(_myServer->getOctree()->getLastEditPosition());
+            }
 
             editsInPacket++;
-            quint64 thisProcessTime = endProcess - startProcess;
-            quint64 thisLockWaitTime = startProcess - startLock;
-            processTime += thisProcessTime;
-            lockWaitTime += thisLockWaitTime;
+            processTime += endProcess - startProcess;
 
             // skip to next voxel edit record in the packet
             editData += editDataBytesRead;
@@ -124,9 +167,11 @@ void OctreeInboundPacketProcessor::processPacket(const SharedNodePointer& sendin
             }
         }
         trackInboundPackets(nodeUUID, sequence, transitTime, editsInPacket, processTime, lockWaitTime);
-    } else {
-        qDebug("unknown packet ignored... packetType=%d", packetType);
+        lockWaitTime = 0;
+        return editsInPacket;
     }
+    qDebug("unknown packet ignored... packetType=%d", packetType);
+    return 0;
 }
 
 void OctreeInboundPacketProcessor::trackInboundPackets(const QUuid& nodeUUID, int sequence, quint64 transitTime,
@@ -160,6 +205,14 @@ void OctreeInboundPacketProcessor::trackInboundPackets(const QUuid& nodeUUID, in
     }
 }
 
+void OctreeInboundPacketProcessor::trackLockHold(quint64 lockHoldTime, int editsApplied) {
+    _totalLockHoldTime += lockHoldTime;
+    _totalLockHolds++;
+    _lockHoldHistogram.addSample(lockHoldTime);
+    if (editsApplied > 0) {
+        _editThroughputHistogram.addSample(editsApplied * USECS_PER_SECOND / qMax(lockHoldTime, (quint64)1));
+    }
+}
 
 SingleSenderStats::SingleSenderStats() {
     _totalTransitTime = 0;
@@ -169,4 +222,28 @@ SingleSenderStats::SingleSenderStats() {
     _totalPackets = 0;
 }
 
+void PowerOfTwoHistogram::reset() {
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        _buckets[i] = 0;
+    }
+    _sampleCount = 0;
+}
+
+void PowerOfTwoHistogram::addSample(quint64 value) {
+    int index = 0;
+    while (index < BUCKET_COUNT - 1 && value >= ((quint64)1 << index)) {
+        index++;
+    }
+    _buckets[index]++;
+    _sampleCount++;
+}
 
+QString PowerOfTwoHistogram::toString() const {
+    QString result;
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        if (_buckets[i] != 0) {
+            result += QString("<%1:%2 ").arg((quint64)1 << i).arg(_buckets[i]);
+        }
+    }
+    return result.trimmed();
+}
@@ -40,6 +40,30 @@ public:
     quint64 _totalPackets;
 };
 
+/// Counts samples in buckets whose upper bounds are successive powers of two.
+class PowerOfTwoHistogram {
+public:
+    static const int BUCKET_COUNT = 32;
+
+    PowerOfTwoHistogram() { reset(); }
+
+    void reset();
+    void addSample(quint64 value);
+
+    quint64 getSampleCount() const { return _sampleCount; }
+
+    /// Returns the number of samples less than 2^index (and at least 2^(index - 1)); the last bucket also holds any
+    /// larger samples.
+    quint64 getBucket(int index) const { return _buckets[index]; }
+
+    /// Returns the non-empty buckets as "<bound:count" pairs.
+    QString toString() const;
+
+private:
+    quint64 _buckets[BUCKET_COUNT];
+    quint64 _sampleCount;
+};
+
 typedef std::map<QUuid, SingleSenderStats> NodeToSenderStatsMap;
 typedef std::map<QUuid, SingleSenderStats>::iterator NodeToSenderStatsMapIterator;
 
@@ -61,6 +85,15 @@ public:
     quint64 getAverageLockWaitTimePerElement() const 
                 { return _totalElementsInPacket == 0 ? 0 : _totalLockWaitTime / _totalElementsInPacket; }
 
+    quint64 getTotalLockHolds() const { return _totalLockHolds; }
+    quint64 getAverageLockHoldTime() const { return _totalLockHolds == 0 ? 0 : _totalLockHoldTime / _totalLockHolds; }
+
+    /// Histogram of the time (in usecs) the tree write lock was held for each batch of edits.
+    const PowerOfTwoHistogram& getLockHoldHistogram() const { return _lockHoldHistogram; }
+
+    /// Histogram of the rate (in edits/second) at which each batch of edits was applied while holding the lock.
+    const PowerOfTwoHistogram& getEditThroughputHistogram() const { return _editThroughputHistogram; }
+
     void resetStats();
 
     NodeToSenderStatsMap& getSingleSenderStats() { return _singleSenderStats; }
@@ -68,10 +101,21 @@ public:
 protected:
     virtual void processPacket(const SharedNodePointer& sendingNode, const QByteArray& packet);
 
+    /// Applies the edits in all of the drained packets under a single write lock, yielding the lock to the send threads
+    /// whenever it has been held for longer than our budget.
+    virtual void processPackets(const std::vector<NetworkPacket>& packets);
+
 private:
+    /// Applies the edits of a single packet; the caller must hold the tree's write lock.
+    /// \param lockWaitTime time spent waiting for the lock, charged to this packet and then reset
+    /// \return the number of edits in the packet
+    int processEditPacket(const SharedNodePointer& sendingNode, const QByteArray& packet, quint64& lockWaitTime);
+
     void trackInboundPackets(const QUuid& nodeUUID, int sequence, quint64 transitTime, 
             int voxelsInPacket, quint64 processTime, quint64 lockWaitTime);
 
+    void trackLockHold(quint64 lockHoldTime, int editsApplied);
+
     OctreeServer* _myServer;
     int _receivedPacketCount;
     
@@ -81,6 +125,11 @@ private:
     quint64 _totalElementsInPacket;
     quint64 _totalPackets;
     
+    quint64 _totalLockHoldTime;
+    quint64 _totalLockHolds;
+    PowerOfTwoHistogram _lockHoldHistogram;
+    PowerOfTwoHistogram _editThroughputHistogram;
+    
     NodeToSenderStatsMap _singleSenderStats;
 };
 #endif // hifi_OctreeInboundPacketProcessor_h
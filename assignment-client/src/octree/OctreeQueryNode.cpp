@@ -38,6 +38,7 @@ OctreeQueryNode::OctreeQueryNode() :
     _lastClientOctreeSizeScale(DEFAULT_OCTREE_SIZE_SCALE),
     _lodChanged(false),
     _lodInitialized(false),
+    _congestionBoundaryLevelAdjust(0),
     _sequenceNumber(0),
     _lastRootTimestamp(0),
     _myPacketType(PacketTypeUnknown),
@@ -276,6 +277,10 @@ bool OctreeQueryNode::updateCurrentViewFrustum() {
             _lastClientOctreeSizeScale = getOctreeSizeScale();
             _lodChanged = true;
         }
+        if (_congestionBoundaryLevelAdjust != _sendRateEstimator.getBoundaryLevelAdjust()) {
+            _congestionBoundaryLevelAdjust = _sendRateEstimator.getBoundaryLevelAdjust();
+            _lodChanged = true;
+        }
     } else {
         _lodInitialized = true;
         _lastClientOctreeSizeScale = getOctreeSizeScale();
@@ -365,3 +370,10 @@ void OctreeQueryNode::dumpOutOfView() {
     }
 }
 
+
+void OctreeQueryNode::processReceiverReport(const QByteArray& packet) {
+    OctreeReceiverReport report;
+    if (report.unpackFromPacket(packet)) {
+        _sendRateEstimator.processReport(report, getMaxOctreePacketsPerSecond());
+    }
+}
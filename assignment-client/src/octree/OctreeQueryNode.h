@@ -15,8 +15,8 @@
 #include <iostream>
 
 
-#include <CoverageMap.h>
 #include <NodeData.h>
+#include <OcclusionBuffer.h>
 #include <OctreeConstants.h>
 #include <OctreeElementBag.h>
 #include <OctreePacketData.h>
@@ -24,6 +24,8 @@
 #include <OctreeSceneStats.h>
 #include <ThreadedAssignment.h> // for SharedAssignmentPointer
 
+#include "OctreeSendRateEstimator.h"
+
 class OctreeSendThread;
 
 class OctreeQueryNode : public OctreeQuery {
@@ -55,7 +57,7 @@ public:
     void setMaxLevelReached(int maxLevelReached) { _maxLevelReachedInLastSearch = maxLevelReached; }
 
     OctreeElementBag nodeBag;
-    CoverageMap map;
+    OcclusionBuffer occlusionBuffer;
 
     ViewFrustum& getCurrentViewFrustum() { return _currentViewFrustum; }
     ViewFrustum& getLastKnownViewFrustum() { return _lastKnownViewFrustum; }
@@ -83,6 +85,14 @@ public:
     }
 
     bool hasLodChanged() const { return _lodChanged; };
+
+    /// Returns the levels of detail we're dropping, on top of the client's own boundary level adjust, because the link to
+    /// the client can't keep up.  Picked up alongside the client's own LOD settings, and a change resends the scene the
+    /// same way.
+    int getCongestionBoundaryLevelAdjust() const { return _congestionBoundaryLevelAdjust; }
+
+    OctreeSendRateEstimator& getSendRateEstimator() { return _sendRateEstimator; }
+    void processReceiverReport(const QByteArray& packet);
     
     OctreeSceneStats stats;
     
@@ -135,6 +145,9 @@ private:
     float _lastClientOctreeSizeScale;
     bool _lodChanged;
     bool _lodInitialized;
+    int _congestionBoundaryLevelAdjust;
+
+    OctreeSendRateEstimator _sendRateEstimator;
     
     OCTREE_PACKET_SEQUENCE _sequenceNumber;
     quint64 _lastRootTimestamp;
@@ -0,0 +1,174 @@
+//
+//  OctreeSendRateEstimator.cpp
+//  assignment-client/src/octree
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <algorithm>
+
+#include <SharedUtil.h>
+
+#include "OctreeServerConsts.h"
+
+#include "OctreeSendRateEstimator.h"
+
+// the send thread can't send fewer than one packet an interval anyway
+const float MIN_PACKETS_PER_SECOND = INTERVALS_PER_SECOND;
+
+const float LOSS_DECREASE_THRESHOLD = 0.1f; // back off when we lose more than this
+const float LOSS_INCREASE_THRESHOLD = 0.02f; // only grow when we lose less than this
+const float LOSS_DECREASE_FACTOR = 0.5f;
+
+const int QUEUING_DELAY_THRESHOLD_USECS = 100 * 1000;
+const float QUEUING_DELAY_DECREASE_RATIO = 0.85f;
+
+const float INCREASE_RATIO = 1.08f;
+
+// a client that has caught up on the scene tells us nothing about how much more the link could take, so don't let the
+// rate run off past what it's actually receiving
+const float MAX_RATE_OVER_RECEIVED = 2.0f;
+
+// if we've been sending and haven't heard back for this long, assume the reports (and probably our data) are being lost
+const quint64 REPORT_TIMEOUT_USECS = 2 * USECS_PER_SECOND;
+const float REPORT_TIMEOUT_DECREASE_RATIO = 0.5f;
+
+// the base flight time is the lowest seen over the last window, so that it follows route changes
+const quint64 BASE_DELAY_WINDOW_USECS = 10 * USECS_PER_SECOND;
+
+// sequence numbers further ahead than this are taken to be behind us, having wrapped
+const OCTREE_PACKET_SEQUENCE MAX_SEQUENCE_ADVANCE = 0x8000;
+
+const int MAX_CONGESTION_BOUNDARY_ADJUST = 3;
+
+// don't give detail back until the rate is this far clear of the point where we took it away, so a rate hovering there
+// doesn't have us resending the scene over and over
+const float BOUNDARY_ADJUST_HYSTERESIS = 0.8f;
+
+static int levelsBelowRequested(int requestedPacketsPerSecond, float packetsPerSecond) {
+    // each level coarser roughly halves what the client's view needs from us
+    int levels = 0;
+    while (levels < MAX_CONGESTION_BOUNDARY_ADJUST && packetsPerSecond * (2 << levels) <= requestedPacketsPerSecond) {
+        levels++;
+    }
+    return levels;
+}
+
+OctreeSendRateEstimator::OctreeSendRateEstimator() :
+    _isActive(false),
+    _packetsPerSecond(0.0f),
+    _boundaryLevelAdjust(0),
+    _highestSequence(0),
+    _lossRate(0.0f),
+    _baseFlightTimeUsecs(0),
+    _windowMinFlightTimeUsecs(0),
+    _windowStart(0),
+    _queuingDelayUsecs(0),
+    _lastAverageFlightTimeUsecs(0),
+    _lastReport(0),
+    _packetsSentSinceReport(0)
+{
+}
+
+void OctreeSendRateEstimator::processReport(const OctreeReceiverReport& report, int requestedPacketsPerSecond) {
+    QMutexLocker locker(&_mutex);
+
+    quint64 now = usecTimestampNow();
+    const QList<OctreeSequenceRange>& ranges = report.getReceivedRanges();
+
+    if (!_isActive) {
+        _isActive = true;
+        _packetsPerSecond = std::max(MIN_PACKETS_PER_SECOND, (float)requestedPacketsPerSecond);
+        _highestSequence = ranges.first().first - 1;
+        _baseFlightTimeUsecs = _windowMinFlightTimeUsecs = _lastAverageFlightTimeUsecs = report.getMinFlightTimeUsecs();
+        _windowStart = now;
+    }
+
+    // count what arrived past the highest sequence number we'd heard about, and how far the sequence numbers advanced;
+    // anything at or behind it came late and was already counted lost
+    int packetsReceived = 0;
+    int sequenceAdvance = 0;
+    foreach (const OctreeSequenceRange& range, ranges) {
+        OCTREE_PACKET_SEQUENCE startOffset = range.first - _highestSequence;
+        OCTREE_PACKET_SEQUENCE endOffset = range.second - _highestSequence;
+        if (endOffset == 0 || startOffset >= MAX_SEQUENCE_ADVANCE || endOffset >= MAX_SEQUENCE_ADVANCE) {
+            continue;
+        }
+        if (startOffset == 0) {
+            // a range can start with a sequence number the server reused after suppressing a duplicate
+            startOffset = 1;
+        }
+        packetsReceived += endOffset - startOffset + 1;
+        sequenceAdvance = std::max(sequenceAdvance, (int)endOffset);
+    }
+    if (sequenceAdvance > 0) {
+        _highestSequence += sequenceAdvance;
+        _lossRate = std::max(0.0f, 1.0f - (float)packetsReceived / sequenceAdvance);
+    }
+
+    int minFlightTimeUsecs = report.getMinFlightTimeUsecs();
+    if (now - _windowStart > BASE_DELAY_WINDOW_USECS) {
+        _baseFlightTimeUsecs = _windowMinFlightTimeUsecs;
+        _windowMinFlightTimeUsecs = minFlightTimeUsecs;
+        _windowStart = now;
+    } else {
+        _windowMinFlightTimeUsecs = std::min(_windowMinFlightTimeUsecs, minFlightTimeUsecs);
+    }
+    _baseFlightTimeUsecs = std::min(_baseFlightTimeUsecs, minFlightTimeUsecs);
+    _queuingDelayUsecs = std::max(0, report.getAverageFlightTimeUsecs() - _baseFlightTimeUsecs);
+    bool queueGrowing = report.getAverageFlightTimeUsecs() >= _lastAverageFlightTimeUsecs;
+    _lastAverageFlightTimeUsecs = report.getAverageFlightTimeUsecs();
+
+    float receivedPerSecond = (float)packetsReceived * USECS_PER_SECOND / report.getIntervalUsecs();
+
+    if (_lossRate > LOSS_DECREASE_THRESHOLD) {
+        _packetsPerSecond *= 1.0f - _lossRate * LOSS_DECREASE_FACTOR;
+
+    } else if (_queuingDelayUsecs > QUEUING_DELAY_THRESHOLD_USECS && queueGrowing) {
+        // we're filling a queue somewhere; drop below what's getting through so that it can drain
+        _packetsPerSecond = std::min(_packetsPerSecond, receivedPerSecond) * QUEUING_DELAY_DECREASE_RATIO;
+
+    } else if (_lossRate < LOSS_INCREASE_THRESHOLD && _queuingDelayUsecs <= QUEUING_DELAY_THRESHOLD_USECS) {
+        float ceiling = std::max(receivedPerSecond * MAX_RATE_OVER_RECEIVED, (float)requestedPacketsPerSecond);
+        if (_packetsPerSecond < ceiling) {
+            _packetsPerSecond = std::min(_packetsPerSecond * INCREASE_RATIO + 1.0f, ceiling);
+        }
+    }
+    _packetsPerSecond = std::max(_packetsPerSecond, MIN_PACKETS_PER_SECOND);
+
+    _lastReport = now;
+    _packetsSentSinceReport = 0;
+    updateBoundaryLevelAdjust(requestedPacketsPerSecond);
+}
+
+void OctreeSendRateEstimator::packetsSent(int packets) {
+    QMutexLocker locker(&_mutex);
+    _packetsSentSinceReport += packets;
+}
+
+int OctreeSendRateEstimator::getPacketsPerSecond(int requestedPacketsPerSecond) {
+    QMutexLocker locker(&_mutex);
+    if (!_isActive || requestedPacketsPerSecond <= 0) {
+        return requestedPacketsPerSecond;
+    }
+
+    quint64 now = usecTimestampNow();
+    if (_packetsSentSinceReport > 0 && now - _lastReport > REPORT_TIMEOUT_USECS) {
+        _packetsPerSecond = std::max(_packetsPerSecond * REPORT_TIMEOUT_DECREASE_RATIO, MIN_PACKETS_PER_SECOND);
+        _lastReport = now;
+        updateBoundaryLevelAdjust(requestedPacketsPerSecond);
+    }
+    return (int)_packetsPerSecond;
+}
+
+void OctreeSendRateEstimator::updateBoundaryLevelAdjust(int requestedPacketsPerSecond) {
+    int levels = levelsBelowRequested(requestedPacketsPerSecond, _packetsPerSecond);
+    if (levels < _boundaryLevelAdjust) {
+        levels = std::max(levels, std::min(_boundaryLevelAdjust,
+            levelsBelowRequested(requestedPacketsPerSecond, _packetsPerSecond * BOUNDARY_ADJUST_HYSTERESIS)));
+    }
+    _boundaryLevelAdjust = levels;
+}
@@ -0,0 +1,65 @@
+//
+//  OctreeSendRateEstimator.h
+//  assignment-client/src/octree
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_OctreeSendRateEstimator_h
+#define hifi_OctreeSendRateEstimator_h
+
+#include <QtCore/QMutex>
+
+#include <OctreeReceiverReport.h>
+
+/// Estimates how many packets per second we can send a client from the receiver reports it sends back.  Loss or a growing
+/// flight time (packets queuing somewhere along the path) cuts the rate back toward what the client actually received;
+/// a clean link lets it grow past what the client asked for, up to the server's own per client limit.  Clients that never
+/// send reports are paced by their requested rate alone, as before.
+class OctreeSendRateEstimator {
+public:
+    OctreeSendRateEstimator();
+
+    /// \thread the server's main thread
+    void processReport(const OctreeReceiverReport& report, int requestedPacketsPerSecond);
+
+    /// \thread the client's send thread
+    void packetsSent(int packets);
+
+    /// Returns the rate we should send at, or the requested rate if the client isn't reporting.  A client asking for no
+    /// packets at all (a server it can't see) still gets just that.
+    /// \thread the client's send thread
+    int getPacketsPerSecond(int requestedPacketsPerSecond);
+
+    /// Returns how many levels coarser than the client asked for we should send while the link can't keep up.
+    int getBoundaryLevelAdjust() const { return _boundaryLevelAdjust; }
+
+    float getLossRate() const { return _lossRate; }
+    int getQueuingDelayUsecs() const { return _queuingDelayUsecs; }
+
+private:
+    void updateBoundaryLevelAdjust(int requestedPacketsPerSecond);
+
+    QMutex _mutex;
+    bool _isActive;
+    float _packetsPerSecond;
+    int _boundaryLevelAdjust;
+
+    OCTREE_PACKET_SEQUENCE _highestSequence;
+    float _lossRate;
+
+    // the lowest flight time we've seen recently stands in for the path's delay when nothing is queued on it
+    int _baseFlightTimeUsecs;
+    int _windowMinFlightTimeUsecs;
+    quint64 _windowStart;
+    int _queuingDelayUsecs;
+    int _lastAverageFlightTimeUsecs;
+
+    quint64 _lastReport;
+    int _packetsSentSinceReport;
+};
+
+#endif // hifi_OctreeSendRateEstimator_h
@@ -15,6 +15,7 @@
 #include <PacketHeaders.h>
 #include <PerfStat.h>
 #include <SharedUtil.h>
+#include <Trace.h>
 
 #include "OctreeSendThread.h"
 #include "OctreeServer.h"
@@ -121,6 +122,7 @@ quint64 OctreeSendThread::_totalWastedBytes = 0;
 quint64 OctreeSendThread::_totalPackets = 0;
 
 int OctreeSendThread::handlePacketSend(OctreeQueryNode* nodeData, int& trueBytesSent, int& truePacketsSent) {
+    TraceScope trace("OctreeSendThread::handlePacketSend");
 
     OctreeServer::didHandlePacketSend(this);
                  
@@ -252,6 +254,7 @@ int OctreeSendThread::handlePacketSend(OctreeQueryNode* nodeData, int& trueBytes
 
 /// Version of voxel distributor that sends the deepest LOD level at once
 int OctreeSendThread::packetDistributor(OctreeQueryNode* nodeData, bool viewFrustumChanged) {
+    TraceScope trace("OctreeSendThread::packetDistributor");
         
     OctreeServer::didPacketDistributor(this);
 
@@ -304,7 +307,7 @@ int OctreeSendThread::packetDistributor(OctreeQueryNode* nodeData, bool viewFrus
             if (nodeData->moveShouldDump() || nodeData->hasLodChanged()) {
                 nodeData->dumpOutOfView();
             }
-            nodeData->map.erase();
+            nodeData->occlusionBuffer.clear();
         }
 
         if (!viewFrustumChanged && !nodeData->getWantDelta()) {
@@ -334,8 +337,10 @@ int OctreeSendThread::packetDistributor(OctreeQueryNode* nodeData, bool viewFrus
         // TODO: add these to stats page
         //::startSceneSleepTime = _usleepTime;
         
-        // start tracking our stats
+        // start tracking our stats; the jurisdiction changes only under the tree write lock
+        _myServer->getOctree()->lockForRead();
         nodeData->stats.sceneStarted(isFullScene, viewFrustumChanged, _myServer->getOctree()->getRoot(), _myServer->getJurisdiction());
+        _myServer->getOctree()->unlock();
 
         // This is the start of "resending" the scene.
         bool dontRestartSceneOnMove = false; // this is experimental
@@ -357,7 +362,10 @@ int OctreeSendThread::packetDistributor(OctreeQueryNode* nodeData, bool viewFrus
         //quint64 startCompressTimeMsecs = OctreePacketData::getCompressContentTime() / 1000;
         //quint64 startCompressCalls = OctreePacketData::getCompressContentCalls();
 
-        int clientMaxPacketsPerInterval = std::max(1,(nodeData->getMaxOctreePacketsPerSecond() / INTERVALS_PER_SECOND));
+        // once the client is sending receiver reports, pace it by what its link can take rather than what it asked for
+        int clientMaxPacketsPerSecond =
+            nodeData->getSendRateEstimator().getPacketsPerSecond(nodeData->getMaxOctreePacketsPerSecond());
+        int clientMaxPacketsPerInterval = std::max(1, clientMaxPacketsPerSecond / INTERVALS_PER_SECOND);
         int maxPacketsPerInterval = std::min(clientMaxPacketsPerInterval, _myServer->getPacketsPerClientPerInterval());
 
         int extraPackingAttempts = 0;
@@ -396,20 +404,16 @@ int OctreeSendThread::packetDistributor(OctreeQueryNode* nodeData, bool viewFrus
                 */
 
                 bool wantOcclusionCulling = nodeData->getWantOcclusionCulling();
-                CoverageMap* coverageMap = wantOcclusionCulling ? &nodeData->map : IGNORE_COVERAGE_MAP;
+                OcclusionBuffer* occlusionBuffer = wantOcclusionCulling ? &nodeData->occlusionBuffer
+                    : IGNORE_OCCLUSION_BUFFER;
                 
                 float voxelSizeScale = nodeData->getOctreeSizeScale();
-                int boundaryLevelAdjustClient = nodeData->getBoundaryLevelAdjust();
+                int boundaryLevelAdjustClient = nodeData->getBoundaryLevelAdjust()
+                    + nodeData->getCongestionBoundaryLevelAdjust();
                 
                 int boundaryLevelAdjust = boundaryLevelAdjustClient + (viewFrustumChanged && nodeData->getWantLowResMoving()
                                                                        ? LOW_RES_MOVING_ADJUST : NO_BOUNDARY_ADJUST);
                 
-                EncodeBitstreamParams params(INT_MAX, &nodeData->getCurrentViewFrustum(), wantColor,
-                                             WANT_EXISTS_BITS, DONT_CHOP, wantDelta, lastViewFrustum,
-                                             wantOcclusionCulling, coverageMap, boundaryLevelAdjust, voxelSizeScale,
-                                             nodeData->getLastTimeBagEmpty(),
-                                             isFullScene, &nodeData->stats, _myServer->getJurisdiction());
-
                 // TODO: should this include the lock time or not? This stat is sent down to the client,
                 // it seems like it may be a good idea to include the lock time as part of the encode time
                 // are reported to client. Since you can encode without the lock
@@ -420,6 +424,13 @@ int OctreeSendThread::packetDistributor(OctreeQueryNode* nodeData, bool viewFrus
                 quint64 lockWaitEnd = usecTimestampNow();
                 lockWaitElapsedUsec = (float)(lockWaitEnd - lockWaitStart);
 
+                // the jurisdiction changes only under the tree write lock, so we can't fetch it before we hold the lock
+                EncodeBitstreamParams params(INT_MAX, &nodeData->getCurrentViewFrustum(), wantColor,
+                                             WANT_EXISTS_BITS, DONT_CHOP, wantDelta, lastViewFrustum,
+                                             wantOcclusionCulling, occlusionBuffer, boundaryLevelAdjust, voxelSizeScale,
+                                             nodeData->getLastTimeBagEmpty(),
+                                             isFullScene, &nodeData->stats, _myServer->getJurisdiction());
+
                 quint64 encodeStart = usecTimestampNow();
                 bytesWritten = _myServer->getOctree()->encodeTreeBitstream(subTree, &_packetData, nodeData->nodeBag, params);
                 quint64 encodeEnd = usecTimestampNow();
@@ -551,10 +562,18 @@ int OctreeSendThread::packetDistributor(OctreeQueryNode* nodeData, bool viewFrus
         if (nodeData->nodeBag.isEmpty()) {
             nodeData->updateLastKnownViewFrustum();
             nodeData->setViewSent(true);
-            nodeData->map.erase(); // It would be nice if we could save this, and only reset it when the view frustum changes
+            // It would be nice if we could save this, and only reset it when the view frustum changes
+            nodeData->occlusionBuffer.clear();
         }
 
     } // end if bag wasn't empty, and so we sent stuff...
 
+    // attribute what we sent to the part of our jurisdiction this viewer is looking from
+    if (truePacketsSent > 0) {
+        nodeData->getSendRateEstimator().packetsSent(truePacketsSent);
+        _myServer->getLoadTracker().recordQuery(nodeData->getCurrentViewFrustum().getPosition() / (float)TREE_SCALE,
+                                                truePacketsSent);
+    }
+
     return truePacketsSent;
 }
@@ -9,6 +9,7 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <QFileInfo>
 #include <QJsonObject>
 #include <QNetworkAccessManager>
 #include <QTimer>
@@ -17,6 +18,7 @@
 #include <time.h>
 #include <HTTPConnection.h>
 #include <Logging.h>
+#include <Trace.h>
 #include <UUID.h>
 
 #include "../AssignmentClient.h"
@@ -31,6 +33,8 @@ const int MOVING_AVERAGE_SAMPLE_COUNTS = 1000000;
 float OctreeServer::SKIP_TIME = -1.0f; // use this for trackXXXTime() calls for non-times
 
 SimpleMovingAverage OctreeServer::_averageLoopTime(MOVING_AVERAGE_SAMPLE_COUNTS);
+MetricsHistogram* OctreeServer::_loopTimeHistogram =
+    MetricsRegistry::getInstance()->getHistogram("octree_server.loop_usecs");
 SimpleMovingAverage OctreeServer::_averageInsideTime(MOVING_AVERAGE_SAMPLE_COUNTS);
 
 SimpleMovingAverage OctreeServer::_averageEncodeTime(MOVING_AVERAGE_SAMPLE_COUNTS);
@@ -41,6 +45,8 @@ int OctreeServer::_extraLongEncode = 0;
 int OctreeServer::_longEncode = 0;
 int OctreeServer::_shortEncode = 0;
 int OctreeServer::_noEncode = 0;
+MetricsHistogram* OctreeServer::_encodeTimeHistogram =
+    MetricsRegistry::getInstance()->getHistogram("octree_server.encode_usecs");
 
 SimpleMovingAverage OctreeServer::_averageTreeWaitTime(MOVING_AVERAGE_SAMPLE_COUNTS);
 SimpleMovingAverage OctreeServer::_averageTreeShortWaitTime(MOVING_AVERAGE_SAMPLE_COUNTS);
@@ -50,6 +56,8 @@ int OctreeServer::_extraLongTreeWait = 0;
 int OctreeServer::_longTreeWait = 0;
 int OctreeServer::_shortTreeWait = 0;
 int OctreeServer::_noTreeWait = 0;
+MetricsHistogram* OctreeServer::_treeWaitTimeHistogram =
+    MetricsRegistry::getInstance()->getHistogram("octree_server.tree_wait_usecs");
 
 SimpleMovingAverage OctreeServer::_averageNodeWaitTime(MOVING_AVERAGE_SAMPLE_COUNTS);
 
@@ -61,9 +69,13 @@ int OctreeServer::_extraLongCompress = 0;
 int OctreeServer::_longCompress = 0;
 int OctreeServer::_shortCompress = 0;
 int OctreeServer::_noCompress = 0;
+MetricsHistogram* OctreeServer::_compressAndWriteTimeHistogram =
+    MetricsRegistry::getInstance()->getHistogram("octree_server.compress_and_write_usecs");
 
 SimpleMovingAverage OctreeServer::_averagePacketSendingTime(MOVING_AVERAGE_SAMPLE_COUNTS);
 int OctreeServer::_noSend = 0;
+MetricsHistogram* OctreeServer::_packetSendingTimeHistogram =
+    MetricsRegistry::getInstance()->getHistogram("octree_server.packet_sending_usecs");
 
 SimpleMovingAverage OctreeServer::_averageProcessWaitTime(MOVING_AVERAGE_SAMPLE_COUNTS);
 SimpleMovingAverage OctreeServer::_averageProcessShortWaitTime(MOVING_AVERAGE_SAMPLE_COUNTS);
@@ -73,6 +85,8 @@ int OctreeServer::_extraLongProcessWait = 0;
 int OctreeServer::_longProcessWait = 0;
 int OctreeServer::_shortProcessWait = 0;
 int OctreeServer::_noProcessWait = 0;
+MetricsHistogram* OctreeServer::_processWaitTimeHistogram =
+    MetricsRegistry::getInstance()->getHistogram("octree_server.process_wait_usecs");
 
 
 void OctreeServer::resetSendingStats() {
@@ -121,6 +135,13 @@ void OctreeServer::resetSendingStats() {
     _noProcessWait = 0;
 }
 
+void OctreeServer::trackLoopTime(float time) {
+    _averageLoopTime.updateAverage(time);
+
+    // loop times are in msecs, but the histograms are all in usecs
+    _loopTimeHistogram->record(time * USECS_PER_MSEC);
+}
+
 void OctreeServer::trackEncodeTime(float time) { 
     const float MAX_SHORT_TIME = 10.0f;
     const float MAX_LONG_TIME = 100.0f;
@@ -128,15 +149,18 @@ void OctreeServer::trackEncodeTime(float time) {
     if (time == SKIP_TIME) {
         _noEncode++;
         time = 0.0f;
-    } else if (time <= MAX_SHORT_TIME) {
-        _shortEncode++;
-        _averageShortEncodeTime.updateAverage(time);
-    } else if (time <= MAX_LONG_TIME) {
-        _longEncode++;
-        _averageLongEncodeTime.updateAverage(time);
     } else {
-        _extraLongEncode++;
-        _averageExtraLongEncodeTime.updateAverage(time);
+        _encodeTimeHistogram->record(time);
+        if (time <= MAX_SHORT_TIME) {
+            _shortEncode++;
+            _averageShortEncodeTime.updateAverage(time);
+        } else if (time <= MAX_LONG_TIME) {
+            _longEncode++;
+            _averageLongEncodeTime.updateAverage(time);
+        } else {
+            _extraLongEncode++;
+            _averageExtraLongEncodeTime.updateAverage(time);
+        }
     }
     _averageEncodeTime.updateAverage(time); 
 }
@@ -147,15 +171,18 @@ void OctreeServer::trackTreeWaitTime(float time) {
     if (time == SKIP_TIME) {
         _noTreeWait++;
         time = 0.0f;
-    } else if (time <= MAX_SHORT_TIME) {
-        _shortTreeWait++;
-        _averageTreeShortWaitTime.updateAverage(time);
-    } else if (time <= MAX_LONG_TIME) {
-        _longTreeWait++;
-        _averageTreeLongWaitTime.updateAverage(time);
     } else {
-        _extraLongTreeWait++;
-        _averageTreeExtraLongWaitTime.updateAverage(time);
+        _treeWaitTimeHistogram->record(time);
+        if (time <= MAX_SHORT_TIME) {
+            _shortTreeWait++;
+            _averageTreeShortWaitTime.updateAverage(time);
+        } else if (time <= MAX_LONG_TIME) {
+            _longTreeWait++;
+            _averageTreeLongWaitTime.updateAverage(time);
+        } else {
+            _extraLongTreeWait++;
+            _averageTreeExtraLongWaitTime.updateAverage(time);
+        }
     }
     _averageTreeWaitTime.updateAverage(time);
 }
@@ -166,15 +193,18 @@ void OctreeServer::trackCompressAndWriteTime(float time) {
     if (time == SKIP_TIME) {
         _noCompress++;
         time = 0.0f;
-    } else if (time <= MAX_SHORT_TIME) {
-        _shortCompress++;
-        _averageShortCompressTime.updateAverage(time);
-    } else if (time <= MAX_LONG_TIME) {
-        _longCompress++;
-        _averageLongCompressTime.updateAverage(time);
     } else {
-        _extraLongCompress++;
-        _averageExtraLongCompressTime.updateAverage(time);
+        _compressAndWriteTimeHistogram->record(time);
+        if (time <= MAX_SHORT_TIME) {
+            _shortCompress++;
+            _averageShortCompressTime.updateAverage(time);
+        } else if (time <= MAX_LONG_TIME) {
+            _longCompress++;
+            _averageLongCompressTime.updateAverage(time);
+        } else {
+            _extraLongCompress++;
+            _averageExtraLongCompressTime.updateAverage(time);
+        }
     }
     _averageCompressAndWriteTime.updateAverage(time); 
 }
@@ -183,6 +213,8 @@ void OctreeServer::trackPacketSendingTime(float time) {
     if (time == SKIP_TIME) {
         _noSend++;
         time = 0.0f;
+    } else {
+        _packetSendingTimeHistogram->record(time);
     }
     _averagePacketSendingTime.updateAverage(time); 
 }
@@ -194,15 +226,18 @@ void OctreeServer::trackProcessWaitTime(float time) {
     if (time == SKIP_TIME) {
         _noProcessWait++;
         time = 0.0f;
-    } else if (time <= MAX_SHORT_TIME) {
-        _shortProcessWait++;
-        _averageProcessShortWaitTime.updateAverage(time);
-    } else if (time <= MAX_LONG_TIME) {
-        _longProcessWait++;
-        _averageProcessLongWaitTime.updateAverage(time);
     } else {
-        _extraLongProcessWait++;
-        _averageProcessExtraLongWaitTime.updateAverage(time);
+        _processWaitTimeHistogram->record(time);
+        if (time <= MAX_SHORT_TIME) {
+            _shortProcessWait++;
+            _averageProcessShortWaitTime.updateAverage(time);
+        } else if (time <= MAX_LONG_TIME) {
+            _longProcessWait++;
+            _averageProcessLongWaitTime.updateAverage(time);
+        } else {
+            _extraLongProcessWait++;
+            _averageProcessExtraLongWaitTime.updateAverage(time);
+        }
     }
     _averageProcessWaitTime.updateAverage(time);
 }
@@ -230,7 +265,10 @@ OctreeServer::OctreeServer(const QByteArray& packet) :
     _debugReceiving(false),
     _verboseDebug(false),
     _jurisdiction(NULL),
+    _jurisdictionFromFile(false),
     _jurisdictionSender(NULL),
+    _loadTracker(),
+    _jurisdictionHandoff(NULL),
     _octreeInboundPacketProcessor(NULL),
     _persistThread(NULL),
     _started(time(0)),
@@ -271,6 +309,9 @@ OctreeServer::~OctreeServer() {
         _persistThread->deleteLater();
     }
 
+    delete _jurisdictionHandoff;
+    _jurisdictionHandoff = NULL;
+
     delete _jurisdiction;
     _jurisdiction = NULL;
     
@@ -324,6 +365,10 @@ bool OctreeServer::handleHTTPRequest(HTTPConnection* connection, const QUrl& url
             _octreeInboundPacketProcessor->resetStats();
             resetSendingStats();
             showStats = true;
+        } else if (url.path() == "/trace") {
+            // the recent timeline of each thread, for loading into Chrome's about:tracing
+            connection->respond(HTTPConnection::StatusCode200, Trace::toChromeTraceJSON(), "application/json");
+            return true;
         }
     }
 
@@ -616,6 +661,12 @@ bool OctreeServer::handleHTTPRequest(HTTPConnection* connection, const QUrl& url
         statsString += "\r\n";
         statsString += "\r\n";
 
+        // display the percentiles of the timings over the last stats interval
+        statsString += "<b>Timing Percentiles (usecs, last stats interval)...</b>\r\n";
+        statsString += MetricsRegistry::getInstance()->getLastSnapshotReport();
+        statsString += "\r\n";
+        statsString += "\r\n";
+
         // display inbound packet stats
         statsString += QString().sprintf("<b>%s Edit Statistics... <a href='/resetStats'>[RESET]</a></b>\r\n",
                                          getMyServerName());
@@ -644,6 +695,15 @@ bool OctreeServer::handleHTTPRequest(HTTPConnection* connection, const QUrl& url
             .arg(locale.toString((uint)averageProcessTimePerElement).rightJustified(COLUMN_WIDTH, ' '));
         statsString += QString("  Average Wait Lock Time/Element: %1 usecs\r\n")
             .arg(locale.toString((uint)averageLockWaitTimePerElement).rightJustified(COLUMN_WIDTH, ' '));
+        statsString += QString("           Total Write Lock Holds: %1 holds\r\n")
+            .arg(locale.toString((uint)_octreeInboundPacketProcessor->getTotalLockHolds()).rightJustified(COLUMN_WIDTH, ' '));
+        statsString += QString("     Average Write Lock Hold Time: %1 usecs\r\n")
+            .arg(locale.toString((uint)_octreeInboundPacketProcessor->getAverageLockHoldTime())
+                .rightJustified(COLUMN_WIDTH, ' '));
+        statsString += QString("    Write Lock Hold Time (usecs): %1\r\n")
+            .arg(_octreeInboundPacketProcessor->getLockHoldHistogram().toString());
+        statsString += QString("  Edit Throughput (edits/second): %1\r\n")
+            .arg(_octreeInboundPacketProcessor->getEditThroughputHistogram().toString());
 
 
         int senderNumber = 0;
@@ -848,8 +908,14 @@ void OctreeServer::readPendingDatagrams() {
                         nodeData->initializeOctreeSendThread(sharedAssignment, matchingNode);
                     }
                 }
+            } else if (packetType == PacketTypeOctreeReceiverReport) {
+                if (matchingNode && matchingNode->getLinkedData()) {
+                    static_cast<OctreeQueryNode*>(matchingNode->getLinkedData())->processReceiverReport(receivedPacket);
+                }
             } else if (packetType == PacketTypeJurisdictionRequest) {
                 _jurisdictionSender->queueReceivedPacket(matchingNode, receivedPacket);
+            } else if (_jurisdictionHandoff && JurisdictionHandoff::handlesPacketType(packetType)) {
+                _jurisdictionHandoff->processPacket(matchingNode, receivedPacket);
             } else if (_octreeInboundPacketProcessor && getOctree()->handlesEditPacketType(packetType)) {
                 _octreeInboundPacketProcessor->queueReceivedPacket(matchingNode, receivedPacket);
             } else {
@@ -904,6 +970,7 @@ void OctreeServer::run() {
 
         qDebug("about to readFromFile().... jurisdictionFile=%s", jurisdictionFile);
         _jurisdiction = new JurisdictionMap(jurisdictionFile);
+        _jurisdictionFromFile = true;
         qDebug("after readFromFile().... jurisdictionFile=%s", jurisdictionFile);
     } else {
         const char* JURISDICTION_ROOT = "--jurisdictionRoot";
@@ -922,6 +989,14 @@ void OctreeServer::run() {
             _jurisdiction = new JurisdictionMap(jurisdictionRoot, jurisdictionEndNodes);
         }
     }
+    _loadTracker.setJurisdiction(_jurisdiction);
+
+    // if the domain server split our jurisdiction off from another server's, that server holds our initial contents
+    const char* JURISDICTION_PARENT = "--jurisdictionParent";
+    const char* jurisdictionParent = getCmdOption(_argc, _argv, JURISDICTION_PARENT);
+    if (jurisdictionParent) {
+        qDebug("jurisdictionParent=%s", jurisdictionParent);
+    }
 
     NodeList* nodeList = NodeList::getInstance();
     nodeList->setOwnerType(getMyNodeType());
@@ -933,6 +1008,9 @@ void OctreeServer::run() {
     // we need to ask the DS about agents so we can ping/reply with them
     nodeList->addNodeTypeToInterestSet(NodeType::Agent);
 
+    // and about servers of our own type, so that we can hand off subtrees when our jurisdiction is split
+    nodeList->addNodeTypeToInterestSet(getMyNodeType());
+
 #ifndef WIN32
     setvbuf(stdout, NULL, _IOLBF, 0);
 #endif
@@ -968,6 +1046,12 @@ void OctreeServer::run() {
         const char* persistFilenameParameter = getCmdOption(_argc, _argv, PERSIST_FILENAME);
         if (persistFilenameParameter) {
             strcpy(_persistFilename, persistFilenameParameter);
+        } else if (jurisdictionParent && _jurisdiction) {
+            // a split jurisdiction may be running on the same machine as its parent, so keep its file separate
+            QFileInfo defaultFileInfo(getMyDefaultPersistFilename());
+            QString splitFilename = QString("%1/%2.%3.%4").arg(defaultFileInfo.path(), defaultFileInfo.completeBaseName(),
+                octalCodeToHexString(_jurisdiction->getRootOctalCode()), defaultFileInfo.suffix());
+            strncpy(_persistFilename, splitFilename.toLocal8Bit().constData(), MAX_FILENAME_LENGTH - 1);
         } else {
             strcpy(_persistFilename, getMyDefaultPersistFilename());
         }
@@ -1029,6 +1113,14 @@ void OctreeServer::run() {
     _octreeInboundPacketProcessor = new OctreeInboundPacketProcessor(this);
     _octreeInboundPacketProcessor->initialize(true);
 
+    // set up the handoff of subtrees between us and the servers our jurisdiction is split with
+    _jurisdictionHandoff = new JurisdictionHandoff(this);
+    connect(nodeList, SIGNAL(receivedJurisdictionSplit(const QByteArray&)),
+            _jurisdictionHandoff, SLOT(processSplitPacket(const QByteArray&)));
+    if (jurisdictionParent && _jurisdiction) {
+        _jurisdictionHandoff->requestFrom(QUuid(QString(jurisdictionParent)));
+    }
+
     // Convert now to tm struct for local timezone
     tm* localtm = localtime(&_started);
     const int MAX_TIME_LENGTH = 128;
@@ -1043,6 +1135,16 @@ void OctreeServer::run() {
     qDebug() << "Now running... started at: " << localBuffer << utcBuffer;
 }
 
+void OctreeServer::addJurisdictionEndNode(const unsigned char* octalCode) {
+    if (!_jurisdiction) {
+        // we had the whole tree without saying so; say so now, less the subtree
+        _jurisdiction = new JurisdictionMap(getMyNodeType());
+        _jurisdictionSender->setJurisdiction(_jurisdiction);
+    }
+    _jurisdictionSender->addEndNode(octalCode);
+    qDebug() << "Removed subtree" << octalCodeToHexString(octalCode) << "from our jurisdiction.";
+}
+
 void OctreeServer::nodeAdded(SharedNodePointer node) {
     // we might choose to use this notifier to track clients in a pending state
     qDebug() << qPrintable(_safeServerName) << "server added node:" << *node;
@@ -1264,8 +1366,31 @@ void OctreeServer::sendStatsPacket() {
         (double)_octreeInboundPacketProcessor->getAverageProcessTimePerElement();
     statsObject3[baseName + QString(".3.inbound.timing.5.avgLockWaitTimePerElement")] = 
         (double)_octreeInboundPacketProcessor->getAverageLockWaitTimePerElement();
+    statsObject3[baseName + QString(".3.inbound.timing.6.avgLockHoldTime")] = 
+        (double)_octreeInboundPacketProcessor->getAverageLockHoldTime();
+    statsObject3[baseName + QString(".3.inbound.timing.7.lockHoldHistogram")] = 
+        _octreeInboundPacketProcessor->getLockHoldHistogram().toString();
+    statsObject3[baseName + QString(".3.inbound.timing.8.editThroughputHistogram")] = 
+        _octreeInboundPacketProcessor->getEditThroughputHistogram().toString();
 
     NodeList::getInstance()->sendStatsToDomainServer(statsObject3);
+
+    // report the load on each octant of our jurisdiction, which the domain server uses to decide when to split it.  A
+    // jurisdiction read from a file can't be described to the domain server, so it isn't offered for splitting.
+    if (!_jurisdictionFromFile) {
+        static QJsonObject statsObject4;
+
+        _loadTracker.sample();
+        for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+            const unsigned char* octantCode = _loadTracker.getOctantOctalCode(i);
+            bool isOurs = !_jurisdiction
+                || _jurisdiction->isMyJurisdiction(octantCode, CHECK_NODE_ONLY) == JurisdictionMap::WITHIN;
+            statsObject4[baseName + QString(".4.jurisdiction.load.") + _loadTracker.getOctantHexCode(i)] =
+                isOurs ? (double)_loadTracker.getLoad(i) : 0.0;
+        }
+
+        NodeList::getInstance()->sendStatsToDomainServer(statsObject4);
+    }
 }
 
 QMap<OctreeSendThread*, quint64> OctreeServer::_threadsDidProcess;
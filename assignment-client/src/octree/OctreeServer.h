@@ -20,7 +20,10 @@
 
 #include <ThreadedAssignment.h>
 #include <EnvironmentData.h>
+#include <Metrics.h>
 
+#include "JurisdictionHandoff.h"
+#include "JurisdictionLoadTracker.h"
 #include "OctreePersistThread.h"
 #include "OctreeSendThread.h"
 #include "OctreeServerConsts.h"
@@ -43,7 +46,14 @@ public:
     bool wantsVerboseDebug() const { return _verboseDebug; }
 
     Octree* getOctree() { return _tree; }
+
+    /// Returns our jurisdiction, or NULL if we have the whole tree.  It only changes on the application thread while
+    /// the tree write lock is held, so other threads must hold the tree lock while they fetch and use it.
     JurisdictionMap* getJurisdiction() { return _jurisdiction; }
+    JurisdictionLoadTracker& getLoadTracker() { return _loadTracker; }
+
+    /// Removes the subtree at the given octal code from our jurisdiction.  The caller must hold the tree write lock.
+    void addJurisdictionEndNode(const unsigned char* octalCode);
 
     int getPacketsPerClientPerInterval() const { return std::min(_packetsPerClientPerInterval, 
                                 std::max(1, getPacketsTotalPerInterval() / std::max(1, getCurrentClientCount()))); }
@@ -78,7 +88,7 @@ public:
     
     static float SKIP_TIME; // use this for trackXXXTime() calls for non-times
 
-    static void trackLoopTime(float time) { _averageLoopTime.updateAverage(time); }
+    static void trackLoopTime(float time);
     static float getAverageLoopTime() { return _averageLoopTime.getAverage(); }
 
     static void trackEncodeTime(float time);
@@ -153,7 +163,10 @@ protected:
     bool _debugReceiving;
     bool _verboseDebug;
     JurisdictionMap* _jurisdiction;
+    bool _jurisdictionFromFile;
     JurisdictionSender* _jurisdictionSender;
+    JurisdictionLoadTracker _loadTracker;
+    JurisdictionHandoff* _jurisdictionHandoff;
     OctreeInboundPacketProcessor* _octreeInboundPacketProcessor;
     OctreePersistThread* _persistThread;
 
@@ -165,6 +178,7 @@ protected:
     
     static int _clientCount;
     static SimpleMovingAverage _averageLoopTime;
+    static MetricsHistogram* _loopTimeHistogram;
 
     static SimpleMovingAverage _averageEncodeTime;
     static SimpleMovingAverage _averageShortEncodeTime;
@@ -174,6 +188,7 @@ protected:
     static int _longEncode;
     static int _shortEncode;
     static int _noEncode;
+    static MetricsHistogram* _encodeTimeHistogram;
 
     static SimpleMovingAverage _averageInsideTime;
 
@@ -185,6 +200,7 @@ protected:
     static int _longTreeWait;
     static int _shortTreeWait;
     static int _noTreeWait;
+    static MetricsHistogram* _treeWaitTimeHistogram;
 
     static SimpleMovingAverage _averageNodeWaitTime;
 
@@ -196,9 +212,11 @@ protected:
     static int _longCompress;
     static int _shortCompress;
     static int _noCompress;
+    static MetricsHistogram* _compressAndWriteTimeHistogram;
 
     static SimpleMovingAverage _averagePacketSendingTime;
     static int _noSend;
+    static MetricsHistogram* _packetSendingTimeHistogram;
 
     static SimpleMovingAverage _averageProcessWaitTime;
     static SimpleMovingAverage _averageProcessShortWaitTime;
@@ -208,6 +226,7 @@ protected:
     static int _longProcessWait;
     static int _shortProcessWait;
     static int _noProcessWait;
+    static MetricsHistogram* _processWaitTimeHistogram;
 
     static QMap<OctreeSendThread*, quint64> _threadsDidProcess;
     static QMap<OctreeSendThread*, quint64> _threadsDidPacketDistributor;
@@ -10,6 +10,7 @@
 //
 
 #include <QTimer>
+#include <ParticleScriptHost.h>
 #include <ParticleTree.h>
 
 #include "ParticleServer.h"
@@ -44,6 +45,19 @@ void ParticleServer::beforeRun() {
     connect(pruneDeletedParticlesTimer, SIGNAL(timeout()), this, SLOT(pruneDeletedParticles()));
     const int PRUNE_DELETED_PARTICLES_INTERVAL_MSECS = 1 * 1000; // once every second
     pruneDeletedParticlesTimer->start(PRUNE_DELETED_PARTICLES_INTERVAL_MSECS);
+
+    // Check to see if the user passed in a command line option for limiting the time spent in particle scripts
+    const char* PARTICLE_SCRIPT_BUDGET = "--particleScriptBudgetUsecs";
+    const char* particleScriptBudget = getCmdOption(_argc, _argv, PARTICLE_SCRIPT_BUDGET);
+    if (particleScriptBudget) {
+        ParticleScriptHost::getInstance()->setTickBudget(atoi(particleScriptBudget));
+        qDebug("particleScriptBudgetUsecs=%s", particleScriptBudget);
+    }
+
+    QTimer* reportParticleScriptsTimer = new QTimer(this);
+    connect(reportParticleScriptsTimer, SIGNAL(timeout()), this, SLOT(reportParticleScripts()));
+    const int REPORT_PARTICLE_SCRIPTS_INTERVAL_MSECS = 10 * 1000; // once every ten seconds
+    reportParticleScriptsTimer->start(REPORT_PARTICLE_SCRIPTS_INTERVAL_MSECS);
 }
 
 void ParticleServer::particleCreated(const Particle& newParticle, const SharedNodePointer& senderNode) {
@@ -135,3 +149,9 @@ void ParticleServer::pruneDeletedParticles() {
     }
 }
 
+void ParticleServer::reportParticleScripts() {
+    QString report = ParticleScriptHost::getInstance()->takeReport();
+    if (!report.isEmpty()) {
+        qDebug() << qPrintable(report);
+    }
+}
@@ -43,6 +43,7 @@ public:
 
 public slots:
     void pruneDeletedParticles();
+    void reportParticleScripts();
 
 private:
 };
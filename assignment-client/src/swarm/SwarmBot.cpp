@@ -0,0 +1,486 @@
+//
+//  SwarmBot.cpp
+//  assignment-client/src/swarm
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QtCore/QDataStream>
+#include <QtCore/QSet>
+
+#include <glm/gtx/quaternion.hpp>
+
+#include <AudioRingBuffer.h>
+#include <NodeList.h>
+#include <OctreeConstants.h>
+#include <OctreePacketData.h>
+#include <ScriptEngine.h>
+#include <SharedUtil.h>
+#include <ViewFrustum.h>
+
+#include "SwarmStats.h"
+
+#include "SwarmBot.h"
+
+const quint64 DOMAIN_CHECK_IN_INTERVAL_USECS = USECS_PER_SECOND;
+
+// the same audio frame a scripted agent sends along with each avatar data packet
+const int BOT_AUDIO_FRAME_SAMPLES = floor(((SCRIPT_DATA_CALLBACK_USECS * SAMPLE_RATE) / (1000 * 1000)) + 0.5);
+
+// bots without a sound to play talk in tones, for this many seconds out of every cycle
+const int TALK_CYCLE_SECONDS = 8;
+const int TALKING_SECONDS = 3;
+const float TONE_AMPLITUDE = 4000.0f;
+const float MIN_TONE_FREQUENCY = 180.0f;
+const float TONE_FREQUENCY_STEP = 20.0f;
+const int NUM_TONE_FREQUENCIES = 16;
+
+const float SWARM_RADIUS = 20.0f;
+const float ORBIT_SPEED = 0.25f; // radians per second
+const float WANDER_SPEED = 1.5f; // meters per second
+const float WANDER_TARGET_REACHED = 0.5f;
+
+SwarmBot::Server::Server() :
+    uuid(),
+    type(NodeType::Unassigned),
+    localID(NULL_LOCAL_ID),
+    publicSocket(),
+    localSocket(),
+    activeSocket(),
+    connectionSecret(),
+    receiverReport()
+{
+}
+
+SwarmBot::SwarmBot(int index, const HifiSockAddr& domainSockAddr, const glm::vec3& center,
+                   const QByteArray& microphoneSamples, SwarmStats* stats) :
+    _index(index),
+    _stats(stats),
+    _socket(NULL),
+    _domainSockAddr(domainSockAddr),
+    _sessionUUID(),
+    _sessionLocalID(NULL_LOCAL_ID),
+    _servers(),
+    _serverUUIDsByLocalID(),
+    _movementPattern((MovementPattern)(index % NUM_MOVEMENT_PATTERNS)),
+    _center(center),
+    _movementPhase(randFloat() * TWO_PI),
+    _wanderTarget(center),
+    _microphoneSamples(microphoneSamples),
+    _microphoneSampleOffset(0),
+    _tonePhase(0.0f),
+    _nextCheckIn(0)
+{
+    // spread the bots out around the center, and start each one somewhere different in the sound it plays
+    _avatar.setPosition(_center + glm::vec3(randFloatInRange(-SWARM_RADIUS, SWARM_RADIUS), 0.0f,
+                                            randFloatInRange(-SWARM_RADIUS, SWARM_RADIUS)));
+    _avatar.setFaceModelURL(QUrl());
+    _avatar.setSkeletonModelURL(QUrl());
+    _avatar.setDisplayName(QString("swarm-bot-%1").arg(index));
+
+    int numMicrophoneSamples = _microphoneSamples.size() / sizeof(int16_t);
+    if (numMicrophoneSamples > 0) {
+        _microphoneSampleOffset = (index * BOT_AUDIO_FRAME_SAMPLES * 7) % numMicrophoneSamples;
+    }
+
+    _octreeQuery.setWantLowResMoving(true);
+    _octreeQuery.setWantColor(true);
+    _octreeQuery.setWantDelta(true);
+    _octreeQuery.setWantOcclusionCulling(false);
+    _octreeQuery.setWantCompression(true);
+    _octreeQuery.setCameraFov(DEFAULT_FIELD_OF_VIEW_DEGREES);
+    _octreeQuery.setCameraAspectRatio(DEFAULT_ASPECT_RATIO);
+    _octreeQuery.setCameraNearClip(DEFAULT_NEAR_CLIP);
+    _octreeQuery.setCameraFarClip(TREE_SCALE);
+    _octreeQuery.setOctreeSizeScale(DEFAULT_OCTREE_SIZE_SCALE);
+    _octreeQuery.setBoundaryLevelAdjust(0);
+}
+
+void SwarmBot::start() {
+    _socket = new QUdpSocket(this);
+    _socket->bind(QHostAddress::AnyIPv4, 0);
+    connect(_socket, &QUdpSocket::readyRead, this, &SwarmBot::readPendingDatagrams);
+
+    // stagger the once a second traffic so the whole swarm doesn't check in at once
+    _nextCheckIn = usecTimestampNow() + (_index * USECS_PER_MSEC * 37) % DOMAIN_CHECK_IN_INTERVAL_USECS;
+}
+
+void SwarmBot::simulate(float deltaTime, quint64 now) {
+    if (!_socket) {
+        return;
+    }
+    if (now >= _nextCheckIn) {
+        _nextCheckIn += DOMAIN_CHECK_IN_INTERVAL_USECS;
+        checkInWithDomain();
+
+        for (QHash<QUuid, Server>::iterator server = _servers.begin(); server != _servers.end(); server++) {
+            pingServer(server.value());
+            if (server->activeSocket.isNull()) {
+                continue;
+            }
+            if (server->type == NodeType::AvatarMixer) {
+                sendIdentity(server.value());
+
+            } else if (server->type == NodeType::VoxelServer || server->type == NodeType::ParticleServer
+                    || server->type == NodeType::ModelServer) {
+                sendOctreeQuery(server.value());
+            }
+        }
+    }
+
+    move(deltaTime);
+
+    for (QHash<QUuid, Server>::iterator server = _servers.begin(); server != _servers.end(); server++) {
+        if (server->activeSocket.isNull()) {
+            continue;
+        }
+        if (server->type == NodeType::AvatarMixer) {
+            sendAvatarData(server.value());
+
+        } else if (server->type == NodeType::AudioMixer) {
+            sendMicrophoneAudio(server.value(), now);
+        }
+    }
+}
+
+void SwarmBot::readPendingDatagrams() {
+    QByteArray packet;
+    HifiSockAddr senderSockAddr;
+
+    while (_socket->hasPendingDatagrams()) {
+        packet.resize(_socket->pendingDatagramSize());
+        _socket->readDatagram(packet.data(), packet.size(),
+                              senderSockAddr.getAddressPointer(), senderSockAddr.getPortPointer());
+
+        PacketType packetType = packetTypeForPacket(packet);
+        if (packet.size() < numBytesForPacketHeaderGivenPacketType(packetType)
+                || packet[numBytesArithmeticCodingFromBuffer(packet.data())] != versionForPacketType(packetType)) {
+            continue;
+        }
+
+        if (packetType == PacketTypeDomainList) {
+            _stats->packetReceived(NodeType::DomainServer, packet.size());
+            processDomainList(packet);
+            continue;
+        }
+        if (NON_VERIFIED_PACKETS.contains(packetType)) {
+            continue;
+        }
+
+        // everything else should come from a server we know, signed with the secret we share with it
+        QUuid serverUUID = _serverUUIDsByLocalID.value(localIDFromPacketHeader(packet));
+        if (serverUUID.isNull() || !_servers.contains(serverUUID)) {
+            continue;
+        }
+        Server& server = _servers[serverUUID];
+        if (hashFromPacketHeader(packet) != hashForPacketAndConnectionUUID(packet, server.connectionSecret)) {
+            continue;
+        }
+        _stats->packetReceived(server.type, packet.size());
+
+        switch (packetType) {
+            case PacketTypePing:
+                processPing(packet, server, senderSockAddr);
+                break;
+
+            case PacketTypePingReply:
+                processPingReply(packet, server);
+                break;
+
+            case PacketTypeVoxelData:
+            case PacketTypeParticleData:
+            case PacketTypeModelData:
+                processOctreeData(packet, server);
+                break;
+
+            default:
+                // mixed audio, bulk avatar data and the rest only count toward throughput
+                break;
+        }
+    }
+}
+
+void SwarmBot::checkInWithDomain() {
+    PacketType packetType = _sessionUUID.isNull() ? PacketTypeDomainConnectRequest : PacketTypeDomainListRequest;
+    QByteArray checkInPacket = byteArrayWithPopulatedHeader(packetType, _sessionUUID);
+    QDataStream packetStream(&checkInPacket, QIODevice::Append);
+
+    // leave the public address empty, so that the domain server fills in what it sees (or nothing, if we're on its box)
+    NodeSet interestSet = NodeSet() << NodeType::AudioMixer << NodeType::AvatarMixer << NodeType::VoxelServer
+        << NodeType::ParticleServer << NodeType::ModelServer;
+    packetStream << NodeType::Agent << HifiSockAddr(QHostAddress(), _socket->localPort())
+        << HifiSockAddr(QHostAddress(getHostOrderLocalAddress()), _socket->localPort()) << (quint8)interestSet.size();
+    foreach (NodeType_t nodeType, interestSet) {
+        packetStream << nodeType;
+    }
+
+    _socket->writeDatagram(checkInPacket, _domainSockAddr.getAddress(), _domainSockAddr.getPort());
+    _stats->packetSent(NodeType::DomainServer, checkInPacket.size());
+}
+
+void SwarmBot::processDomainList(const QByteArray& packet) {
+    QDataStream packetStream(packet);
+    packetStream.skipRawData(numBytesForPacketHeader(packet));
+
+    QUuid sessionUUID;
+    LocalID sessionLocalID;
+    packetStream >> sessionUUID >> sessionLocalID;
+    if (_sessionUUID.isNull()) {
+        _stats->botConnected();
+    }
+    _sessionUUID = sessionUUID;
+    _sessionLocalID = sessionLocalID;
+    _avatar.setSessionUUID(sessionUUID);
+
+    QSet<QUuid> listedServers;
+    _serverUUIDsByLocalID.clear();
+    while (!packetStream.atEnd()) {
+        qint8 nodeType;
+        QUuid nodeUUID, connectionSecret;
+        HifiSockAddr publicSocket, localSocket;
+        LocalID localID;
+        packetStream >> nodeType >> nodeUUID >> publicSocket >> localSocket >> localID >> connectionSecret;
+        if (packetStream.status() != QDataStream::Ok) {
+            break;
+        }
+
+        // a server on the domain server's box is reachable at the address we have for the domain server
+        if (publicSocket.getAddress().isNull()) {
+            publicSocket.setAddress(_domainSockAddr.getAddress());
+        }
+
+        Server& server = _servers[nodeUUID];
+        if (server.publicSocket != publicSocket || server.localSocket != localSocket) {
+            server.activeSocket = HifiSockAddr();
+        }
+        server.uuid = nodeUUID;
+        server.type = nodeType;
+        server.localID = localID;
+        server.publicSocket = publicSocket;
+        server.localSocket = localSocket;
+        server.connectionSecret = connectionSecret;
+
+        listedServers.insert(nodeUUID);
+        _serverUUIDsByLocalID.insert(localID, nodeUUID);
+    }
+
+    // forget the servers that have gone away
+    for (QHash<QUuid, Server>::iterator server = _servers.begin(); server != _servers.end(); ) {
+        if (listedServers.contains(server.key())) {
+            server++;
+        } else {
+            server = _servers.erase(server);
+        }
+    }
+}
+
+void SwarmBot::processPing(const QByteArray& packet, Server& server, const HifiSockAddr& senderSockAddr) {
+    QDataStream pingStream(packet);
+    pingStream.skipRawData(numBytesForPacketHeader(packet));
+
+    PingType_t pingType;
+    quint64 timeFromOriginalPing;
+    pingStream >> pingType >> timeFromOriginalPing;
+
+    QByteArray replyPacket = packetForServer(PacketTypePingReply);
+    QDataStream replyStream(&replyPacket, QIODevice::Append);
+    replyStream << pingType << timeFromOriginalPing << usecTimestampNow();
+
+    writeToServer(replyPacket, server, senderSockAddr);
+}
+
+void SwarmBot::processPingReply(const QByteArray& packet, Server& server) {
+    QDataStream replyStream(packet);
+    replyStream.skipRawData(numBytesForPacketHeader(packet));
+
+    PingType_t pingType;
+    quint64 ourOriginalTime, othersReplyTime;
+    replyStream >> pingType >> ourOriginalTime >> othersReplyTime;
+
+    if (server.activeSocket.isNull()) {
+        if (pingType == PingType::Local) {
+            server.activeSocket = server.localSocket;
+        } else if (pingType == PingType::Public) {
+            server.activeSocket = server.publicSocket;
+        }
+    } else {
+        _stats->pingTimeMeasured(server.type, usecTimestampNow() - ourOriginalTime);
+    }
+}
+
+void SwarmBot::processOctreeData(const QByteArray& packet, Server& server) {
+    int numBytesPacketHeader = numBytesForPacketHeader(packet);
+    if (packet.size() < numBytesPacketHeader + (int)OCTREE_PACKET_EXTRA_HEADERS_SIZE) {
+        return;
+    }
+    const unsigned char* dataAt = reinterpret_cast<const unsigned char*>(packet.data()) + numBytesPacketHeader;
+    dataAt += sizeof(OCTREE_PACKET_FLAGS);
+    OCTREE_PACKET_SEQUENCE sequence = (*(OCTREE_PACKET_SEQUENCE*)dataAt);
+    dataAt += sizeof(OCTREE_PACKET_SEQUENCE);
+    OCTREE_PACKET_SENT_TIME sentAt = (*(OCTREE_PACKET_SENT_TIME*)dataAt);
+
+    // we're running against a local domain, so the servers share our clock
+    quint64 arrivedAt = usecTimestampNow();
+    int flightTime = arrivedAt - sentAt;
+    _stats->flightTimeMeasured(server.type, flightTime);
+
+    // report back like any other viewer, so that the server paces us the way it would a real client
+    server.receiverReport.packetReceived(sequence, flightTime, packet.size());
+    if (server.receiverReport.isReadyToSend(arrivedAt)) {
+        QByteArray reportPacket = server.receiverReport.packAndReset(arrivedAt);
+        replaceLocalIDInPacketHeader(reportPacket, _sessionLocalID);
+        writeToServer(reportPacket, server);
+    }
+}
+
+void SwarmBot::move(float deltaTime) {
+    glm::vec3 position = _avatar.getPosition();
+    glm::vec3 velocity;
+
+    switch (_movementPattern) {
+        case Orbiting: {
+            _movementPhase += ORBIT_SPEED * deltaTime;
+            float radius = SWARM_RADIUS * (0.25f + 0.75f * (_index % 10) / 10.0f);
+            glm::vec3 newPosition = _center
+                + glm::vec3(cosf(_movementPhase) * radius, 0.0f, sinf(_movementPhase) * radius);
+            velocity = (newPosition - position) / glm::max(deltaTime, EPSILON);
+            position = newPosition;
+            break;
+        }
+        case Wandering: {
+            glm::vec3 toTarget = _wanderTarget - position;
+            if (glm::length(toTarget) < WANDER_TARGET_REACHED) {
+                _wanderTarget = _center + glm::vec3(randFloatInRange(-SWARM_RADIUS, SWARM_RADIUS), 0.0f,
+                                                    randFloatInRange(-SWARM_RADIUS, SWARM_RADIUS));
+            } else {
+                velocity = glm::normalize(toTarget) * WANDER_SPEED;
+                position += velocity * deltaTime;
+            }
+            break;
+        }
+        default:
+            // standing bots just look around
+            _movementPhase += deltaTime;
+            break;
+    }
+    _avatar.setPosition(position);
+
+    float yaw = glm::length(velocity) > EPSILON ? glm::degrees(atan2f(-velocity.x, -velocity.z))
+        : glm::degrees(sinf(_movementPhase)) * 0.5f;
+    _avatar.setOrientation(glm::quat(glm::radians(glm::vec3(0.0f, yaw, 0.0f))));
+}
+
+void SwarmBot::sendAvatarData(Server& avatarMixer) {
+    QByteArray avatarPacket = packetForServer(PacketTypeAvatarData);
+    avatarPacket.append(_avatar.toByteArray());
+    writeToServer(avatarPacket, avatarMixer);
+}
+
+void SwarmBot::sendIdentity(Server& avatarMixer) {
+    QByteArray identityPacket = packetForServer(PacketTypeAvatarIdentity);
+    identityPacket.append(_avatar.identityByteArray());
+    writeToServer(identityPacket, avatarMixer);
+}
+
+void SwarmBot::sendMicrophoneAudio(Server& audioMixer, quint64 now) {
+    QByteArray frameByteArray(BOT_AUDIO_FRAME_SAMPLES * sizeof(int16_t), 0);
+    int16_t* frame = reinterpret_cast<int16_t*>(frameByteArray.data());
+    bool silentFrame = false;
+
+    int numMicrophoneSamples = _microphoneSamples.size() / sizeof(int16_t);
+    if (numMicrophoneSamples > 0) {
+        const int16_t* samples = reinterpret_cast<const int16_t*>(_microphoneSamples.constData());
+        for (int i = 0; i < BOT_AUDIO_FRAME_SAMPLES; i++) {
+            frame[i] = samples[_microphoneSampleOffset];
+            _microphoneSampleOffset = (_microphoneSampleOffset + 1) % numMicrophoneSamples;
+        }
+    } else if ((now / USECS_PER_SECOND + _index) % TALK_CYCLE_SECONDS < TALKING_SECONDS) {
+        float frequency = MIN_TONE_FREQUENCY + (_index % NUM_TONE_FREQUENCIES) * TONE_FREQUENCY_STEP;
+        float phaseStep = TWO_PI * frequency / SAMPLE_RATE;
+        for (int i = 0; i < BOT_AUDIO_FRAME_SAMPLES; i++) {
+            frame[i] = (int16_t)(sinf(_tonePhase) * TONE_AMPLITUDE);
+            _tonePhase = fmodf(_tonePhase + phaseStep, TWO_PI);
+        }
+    } else {
+        silentFrame = true;
+    }
+
+    QByteArray audioPacket = packetForServer(silentFrame
+                                             ? PacketTypeSilentAudioFrame : PacketTypeMicrophoneAudioNoEcho);
+    QDataStream packetStream(&audioPacket, QIODevice::Append);
+
+    // the same layout a scripted agent sends: position and orientation of the source, then the samples
+    packetStream.writeRawData(reinterpret_cast<const char*>(&_avatar.getPosition()), sizeof(glm::vec3));
+    glm::quat orientation = _avatar.getOrientation();
+    packetStream.writeRawData(reinterpret_cast<const char*>(&orientation), sizeof(glm::quat));
+    if (silentFrame) {
+        packetStream.writeRawData(reinterpret_cast<const char*>(&BOT_AUDIO_FRAME_SAMPLES), sizeof(int16_t));
+    } else {
+        packetStream.writeRawData(frameByteArray.constData(), frameByteArray.size());
+    }
+
+    writeToServer(audioPacket, audioMixer);
+}
+
+void SwarmBot::sendOctreeQuery(Server& octreeServer) {
+    _octreeQuery.setCameraPosition(_avatar.getPosition());
+    _octreeQuery.setCameraOrientation(_avatar.getOrientation());
+    _octreeQuery.setMaxOctreePacketsPerSecond(DEFAULT_MAX_OCTREE_PPS);
+
+    PacketType queryType = octreeServer.type == NodeType::VoxelServer ? PacketTypeVoxelQuery
+        : (octreeServer.type == NodeType::ParticleServer ? PacketTypeParticleQuery : PacketTypeModelQuery);
+
+    unsigned char queryPacket[MAX_PACKET_SIZE];
+    unsigned char* endOfQueryPacket = queryPacket;
+    endOfQueryPacket += populatePacketHeader(reinterpret_cast<char*>(endOfQueryPacket), queryType, _sessionUUID);
+    endOfQueryPacket += _octreeQuery.getBroadcastData(endOfQueryPacket);
+
+    writeUnverifiedToServer(QByteArray(reinterpret_cast<const char*>(queryPacket), endOfQueryPacket - queryPacket),
+                            octreeServer);
+}
+
+void SwarmBot::pingServer(Server& server) {
+    if (server.activeSocket.isNull()) {
+        // punch through to both sockets, and use whichever answers first
+        QByteArray localPingPacket = packetForServer(PacketTypePing);
+        QDataStream localPingStream(&localPingPacket, QIODevice::Append);
+        localPingStream << PingType::Local << usecTimestampNow();
+        writeToServer(localPingPacket, server, server.localSocket);
+
+        QByteArray publicPingPacket = packetForServer(PacketTypePing);
+        QDataStream publicPingStream(&publicPingPacket, QIODevice::Append);
+        publicPingStream << PingType::Public << usecTimestampNow();
+        writeToServer(publicPingPacket, server, server.publicSocket);
+    } else {
+        QByteArray pingPacket = packetForServer(PacketTypePing);
+        QDataStream pingStream(&pingPacket, QIODevice::Append);
+        pingStream << PingType::Agnostic << usecTimestampNow();
+        writeToServer(pingPacket, server);
+    }
+}
+
+QByteArray SwarmBot::packetForServer(PacketType type) const {
+    QByteArray packet = byteArrayWithPopulatedHeader(type, _sessionUUID);
+    if (!NON_VERIFIED_PACKETS.contains(type)) {
+        replaceLocalIDInPacketHeader(packet, _sessionLocalID);
+    }
+    return packet;
+}
+
+void SwarmBot::writeToServer(QByteArray& packet, Server& server, const HifiSockAddr& sockAddr) {
+    const HifiSockAddr& destination = sockAddr.isNull() ? server.activeSocket : sockAddr;
+    if (destination.isNull()) {
+        return;
+    }
+    replaceHashInPacketGivenConnectionUUID(packet, server.connectionSecret);
+    _socket->writeDatagram(packet, destination.getAddress(), destination.getPort());
+    _stats->packetSent(server.type, packet.size());
+}
+
+void SwarmBot::writeUnverifiedToServer(const QByteArray& packet, Server& server) {
+    _socket->writeDatagram(packet, server.activeSocket.getAddress(), server.activeSocket.getPort());
+    _stats->packetSent(server.type, packet.size());
+}
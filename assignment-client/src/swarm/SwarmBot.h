@@ -0,0 +1,109 @@
+//
+//  SwarmBot.h
+//  assignment-client/src/swarm
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_SwarmBot_h
+#define hifi_SwarmBot_h
+
+#include <QtCore/QHash>
+#include <QtCore/QObject>
+#include <QtNetwork/QUdpSocket>
+
+#include <AvatarData.h>
+#include <HifiSockAddr.h>
+#include <OctreeQuery.h>
+#include <OctreeReceiverReport.h>
+#include <PacketHeaders.h>
+
+class SwarmStats;
+
+/// One simulated client in a swarm.  It has its own socket and its own session with the domain server, and sends the
+/// mixers and octree servers what an interface or scripted agent would: avatar data, a microphone stream and octree
+/// queries.  NodeList is a singleton, so a bot keeps its own small list of the servers it talks to and signs its
+/// packets with its own local ID and connection secrets.
+class SwarmBot : public QObject {
+    Q_OBJECT
+public:
+    enum MovementPattern {
+        Standing,
+        Orbiting,
+        Wandering,
+        NUM_MOVEMENT_PATTERNS
+    };
+
+    /// Microphone samples are looped, starting at an offset that depends on the bot; if empty the bot talks in tones.
+    SwarmBot(int index, const HifiSockAddr& domainSockAddr, const glm::vec3& center,
+             const QByteArray& microphoneSamples, SwarmStats* stats);
+
+    /// Opens the bot's socket; call from the thread that will run it.
+    void start();
+
+    /// Moves the bot and sends its packets for this frame.
+    void simulate(float deltaTime, quint64 now);
+
+private slots:
+    void readPendingDatagrams();
+
+private:
+    class Server {
+    public:
+        Server();
+
+        QUuid uuid;
+        NodeType_t type;
+        LocalID localID;
+        HifiSockAddr publicSocket;
+        HifiSockAddr localSocket;
+        HifiSockAddr activeSocket;
+        QUuid connectionSecret;
+        OctreeReceiverReport receiverReport;
+    };
+
+    void checkInWithDomain();
+    void processDomainList(const QByteArray& packet);
+    void processPing(const QByteArray& packet, Server& server, const HifiSockAddr& senderSockAddr);
+    void processPingReply(const QByteArray& packet, Server& server);
+    void processOctreeData(const QByteArray& packet, Server& server);
+
+    void move(float deltaTime);
+    void sendAvatarData(Server& avatarMixer);
+    void sendIdentity(Server& avatarMixer);
+    void sendMicrophoneAudio(Server& audioMixer, quint64 now);
+    void sendOctreeQuery(Server& octreeServer);
+    void pingServer(Server& server);
+
+    QByteArray packetForServer(PacketType type) const;
+    void writeToServer(QByteArray& packet, Server& server, const HifiSockAddr& sockAddr = HifiSockAddr());
+    void writeUnverifiedToServer(const QByteArray& packet, Server& server);
+
+    int _index;
+    SwarmStats* _stats;
+    QUdpSocket* _socket;
+
+    HifiSockAddr _domainSockAddr;
+    QUuid _sessionUUID;
+    LocalID _sessionLocalID;
+    QHash<QUuid, Server> _servers;
+    QHash<LocalID, QUuid> _serverUUIDsByLocalID;
+
+    AvatarData _avatar;
+    OctreeQuery _octreeQuery;
+    MovementPattern _movementPattern;
+    glm::vec3 _center;
+    float _movementPhase;
+    glm::vec3 _wanderTarget;
+
+    QByteArray _microphoneSamples;
+    int _microphoneSampleOffset;
+    float _tonePhase;
+
+    quint64 _nextCheckIn;
+};
+
+#endif // hifi_SwarmBot_h
@@ -0,0 +1,58 @@
+//
+//  SwarmBotGroup.cpp
+//  assignment-client/src/swarm
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QtCore/QTimer>
+
+#include <ScriptEngine.h>
+#include <SharedUtil.h>
+
+#include "SwarmBot.h"
+
+#include "SwarmBotGroup.h"
+
+SwarmBotGroup::SwarmBotGroup(int firstBotIndex, int numBots, const HifiSockAddr& domainSockAddr, const glm::vec3& center,
+                             const QByteArray& microphoneSamples, SwarmStats* stats) :
+    _firstBotIndex(firstBotIndex),
+    _numBots(numBots),
+    _domainSockAddr(domainSockAddr),
+    _center(center),
+    _microphoneSamples(microphoneSamples),
+    _stats(stats),
+    _bots(),
+    _lastSimulate(0)
+{
+}
+
+void SwarmBotGroup::start() {
+    for (int i = 0; i < _numBots; i++) {
+        SwarmBot* bot = new SwarmBot(_firstBotIndex + i, _domainSockAddr, _center, _microphoneSamples, _stats);
+        bot->setParent(this);
+        bot->start();
+        _bots.append(bot);
+    }
+
+    // run the bots at the same rate a script's avatar sends its data
+    QTimer* simulateTimer = new QTimer(this);
+    simulateTimer->setTimerType(Qt::PreciseTimer);
+    connect(simulateTimer, &QTimer::timeout, this, &SwarmBotGroup::simulate);
+    simulateTimer->start(SCRIPT_DATA_CALLBACK_USECS / USECS_PER_MSEC);
+
+    _lastSimulate = usecTimestampNow();
+}
+
+void SwarmBotGroup::simulate() {
+    quint64 now = usecTimestampNow();
+    float deltaTime = (float)(now - _lastSimulate) / USECS_PER_SECOND;
+    _lastSimulate = now;
+
+    foreach (SwarmBot* bot, _bots) {
+        bot->simulate(deltaTime, now);
+    }
+}
@@ -0,0 +1,50 @@
+//
+//  SwarmBotGroup.h
+//  assignment-client/src/swarm
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_SwarmBotGroup_h
+#define hifi_SwarmBotGroup_h
+
+#include <QtCore/QObject>
+#include <QtCore/QVector>
+
+#include <glm/glm.hpp>
+
+#include <HifiSockAddr.h>
+
+class SwarmBot;
+class SwarmStats;
+
+/// The bots run by one of the swarm's threads.  Move the group to its thread before starting it, so that the bots and
+/// their sockets are created there.
+class SwarmBotGroup : public QObject {
+    Q_OBJECT
+public:
+    SwarmBotGroup(int firstBotIndex, int numBots, const HifiSockAddr& domainSockAddr, const glm::vec3& center,
+                  const QByteArray& microphoneSamples, SwarmStats* stats);
+
+public slots:
+    void start();
+
+private slots:
+    void simulate();
+
+private:
+    int _firstBotIndex;
+    int _numBots;
+    HifiSockAddr _domainSockAddr;
+    glm::vec3 _center;
+    QByteArray _microphoneSamples;
+    SwarmStats* _stats;
+
+    QVector<SwarmBot*> _bots;
+    quint64 _lastSimulate;
+};
+
+#endif // hifi_SwarmBotGroup_h
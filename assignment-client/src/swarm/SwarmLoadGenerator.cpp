@@ -0,0 +1,116 @@
+//
+//  SwarmLoadGenerator.cpp
+//  assignment-client/src/swarm
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <algorithm>
+
+#include <Logging.h>
+#include <NodeList.h>
+#include <OctreeConstants.h>
+
+#include "SwarmBotGroup.h"
+
+#include "SwarmLoadGenerator.h"
+
+const char* SWARM_SIZE_PARAMETER = "--swarm";
+
+const QString SWARM_TARGET_NAME = "swarm";
+
+// past a few threads the bots spend more time contending for the stats than they save
+const int MAX_DEFAULT_SWARM_THREADS = 4;
+
+const int SWARM_REPORT_INTERVAL_MSECS = 5 * 1000;
+const int SOUND_DOWNLOAD_CHECK_MSECS = 100;
+
+// where an interface starts, so the bots are in view of anyone who joins the domain to watch
+const glm::vec3 SWARM_CENTER = glm::vec3(0.485f * TREE_SCALE, 0.0f, 0.5f * TREE_SCALE);
+
+SwarmLoadGenerator::SwarmLoadGenerator(int &argc, char **argv, int numBots) :
+    QCoreApplication(argc, argv),
+    _numBots(numBots),
+    _numThreads(std::min(QThread::idealThreadCount(), MAX_DEFAULT_SWARM_THREADS)),
+    _domainSockAddr(QHostAddress(QHostAddress::LocalHost), DEFAULT_DOMAIN_SERVER_PORT),
+    _microphoneSound(NULL)
+{
+    Logging::setTargetName(SWARM_TARGET_NAME);
+
+    // the bots keep their own sessions, but packet headers are still written through the NodeList
+    NodeList::createInstance(NodeType::Agent);
+
+    QStringList argumentList = arguments();
+
+    const QString SWARM_THREADS_OPTION = "--swarmThreads";
+    int argumentIndex = argumentList.indexOf(SWARM_THREADS_OPTION);
+    if (argumentIndex != -1 && argumentIndex + 1 < argumentList.size()) {
+        _numThreads = argumentList[argumentIndex + 1].toInt();
+    }
+    _numThreads = std::max(1, std::min(_numThreads, _numBots));
+
+    const QString DOMAIN_HOSTNAME_OPTION = "-a";
+    argumentIndex = argumentList.indexOf(DOMAIN_HOSTNAME_OPTION);
+    if (argumentIndex != -1 && argumentIndex + 1 < argumentList.size()) {
+        _domainSockAddr = HifiSockAddr(argumentList[argumentIndex + 1], DEFAULT_DOMAIN_SERVER_PORT);
+    }
+
+    connect(&_reportTimer, &QTimer::timeout, this, &SwarmLoadGenerator::report);
+
+    const QString SWARM_SOUND_OPTION = "--swarmSound";
+    argumentIndex = argumentList.indexOf(SWARM_SOUND_OPTION);
+    if (argumentIndex != -1 && argumentIndex + 1 < argumentList.size()) {
+        // Sound doesn't tell us when it's done, so check back until it has
+        _microphoneSound = new Sound(QUrl(argumentList[argumentIndex + 1]), this);
+        connect(&_soundTimer, &QTimer::timeout, this, &SwarmLoadGenerator::checkSoundDownloaded);
+        _soundTimer.start(SOUND_DOWNLOAD_CHECK_MSECS);
+    } else {
+        startBots();
+    }
+}
+
+SwarmLoadGenerator::~SwarmLoadGenerator() {
+    foreach (QThread* thread, _threads) {
+        thread->quit();
+        thread->wait();
+    }
+}
+
+void SwarmLoadGenerator::checkSoundDownloaded() {
+    if (_microphoneSound->hasDownloaded()) {
+        _soundTimer.stop();
+        startBots();
+    }
+}
+
+void SwarmLoadGenerator::startBots() {
+    QByteArray microphoneSamples = _microphoneSound ? _microphoneSound->getByteArray() : QByteArray();
+
+    qDebug() << "Starting a swarm of" << _numBots << "bots on" << _numThreads << "threads against the domain at"
+        << _domainSockAddr;
+
+    int firstBotIndex = 0;
+    for (int i = 0; i < _numThreads; i++) {
+        int groupSize = (_numBots - firstBotIndex) / (_numThreads - i);
+
+        QThread* thread = new QThread(this);
+        SwarmBotGroup* group = new SwarmBotGroup(firstBotIndex, groupSize, _domainSockAddr, SWARM_CENTER,
+                                                 microphoneSamples, &_stats);
+        group->moveToThread(thread);
+        connect(thread, &QThread::started, group, &SwarmBotGroup::start);
+        connect(thread, &QThread::finished, group, &QObject::deleteLater);
+        thread->start();
+        _threads.append(thread);
+
+        firstBotIndex += groupSize;
+    }
+
+    _reportTimer.start(SWARM_REPORT_INTERVAL_MSECS);
+}
+
+void SwarmLoadGenerator::report() {
+    _stats.report(_numBots);
+}
@@ -0,0 +1,50 @@
+//
+//  SwarmLoadGenerator.h
+//  assignment-client/src/swarm
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_SwarmLoadGenerator_h
+#define hifi_SwarmLoadGenerator_h
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QThread>
+#include <QtCore/QTimer>
+
+#include <HifiSockAddr.h>
+#include <Sound.h>
+
+#include "SwarmStats.h"
+
+extern const char* SWARM_SIZE_PARAMETER;
+
+/// Runs a swarm of simulated clients against a domain and logs the throughput and latency of its mixers and octree
+/// servers.  Started in place of an assignment client with --swarm <number of bots>.
+class SwarmLoadGenerator : public QCoreApplication {
+    Q_OBJECT
+public:
+    SwarmLoadGenerator(int &argc, char **argv, int numBots);
+    ~SwarmLoadGenerator();
+
+private slots:
+    void checkSoundDownloaded();
+    void report();
+
+private:
+    void startBots();
+
+    int _numBots;
+    int _numThreads;
+    HifiSockAddr _domainSockAddr;
+    Sound* _microphoneSound;
+    QTimer _soundTimer;
+    QTimer _reportTimer;
+    SwarmStats _stats;
+    QList<QThread*> _threads;
+};
+
+#endif // hifi_SwarmLoadGenerator_h
@@ -0,0 +1,113 @@
+//
+//  SwarmStats.cpp
+//  assignment-client/src/swarm
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <algorithm>
+
+#include <QtCore/QDebug>
+
+#include <SharedUtil.h>
+
+#include "SwarmStats.h"
+
+// plenty for a percentile over a report interval, without letting a big swarm eat memory between reports
+const int MAX_LATENCY_SAMPLES_PER_INTERVAL = 100000;
+
+SwarmStats::ServerStats::ServerStats() :
+    packetsSent(0),
+    bytesSent(0),
+    packetsReceived(0),
+    bytesReceived(0),
+    pingTimes(),
+    flightTimes()
+{
+}
+
+SwarmStats::SwarmStats() :
+    _serverStats(),
+    _connectedBots(0),
+    _lastReport(usecTimestampNow())
+{
+}
+
+void SwarmStats::packetSent(NodeType_t serverType, int bytes) {
+    QMutexLocker locker(&_mutex);
+    ServerStats& stats = _serverStats[serverType];
+    stats.packetsSent++;
+    stats.bytesSent += bytes;
+}
+
+void SwarmStats::packetReceived(NodeType_t serverType, int bytes) {
+    QMutexLocker locker(&_mutex);
+    ServerStats& stats = _serverStats[serverType];
+    stats.packetsReceived++;
+    stats.bytesReceived += bytes;
+}
+
+void SwarmStats::pingTimeMeasured(NodeType_t serverType, int usecs) {
+    QMutexLocker locker(&_mutex);
+    QVector<int>& pingTimes = _serverStats[serverType].pingTimes;
+    if (pingTimes.size() < MAX_LATENCY_SAMPLES_PER_INTERVAL) {
+        pingTimes.append(usecs);
+    }
+}
+
+void SwarmStats::flightTimeMeasured(NodeType_t serverType, int usecs) {
+    QMutexLocker locker(&_mutex);
+    QVector<int>& flightTimes = _serverStats[serverType].flightTimes;
+    if (flightTimes.size() < MAX_LATENCY_SAMPLES_PER_INTERVAL) {
+        flightTimes.append(usecs);
+    }
+}
+
+void SwarmStats::botConnected() {
+    QMutexLocker locker(&_mutex);
+    _connectedBots++;
+}
+
+void SwarmStats::report(int numBots) {
+    QMutexLocker locker(&_mutex);
+
+    quint64 now = usecTimestampNow();
+    float elapsedSeconds = (float)(now - _lastReport) / USECS_PER_SECOND;
+    _lastReport = now;
+    if (elapsedSeconds <= 0.0f) {
+        return;
+    }
+
+    const float BITS_PER_MEGABIT = 1000.0f * 1000.0f;
+
+    qDebug() << "Swarm:" << _connectedBots << "of" << numBots << "bots connected";
+    for (QHash<NodeType_t, ServerStats>::iterator i = _serverStats.begin(); i != _serverStats.end(); i++) {
+        ServerStats& stats = i.value();
+        QString line = QString("    %1: sent %2 pps %3 Mbps, received %4 pps %5 Mbps")
+            .arg(NodeType::getNodeTypeName(i.key()))
+            .arg(stats.packetsSent / elapsedSeconds, 0, 'f', 0)
+            .arg(stats.bytesSent * BITS_IN_BYTE / BITS_PER_MEGABIT / elapsedSeconds, 0, 'f', 2)
+            .arg(stats.packetsReceived / elapsedSeconds, 0, 'f', 0)
+            .arg(stats.bytesReceived * BITS_IN_BYTE / BITS_PER_MEGABIT / elapsedSeconds, 0, 'f', 2);
+        if (!stats.pingTimes.isEmpty()) {
+            line += ", ping " + describeLatency(stats.pingTimes);
+        }
+        if (!stats.flightTimes.isEmpty()) {
+            line += ", flight " + describeLatency(stats.flightTimes);
+        }
+        qDebug() << qPrintable(line);
+
+        stats = ServerStats();
+    }
+}
+
+QString SwarmStats::describeLatency(QVector<int>& usecs) {
+    std::sort(usecs.begin(), usecs.end());
+    return QString("p50 %1 p99 %2 max %3 ms")
+        .arg(usecs.at(usecs.size() / 2) / (float)USECS_PER_MSEC, 0, 'f', 1)
+        .arg(usecs.at((usecs.size() * 99) / 100) / (float)USECS_PER_MSEC, 0, 'f', 1)
+        .arg(usecs.last() / (float)USECS_PER_MSEC, 0, 'f', 1);
+}
@@ -0,0 +1,56 @@
+//
+//  SwarmStats.h
+//  assignment-client/src/swarm
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_SwarmStats_h
+#define hifi_SwarmStats_h
+
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QVector>
+
+#include <Node.h>
+
+/// Collects what a swarm of simulated clients sends to and receives from each type of server under test, along with
+/// ping round trip times and octree packet flight times, and logs a summary every report interval.
+class SwarmStats {
+public:
+    SwarmStats();
+
+    /// \thread any thread
+    void packetSent(NodeType_t serverType, int bytes);
+    void packetReceived(NodeType_t serverType, int bytes);
+    void pingTimeMeasured(NodeType_t serverType, int usecs);
+    void flightTimeMeasured(NodeType_t serverType, int usecs);
+    void botConnected();
+
+    /// Logs rates and latencies since the last report and starts a new interval.
+    void report(int numBots);
+
+private:
+    struct ServerStats {
+        ServerStats();
+
+        quint64 packetsSent;
+        quint64 bytesSent;
+        quint64 packetsReceived;
+        quint64 bytesReceived;
+        QVector<int> pingTimes;
+        QVector<int> flightTimes;
+    };
+
+    static QString describeLatency(QVector<int>& usecs);
+
+    QMutex _mutex;
+    QHash<NodeType_t, ServerStats> _serverStats;
+    int _connectedBots;
+    quint64 _lastReport;
+};
+
+#endif // hifi_SwarmStats_h
@@ -9,6 +9,8 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <limits>
+
 #include <QtCore/QDir>
 #include <QtCore/QJsonDocument>
 #include <QtCore/QJsonObject>
@@ -23,6 +25,7 @@
 #include <AccountManager.h>
 #include <HifiConfigVariantMap.h>
 #include <HTTPConnection.h>
+#include <OctalCode.h>
 #include <PacketHeaders.h>
 #include <SharedUtil.h>
 #include <UUID.h>
@@ -47,7 +50,10 @@ DomainServer::DomainServer(int argc, char* argv[]) :
     _oauthClientID(),
     _hostname(),
     _networkReplyUUIDMap(),
-    _sessionAuthenticationHash()
+    _sessionAuthenticationHash(),
+    _lastLocalID(NULL_LOCAL_ID),
+    _jurisdictionSplitLoad(0.0f),
+    _splitJurisdictions()
 {
     gnutls_global_init();
     
@@ -246,6 +252,19 @@ void DomainServer::setupNodeListAndAssignments(const QUuid& sessionUUID) {
     
     connect(&nodeList->getNodeSocket(), SIGNAL(readyRead()), SLOT(readAvailableDatagrams()));
     
+    // if we've been given a load at which to split octree server jurisdictions, keep an eye on their reported loads
+    const QString JURISDICTION_SPLIT_LOAD_OPTION = "jurisdiction-split-load";
+    
+    if (_argumentVariantMap.contains(JURISDICTION_SPLIT_LOAD_OPTION)) {
+        _jurisdictionSplitLoad = _argumentVariantMap.value(JURISDICTION_SPLIT_LOAD_OPTION).toFloat();
+        
+        const int JURISDICTION_LOAD_CHECK_INTERVAL_MSECS = 10 * 1000;
+        
+        QTimer* jurisdictionLoadTimer = new QTimer(this);
+        connect(jurisdictionLoadTimer, SIGNAL(timeout()), SLOT(checkJurisdictionLoads()));
+        jurisdictionLoadTimer->start(JURISDICTION_LOAD_CHECK_INTERVAL_MSECS);
+    }
+    
     // add whatever static assignments that have been parsed to the queue
     addStaticAssignmentsToQueue();
 }
@@ -438,11 +457,18 @@ void DomainServer::handleConnectRequest(const QByteArray& packet, const HifiSock
         || (isFulfilledOrUnfulfilledAssignment && matchingQueuedAssignment)) {
         // this was either not a static assignment or it was and we had a matching one in the queue
         
+        LocalID localID = allocateLocalID();
+        if (localID == NULL_LOCAL_ID) {
+            qDebug() << "Refusing connection from" << senderSockAddr << "- every local ID is in use.";
+            return;
+        }
+        
         // create a new session UUID for this node
         QUuid nodeUUID = QUuid::createUuid();
         
         SharedNodePointer newNode = LimitedNodeList::getInstance()->addOrUpdateNode(nodeUUID, nodeType,
-                                                                                    publicSockAddr, localSockAddr);
+                                                                                    publicSockAddr, localSockAddr,
+                                                                                    localID);
         // when the newNode is created the linked data is also created
         // if this was a static assignment set the UUID, set the sendingSockAddr
         DomainServerNodeData* nodeData = reinterpret_cast<DomainServerNodeData*>(newNode->getLinkedData());
@@ -455,7 +481,27 @@ void DomainServer::handleConnectRequest(const QByteArray& packet, const HifiSock
         
         // reply back to the user with a PacketTypeDomainList
         sendDomainListToNode(newNode, senderSockAddr, nodeInterestListFromPacket(packet, numPreInterestBytes));
+        
+        sendJurisdictionSplitToParent(newNode);
+    }
+}
+
+LocalID DomainServer::allocateLocalID() {
+    // hand out IDs in sequence rather than reusing the most recently freed, so that packets still in flight from a
+    // killed node aren't attributed to its replacement
+    LimitedNodeList* nodeList = LimitedNodeList::getInstance();
+    
+    // give up once we've wrapped around to where we started, rather than spin forever when every ID is taken
+    const int MAX_LOCAL_IDS = std::numeric_limits<LocalID>::max();
+    for (int i = 0; i < MAX_LOCAL_IDS; i++) {
+        if (++_lastLocalID == NULL_LOCAL_ID) {
+            _lastLocalID++;
+        }
+        if (!nodeList->nodeWithLocalID(_lastLocalID)) {
+            return _lastLocalID;
+        }
     }
+    return NULL_LOCAL_ID;
 }
 
 QUrl DomainServer::oauthRedirectURL() {
@@ -540,9 +586,9 @@ void DomainServer::sendDomainListToNode(const SharedNodePointer& node, const Hif
     
     QByteArray broadcastPacket = byteArrayWithPopulatedHeader(PacketTypeDomainList);
     
-    // always send the node their own UUID back
+    // always send the node their own UUID and local ID back
     QDataStream broadcastDataStream(&broadcastPacket, QIODevice::Append);
-    broadcastDataStream << node->getUUID();
+    broadcastDataStream << node->getUUID() << node->getLocalID();
     
     int numBroadcastPacketLeadBytes = broadcastDataStream.device()->pos();
     
@@ -794,6 +840,8 @@ void DomainServer::processDatagram(const QByteArray& receivedPacket, const HifiS
                 checkInNode->setLastHeardMicrostamp(timeNow);
             
                 sendDomainListToNode(checkInNode, senderSockAddr, nodeInterestListFromPacket(receivedPacket, numNodeInfoBytes));
+                
+                sendJurisdictionSplitToParent(checkInNode);
             }
         } else if (requestType == PacketTypeNodeJsonStats) {
             SharedNodePointer matchingNode = nodeList->sendingNodeForPacket(receivedPacket);
@@ -1184,6 +1232,164 @@ void DomainServer::refreshStaticAssignmentAndAddToQueue(SharedAssignmentPointer&
     _unfulfilledAssignments.enqueue(assignment);
 }
 
+const NodeSet JURISDICTION_SERVER_TYPES = NodeSet() << NodeType::VoxelServer << NodeType::ParticleServer
+    << NodeType::ModelServer;
+
+const QString JURISDICTION_ROOT_OPTION = "--jurisdictionRoot";
+const QString JURISDICTION_END_NODES_OPTION = "--jurisdictionEndNodes";
+const QString JURISDICTION_PARENT_OPTION = "--jurisdictionParent";
+
+void DomainServer::checkJurisdictionLoads() {
+    // octree servers report the load on each octant of their jurisdiction as <server>.4.jurisdiction.load.<octal code>
+    const QString JURISDICTION_LOAD_STATS_MARKER = ".4.jurisdiction.load.";
+    
+    foreach (const SharedNodePointer& node, LimitedNodeList::getInstance()->getNodeHash()) {
+        DomainServerNodeData* nodeData = reinterpret_cast<DomainServerNodeData*>(node->getLinkedData());
+        if (!JURISDICTION_SERVER_TYPES.contains(node->getType()) || !nodeData) {
+            continue;
+        }
+        
+        // only statically assigned servers can be split, since we need to rewrite their assignment
+        SharedAssignmentPointer matchingAssignment = _allAssignments.value(nodeData->getAssignmentUUID());
+        if (!matchingAssignment || !matchingAssignment->isStatic()) {
+            continue;
+        }
+        
+        QString hottestOctant;
+        double hottestLoad = _jurisdictionSplitLoad;
+        
+        const QJsonObject& statsObject = nodeData->getStatsJSONObject();
+        foreach (const QString& statKey, statsObject.keys()) {
+            int markerIndex = statKey.indexOf(JURISDICTION_LOAD_STATS_MARKER);
+            if (markerIndex == -1) {
+                continue;
+            }
+            QString octantHexCode = statKey.mid(markerIndex + JURISDICTION_LOAD_STATS_MARKER.size());
+            double octantLoad = statsObject[statKey].toDouble();
+            
+            if (octantLoad > hottestLoad
+                && !_splitJurisdictions.contains(QString("%1:%2").arg(node->getType()).arg(octantHexCode))) {
+                hottestLoad = octantLoad;
+                hottestOctant = octantHexCode;
+            }
+        }
+        
+        if (!hottestOctant.isEmpty()) {
+            qDebug() << "Octant" << hottestOctant << "of" << uuidStringWithoutCurlyBraces(node->getUUID())
+                << "has load" << hottestLoad << "- splitting it off to a new assignment.";
+            splitJurisdiction(node, matchingAssignment, hottestOctant);
+        }
+    }
+}
+
+void DomainServer::splitJurisdiction(const SharedNodePointer& node, const SharedAssignmentPointer& assignment,
+                                     const QString& octantHexCode) {
+    unsigned char* octantCode = hexStringToOctalCode(octantHexCode);
+    if (!octantCode) {
+        return;
+    }
+    
+    QStringList parentArguments = QString(assignment->getPayload()).split(' ', QString::SkipEmptyParts);
+    
+    int endNodesIndex = parentArguments.indexOf(JURISDICTION_END_NODES_OPTION);
+    QStringList parentEndNodes;
+    if (endNodesIndex != -1 && endNodesIndex + 1 < parentArguments.size()) {
+        parentEndNodes = parentArguments[endNodesIndex + 1].split(',', QString::SkipEmptyParts);
+    }
+    
+    // the new server takes over whichever of the parent's end nodes fall inside the octant
+    QStringList childEndNodes;
+    foreach (const QString& endNodeHexCode, parentEndNodes) {
+        unsigned char* endNodeCode = hexStringToOctalCode(endNodeHexCode);
+        if (endNodeCode && isAncestorOf(octantCode, endNodeCode)) {
+            childEndNodes << endNodeHexCode;
+        }
+        delete[] endNodeCode;
+    }
+    delete[] octantCode;
+    
+    // the new server will ask the parent for the octant's contents when it starts
+    QStringList childArguments;
+    childArguments << JURISDICTION_ROOT_OPTION << octantHexCode;
+    if (!childEndNodes.isEmpty()) {
+        childArguments << JURISDICTION_END_NODES_OPTION << childEndNodes.join(',');
+    }
+    childArguments << JURISDICTION_PARENT_OPTION << uuidStringWithoutCurlyBraces(node->getUUID());
+    
+    Assignment* childAssignment = new Assignment(Assignment::CreateCommand, assignment->getType(), assignment->getPool());
+    childAssignment->setPayload(childArguments.join(' ').toUtf8());
+    addStaticAssignmentToAssignmentHash(childAssignment);
+    _unfulfilledAssignments.enqueue(_allAssignments.value(childAssignment->getUUID()));
+    
+    // rewrite the parent's assignment without the octant, so that it doesn't reclaim it if it is restarted
+    const QString WHOLE_TREE_HEX_CODE = "00";
+    if (!parentArguments.contains(JURISDICTION_ROOT_OPTION)) {
+        parentArguments << JURISDICTION_ROOT_OPTION << WHOLE_TREE_HEX_CODE;
+    }
+    parentEndNodes << octantHexCode;
+    if (endNodesIndex == -1) {
+        parentArguments << JURISDICTION_END_NODES_OPTION;
+        endNodesIndex = parentArguments.size() - 1;
+    }
+    if (endNodesIndex + 1 < parentArguments.size()) {
+        parentArguments[endNodesIndex + 1] = parentEndNodes.join(',');
+    } else {
+        parentArguments << parentEndNodes.join(',');
+    }
+    assignment->setPayload(parentArguments.join(' ').toUtf8());
+    
+    _splitJurisdictions.insert(QString("%1:%2").arg(node->getType()).arg(octantHexCode));
+}
+
+void DomainServer::sendJurisdictionSplitToParent(const SharedNodePointer& node) {
+    if (!JURISDICTION_SERVER_TYPES.contains(node->getType())) {
+        return;
+    }
+    DomainServerNodeData* nodeData = reinterpret_cast<DomainServerNodeData*>(node->getLinkedData());
+    SharedAssignmentPointer matchingAssignment = _allAssignments.value(nodeData->getAssignmentUUID());
+    if (!matchingAssignment) {
+        return;
+    }
+    
+    // a split-off server's assignment names its parent and its octant
+    QStringList arguments = QString(matchingAssignment->getPayload()).split(' ', QString::SkipEmptyParts);
+    int parentIndex = arguments.indexOf(JURISDICTION_PARENT_OPTION);
+    int rootIndex = arguments.indexOf(JURISDICTION_ROOT_OPTION);
+    if (parentIndex == -1 || parentIndex + 1 >= arguments.size()
+        || rootIndex == -1 || rootIndex + 1 >= arguments.size()) {
+        return;
+    }
+    
+    LimitedNodeList* nodeList = LimitedNodeList::getInstance();
+    SharedNodePointer parentNode = nodeList->nodeWithUUID(QUuid(arguments[parentIndex + 1]));
+    if (!parentNode || parentNode->getType() != node->getType()) {
+        // the parent has gone away, and will have come back without the octant
+        return;
+    }
+    
+    unsigned char* octantCode = hexStringToOctalCode(arguments[rootIndex + 1]);
+    if (!octantCode) {
+        return;
+    }
+    
+    // the parent only hands the octant over to the node we name, and we keep naming it for as long as the node
+    // checks in, in case a packet is lost or the node is replaced
+    QByteArray splitPacket = byteArrayWithPopulatedHeader(PacketTypeJurisdictionSplit);
+    QDataStream splitStream(&splitPacket, QIODevice::Append);
+    QByteArray octantCodeBytes(reinterpret_cast<const char*>(octantCode),
+                               bytesRequiredForCodeLength(numberOfThreeBitSectionsInCode(octantCode)));
+    splitStream << octantCodeBytes << node->getUUID();
+    delete[] octantCode;
+    
+    DomainServerNodeData* parentData = reinterpret_cast<DomainServerNodeData*>(parentNode->getLinkedData());
+    DTLSServerSession* dtlsSession = _isUsingDTLS ? _dtlsSessions.value(parentData->getSendingSockAddr()) : NULL;
+    if (dtlsSession) {
+        dtlsSession->writeDatagram(splitPacket);
+    } else {
+        nodeList->writeUnverifiedDatagram(splitPacket, parentData->getSendingSockAddr());
+    }
+}
+
 void DomainServer::nodeAdded(SharedNodePointer node) {
     // we don't use updateNodeWithData, so add the DomainServerNodeData to the node here
     node->setLinkedData(new DomainServerNodeData());
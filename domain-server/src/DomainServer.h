@@ -51,6 +51,8 @@ private slots:
     
     void readAvailableDatagrams();
     void readAvailableDTLSDatagrams();
+    
+    void checkJurisdictionLoads();
 private:
     void setupNodeListAndAssignments(const QUuid& sessionUUID = QUuid::createUuid());
     bool optionallySetupOAuth();
@@ -60,6 +62,10 @@ private:
     void processDatagram(const QByteArray& receivedPacket, const HifiSockAddr& senderSockAddr);
     
     void handleConnectRequest(const QByteArray& packet, const HifiSockAddr& senderSockAddr);
+    
+    /// Returns the next local ID not in use by any node, or NULL_LOCAL_ID if they're all taken.
+    LocalID allocateLocalID();
+    
     int parseNodeDataFromByteArray(NodeType_t& nodeType, HifiSockAddr& publicSockAddr,
                                     HifiSockAddr& localSockAddr, const QByteArray& packet, const HifiSockAddr& senderSockAddr);
     NodeSet nodeInterestListFromPacket(const QByteArray& packet, int numPreceedingBytes);
@@ -78,6 +84,10 @@ private:
     void refreshStaticAssignmentAndAddToQueue(SharedAssignmentPointer& assignment);
     void addStaticAssignmentsToQueue();
     
+    void splitJurisdiction(const SharedNodePointer& node, const SharedAssignmentPointer& assignment,
+                           const QString& octantHexCode);
+    void sendJurisdictionSplitToParent(const SharedNodePointer& node);
+    
     QUrl oauthRedirectURL();
     QUrl oauthAuthorizationURL(const QUuid& stateUUID = QUuid::createUuid());
     
@@ -111,6 +121,11 @@ private:
     QString _hostname;
     QMap<QNetworkReply*, QUuid> _networkReplyUUIDMap;
     QHash<QUuid, bool> _sessionAuthenticationHash;
+    
+    LocalID _lastLocalID;
+    
+    float _jurisdictionSplitLoad;
+    QSet<QString> _splitJurisdictions;
 };
 
 #endif // hifi_DomainServer_h
@@ -60,6 +60,7 @@
 #include <ParticlesScriptingInterface.h>
 #include <PerfStat.h>
 #include <ResourceCache.h>
+#include <Trace.h>
 #include <UUID.h>
 #include <OctreeSceneStats.h>
 #include <LocalVoxelsList.h>
@@ -545,6 +546,7 @@ void Application::paintGL() {
     PerformanceWarning::setSuppressShortTimings(Menu::getInstance()->isOptionChecked(MenuOption::SuppressShortTimings));
     bool showWarnings = Menu::getInstance()->isOptionChecked(MenuOption::PipelineWarnings);
     PerformanceWarning warn(showWarnings, "Application::paintGL()");
+    TraceScope trace("Application::paintGL");
 
     glEnable(GL_LINE_SMOOTH);
 
@@ -2006,6 +2008,7 @@ void Application::updateCursor(float deltaTime) {
 void Application::update(float deltaTime) {
     bool showWarnings = Menu::getInstance()->isOptionChecked(MenuOption::PipelineWarnings);
     PerformanceWarning warn(showWarnings, "Application::update()");
+    TraceScope trace("Application::update");
 
     updateLOD();
 
@@ -3306,6 +3309,9 @@ void Application::trackIncomingVoxelPacket(const QByteArray& packet, const Share
             stats.trackIncomingOctreePacket(packet, wasStatsPacket, sendingNode->getClockSkewUsec());
         }
         _octreeSceneStatsLock.unlock();
+
+        // let the server know what made it here, so it can pace what it sends us
+        _octreeReceiverReporter.trackIncomingOctreePacket(packet, sendingNode);
     }
 }
 
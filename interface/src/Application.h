@@ -37,6 +37,7 @@
 #include <ParticleEditPacketSender.h>
 #include <ScriptEngine.h>
 #include <OctreeQuery.h>
+#include <OctreeReceiverReport.h>
 #include <ViewFrustum.h>
 #include <VoxelEditPacketSender.h>
 
@@ -519,6 +520,7 @@ private:
     NodeToJurisdictionMap _modelServerJurisdictions;
     NodeToOctreeSceneStats _octreeServerSceneStats;
     QReadWriteLock _octreeSceneStatsLock;
+    OctreeReceiverReporter _octreeReceiverReporter;
 
     std::vector<VoxelFade> _voxelFades;
     ControllerScriptingInterface _controllerScriptingInterface;
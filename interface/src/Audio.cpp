@@ -51,6 +51,9 @@ static const int NUMBER_OF_NOISE_SAMPLE_FRAMES = 300;
 // Mute icon configration
 static const int MUTE_ICON_SIZE = 24;
 
+// a few seconds of mixed audio
+static const int MAX_QUEUED_AUDIO_PACKETS = 256;
+
 Audio::Audio(int16_t initialJitterBufferSamples, QObject* parent) :
     AbstractAudioInterface(parent),
     _audioInput(NULL),
@@ -68,6 +71,7 @@ Audio::Audio(int16_t initialJitterBufferSamples, QObject* parent) :
     _proceduralOutputDevice(NULL),
     _inputRingBuffer(0),
     _ringBuffer(NETWORK_BUFFER_LENGTH_BYTES_PER_CHANNEL),
+    _lastReceivedAudioUsecs(0),
     _averagedLatency(0.0),
     _measuredJitter(0),
     _jitterBufferSamples(initialJitterBufferSamples),
@@ -99,7 +103,9 @@ Audio::Audio(int16_t initialJitterBufferSamples, QObject* parent) :
     _scopeOutputOffset(0),
     _scopeInput(SAMPLES_PER_SCOPE_WIDTH * sizeof(int16_t), 0),
     _scopeOutputLeft(SAMPLES_PER_SCOPE_WIDTH * sizeof(int16_t), 0),
-    _scopeOutputRight(SAMPLES_PER_SCOPE_WIDTH * sizeof(int16_t), 0)
+    _scopeOutputRight(SAMPLES_PER_SCOPE_WIDTH * sizeof(int16_t), 0),
+    _queuedAudio(MAX_QUEUED_AUDIO_PACKETS),
+    _queuedAudioWakeupPending(0)
 {
     // clear the array of locally injected samples
     memset(_localProceduralSamples, 0, NETWORK_BUFFER_LENGTH_BYTES_PER_CHANNEL);
@@ -640,14 +646,39 @@ void Audio::handleAudioInput() {
     }
 }
 
+void Audio::queueReceivedAudio(const QByteArray& audioByteArray) {
+    if (!_queuedAudio.push(qMakePair(audioByteArray, usecTimestampNow()))) {
+        // the audio thread has fallen seconds behind; the ring buffer would overflow with this anyway
+        return;
+    }
+    // wake the audio thread once for however many packets arrive before it gets to them
+    if (_queuedAudioWakeupPending.testAndSetOrdered(0, 1)) {
+        QMetaObject::invokeMethod(this, "processQueuedAudio", Qt::QueuedConnection);
+    }
+}
+
+void Audio::processQueuedAudio() {
+    // clear the flag before draining, so that a packet queued while we drain wakes us again
+    _queuedAudioWakeupPending.storeRelease(0);
+
+    QPair<QByteArray, quint64> queued;
+    while (_queuedAudio.pop(queued)) {
+        addReceivedAudioToBuffer(queued.first, queued.second);
+    }
+}
+
 void Audio::addReceivedAudioToBuffer(const QByteArray& audioByteArray) {
+    addReceivedAudioToBuffer(audioByteArray, usecTimestampNow());
+}
+
+void Audio::addReceivedAudioToBuffer(const QByteArray& audioByteArray, quint64 receivedUsecs) {
     const int NUM_INITIAL_PACKETS_DISCARD = 3;
     const int STANDARD_DEVIATION_SAMPLE_COUNT = 500;
     
     _totalPacketsReceived++;
     
-    double timeDiff = (double)_timeSinceLastReceived.nsecsElapsed() / 1000000.0; // ns to ms
-    _timeSinceLastReceived.start();
+    double timeDiff = (double)(receivedUsecs - _lastReceivedAudioUsecs) / USECS_PER_MSEC;
+    _lastReceivedAudioUsecs = receivedUsecs;
     
     //  Discard first few received packets for computing jitter (often they pile up on start)
     if (_totalPacketsReceived > NUM_INITIAL_PACKETS_DISCARD) {
@@ -1265,7 +1296,7 @@ bool Audio::switchOutputToAudioDevice(const QAudioDeviceInfo& outputDeviceInfo)
             // setup a procedural audio output device
             _proceduralAudioOutput = new QAudioOutput(outputDeviceInfo, _outputFormat, this);
 
-            _timeSinceLastReceived.start();
+            _lastReceivedAudioUsecs = usecTimestampNow();
 
             // setup spatial audio ringbuffer
             int numFrameSamples = _outputFormat.sampleRate() * _desiredOutputFormat.channelCount();
@@ -19,7 +19,6 @@
 
 #include <QAudio>
 #include <QAudioInput>
-#include <QElapsedTimer>
 #include <QGLWidget>
 #include <QtCore/QObject>
 #include <QtCore/QVector>
@@ -29,6 +28,7 @@
 
 #include <AbstractAudioInterface.h>
 #include <AudioRingBuffer.h>
+#include <SPSCQueue.h>
 #include <StdDev.h>
 
 static const int NUM_AUDIO_CHANNELS = 2;
@@ -72,6 +72,10 @@ public:
 
     bool getProcessSpatialAudio() const { return _processSpatialAudio; }
 
+    /// Hands a mixed audio packet to the audio thread, stamped with when it arrived.
+    /// \thread network receive thread
+    void queueReceivedAudio(const QByteArray& audioByteArray);
+
 public slots:
     void start();
     void stop();
@@ -98,6 +102,9 @@ public slots:
     float getInputVolume() const { return (_audioInput) ? _audioInput->volume() : 0.0f; }
     void setInputVolume(float volume) { if (_audioInput) _audioInput->setVolume(volume); }
 
+private slots:
+    void processQueuedAudio();
+
 signals:
     bool muteToggled();
     void preProcessOriginalInboundAudio(unsigned int sampleTime, QByteArray& samples, const QAudioFormat& format);
@@ -129,7 +136,7 @@ private:
     QString _outputAudioDeviceName;
     
     StDev _stdev;
-    QElapsedTimer _timeSinceLastReceived;
+    quint64 _lastReceivedAudioUsecs;
     float _averagedLatency;
     float _measuredJitter;
     int16_t _jitterBufferSamples;
@@ -185,6 +192,9 @@ private:
     // Add sounds that we want the user to not hear themselves, by adding on top of mic input signal
     void addProceduralSounds(int16_t* monoInput, int numSamples);
     
+    // Measure jitter from when received audio arrived and then process it
+    void addReceivedAudioToBuffer(const QByteArray& audioByteArray, quint64 receivedUsecs);
+
     // Process received audio
     void processReceivedAudio(const QByteArray& audioByteArray);
 
@@ -220,6 +230,10 @@ private:
     QByteArray _scopeOutputLeft;
     QByteArray _scopeOutputRight;
 
+    // packets from the network receive thread, with the time each arrived
+    SPSCQueue<QPair<QByteArray, quint64> > _queuedAudio;
+    QAtomicInt _queuedAudioWakeupPending;
+
 };
 
 
@@ -31,12 +31,12 @@ void DatagramProcessor::processDatagrams() {
     
     HifiSockAddr senderSockAddr;
     
-    static QByteArray incomingPacket;
-    
     Application* application = Application::getInstance();
     NodeList* nodeList = NodeList::getInstance();
     
     while (NodeList::getInstance()->getNodeSocket().hasPendingDatagrams()) {
+        // each packet gets its own buffer, since the subsystem queues hold on to it after we move on to the next
+        QByteArray incomingPacket;
         incomingPacket.resize(nodeList->getNodeSocket().pendingDatagramSize());
         nodeList->getNodeSocket().readDatagram(incomingPacket.data(), incomingPacket.size(),
                                                senderSockAddr.getAddressPointer(), senderSockAddr.getPortPointer());
@@ -48,8 +48,7 @@ void DatagramProcessor::processDatagrams() {
             // only process this packet if we have a match on the packet version
             switch (packetTypeForPacket(incomingPacket)) {
                 case PacketTypeMixedAudio:
-                    QMetaObject::invokeMethod(&application->_audio, "addReceivedAudioToBuffer", Qt::QueuedConnection,
-                                              Q_ARG(QByteArray, incomingPacket));
+                    application->_audio.queueReceivedAudio(incomingPacket);
                     break;
                     
                 case PacketTypeParticleAddResponse:
@@ -111,9 +110,7 @@ void DatagramProcessor::processDatagrams() {
                         avatarMixer->setLastHeardMicrostamp(usecTimestampNow());
                         avatarMixer->recordBytesReceived(incomingPacket.size());
                         
-                        QMetaObject::invokeMethod(&application->getAvatarManager(), "processAvatarMixerDatagram",
-                                                  Q_ARG(const QByteArray&, incomingPacket),
-                                                  Q_ARG(const QWeakPointer<Node>&, avatarMixer));
+                        application->getAvatarManager().queueAvatarMixerDatagram(incomingPacket, avatarMixer);
                     }
                     
                     application->_bandwidthMeter.inputStream(BandwidthMeter::AVATARS).updateValue(incomingPacket.size());
@@ -14,6 +14,9 @@
 
 #include <QtCore/QObject>
 
+/// Reads, verifies and sorts incoming packets on the node thread.  Audio and avatar packets are handed to their
+/// subsystems through single producer/consumer queues and octree packets to their processing threads, so that the
+/// main thread only sees work that is ready for it.
 class DatagramProcessor : public QObject {
     Q_OBJECT
 public:
@@ -16,6 +16,7 @@
 #include <QColorDialog>
 #include <QDialogButtonBox>
 #include <QDoubleSpinBox>
+#include <QFile>
 #include <QFileDialog>
 #include <QFormLayout>
 #include <QInputDialog>
@@ -30,6 +31,7 @@
 #include <QDesktopServices>
 
 #include <AccountManager.h>
+#include <Trace.h>
 #include <XmppClient.h>
 #include <UUID.h>
 
@@ -361,6 +363,7 @@ Menu::Menu() :
     addCheckableActionToQMenuAndActionHash(timingMenu, MenuOption::TestPing, 0, true);
     addCheckableActionToQMenuAndActionHash(timingMenu, MenuOption::FrameTimer);
     addActionToQMenuAndActionHash(timingMenu, MenuOption::RunTimingTests, 0, this, SLOT(runTests()));
+    addActionToQMenuAndActionHash(timingMenu, MenuOption::DumpTrace, 0, this, SLOT(dumpTrace()));
 
     QMenu* frustumMenu = developerMenu->addMenu("View Frustum Debugging Tools");
     addCheckableActionToQMenuAndActionHash(frustumMenu, MenuOption::DisplayFrustum, Qt::SHIFT | Qt::Key_F);
@@ -1383,6 +1386,22 @@ void Menu::runTests() {
     runTimingTests();
 }
 
+void Menu::dumpTrace() {
+    // take the trace before the dialog opens, so that it shows what led up to the request
+    QByteArray trace = Trace::toChromeTraceJSON();
+    QString locationDir(QStandardPaths::displayName(QStandardPaths::DesktopLocation));
+    QString fileName = QFileDialog::getSaveFileName(Application::getInstance()->getWindow(),
+                                                    tr("Save Chrome trace"),
+                                                    locationDir,
+                                                    tr("Trace files (*.json)"));
+    if (fileName != "") {
+        QFile file(fileName);
+        if (file.open(QIODevice::WriteOnly)) {
+            file.write(trace);
+        }
+    }
+}
+
 void Menu::updateFrustumRenderModeAction() {
     QAction* frustumRenderModeAction = _actionHash.value(MenuOption::FrustumRenderMode);
     switch (_frustumDrawMode) {
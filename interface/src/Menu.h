@@ -184,6 +184,7 @@ private slots:
     void lodToolsClosed();
     void cycleFrustumRenderMode();
     void runTests();
+    void dumpTrace();
     void showMetavoxelEditor();
     void showScriptEditor();
     void showChat();
@@ -308,6 +309,7 @@ namespace MenuOption {
     const QString DisplayModelElementProxy = "Display Model Element Bounds";
     const QString DisplayModelElementChildProxies = "Display Model Element Children";
     const QString DontFadeOnVoxelServerChanges = "Don't Fade In/Out on Voxel Server Changes";
+    const QString DumpTrace = "Save Trace...";
     const QString EchoLocalAudio = "Echo Local Audio";
     const QString EchoServerAudio = "Echo Server Audio";
     const QString Enable3DTVMode = "Enable 3DTV Mode";
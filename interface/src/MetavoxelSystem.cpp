@@ -239,6 +239,8 @@ MetavoxelClient::MetavoxelClient(const SharedNodePointer& node) :
     _node(node),
     _sequencer(byteArrayWithPopulatedHeader(PacketTypeMetavoxelData)) {
     
+    _sequencer.setIntegerEncoding(Bitstream::VARIABLE_INTEGERS);
+    
     connect(&_sequencer, SIGNAL(readyToWrite(const QByteArray&)), SLOT(sendData(const QByteArray&)));
     connect(&_sequencer, SIGNAL(readyToRead(Bitstream&)), SLOT(readPacket(Bitstream&)));
     connect(&_sequencer, SIGNAL(sendAcknowledged(int)), SLOT(clearSendRecordsBefore(int)));
@@ -265,6 +267,12 @@ static MetavoxelLOD getLOD() {
     return MetavoxelLOD(Application::getInstance()->getCamera()->getPosition(), FIXED_LOD_THRESHOLD);
 }
 
+static MetavoxelLOD getQuantizedLOD() {
+    // quantize the LOD we send so that nearby clients are likely to share encoded deltas on the server
+    const float LOD_POSITION_GRANULARITY = 0.5f;
+    return getLOD().getQuantized(LOD_POSITION_GRANULARITY);
+}
+
 void MetavoxelClient::guide(MetavoxelVisitor& visitor) {
     visitor.setLOD(getLOD());
     _data.guide(visitor);
@@ -286,7 +294,7 @@ void MetavoxelClient::applyEdit(const MetavoxelEditMessage& edit, bool reliable)
 void MetavoxelClient::simulate(float deltaTime) {
     Bitstream& out = _sequencer.startPacket();
     
-    ClientStateMessage state = { getLOD() };
+    ClientStateMessage state = { getQuantizedLOD() };
     out << QVariant::fromValue(state);
     _sequencer.endPacket();
     
@@ -20,6 +20,7 @@
 #include <glm/detail/func_common.hpp>
 
 #include <SharedUtil.h>
+#include <ViewFrustum.h>
 
 #include "InterfaceConfig.h"
 #include "ui/TextRenderer.h"
@@ -460,6 +461,53 @@ void runTimingTests() {
     }
     elapsedUsecs = (float)startTime.nsecsElapsed() * NSEC_TO_USEC;
     qDebug("vec3 assign and dot() usecs: %f, last result:%f", elapsedUsecs / (float) numTests, result);
+
+    //  Classifying the children of an octree element, one at a time and all at once
+    ViewFrustum viewFrustum;
+    viewFrustum.setPosition(glm::vec3(TREE_SCALE * 0.5f, 2.0f, TREE_SCALE * 0.5f));
+    viewFrustum.setOrientation(glm::quat(glm::vec3(0.0f, PI_OVER_TWO * 0.5f, 0.0f)));
+    viewFrustum.setFieldOfView(DEFAULT_FIELD_OF_VIEW_DEGREES);
+    viewFrustum.setAspectRatio(DEFAULT_ASPECT_RATIO);
+    viewFrustum.setNearClip(DEFAULT_NEAR_CLIP);
+    viewFrustum.setFarClip(DEFAULT_FAR_CLIP);
+    viewFrustum.calculate();
+    const int numBoxes = 1024;
+    const float boxScale = 4.0f;
+    AABox boxes[numBoxes];
+    for (int i = 0; i < numBoxes; i++) {
+        boxes[i] = AABox(glm::vec3(randFloat(), randFloat() * 0.01f, randFloat()) * (float)TREE_SCALE, boxScale);
+    }
+    const int numClassifications = numTests / NUMBER_OF_CHILDREN;
+    int inView = 0;
+    startTime.start();
+    for (int i = 0; i < numClassifications; i++) {
+        const AABox& box = boxes[i % numBoxes];
+        for (int j = 0; j < NUMBER_OF_CHILDREN; j++) {
+            glm::vec3 childCorner = box.getCorner() + glm::vec3((j >> 2) & 1, (j >> 1) & 1, j & 1) * (boxScale * 0.5f);
+            AABox child(childCorner, boxScale * 0.5f);
+            if (viewFrustum.boxInFrustum(child) != ViewFrustum::OUTSIDE) {
+                inView++;
+            }
+            result = glm::distance(child.calcCenter(), viewFrustum.getPosition());
+        }
+    }
+    elapsedUsecs = (float)startTime.nsecsElapsed() * NSEC_TO_USEC;
+    qDebug("boxInFrustum() and distance for each child usecs: %f, in view: %d",
+           elapsedUsecs / (float) numClassifications, inView);
+
+    ChildrenInView children;
+    inView = 0;
+    startTime.start();
+    for (int i = 0; i < numClassifications; i++) {
+        viewFrustum.classifyChildren(boxes[i % numBoxes], ALL_FRUSTUM_PLANES, children);
+        for (int j = 0; j < NUMBER_OF_CHILDREN; j++) {
+            if (children.locations[j] != ViewFrustum::OUTSIDE) {
+                inView++;
+            }
+        }
+    }
+    elapsedUsecs = (float)startTime.nsecsElapsed() * NSEC_TO_USEC;
+    qDebug("classifyChildren() usecs: %f, in view: %d", elapsedUsecs / (float) numClassifications, inView);
 }
 
 float loadSetting(QSettings* settings, const char* name, float defaultValue) {
@@ -56,7 +56,9 @@ Avatar::Avatar() :
     _moving(false),
     _collisionGroups(0),
     _initialized(false),
-    _shouldRenderBillboard(true)
+    _shouldRenderBillboard(true),
+    _inViewFrustum(false),
+    _skeletonGeometryChanged(false)
 {
     // we may have been created in the network thread, but we live in the main thread
     moveToThread(Application::getInstance()->thread());
@@ -95,6 +97,11 @@ float Avatar::getLODDistance() const {
 }
 
 void Avatar::simulate(float deltaTime) {
+    prepareToSimulate(deltaTime);
+    simulatePrepared(deltaTime);
+}
+
+void Avatar::prepareToSimulate(float deltaTime) {
     if (_scale != _targetScale) {
         setScale(_targetScale);
     }
@@ -111,21 +118,29 @@ void Avatar::simulate(float deltaTime) {
 
     // simple frustum check
     float boundingRadius = getBillboardSize();
-    bool inViewFrustum = Application::getInstance()->getViewFrustum()->sphereInFrustum(_position, boundingRadius) !=
+    _inViewFrustum = Application::getInstance()->getViewFrustum()->sphereInFrustum(_position, boundingRadius) !=
         ViewFrustum::OUTSIDE;
 
     getHand()->simulate(deltaTime, false);
     _skeletonModel.setLODDistance(getLODDistance());
     
-    if (!_shouldRenderBillboard && inViewFrustum) {
+    if (!_shouldRenderBillboard && _inViewFrustum) {
+        _skeletonGeometryChanged = _skeletonModel.prepareToSimulate(false);
+        prepareAttachmentsToSimulate();
+        getHead()->prepareToSimulate();
+    }
+}
+
+void Avatar::simulatePrepared(float deltaTime) {
+    if (!_shouldRenderBillboard && _inViewFrustum) {
         if (_hasNewJointRotations) {
             for (int i = 0; i < _jointData.size(); i++) {
                 const JointData& data = _jointData.at(i);
                 _skeletonModel.setJointState(i, data.valid, data.rotation);
             }
-            _skeletonModel.simulate(deltaTime);
+            _skeletonModel.simulatePrepared(deltaTime, true);
         }
-        _skeletonModel.simulate(deltaTime, _hasNewJointRotations);
+        _skeletonModel.simulatePrepared(deltaTime, _skeletonGeometryChanged || _hasNewJointRotations);
         simulateAttachments(deltaTime);
         _hasNewJointRotations = false;
 
@@ -135,6 +150,9 @@ void Avatar::simulate(float deltaTime) {
         head->setPosition(headPosition);
         head->setScale(_scale);
         head->simulate(deltaTime, false, _shouldRenderBillboard);
+        
+        // place the collision shapes here too, rather than on the main thread when they're first needed
+        updateShapePositions();
     }
     
     // update position by velocity, and subtract the change added earlier for gravity
@@ -364,6 +382,12 @@ bool Avatar::shouldRenderHead(const glm::vec3& cameraPosition, RenderMode render
     return true;
 }
 
+void Avatar::prepareAttachmentsToSimulate() {
+    foreach (Model* model, _attachmentModels) {
+        model->prepareToSimulate();
+    }
+}
+
 void Avatar::simulateAttachments(float deltaTime) {
     for (int i = 0; i < _attachmentModels.size(); i++) {
         const AttachmentData& attachment = _attachmentData.at(i);
@@ -376,7 +400,7 @@ void Avatar::simulateAttachments(float deltaTime) {
             model->setTranslation(jointPosition + jointRotation * attachment.translation * _scale);
             model->setRotation(jointRotation * attachment.rotation);
             model->setScale(_skeletonModel.getScale() * attachment.scale);
-            model->simulate(deltaTime);
+            model->simulatePrepared(deltaTime, true);
         }
     }
 }
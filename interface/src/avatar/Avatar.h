@@ -72,6 +72,14 @@ public:
     void init();
     void simulate(float deltaTime);
     
+    /// The first half of simulate, which must run on the main thread: updates the level of detail and geometry of the
+    /// avatar's models, along with the state that depends on the camera.
+    void prepareToSimulate(float deltaTime);
+    
+    /// The second half of simulate: computes the joint transforms, shapes and blendshapes.  This touches only the
+    /// avatar itself, so once prepared, different avatars may be simulated on different threads at once.
+    void simulatePrepared(float deltaTime);
+    
     enum RenderMode { NORMAL_RENDER_MODE, SHADOW_RENDER_MODE, MIRROR_RENDER_MODE };
     
     virtual void render(const glm::vec3& cameraPosition, RenderMode renderMode = NORMAL_RENDER_MODE);
@@ -191,6 +199,7 @@ protected:
     virtual void renderBody(RenderMode renderMode, float glowLevel = 0.0f);
     virtual bool shouldRenderHead(const glm::vec3& cameraPosition, RenderMode renderMode) const;
 
+    void prepareAttachmentsToSimulate();
     void simulateAttachments(float deltaTime);
     void renderAttachments(Model::RenderMode renderMode);
 
@@ -202,6 +211,8 @@ private:
     QScopedPointer<Texture> _billboardTexture;
     bool _shouldRenderBillboard;
     bool _isLookAtTarget;
+    bool _inViewFrustum; ///< as of the last prepareToSimulate
+    bool _skeletonGeometryChanged; ///< whether the last prepareToSimulate requires a full update of the skeleton
 
     void renderBillboard();
     
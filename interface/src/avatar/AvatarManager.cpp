@@ -11,9 +11,17 @@
 
 #include <string>
 
+#include <QAtomicInt>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QSharedPointer>
+#include <QThreadPool>
+
 #include <glm/gtx/string_cast.hpp>
 
+#include <PacketHeaders.h>
 #include <PerfStat.h>
+#include <Trace.h>
 #include <UUID.h>
 
 #include "Application.h"
@@ -26,8 +34,68 @@
 // We add _myAvatar into the hash with all the other AvatarData, and we use the default NULL QUid as the key.
 const QUuid MY_AVATAR_KEY;  // NULL key
 
+// enough for a couple of seconds of a crowded mixer's packets if the main thread stalls
+const int MAX_QUEUED_AVATAR_MIXER_DATAGRAMS = 1024;
+
+// below this many avatars, starting tasks costs more than simulating them all here
+const int MIN_AVATARS_TO_SIMULATE_IN_PARALLEL = 4;
+
+/// Shared state for simulating a set of prepared avatars in parallel.
+class AvatarSimulation {
+public:
+
+    AvatarSimulation(const QVector<Avatar*>& avatars, float deltaTime, quint64* simulationUsecs) :
+        avatars(avatars),
+        avatarCount(avatars.size()),
+        deltaTime(deltaTime),
+        simulationUsecs(simulationUsecs) { }
+
+    /// Takes the next unclaimed avatar and simulates it.
+    /// \return false if there were no avatars left to simulate
+    bool simulateNext();
+
+    const QVector<Avatar*>& avatars;
+    int avatarCount; ///< copied, so that a task starting late sees there's nothing left even if avatars changed
+    float deltaTime;
+    quint64* simulationUsecs; ///< written by index, so that each thread writes only its own avatars' times
+    QAtomicInt nextAvatar;
+    QSemaphore completed;
+};
+
+bool AvatarSimulation::simulateNext() {
+    int index = nextAvatar.fetchAndAddOrdered(1);
+    if (index >= avatarCount) {
+        return false;
+    }
+    TraceScope trace("Avatar::simulatePrepared");
+    quint64 startedAt = usecTimestampNow();
+    avatars.at(index)->simulatePrepared(deltaTime);
+    simulationUsecs[index] = usecTimestampNow() - startedAt;
+    completed.release();
+    return true;
+}
+
+/// Simulates avatars on a pool thread until there are none left.
+class AvatarSimulationTask : public QRunnable {
+public:
+
+    AvatarSimulationTask(const QSharedPointer<AvatarSimulation>& simulation) : _simulation(simulation) { }
+
+    virtual void run() { while (_simulation->simulateNext()); }
+
+private:
+
+    QSharedPointer<AvatarSimulation> _simulation;
+};
+
 AvatarManager::AvatarManager(QObject* parent) :
-    _avatarFades() {
+    _avatarFades(),
+    _queuedAvatarMixerDatagrams(MAX_QUEUED_AVATAR_MIXER_DATAGRAMS),
+    _avatarMixerDatagramsOverflowed(0),
+    _droppedAvatarDataPackets(0),
+    _simulationUsecs(0),
+    _averageAvatarSimulationUsecs(0),
+    _maxAvatarSimulationUsecs(0) {
     // register a meta type for the weak pointer we'll use for the owning avatar mixer for each avatar
     qRegisterMetaType<QWeakPointer<Node> >("NodeWeakPointer");
     _myAvatar = QSharedPointer<MyAvatar>(new MyAvatar());
@@ -40,15 +108,53 @@ void AvatarManager::init() {
     _avatarHash.insert(MY_AVATAR_KEY, _myAvatar);
 }
 
+void AvatarManager::queueAvatarMixerDatagram(const QByteArray& datagram, const QWeakPointer<Node>& mixerWeakPointer) {
+    // once anything has overflowed, later packets must follow it rather than jump ahead through the queue
+    if (!_avatarMixerDatagramsOverflowed.loadAcquire() &&
+            _queuedAvatarMixerDatagrams.push(qMakePair(datagram, mixerWeakPointer))) {
+        return;
+    }
+    // if the main thread is this far behind, drop avatar data; the mixer will be sending newer data anyway.  A lost
+    // kill or identity packet, though, won't be sent again
+    if (packetTypeForPacket(datagram) == PacketTypeBulkAvatarData) {
+        _droppedAvatarDataPackets.ref();
+        return;
+    }
+    QMutexLocker locker(&_overflowMutex);
+    _overflowedAvatarMixerDatagrams.append(qMakePair(datagram, mixerWeakPointer));
+    _avatarMixerDatagramsOverflowed.storeRelease(1);
+}
+
+void AvatarManager::processQueuedAvatarMixerDatagrams() {
+    // everything in the queue arrived before anything in the overflow list
+    QueuedDatagram queued;
+    while (_queuedAvatarMixerDatagrams.pop(queued)) {
+        processAvatarMixerDatagram(queued.first, queued.second);
+    }
+    QList<QueuedDatagram> overflowed;
+    {
+        QMutexLocker locker(&_overflowMutex);
+        overflowed.swap(_overflowedAvatarMixerDatagrams);
+        _avatarMixerDatagramsOverflowed.storeRelease(0);
+    }
+    foreach (const QueuedDatagram& datagram, overflowed) {
+        processAvatarMixerDatagram(datagram.first, datagram.second);
+    }
+}
+
 void AvatarManager::updateOtherAvatars(float deltaTime) {
     bool showWarnings = Menu::getInstance()->isOptionChecked(MenuOption::PipelineWarnings);
     PerformanceWarning warn(showWarnings, "Application::updateAvatars()");
 
+    // take in everything the avatar mixer sent since the last frame before simulating
+    processQueuedAvatarMixerDatagrams();
+
     Application* applicationInstance = Application::getInstance();
     glm::vec3 mouseOrigin = applicationInstance->getMouseRayOrigin();
     glm::vec3 mouseDirection = applicationInstance->getMouseRayDirection();
 
-    // simulate avatars
+    // prepare the avatars here (loading their models and so on), then simulate them in parallel
+    _avatarsToSimulate.clear();
     AvatarHash::iterator avatarIterator = _avatarHash.begin();
     while (avatarIterator != _avatarHash.end()) {
         AvatarSharedPointer sharedAvatar = avatarIterator.value();
@@ -62,19 +168,50 @@ void AvatarManager::updateOtherAvatars(float deltaTime) {
         }
         if (!shouldKillAvatar(sharedAvatar)) {
             // this avatar's mixer is still around, go ahead and simulate it
-            avatar->simulate(deltaTime);
+            avatar->prepareToSimulate(deltaTime);
             avatar->setMouseRay(mouseOrigin, mouseDirection);
+            _avatarsToSimulate.append(avatar);
             ++avatarIterator;
         } else {
             // the mixer that owned this avatar is gone, give it to the vector of fades and kill it
             avatarIterator = erase(avatarIterator);
         }
     }
+    simulateOtherAvatars(deltaTime);
     
     // simulate avatar fades
     simulateAvatarFades(deltaTime);
 }
 
+void AvatarManager::simulateOtherAvatars(float deltaTime) {
+    int avatarCount = _avatarsToSimulate.size();
+    _avatarSimulationUsecs.fill(0, avatarCount);
+    quint64 startedAt = usecTimestampNow();
+    if (avatarCount > 0) {
+        QSharedPointer<AvatarSimulation> simulation(new AvatarSimulation(_avatarsToSimulate, deltaTime,
+            _avatarSimulationUsecs.data()));
+        if (avatarCount >= MIN_AVATARS_TO_SIMULATE_IN_PARALLEL) {
+            // start tasks on the pool, but also simulate on this thread so that we never wait on a task that hasn't
+            // started
+            int taskCount = qMin(avatarCount - 1, QThreadPool::globalInstance()->maxThreadCount());
+            for (int i = 0; i < taskCount; i++) {
+                QThreadPool::globalInstance()->start(new AvatarSimulationTask(simulation));
+            }
+        }
+        while (simulation->simulateNext());
+        simulation->completed.acquire(avatarCount);
+    }
+    _simulationUsecs = usecTimestampNow() - startedAt;
+
+    quint64 totalAvatarUsecs = 0;
+    _maxAvatarSimulationUsecs = 0;
+    foreach (quint64 usecs, _avatarSimulationUsecs) {
+        totalAvatarUsecs += usecs;
+        _maxAvatarSimulationUsecs = qMax(_maxAvatarSimulationUsecs, usecs);
+    }
+    _averageAvatarSimulationUsecs = (avatarCount > 0) ? totalAvatarUsecs / avatarCount : 0;
+}
+
 void AvatarManager::renderAvatars(Avatar::RenderMode renderMode, bool selfAvatarOnly) {
     PerformanceWarning warn(Menu::getInstance()->isOptionChecked(MenuOption::PipelineWarnings),
                             "Application::renderAvatars()");
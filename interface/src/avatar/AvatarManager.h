@@ -12,11 +12,15 @@
 #ifndef hifi_AvatarManager_h
 #define hifi_AvatarManager_h
 
+#include <QtCore/QAtomicInt>
 #include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
 #include <QtCore/QObject>
 #include <QtCore/QSharedPointer>
 
 #include <AvatarHashMap.h>
+#include <SPSCQueue.h>
 
 #include "Avatar.h"
 
@@ -31,7 +35,26 @@ public:
 
     MyAvatar* getMyAvatar() { return _myAvatar.data(); }
     
+    /// Holds an avatar mixer packet for the next update, rather than asking the main thread to process each one.
+    /// If the main thread falls so far behind that the queue fills, avatar data packets are dropped (the mixer will
+    /// send newer ones), but kill, identity and billboard packets are always kept, in order.
+    /// \thread network receive thread
+    void queueAvatarMixerDatagram(const QByteArray& datagram, const QWeakPointer<Node>& mixerWeakPointer);
+
+    /// Returns the number of avatar data packets dropped because the queue was full.
+    int getDroppedAvatarDataPackets() const { return _droppedAvatarDataPackets.load(); }
+
     void updateOtherAvatars(float deltaTime);
+    
+    /// Returns the time spent simulating the other avatars in the last update, end to end.
+    quint64 getSimulationUsecs() const { return _simulationUsecs; }
+    
+    /// Returns the average time spent simulating each of the other avatars in the last update.
+    quint64 getAverageAvatarSimulationUsecs() const { return _averageAvatarSimulationUsecs; }
+    
+    /// Returns the longest time spent simulating one of the other avatars in the last update.
+    quint64 getMaxAvatarSimulationUsecs() const { return _maxAvatarSimulationUsecs; }
+    
     void renderAvatars(Avatar::RenderMode renderMode, bool selfAvatarOnly = false);
     
     void clearOtherAvatars();
@@ -39,6 +62,8 @@ public:
 private:
     AvatarManager(const AvatarManager& other);
 
+    void processQueuedAvatarMixerDatagrams();
+    void simulateOtherAvatars(float deltaTime);
     void simulateAvatarFades(float deltaTime);
     void renderAvatarFades(const glm::vec3& cameraPosition, Avatar::RenderMode renderMode);
     
@@ -49,6 +74,20 @@ private:
     
     QVector<AvatarSharedPointer> _avatarFades;
     QSharedPointer<MyAvatar> _myAvatar;
+
+    typedef QPair<QByteArray, QWeakPointer<Node> > QueuedDatagram;
+    
+    SPSCQueue<QueuedDatagram> _queuedAvatarMixerDatagrams;
+    QList<QueuedDatagram> _overflowedAvatarMixerDatagrams; ///< packets that must not be dropped, once the queue fills
+    QAtomicInt _avatarMixerDatagramsOverflowed; ///< nonzero while the packets are going to the overflow list
+    QMutex _overflowMutex;
+    QAtomicInt _droppedAvatarDataPackets;
+    
+    QVector<Avatar*> _avatarsToSimulate;
+    QVector<quint64> _avatarSimulationUsecs;
+    quint64 _simulationUsecs;
+    quint64 _averageAvatarSimulationUsecs;
+    quint64 _maxAvatarSimulationUsecs;
 };
 
 #endif // hifi_AvatarManager_h
@@ -21,8 +21,7 @@ FaceModel::FaceModel(Head* owningHead) :
 {
 }
 
-void FaceModel::simulate(float deltaTime, bool fullUpdate) {
-    updateGeometry();
+void FaceModel::simulatePrepared(float deltaTime, bool fullUpdate) {
     Avatar* owningAvatar = static_cast<Avatar*>(_owningHead->_owningAvatar);
     glm::vec3 neckPosition;
     if (!owningAvatar->getSkeletonModel().getNeckPosition(neckPosition)) {
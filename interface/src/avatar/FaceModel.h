@@ -24,7 +24,7 @@ public:
 
     FaceModel(Head* owningHead);
 
-    virtual void simulate(float deltaTime, bool fullUpdate = true);
+    virtual void simulatePrepared(float deltaTime, bool fullUpdate);
     
     virtual void maybeUpdateNeckRotation(const JointState& parentState, const FBXJoint& joint, JointState& state);
     virtual void maybeUpdateEyeRotation(const JointState& parentState, const FBXJoint& joint, JointState& state);
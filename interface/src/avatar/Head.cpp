@@ -62,6 +62,11 @@ void Head::reset() {
     _faceModel.reset();
 }
 
+void Head::prepareToSimulate() {
+    _faceModel.setLODDistance(static_cast<Avatar*>(_owningAvatar)->getLODDistance());
+    _faceModel.prepareToSimulate();
+}
+
 void Head::simulate(float deltaTime, bool isMine, bool billboard) {
     //  Update audio trailing average for rendering facial animations
     if (isMine) {
@@ -155,12 +160,13 @@ void Head::simulate(float deltaTime, bool isMine, bool billboard) {
 				JAW_OPEN_DEAD_ZONE, 0.0f, 1.0f), _blendshapeCoefficients);
     }
     
-    if (!isMine) {
-        _faceModel.setLODDistance(static_cast<Avatar*>(_owningAvatar)->getLODDistance());
-    }
     _leftEyePosition = _rightEyePosition = getPosition();
     if (!billboard) {
-        _faceModel.simulate(deltaTime);
+        if (isMine) {
+            _faceModel.simulate(deltaTime);
+        } else {
+            _faceModel.simulatePrepared(deltaTime, true);
+        }
         if (!_faceModel.getEyePositions(_leftEyePosition, _rightEyePosition)) {
             static_cast<Avatar*>(_owningAvatar)->getSkeletonModel().getEyePositions(_leftEyePosition, _rightEyePosition);
         }
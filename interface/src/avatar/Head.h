@@ -41,6 +41,11 @@ public:
     
     void init();
     void reset();
+    
+    /// Updates the level of detail and geometry of the face, on the main thread.  Other avatars' heads must be prepared
+    /// before they're simulated, which may then happen on any thread; ours prepares itself.
+    void prepareToSimulate();
+    
     void simulate(float deltaTime, bool isMine, bool billboard = false);
     void render(float alpha, Model::RenderMode mode);
     void setScale(float scale);
@@ -180,6 +180,7 @@ void MyAvatar::simulate(float deltaTime) {
     getHand()->simulate(deltaTime, true);
 
     _skeletonModel.simulate(deltaTime);
+    prepareAttachmentsToSimulate();
     simulateAttachments(deltaTime);
 
     // copy out the skeleton joints from the model
@@ -1113,6 +1114,11 @@ void MyAvatar::updateCollisionWithAvatars(float deltaTime) {
 
     const float BODY_COLLISION_RESOLUTION_FACTOR = glm::max(1.0f, deltaTime / BODY_COLLISION_RESOLUTION_TIMESCALE);
 
+    // our shapes are batched once for all the avatars (and only if we come near one)
+    ShapeBatch myBatch;
+    bool myBatchIsBuilt = false;
+    ShapeBatch theirBatch;
+
     foreach (const AvatarSharedPointer& avatarPointer, avatars) {
         Avatar* avatar = static_cast<Avatar*>(avatarPointer.data());
         if (static_cast<Avatar*>(this) == avatar) {
@@ -1127,13 +1133,19 @@ void MyAvatar::updateCollisionWithAvatars(float deltaTime) {
         float theirBoundingRadius = avatar->getBoundingRadius();
         if (distance < myBoundingRadius + theirBoundingRadius) {
             // collide our body against theirs
-            QVector<const Shape*> myShapes;
-            _skeletonModel.getBodyShapes(myShapes);
+            if (!myBatchIsBuilt) {
+                QVector<const Shape*> myShapes;
+                _skeletonModel.getBodyShapes(myShapes);
+                myBatch.addShapes(myShapes);
+                myBatchIsBuilt = true;
+            }
             QVector<const Shape*> theirShapes;
             avatar->getSkeletonModel().getBodyShapes(theirShapes);
+            theirBatch.clear();
+            theirBatch.addShapes(theirShapes);
 
             CollisionInfo collision;
-            if (ShapeCollider::collideShapesCoarse(myShapes, theirShapes, collision)) {
+            if (ShapeCollider::collideShapesCoarse(myBatch, theirBatch, collision)) {
                 float penetrationDepth = glm::length(collision._penetration);
                 if (penetrationDepth > myBoundingRadius) {
                     qDebug() << "WARNING: ignoring avatar-avatar penetration depth " << penetrationDepth;
@@ -22,11 +22,6 @@ SkeletonModel::SkeletonModel(Avatar* owningAvatar) :
 }
 
 void SkeletonModel::simulate(float deltaTime, bool fullUpdate) {
-    setTranslation(_owningAvatar->getPosition());
-    setRotation(_owningAvatar->getOrientation() * glm::angleAxis(PI, glm::vec3(0.0f, 1.0f, 0.0f)));
-    const float MODEL_SCALE = 0.0006f;
-    setScale(glm::vec3(1.0f, 1.0f, 1.0f) * _owningAvatar->getScale() * MODEL_SCALE);
-    
     Model::simulate(deltaTime, fullUpdate);
     
     if (!(isActive() && _owningAvatar->isMyAvatar())) {
@@ -65,6 +60,15 @@ void SkeletonModel::simulate(float deltaTime, bool fullUpdate) {
     }
 }
 
+void SkeletonModel::simulatePrepared(float deltaTime, bool fullUpdate) {
+    setTranslation(_owningAvatar->getPosition());
+    setRotation(_owningAvatar->getOrientation() * glm::angleAxis(PI, glm::vec3(0.0f, 1.0f, 0.0f)));
+    const float MODEL_SCALE = 0.0006f;
+    setScale(glm::vec3(1.0f, 1.0f, 1.0f) * _owningAvatar->getScale() * MODEL_SCALE);
+    
+    Model::simulatePrepared(deltaTime, fullUpdate);
+}
+
 void SkeletonModel::getHandShapes(int jointIndex, QVector<const Shape*>& shapes) const {
     if (jointIndex < 0 || jointIndex >= int(_jointShapes.size())) {
         return;
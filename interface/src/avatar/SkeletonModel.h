@@ -25,6 +25,7 @@ public:
     SkeletonModel(Avatar* owningAvatar);
     
     void simulate(float deltaTime, bool fullUpdate = true);
+    virtual void simulatePrepared(float deltaTime, bool fullUpdate);
 
     /// \param jointIndex index of hand joint
     /// \param shapes[out] list in which is stored pointers to hand shapes
@@ -15,6 +15,9 @@
 #include <QRunnable>
 #include <QThreadPool>
 
+#include <BlendshapeEvaluator.h>
+#include <FBXCooker.h>
+
 #include "Application.h"
 #include "GeometryCache.h"
 #include "Model.h"
@@ -497,7 +500,8 @@ void GeometryReader::run() {
     }
     try {
         QMetaObject::invokeMethod(geometry.data(), "setGeometry", Q_ARG(const FBXGeometry&,
-            _url.path().toLower().endsWith(".svo") ? readSVO(_reply->readAll()) : readFBX(_reply->readAll(), _mapping)));
+            _url.path().toLower().endsWith(".svo") ? readSVO(_reply->readAll()) :
+                readFBXWithCookedCache(_reply->readAll(), _mapping)));
         
     } catch (const QString& error) {
         qDebug() << "Error reading " << _url << ": " << error;
@@ -559,6 +563,10 @@ void NetworkGeometry::reinsert() {
 
 void NetworkGeometry::setGeometry(const FBXGeometry& geometry) {
     _geometry = geometry;
+    if (_geometry.hasBlendedMeshes()) {
+        // packed on first use, by whichever model's blender gets there first
+        _blendshapeDeltas = QSharedPointer<BlendshapeDeltas>(new BlendshapeDeltas(_geometry.meshes));
+    }
     
     foreach (const FBXMesh& mesh, _geometry.meshes) {
         NetworkMesh networkMesh = { QOpenGLBuffer(QOpenGLBuffer::IndexBuffer), QOpenGLBuffer(QOpenGLBuffer::VertexBuffer) };
@@ -22,6 +22,7 @@
 
 #include <FBXReader.h>
 
+class BlendshapeDeltas;
 class Model;
 class NetworkGeometry;
 class NetworkMesh;
@@ -90,6 +91,10 @@ public:
     const FBXGeometry& getFBXGeometry() const { return _geometry; }
     const QVector<NetworkMesh>& getMeshes() const { return _meshes; }
 
+    /// Returns the packed blendshape deltas that every model using this geometry evaluates, or a null pointer if the
+    /// geometry has no blended meshes.
+    const QSharedPointer<BlendshapeDeltas>& getBlendshapeDeltas() const { return _blendshapeDeltas; }
+
     virtual void setLoadPriority(const QPointer<QObject>& owner, float priority);
     virtual void setLoadPriorities(const QHash<QPointer<QObject>, float>& priorities);
     virtual void clearLoadPriority(const QPointer<QObject>& owner);
@@ -114,6 +119,7 @@ private:
     QMap<float, QSharedPointer<NetworkGeometry> > _lods;
     FBXGeometry _geometry;
     QVector<NetworkMesh> _meshes;
+    QSharedPointer<BlendshapeDeltas> _blendshapeDeltas;
     
     QWeakPointer<NetworkGeometry> _lodParent;
 };
@@ -16,6 +16,7 @@
 #include <glm/gtx/transform.hpp>
 #include <glm/gtx/norm.hpp>
 
+#include <BlendshapeEvaluator.h>
 #include <GeometryUtil.h>
 
 #include "Application.h"
@@ -343,6 +344,11 @@ bool Model::updateGeometry() {
             }
             _blendedVertexBuffers.append(buffer);
         }
+        if (fbxGeometry.hasBlendedMeshes()) {
+            // the deltas are shared with every other model using this geometry; only the blended result is ours
+            _blendshapeEvaluator = QSharedPointer<BlendshapeEvaluator>(
+                new BlendshapeEvaluator(geometry->getBlendshapeDeltas()));
+        }
         foreach (const FBXAttachment& attachment, fbxGeometry.attachments) {
             Model* model = new Model(this);
             model->init();
@@ -755,17 +761,12 @@ bool Model::findRayIntersection(const glm::vec3& origin, const glm::vec3& direct
 }
 
 bool Model::findCollisions(const QVector<const Shape*> shapes, CollisionList& collisions) {
-    bool collided = false;
-    for (int i = 0; i < shapes.size(); ++i) {
-        const Shape* theirShape = shapes[i];
-        for (int j = 0; j < _jointShapes.size(); ++j) {
-            const Shape* ourShape = _jointShapes[j];
-            if (ShapeCollider::collideShapes(theirShape, ourShape, collisions)) {
-                collided = true;
-            }
-        }
+    QVector<const Shape*> ourShapes;
+    ourShapes.reserve(_jointShapes.size());
+    foreach (const Shape* shape, _jointShapes) {
+        ourShapes.append(shape);
     }
-    return collided;
+    return ShapeCollider::collideShapeLists(shapes, ourShapes, collisions);
 }
 
 bool Model::findSphereCollisions(const glm::vec3& sphereCenter, float sphereRadius,
@@ -818,7 +819,7 @@ class Blender : public QRunnable {
 public:
 
     Blender(Model* model, const QWeakPointer<NetworkGeometry>& geometry,
-        const QVector<FBXMesh>& meshes, const QVector<float>& blendshapeCoefficients);
+        const QSharedPointer<BlendshapeEvaluator>& evaluator, const QVector<float>& blendshapeCoefficients);
     
     virtual void run();
 
@@ -826,54 +827,31 @@ private:
     
     QPointer<Model> _model;
     QWeakPointer<NetworkGeometry> _geometry;
-    QVector<FBXMesh> _meshes;
+    QSharedPointer<BlendshapeEvaluator> _evaluator;
     QVector<float> _blendshapeCoefficients;
 };
 
 Blender::Blender(Model* model, const QWeakPointer<NetworkGeometry>& geometry,
-        const QVector<FBXMesh>& meshes, const QVector<float>& blendshapeCoefficients) :
+        const QSharedPointer<BlendshapeEvaluator>& evaluator, const QVector<float>& blendshapeCoefficients) :
     _model(model),
     _geometry(geometry),
-    _meshes(meshes),
+    _evaluator(evaluator),
     _blendshapeCoefficients(blendshapeCoefficients) {
 }
 
 void Blender::run() {
-    // make sure the model/geometry still exists
-    if (_model.isNull() || _geometry.isNull()) {
-        return;
-    }
-    QVector<glm::vec3> vertices, normals;
-    int offset = 0;
-    foreach (const FBXMesh& mesh, _meshes) {
-        if (mesh.blendshapes.isEmpty()) {
-            continue;
+    // evaluate the coefficients we were started with, then any that were queued while we were running
+    do {
+        // make sure the model/geometry still exists, and that there's something new to post
+        if (!_model.isNull() && !_geometry.isNull() && _evaluator->evaluate(_blendshapeCoefficients)) {
+            // post the result to the geometry cache, which will dispatch to the model if still alive; we post before
+            // releasing the evaluator so that results arrive in order
+            QMetaObject::invokeMethod(Application::getInstance()->getGeometryCache(), "setBlendedVertices",
+                Q_ARG(const QPointer<Model>&, _model), Q_ARG(const QWeakPointer<NetworkGeometry>&, _geometry),
+                Q_ARG(const QVector<glm::vec3>&, _evaluator->getVertices()),
+                Q_ARG(const QVector<glm::vec3>&, _evaluator->getNormals()));
         }
-        vertices += mesh.vertices;
-        normals += mesh.normals;
-        glm::vec3* meshVertices = vertices.data() + offset;
-        glm::vec3* meshNormals = normals.data() + offset;
-        offset += mesh.vertices.size();
-        const float NORMAL_COEFFICIENT_SCALE = 0.01f;
-        for (int i = 0, n = qMin(_blendshapeCoefficients.size(), mesh.blendshapes.size()); i < n; i++) {
-            float vertexCoefficient = _blendshapeCoefficients.at(i);
-            if (vertexCoefficient < EPSILON) {
-                continue;
-            }
-            float normalCoefficient = vertexCoefficient * NORMAL_COEFFICIENT_SCALE;
-            const FBXBlendshape& blendshape = mesh.blendshapes.at(i);
-            for (int j = 0; j < blendshape.indices.size(); j++) {
-                int index = blendshape.indices.at(j);
-                meshVertices[index] += blendshape.vertices.at(j) * vertexCoefficient;
-                meshNormals[index] += blendshape.normals.at(j) * normalCoefficient;
-            }
-        }
-    }
-    
-    // post the result to the geometry cache, which will dispatch to the model if still alive
-    QMetaObject::invokeMethod(Application::getInstance()->getGeometryCache(), "setBlendedVertices",
-        Q_ARG(const QPointer<Model>&, _model), Q_ARG(const QWeakPointer<NetworkGeometry>&, _geometry),
-        Q_ARG(const QVector<glm::vec3>&, vertices), Q_ARG(const QVector<glm::vec3>&, normals));
+    } while (_evaluator->releaseOrTakeQueued(_blendshapeCoefficients));
 }
 
 void Model::setScaleToFit(bool scaleToFit, float largestDimension) {
@@ -913,7 +891,15 @@ void Model::snapToCenter() {
 }
 
 void Model::simulate(float deltaTime, bool fullUpdate) {
-    fullUpdate = updateGeometry() || fullUpdate || (_scaleToFit && !_scaledToFit) || (_snapModelToCenter && !_snappedToCenter);
+    simulatePrepared(deltaTime, prepareToSimulate(fullUpdate));
+}
+
+bool Model::prepareToSimulate(bool fullUpdate) {
+    return updateGeometry() || fullUpdate;
+}
+
+void Model::simulatePrepared(float deltaTime, bool fullUpdate) {
+    fullUpdate = fullUpdate || (_scaleToFit && !_scaledToFit) || (_snapModelToCenter && !_snappedToCenter);
     if (isActive() && fullUpdate) {
         // check for scale to fit
         if (_scaleToFit && !_scaledToFit) {
@@ -964,9 +950,10 @@ void Model::simulateInternal(float deltaTime) {
         }
     }
     
-    // post the blender
-    if (geometry.hasBlendedMeshes()) {
-        QThreadPool::globalInstance()->start(new Blender(this, _geometry, geometry.meshes, _blendshapeCoefficients));
+    // post the blender, unless the last one is still running, in which case it picks up these coefficients when done
+    if (_blendshapeEvaluator && _blendshapeEvaluator->acquireOrQueue(_blendshapeCoefficients)) {
+        QThreadPool::globalInstance()->start(new Blender(this, _geometry, _blendshapeEvaluator,
+            _blendshapeCoefficients));
     }
 }
 
@@ -1343,6 +1330,7 @@ void Model::deleteGeometry() {
     }
     _attachments.clear();
     _blendedVertexBuffers.clear();
+    _blendshapeEvaluator.clear();
     _jointStates.clear();
     _meshStates.clear();
     clearShapes();
@@ -22,6 +22,7 @@
 #include "ProgramObject.h"
 #include "TextureCache.h"
 
+class BlendshapeEvaluator;
 class Shape;
 
 /// A generic 3D model displaying geometry loaded from a URL.
@@ -70,6 +71,15 @@ public:
     void reset();
     virtual void simulate(float deltaTime, bool fullUpdate = true);
     
+    /// The first half of simulate, which updates the geometry (loading it, switching LODs, creating buffers) and so
+    /// must run on the main thread.
+    /// \return whether the second half should do a full update
+    bool prepareToSimulate(bool fullUpdate = true);
+    
+    /// The second half of simulate, which updates the joint transforms and starts blending, touching only this model
+    /// and its attachments; once prepared, different models may be simulated on different threads at once.
+    virtual void simulatePrepared(float deltaTime, bool fullUpdate);
+    
     enum RenderMode { DEFAULT_RENDER_MODE, SHADOW_RENDER_MODE, DIFFUSE_RENDER_MODE, NORMAL_RENDER_MODE };
     
     bool render(float alpha = 1.0f, RenderMode mode = DEFAULT_RENDER_MODE);
@@ -311,6 +321,7 @@ private:
     QUrl _url;
         
     QVector<QOpenGLBuffer> _blendedVertexBuffers;
+    QSharedPointer<BlendshapeEvaluator> _blendshapeEvaluator;
     
     QVector<QVector<QSharedPointer<Texture> > > _dilatedTextures;
     
@@ -722,6 +722,7 @@ public:
     
     VoxelizationVisitor(const QVector<DirectionImages>& directionImages, const glm::vec3& center, float granularity);
     
+    virtual bool isThreadSafe() const { return true; }
     virtual int visit(MetavoxelInfo& info);
 
 private:
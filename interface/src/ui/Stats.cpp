@@ -74,7 +74,7 @@ void Stats::checkClick(int mouseX, int mouseY, int mouseDragStartedX, int mouseD
     statsX = horizontalOffset;
 
     // top-left stats click
-    lines = _expanded ? 5 : 3;
+    lines = _expanded ? 7 : 3;
     statsHeight = lines * STATS_PELS_PER_LINE + 10;
     if (mouseX > statsX && mouseX < statsX + _generalStatsWidth && mouseY > statsY && mouseY < statsY + statsHeight) {
         toggleExpanded();
@@ -189,7 +189,7 @@ void Stats::display(
     int totalAvatars = Application::getInstance()->getAvatarManager().size() - 1;
     int totalServers = NodeList::getInstance()->size();
 
-    lines = _expanded ? 5 : 3;
+    lines = _expanded ? 8 : 3;
     drawBackground(backgroundColor, horizontalOffset, 0, _generalStatsWidth, lines * STATS_PELS_PER_LINE + 10);
     horizontalOffset += 5;
 
@@ -212,11 +212,25 @@ void Stats::display(
         sprintf(packetsPerSecondString, "Pkts/sec: %d", packetsPerSecond);
         char averageMegabitsPerSecond[30];
         sprintf(averageMegabitsPerSecond, "Mbps: %3.2f", (float)bytesPerSecond * 8.f / 1000000.f);
+        const AvatarManager& avatarManager = Application::getInstance()->getAvatarManager();
+        char avatarSimulation[30];
+        sprintf(avatarSimulation, "Avatar sim: %.1f ms", avatarManager.getSimulationUsecs() / 1000.0f);
+        char avatarSimulationEach[30];
+        sprintf(avatarSimulationEach, "Each: %d us, max %d", (int)avatarManager.getAverageAvatarSimulationUsecs(),
+            (int)avatarManager.getMaxAvatarSimulationUsecs());
+        char avatarDataDropped[30];
+        sprintf(avatarDataDropped, "Avatar data dropped: %d", avatarManager.getDroppedAvatarDataPackets());
 
         verticalOffset += STATS_PELS_PER_LINE;
         drawText(horizontalOffset, verticalOffset, scale, rotation, font, packetsPerSecondString, color);
         verticalOffset += STATS_PELS_PER_LINE;
         drawText(horizontalOffset, verticalOffset, scale, rotation, font, averageMegabitsPerSecond, color);
+        verticalOffset += STATS_PELS_PER_LINE;
+        drawText(horizontalOffset, verticalOffset, scale, rotation, font, avatarSimulation, color);
+        verticalOffset += STATS_PELS_PER_LINE;
+        drawText(horizontalOffset, verticalOffset, scale, rotation, font, avatarSimulationEach, color);
+        verticalOffset += STATS_PELS_PER_LINE;
+        drawText(horizontalOffset, verticalOffset, scale, rotation, font, avatarDataDropped, color);
     }
 
     verticalOffset = 0;
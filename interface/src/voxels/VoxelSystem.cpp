@@ -15,6 +15,8 @@
 #include <iostream> // to load voxels from file
 #include <fstream> // to load voxels from file
 
+#include <QThread>
+
 #include <OctalCode.h>
 #include <PacketHeaders.h>
 #include <PerfStat.h>
@@ -30,8 +32,6 @@
 
 const bool VoxelSystem::DONT_BAIL_EARLY = false;
 
-float identityVerticesGlobalNormals[] = { 0,0,0, 1,0,0, 1,1,0, 0,1,0, 0,0,1, 1,0,1, 1,1,1, 0,1,1 };
-
 float identityVertices[] = { 0,0,0, 1,0,0, 1,1,0, 0,1,0, 0,0,1, 1,0,1, 1,1,1, 0,1,1, //0-7
                              0,0,0, 1,0,0, 1,1,0, 0,1,0, 0,0,1, 1,0,1, 1,1,1, 0,1,1, //8-15
                              0,0,0, 1,0,0, 1,1,0, 0,1,0, 0,0,1, 1,0,1, 1,1,1, 0,1,1 }; // 16-23
@@ -99,6 +99,9 @@ VoxelSystem::VoxelSystem(float treeScale, int maxVoxels, VoxelTree* tree)
     _writeColorsArray = NULL;
     _writeVoxelDirtyArray = NULL;
     _readVoxelDirtyArray = NULL;
+    _writeChunkDirtyArray = NULL;
+    _readChunkDirtyArray = NULL;
+    _arrayWritesThread = NULL;
 
     _inSetupNewVoxelsForDrawing = false;
     _useFastVoxelPipeline = false;
@@ -185,15 +188,15 @@ void VoxelSystem::elementUpdated(OctreeElement* element) {
 glBufferIndex VoxelSystem::getNextBufferIndex() {
     glBufferIndex output = GLBUFFER_INDEX_UNKNOWN;
     // if there's a free index, use it...
+    _freeIndexLock.lock();
     if (_freeIndexes.size() > 0) {
-        _freeIndexLock.lock();
         output = _freeIndexes.back();
         _freeIndexes.pop_back();
-        _freeIndexLock.unlock();
     } else {
         output = _voxelsInWriteArrays;
         _voxelsInWriteArrays++;
     }
+    _freeIndexLock.unlock();
     return output;
 }
 
@@ -372,6 +375,12 @@ void VoxelSystem::cleanupVoxelMemory() {
         delete[] _writeVoxelDirtyArray;
         delete[] _readVoxelDirtyArray;
         _writeVoxelDirtyArray = _readVoxelDirtyArray = NULL;
+
+        delete[] _writeChunkDirtyArray;
+        delete[] _readChunkDirtyArray;
+        _writeChunkDirtyArray = _readChunkDirtyArray = NULL;
+
+        _arrayBuilder.setArrays(NULL, NULL, NULL);
         _readArraysLock.unlock();
     }
 }
@@ -523,6 +532,16 @@ void VoxelSystem::initVoxelMemory() {
     }
     _renderer = new PrimitiveRenderer(_maxVoxels);
 
+    // we also track dirtiness per chunk of voxels, so that passing on changes needn't look at every voxel
+    int chunkCount = VoxelArrayBuilder::getChunkCount(_maxVoxels);
+    _writeChunkDirtyArray = new bool[chunkCount];
+    memset(_writeChunkDirtyArray, false, chunkCount * sizeof(bool));
+    _readChunkDirtyArray = new bool[chunkCount];
+    memset(_readChunkDirtyArray, false, chunkCount * sizeof(bool));
+    _memoryUsageRAM += (2 * sizeof(bool) * chunkCount);
+
+    _arrayBuilder.setArrays(_writeVerticesArray, _writeColorsArray, _writeVoxelShaderData);
+
     _initialized = true;
 
     _writeArraysLock.unlock();
@@ -645,7 +664,9 @@ void VoxelSystem::setupNewVoxelsForDrawing() {
             }
             clearFreeBufferIndexes();
         }
+        beginArrayWrites();
         _voxelsUpdated = newTreeToArrays(_tree->getRoot());
+        endArrayWrites();
         _tree->clearDirtyBit(); // after we pull the trees into the array, we can consider the tree clean
 
         if (_writeRenderFullVBO) {
@@ -787,8 +808,11 @@ void VoxelSystem::recreateVoxelGeometryInView() {
 
     // do we need to reset out _writeVoxelDirtyArray arrays??
     memset(_writeVoxelDirtyArray, false, _maxVoxels * sizeof(bool));
+    memset(_writeChunkDirtyArray, false, VoxelArrayBuilder::getChunkCount(_maxVoxels) * sizeof(bool));
     
+    beginArrayWrites();
     _tree->recurseTreeWithOperation(recreateVoxelGeometryInViewOperation,(void*)&args);
+    endArrayWrites();
     _tree->unlock();
     _writeArraysLock.unlock();
 }
@@ -878,6 +902,7 @@ void VoxelSystem::copyWrittenDataToReadArraysFullVBOs() {
 
     // clear our dirty flags
     memset(_writeVoxelDirtyArray, false, _voxelsInWriteArrays * sizeof(bool));
+    memset(_writeChunkDirtyArray, false, VoxelArrayBuilder::getChunkCount(_voxelsInWriteArrays) * sizeof(bool));
 
     // let the reader know to get the full array
     _readRenderFullVBO = true;
@@ -886,22 +911,38 @@ void VoxelSystem::copyWrittenDataToReadArraysFullVBOs() {
 void VoxelSystem::copyWrittenDataToReadArraysPartialVBOs() {
     glBufferIndex segmentStart = 0;
     bool inSegment = false;
-    for (glBufferIndex i = 0; i < _voxelsInWriteArrays; i++) {
-        bool thisVoxelDirty = _writeVoxelDirtyArray[i];
-        _readVoxelDirtyArray[i] |= thisVoxelDirty;
-        _writeVoxelDirtyArray[i] = false;
-        if (!inSegment) {
-            if (thisVoxelDirty) {
-                segmentStart = i;
-                inSegment = true;
-            }
-        } else {
-            if (!thisVoxelDirty) {
-                // If we got here because because this voxel is NOT dirty, so the last dirty voxel was the one before
-                // this one and so that's where the "segment" ends
-                copyWrittenDataSegmentToReadArrays(segmentStart, i - 1);
+    int chunkCount = VoxelArrayBuilder::getChunkCount(_voxelsInWriteArrays);
+    for (int chunk = 0; chunk < chunkCount; chunk++) {
+        glBufferIndex chunkStart = chunk * VoxelArrayBuilder::SLOTS_PER_CHUNK;
+        if (!_writeChunkDirtyArray[chunk]) {
+            // nothing in this chunk was written since we last copied, so any segment ends where it starts
+            if (inSegment) {
+                copyWrittenDataSegmentToReadArrays(segmentStart, chunkStart - 1);
                 inSegment = false;
             }
+            continue;
+        }
+        _writeChunkDirtyArray[chunk] = false;
+        _readChunkDirtyArray[chunk] = true;
+
+        glBufferIndex chunkEnd = std::min(chunkStart + VoxelArrayBuilder::SLOTS_PER_CHUNK, _voxelsInWriteArrays);
+        for (glBufferIndex i = chunkStart; i < chunkEnd; i++) {
+            bool thisVoxelDirty = _writeVoxelDirtyArray[i];
+            _readVoxelDirtyArray[i] |= thisVoxelDirty;
+            _writeVoxelDirtyArray[i] = false;
+            if (!inSegment) {
+                if (thisVoxelDirty) {
+                    segmentStart = i;
+                    inSegment = true;
+                }
+            } else {
+                if (!thisVoxelDirty) {
+                    // If we got here because because this voxel is NOT dirty, so the last dirty voxel was the one
+                    // before this one and so that's where the "segment" ends
+                    copyWrittenDataSegmentToReadArrays(segmentStart, i - 1);
+                    inSegment = false;
+                }
+            }
         }
     }
 
@@ -1131,34 +1172,32 @@ int VoxelSystem::updateNodeInArrays(VoxelTreeElement* node, bool reuseIndex, boo
 void VoxelSystem::updateArraysDetails(glBufferIndex nodeIndex, const glm::vec3& startVertex,
                                      float voxelScale, const nodeColor& color) {
 
-    if (_initialized && nodeIndex <= _maxVoxels) {
+    if (_initialized && nodeIndex < _maxVoxels) {
         _writeVoxelDirtyArray[nodeIndex] = true;
+        _writeChunkDirtyArray[VoxelArrayBuilder::getChunk(nodeIndex)] = true;
 
-        if (_useVoxelShader) {
-            if (_writeVoxelShaderData) {
-                VoxelShaderVBOData* writeVerticesAt = &_writeVoxelShaderData[nodeIndex];
-                writeVerticesAt->x = startVertex.x * TREE_SCALE;
-                writeVerticesAt->y = startVertex.y * TREE_SCALE;
-                writeVerticesAt->z = startVertex.z * TREE_SCALE;
-                writeVerticesAt->s = voxelScale * TREE_SCALE;
-                writeVerticesAt->r = color[RED_INDEX];
-                writeVerticesAt->g = color[GREEN_INDEX];
-                writeVerticesAt->b = color[BLUE_INDEX];
-            }
+        if (_arrayWritesThread == QThread::currentThread()) {
+            _arrayBuilder.queueWrite(nodeIndex, startVertex, voxelScale, color);
         } else {
-            if (_writeVerticesArray && _writeColorsArray) {
-                int vertexPointsPerVoxel = GLOBAL_NORMALS_VERTEX_POINTS_PER_VOXEL;
-                for (int j = 0; j < vertexPointsPerVoxel; j++ ) {
-                    GLfloat* writeVerticesAt = _writeVerticesArray + (nodeIndex * vertexPointsPerVoxel);
-                    GLubyte* writeColorsAt   = _writeColorsArray   + (nodeIndex * vertexPointsPerVoxel);
-                    *(writeVerticesAt+j) = startVertex[j % 3] + (identityVerticesGlobalNormals[j] * voxelScale);
-                    *(writeColorsAt  +j) = color[j % 3];
-                }
-            }
+            VoxelArrayWrite write;
+            write.slot = nodeIndex;
+            write.corner = startVertex;
+            write.scale = voxelScale;
+            memcpy(write.color, color, BYTES_PER_COLOR);
+            _arrayBuilder.write(write);
         }
     }
 }
 
+void VoxelSystem::beginArrayWrites() {
+    _arrayWritesThread = QThread::currentThread();
+}
+
+void VoxelSystem::endArrayWrites() {
+    _arrayWritesThread = NULL;
+    _arrayBuilder.build();
+}
+
 glm::vec3 VoxelSystem::computeVoxelVertex(const glm::vec3& startVertex, float voxelScale, int index) const {
     const float* identityVertex = identityVertices + index * 3;
     return startVertex + glm::vec3(identityVertex[0], identityVertex[1], identityVertex[2]) * voxelScale;
@@ -1219,28 +1258,44 @@ void VoxelSystem::updateFullVBOs() {
         PerformanceWarning warn(outputWarning,"updateFullVBOs() : memset(_readVoxelDirtyArray...)");
         // consider the _readVoxelDirtyArray[] clean!
         memset(_readVoxelDirtyArray, false, _voxelsInReadArrays * sizeof(bool));
+        memset(_readChunkDirtyArray, false, VoxelArrayBuilder::getChunkCount(_voxelsInReadArrays) * sizeof(bool));
     }
 }
 
 void VoxelSystem::updatePartialVBOs() {
     glBufferIndex segmentStart = 0;
     bool inSegment = false;
-    for (glBufferIndex i = 0; i < _voxelsInReadArrays; i++) {
-        bool thisVoxelDirty = _readVoxelDirtyArray[i];
-        if (!inSegment) {
-            if (thisVoxelDirty) {
-                segmentStart = i;
-                inSegment = true;
-                _readVoxelDirtyArray[i] = false; // consider us clean!
-            }
-        } else {
-            if (!thisVoxelDirty) {
-                // If we got here because because this voxel is NOT dirty, so the last dirty voxel was the one before
-                // this one and so that's where the "segment" ends
-                updateVBOSegment(segmentStart, i - 1);
+    int chunkCount = VoxelArrayBuilder::getChunkCount(_voxelsInReadArrays);
+    for (int chunk = 0; chunk < chunkCount; chunk++) {
+        glBufferIndex chunkStart = chunk * VoxelArrayBuilder::SLOTS_PER_CHUNK;
+        if (!_readChunkDirtyArray[chunk]) {
+            // nothing in this chunk was copied since we last updated, so any segment ends where it starts
+            if (inSegment) {
+                updateVBOSegment(segmentStart, chunkStart - 1);
                 inSegment = false;
             }
-            _readVoxelDirtyArray[i] = false; // consider us clean!
+            continue;
+        }
+        _readChunkDirtyArray[chunk] = false;
+
+        glBufferIndex chunkEnd = std::min(chunkStart + VoxelArrayBuilder::SLOTS_PER_CHUNK, _voxelsInReadArrays);
+        for (glBufferIndex i = chunkStart; i < chunkEnd; i++) {
+            bool thisVoxelDirty = _readVoxelDirtyArray[i];
+            if (!inSegment) {
+                if (thisVoxelDirty) {
+                    segmentStart = i;
+                    inSegment = true;
+                    _readVoxelDirtyArray[i] = false; // consider us clean!
+                }
+            } else {
+                if (!thisVoxelDirty) {
+                    // If we got here because because this voxel is NOT dirty, so the last dirty voxel was the one
+                    // before this one and so that's where the "segment" ends
+                    updateVBOSegment(segmentStart, i - 1);
+                    inSegment = false;
+                }
+                _readVoxelDirtyArray[i] = false; // consider us clean!
+            }
         }
     }
 
@@ -19,6 +19,7 @@
 
 #include <NodeData.h>
 #include <ViewFrustum.h>
+#include <VoxelArrayBuilder.h>
 #include <VoxelTree.h>
 #include <OctreePersistThread.h>
 
@@ -33,14 +34,6 @@ class ProgramObject;
 const int NUM_CHILDREN = 8;
 
 
-struct VoxelShaderVBOData
-{
-    float x, y, z; // position
-    float s; // size
-    unsigned char r,g,b; // color
-};
-
-
 class VoxelSystem : public NodeData, public OctreeElementDeleteHook, public OctreeElementUpdateHook {
     Q_OBJECT
 
@@ -176,6 +169,8 @@ private:
     GLubyte* _writeColorsArray;
     bool* _writeVoxelDirtyArray;
     bool* _readVoxelDirtyArray;
+    bool* _writeChunkDirtyArray; /// whether any voxel in each chunk of VoxelArrayBuilder::SLOTS_PER_CHUNK is dirty
+    bool* _readChunkDirtyArray;
     unsigned long _voxelsUpdated;
     unsigned long _voxelsInReadArrays;
     unsigned long _voxelsInWriteArrays;
@@ -224,6 +219,13 @@ private:
     void setupFaceIndices(GLuint& faceVBOID, GLubyte faceIdentityIndices[]);
 
     int newTreeToArrays(VoxelTreeElement* currentNode);
+
+    /// Queues array writes made on this thread until endArrayWrites(), which builds them all at once.
+    void beginArrayWrites();
+    void endArrayWrites();
+
+    VoxelArrayBuilder _arrayBuilder;
+    QThread* _arrayWritesThread;
     void cleanupRemovedVoxels();
 
     void copyWrittenDataToReadArrays(bool fullVBOs);
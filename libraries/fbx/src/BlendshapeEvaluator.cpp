@@ -0,0 +1,169 @@
+//
+//  BlendshapeEvaluator.cpp
+//  libraries/fbx/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <cstring>
+
+#include <QMutexLocker>
+
+#include <SharedUtil.h>
+
+#include "BlendshapeEvaluator.h"
+
+// normals are displaced by the same deltas, but much less
+const float NORMAL_COEFFICIENT_SCALE = 0.01f;
+
+// incremental updates accumulate rounding error, so every so often we start over from the base shape
+const int MAX_EVALUATIONS_BETWEEN_REBASES = 256;
+
+static float getCoefficient(const QVector<float>& coefficients, int index) {
+    float coefficient = (index < coefficients.size()) ? coefficients.at(index) : 0.0f;
+    return (coefficient < EPSILON) ? 0.0f : coefficient;
+}
+
+BlendshapeDeltas::BlendshapeDeltas(const QVector<FBXMesh>& meshes) :
+    _packed(0),
+    _meshes(meshes) {
+}
+
+void BlendshapeDeltas::pack() {
+    if (_packed.loadAcquire()) {
+        return;
+    }
+    QMutexLocker locker(&_packMutex);
+    if (_packed.load()) {
+        return; // another evaluator packed them while we waited
+    }
+    int rowCount = 0;
+    foreach (const FBXMesh& mesh, _meshes) {
+        if (mesh.blendshapes.isEmpty()) {
+            continue;
+        }
+        rowCount = qMax(rowCount, mesh.blendshapes.size());
+        _baseVertices += mesh.vertices;
+        _baseNormals += mesh.normals;
+        _baseNormals.resize(_baseVertices.size());
+    }
+    _rowOffsets.reserve(rowCount + 1);
+    for (int i = 0; i < rowCount; i++) {
+        _rowOffsets.append(_indices.size());
+        int offset = 0;
+        foreach (const FBXMesh& mesh, _meshes) {
+            if (mesh.blendshapes.isEmpty()) {
+                continue;
+            }
+            if (i < mesh.blendshapes.size()) {
+                const FBXBlendshape& blendshape = mesh.blendshapes.at(i);
+                for (int j = 0; j < blendshape.indices.size(); j++) {
+                    _indices.append(offset + blendshape.indices.at(j));
+                    _vertexDeltas.append(blendshape.vertices.at(j));
+                    _normalDeltas.append(j < blendshape.normals.size() ? blendshape.normals.at(j) : glm::vec3());
+                }
+            }
+            offset += mesh.vertices.size();
+        }
+    }
+    _rowOffsets.append(_indices.size());
+    _meshes.clear();
+    _packed.storeRelease(1);
+}
+
+BlendshapeEvaluator::BlendshapeEvaluator(const QSharedPointer<BlendshapeDeltas>& deltas) :
+    _deltas(deltas),
+    _evaluated(false),
+    _evaluationsSinceRebase(0),
+    _claimed(false),
+    _queued(false) {
+}
+
+bool BlendshapeEvaluator::evaluate(const QVector<float>& coefficients) {
+    if (!_evaluated) {
+        _deltas->pack();
+        _appliedCoefficients.fill(0.0f, _deltas->getRowCount());
+    }
+    const QVector<int>& rowOffsets = _deltas->getRowOffsets();
+
+    // compare the work of applying the changed rows to that of starting over and applying the nonzero ones
+    int rowCount = _appliedCoefficients.size();
+    int changedDeltas = 0;
+    int activeDeltas = 0;
+    for (int i = 0; i < rowCount; i++) {
+        float coefficient = getCoefficient(coefficients, i);
+        int rowSize = rowOffsets.at(i + 1) - rowOffsets.at(i);
+        if (coefficient != 0.0f) {
+            activeDeltas += rowSize;
+        }
+        if (coefficient != _appliedCoefficients.at(i)) {
+            changedDeltas += rowSize;
+        }
+    }
+    if (_evaluated && changedDeltas == 0) {
+        return false;
+    }
+    if (!_evaluated || activeDeltas < changedDeltas || ++_evaluationsSinceRebase > MAX_EVALUATIONS_BETWEEN_REBASES) {
+        rebase();
+    }
+    _evaluated = true;
+
+    // apply the difference between each changed coefficient and the one already applied
+    glm::vec3* vertices = _vertices.data();
+    glm::vec3* normals = _normals.data();
+    const int* indices = _deltas->getIndices().constData();
+    const glm::vec3* vertexDeltas = _deltas->getVertexDeltas().constData();
+    const glm::vec3* normalDeltas = _deltas->getNormalDeltas().constData();
+    for (int i = 0; i < rowCount; i++) {
+        float coefficient = getCoefficient(coefficients, i);
+        float vertexCoefficient = coefficient - _appliedCoefficients.at(i);
+        if (vertexCoefficient == 0.0f) {
+            continue;
+        }
+        _appliedCoefficients[i] = coefficient;
+        float normalCoefficient = vertexCoefficient * NORMAL_COEFFICIENT_SCALE;
+        for (int j = rowOffsets.at(i), end = rowOffsets.at(i + 1); j < end; j++) {
+            int index = indices[j];
+            vertices[index] += vertexDeltas[j] * vertexCoefficient;
+            normals[index] += normalDeltas[j] * normalCoefficient;
+        }
+    }
+    return true;
+}
+
+bool BlendshapeEvaluator::acquireOrQueue(const QVector<float>& coefficients) {
+    QMutexLocker locker(&_claimMutex);
+    if (!_claimed) {
+        _claimed = true;
+        return true;
+    }
+    _queuedCoefficients = coefficients;
+    _queued = true;
+    return false;
+}
+
+bool BlendshapeEvaluator::releaseOrTakeQueued(QVector<float>& coefficients) {
+    QMutexLocker locker(&_claimMutex);
+    if (_queued) {
+        coefficients = _queuedCoefficients;
+        _queued = false;
+        return true;
+    }
+    _claimed = false;
+    return false;
+}
+
+void BlendshapeEvaluator::rebase() {
+    // copy into the existing buffers rather than sharing the base, so that they're reused from one rebase to the next
+    const QVector<glm::vec3>& baseVertices = _deltas->getBaseVertices();
+    const QVector<glm::vec3>& baseNormals = _deltas->getBaseNormals();
+    _vertices.resize(baseVertices.size());
+    _normals.resize(baseNormals.size());
+    memcpy(_vertices.data(), baseVertices.constData(), baseVertices.size() * sizeof(glm::vec3));
+    memcpy(_normals.data(), baseNormals.constData(), baseNormals.size() * sizeof(glm::vec3));
+    _appliedCoefficients.fill(0.0f);
+    _evaluationsSinceRebase = 0;
+}
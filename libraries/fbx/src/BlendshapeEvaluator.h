@@ -0,0 +1,107 @@
+//
+//  BlendshapeEvaluator.h
+//  libraries/fbx/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_BlendshapeEvaluator_h
+#define hifi_BlendshapeEvaluator_h
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QVector>
+
+#include <glm/glm.hpp>
+
+#include "FBXReader.h"
+
+/// The blendshapes of a set of meshes, packed into a compressed sparse row layout: a row per coefficient holding that
+/// blendshape's deltas for every mesh, indexed into the concatenated vertices of the meshes that have blendshapes.
+/// Along with the base vertices and normals, these never change once packed, so one copy serves every evaluator of the
+/// same geometry.
+class BlendshapeDeltas {
+public:
+
+    BlendshapeDeltas(const QVector<FBXMesh>& meshes);
+
+    /// Packs the deltas, if they haven't been already.  Safe to call from any thread.
+    void pack();
+
+    int getRowCount() const { return _rowOffsets.size() - 1; }
+
+    const QVector<glm::vec3>& getBaseVertices() const { return _baseVertices; }
+    const QVector<glm::vec3>& getBaseNormals() const { return _baseNormals; }
+
+    /// Returns where each coefficient's deltas start, followed by the end of the last row's.
+    const QVector<int>& getRowOffsets() const { return _rowOffsets; }
+    const QVector<int>& getIndices() const { return _indices; }
+    const QVector<glm::vec3>& getVertexDeltas() const { return _vertexDeltas; }
+    const QVector<glm::vec3>& getNormalDeltas() const { return _normalDeltas; }
+
+private:
+
+    QMutex _packMutex;
+    QAtomicInt _packed;
+    QVector<FBXMesh> _meshes; ///< held until the deltas are packed
+
+    QVector<glm::vec3> _baseVertices;
+    QVector<glm::vec3> _baseNormals;
+
+    QVector<int> _rowOffsets;
+    QVector<int> _indices;
+    QVector<glm::vec3> _vertexDeltas;
+    QVector<glm::vec3> _normalDeltas;
+};
+
+/// Evaluates shared blendshape deltas for one user of the geometry.  The blended result is retained, so that each
+/// evaluation only applies the change in the coefficients that changed since the last.  Evaluation isn't thread-safe:
+/// callers on other threads should claim the evaluator with acquireOrQueue first.
+class BlendshapeEvaluator {
+public:
+
+    BlendshapeEvaluator(const QSharedPointer<BlendshapeDeltas>& deltas);
+
+    /// Brings the retained result up to date with the given coefficients, packing the deltas first if no evaluator has.
+    /// \return whether the result changed
+    bool evaluate(const QVector<float>& coefficients);
+
+    /// Returns the blended vertices of the meshes with blendshapes, one mesh after another.
+    const QVector<glm::vec3>& getVertices() const { return _vertices; }
+
+    /// Returns the blended normals of the meshes with blendshapes, one mesh after another.
+    const QVector<glm::vec3>& getNormals() const { return _normals; }
+
+    /// Claims the evaluator for an evaluation of the given coefficients.  If an earlier claim hasn't been released yet,
+    /// the coefficients are kept instead (replacing any kept before), for the holder of that claim to evaluate.
+    /// \return whether the claim succeeded
+    bool acquireOrQueue(const QVector<float>& coefficients);
+
+    /// Releases a claim, unless coefficients were queued while it was held.
+    /// \param coefficients[out] the queued coefficients, to evaluate under the same claim
+    /// \return true if coefficients were queued (and the claim is still held), false if the claim was released
+    bool releaseOrTakeQueued(QVector<float>& coefficients);
+
+private:
+
+    void rebase();
+
+    QSharedPointer<BlendshapeDeltas> _deltas;
+
+    QVector<float> _appliedCoefficients;
+    QVector<glm::vec3> _vertices;
+    QVector<glm::vec3> _normals;
+    bool _evaluated;
+    int _evaluationsSinceRebase;
+
+    QMutex _claimMutex;
+    bool _claimed;
+    bool _queued;
+    QVector<float> _queuedCoefficients;
+};
+
+#endif // hifi_BlendshapeEvaluator_h
@@ -0,0 +1,475 @@
+//
+//  FBXCooker.cpp
+//  libraries/fbx/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <cstring>
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMultiMap>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QStringList>
+#include <QtDebug>
+
+#include <StreamUtils.h>
+
+#include "FBXCooker.h"
+
+const quint32 COOKED_FBX_VERSION = 1;
+
+const qint64 MAX_COOKED_FBX_CACHE_BYTES = 256 * 1024 * 1024;
+
+static const char COOKED_FBX_MAGIC[] = "HFCOOKED";
+static const int COOKED_FBX_MAGIC_SIZE = sizeof(COOKED_FBX_MAGIC) - 1;
+
+// arrays are written as they are in memory, so cooked files are only read back on machines with the same byte order
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+static const quint8 COOKED_FBX_BYTE_ORDER = 0;
+#else
+static const quint8 COOKED_FBX_BYTE_ORDER = 1;
+#endif
+
+static const QString COOKED_FBX_CACHE_DIRECTORY = "cookedfbx";
+static const QString COOKED_FBX_EXTENSION = ".cooked";
+
+template<typename T> static void writeArray(QDataStream& out, const QVector<T>& array) {
+    out << (qint32)array.size();
+    out.writeRawData(reinterpret_cast<const char*>(array.constData()), array.size() * sizeof(T));
+}
+
+static int readCount(QDataStream& in) {
+    // every element takes at least a byte, so a count past the end of the data means it's been corrupted
+    qint32 count;
+    in >> count;
+    if (count < 0 || count > in.device()->bytesAvailable()) {
+        throw QString("Cooked geometry is truncated.");
+    }
+    return count;
+}
+
+template<typename T> static void readArray(QDataStream& in, QVector<T>& array) {
+    qint32 size;
+    in >> size;
+    if (size < 0 || (qint64)size * (qint64)sizeof(T) > in.device()->bytesAvailable()) {
+        throw QString("Cooked geometry is truncated.");
+    }
+    array.resize(size);
+    in.readRawData(reinterpret_cast<char*>(array.data()), size * sizeof(T));
+}
+
+/// Checks an index read from cooked geometry, so that a corrupted file can't send the code using it out of bounds.
+/// \param allowNone whether -1 (for none) is allowed
+static void checkIndex(int index, int count, bool allowNone = false) {
+    if (index < (allowNone ? -1 : 0) || index >= count) {
+        throw QString("Cooked geometry has an index out of range.");
+    }
+}
+
+static void checkIndices(const QVector<int>& indices, int count, bool allowNone = false) {
+    foreach (int index, indices) {
+        checkIndex(index, count, allowNone);
+    }
+}
+
+static void writeMatrix(QDataStream& out, const glm::mat4& matrix) {
+    out.writeRawData(reinterpret_cast<const char*>(&matrix), sizeof(glm::mat4));
+}
+
+static void readMatrix(QDataStream& in, glm::mat4& matrix) {
+    in.readRawData(reinterpret_cast<char*>(&matrix), sizeof(glm::mat4));
+}
+
+static void writeExtents(QDataStream& out, const Extents& extents) {
+    out << extents.minimum << extents.maximum;
+}
+
+static void readExtents(QDataStream& in, Extents& extents) {
+    in >> extents.minimum >> extents.maximum;
+}
+
+static void writeTexture(QDataStream& out, const FBXTexture& texture) {
+    out << texture.filename << texture.content;
+}
+
+static void readTexture(QDataStream& in, FBXTexture& texture) {
+    in >> texture.filename >> texture.content;
+}
+
+static void writeJoint(QDataStream& out, const FBXJoint& joint) {
+    out << joint.isFree;
+    writeArray(out, joint.freeLineage);
+    out << (qint32)joint.parentIndex << joint.distanceToParent << joint.boneRadius << joint.translation;
+    writeMatrix(out, joint.preTransform);
+    out << joint.preRotation << joint.rotation << joint.postRotation;
+    writeMatrix(out, joint.postTransform);
+    writeMatrix(out, joint.transform);
+    out << joint.rotationMin << joint.rotationMax << joint.inverseDefaultRotation << joint.inverseBindRotation;
+    writeMatrix(out, joint.bindTransform);
+    out << joint.name << joint.shapePosition << joint.shapeRotation << (qint32)joint.shapeType;
+}
+
+static void readJoint(QDataStream& in, FBXJoint& joint) {
+    in >> joint.isFree;
+    readArray(in, joint.freeLineage);
+    qint32 parentIndex;
+    in >> parentIndex >> joint.distanceToParent >> joint.boneRadius >> joint.translation;
+    joint.parentIndex = parentIndex;
+    readMatrix(in, joint.preTransform);
+    in >> joint.preRotation >> joint.rotation >> joint.postRotation;
+    readMatrix(in, joint.postTransform);
+    readMatrix(in, joint.transform);
+    in >> joint.rotationMin >> joint.rotationMax >> joint.inverseDefaultRotation >> joint.inverseBindRotation;
+    readMatrix(in, joint.bindTransform);
+    qint32 shapeType;
+    in >> joint.name >> joint.shapePosition >> joint.shapeRotation >> shapeType;
+    joint.shapeType = (Shape::Type)shapeType;
+}
+
+static void writeMesh(QDataStream& out, const FBXMesh& mesh) {
+    out << (qint32)mesh.parts.size();
+    foreach (const FBXMeshPart& part, mesh.parts) {
+        writeArray(out, part.quadIndices);
+        writeArray(out, part.triangleIndices);
+        out << part.diffuseColor << part.specularColor << part.shininess;
+        writeTexture(out, part.diffuseTexture);
+        writeTexture(out, part.normalTexture);
+        writeTexture(out, part.specularTexture);
+    }
+    writeArray(out, mesh.vertices);
+    writeArray(out, mesh.normals);
+    writeArray(out, mesh.tangents);
+    writeArray(out, mesh.colors);
+    writeArray(out, mesh.texCoords);
+    writeArray(out, mesh.clusterIndices);
+    writeArray(out, mesh.clusterWeights);
+
+    out << (qint32)mesh.clusters.size();
+    foreach (const FBXCluster& cluster, mesh.clusters) {
+        out << (qint32)cluster.jointIndex;
+        writeMatrix(out, cluster.inverseBindMatrix);
+    }
+    out << mesh.isEye;
+
+    out << (qint32)mesh.blendshapes.size();
+    foreach (const FBXBlendshape& blendshape, mesh.blendshapes) {
+        writeArray(out, blendshape.indices);
+        writeArray(out, blendshape.vertices);
+        writeArray(out, blendshape.normals);
+    }
+}
+
+static void readMesh(QDataStream& in, FBXMesh& mesh) {
+    mesh.parts.resize(readCount(in));
+    for (int i = 0; i < mesh.parts.size(); i++) {
+        FBXMeshPart& part = mesh.parts[i];
+        readArray(in, part.quadIndices);
+        readArray(in, part.triangleIndices);
+        in >> part.diffuseColor >> part.specularColor >> part.shininess;
+        readTexture(in, part.diffuseTexture);
+        readTexture(in, part.normalTexture);
+        readTexture(in, part.specularTexture);
+    }
+    readArray(in, mesh.vertices);
+    readArray(in, mesh.normals);
+    readArray(in, mesh.tangents);
+    readArray(in, mesh.colors);
+    readArray(in, mesh.texCoords);
+    readArray(in, mesh.clusterIndices);
+    readArray(in, mesh.clusterWeights);
+
+    mesh.clusters.resize(readCount(in));
+    for (int i = 0; i < mesh.clusters.size(); i++) {
+        qint32 jointIndex;
+        in >> jointIndex;
+        mesh.clusters[i].jointIndex = jointIndex;
+        readMatrix(in, mesh.clusters[i].inverseBindMatrix);
+    }
+    in >> mesh.isEye;
+
+    mesh.blendshapes.resize(readCount(in));
+    for (int i = 0; i < mesh.blendshapes.size(); i++) {
+        FBXBlendshape& blendshape = mesh.blendshapes[i];
+        readArray(in, blendshape.indices);
+        readArray(in, blendshape.vertices);
+        readArray(in, blendshape.normals);
+    }
+}
+
+static void checkMesh(const FBXMesh& mesh, int jointCount) {
+    int vertexCount = mesh.vertices.size();
+    foreach (const FBXMeshPart& part, mesh.parts) {
+        checkIndices(part.quadIndices, vertexCount);
+        checkIndices(part.triangleIndices, vertexCount);
+    }
+    foreach (const FBXCluster& cluster, mesh.clusters) {
+        checkIndex(cluster.jointIndex, jointCount);
+    }
+    int clusterCount = mesh.clusters.size();
+    foreach (const glm::vec4& clusterIndices, mesh.clusterIndices) {
+        for (int i = 0; i < 4; i++) {
+            // written negated so that NaNs fail too
+            if (!(clusterIndices[i] >= 0.0f && clusterIndices[i] < clusterCount)) {
+                throw QString("Cooked geometry has an index out of range.");
+            }
+        }
+    }
+    foreach (const FBXBlendshape& blendshape, mesh.blendshapes) {
+        checkIndices(blendshape.indices, vertexCount);
+        if (blendshape.vertices.size() != blendshape.indices.size()) {
+            throw QString("Cooked geometry has a blendshape with mismatched deltas.");
+        }
+    }
+}
+
+/// Checks every joint and cluster index in geometry read from a cooked file.
+static void checkGeometryIndices(const FBXGeometry& geometry) {
+    int jointCount = geometry.joints.size();
+    foreach (const FBXJoint& joint, geometry.joints) {
+        checkIndex(joint.parentIndex, jointCount, true);
+        checkIndices(joint.freeLineage, jointCount);
+    }
+    foreach (int jointIndex, geometry.jointIndices) {
+        checkIndex(jointIndex - 1, jointCount); // one-based
+    }
+    foreach (const FBXMesh& mesh, geometry.meshes) {
+        checkMesh(mesh, jointCount);
+    }
+    checkIndex(geometry.leftEyeJointIndex, jointCount, true);
+    checkIndex(geometry.rightEyeJointIndex, jointCount, true);
+    checkIndex(geometry.neckJointIndex, jointCount, true);
+    checkIndex(geometry.rootJointIndex, jointCount, true);
+    checkIndex(geometry.leanJointIndex, jointCount, true);
+    checkIndex(geometry.headJointIndex, jointCount, true);
+    checkIndex(geometry.leftHandJointIndex, jointCount, true);
+    checkIndex(geometry.rightHandJointIndex, jointCount, true);
+    checkIndices(geometry.leftFingerJointIndices, jointCount, true);
+    checkIndices(geometry.rightFingerJointIndices, jointCount, true);
+    checkIndices(geometry.leftFingertipJointIndices, jointCount, true);
+    checkIndices(geometry.rightFingertipJointIndices, jointCount, true);
+    foreach (const FBXAttachment& attachment, geometry.attachments) {
+        checkIndex(attachment.jointIndex, jointCount, true);
+    }
+}
+
+QByteArray cookFBXGeometry(const FBXGeometry& geometry) {
+    QByteArray cooked;
+    QDataStream out(&cooked, QIODevice::WriteOnly);
+    out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    out.writeRawData(COOKED_FBX_MAGIC, COOKED_FBX_MAGIC_SIZE);
+    out << COOKED_FBX_VERSION << COOKED_FBX_BYTE_ORDER;
+
+    out << geometry.author << geometry.applicationName;
+
+    out << (qint32)geometry.joints.size();
+    foreach (const FBXJoint& joint, geometry.joints) {
+        writeJoint(out, joint);
+    }
+    out << geometry.jointIndices;
+
+    out << (qint32)geometry.meshes.size();
+    foreach (const FBXMesh& mesh, geometry.meshes) {
+        writeMesh(out, mesh);
+    }
+
+    writeMatrix(out, geometry.offset);
+    out << (qint32)geometry.leftEyeJointIndex << (qint32)geometry.rightEyeJointIndex << (qint32)geometry.neckJointIndex
+        << (qint32)geometry.rootJointIndex << (qint32)geometry.leanJointIndex << (qint32)geometry.headJointIndex
+        << (qint32)geometry.leftHandJointIndex << (qint32)geometry.rightHandJointIndex;
+    writeArray(out, geometry.leftFingerJointIndices);
+    writeArray(out, geometry.rightFingerJointIndices);
+    writeArray(out, geometry.leftFingertipJointIndices);
+    writeArray(out, geometry.rightFingertipJointIndices);
+
+    out << geometry.palmDirection << geometry.neckPivot;
+    writeExtents(out, geometry.bindExtents);
+    writeExtents(out, geometry.meshExtents);
+
+    out << (qint32)geometry.animationFrames.size();
+    foreach (const FBXAnimationFrame& frame, geometry.animationFrames) {
+        writeArray(out, frame.rotations);
+    }
+
+    out << (qint32)geometry.attachments.size();
+    foreach (const FBXAttachment& attachment, geometry.attachments) {
+        out << (qint32)attachment.jointIndex << attachment.url << attachment.translation << attachment.rotation
+            << attachment.scale;
+    }
+    return cooked;
+}
+
+FBXGeometry readCookedFBXGeometry(const QByteArray& cooked) {
+    QDataStream in(cooked);
+    in.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    char magic[COOKED_FBX_MAGIC_SIZE];
+    quint32 version = 0;
+    quint8 byteOrder = 0;
+    if (in.readRawData(magic, COOKED_FBX_MAGIC_SIZE) != COOKED_FBX_MAGIC_SIZE ||
+            memcmp(magic, COOKED_FBX_MAGIC, COOKED_FBX_MAGIC_SIZE) != 0) {
+        throw QString("Not cooked geometry.");
+    }
+    in >> version >> byteOrder;
+    if (version != COOKED_FBX_VERSION || byteOrder != COOKED_FBX_BYTE_ORDER) {
+        throw QString("Cooked geometry is version %1, expected %2.").arg(version).arg(COOKED_FBX_VERSION);
+    }
+
+    FBXGeometry geometry;
+    in >> geometry.author >> geometry.applicationName;
+
+    geometry.joints.resize(readCount(in));
+    for (int i = 0; i < geometry.joints.size(); i++) {
+        readJoint(in, geometry.joints[i]);
+    }
+    in >> geometry.jointIndices;
+
+    geometry.meshes.resize(readCount(in));
+    for (int i = 0; i < geometry.meshes.size(); i++) {
+        readMesh(in, geometry.meshes[i]);
+    }
+
+    readMatrix(in, geometry.offset);
+    qint32 leftEyeJointIndex, rightEyeJointIndex, neckJointIndex, rootJointIndex, leanJointIndex, headJointIndex,
+        leftHandJointIndex, rightHandJointIndex;
+    in >> leftEyeJointIndex >> rightEyeJointIndex >> neckJointIndex >> rootJointIndex >> leanJointIndex
+        >> headJointIndex >> leftHandJointIndex >> rightHandJointIndex;
+    geometry.leftEyeJointIndex = leftEyeJointIndex;
+    geometry.rightEyeJointIndex = rightEyeJointIndex;
+    geometry.neckJointIndex = neckJointIndex;
+    geometry.rootJointIndex = rootJointIndex;
+    geometry.leanJointIndex = leanJointIndex;
+    geometry.headJointIndex = headJointIndex;
+    geometry.leftHandJointIndex = leftHandJointIndex;
+    geometry.rightHandJointIndex = rightHandJointIndex;
+    readArray(in, geometry.leftFingerJointIndices);
+    readArray(in, geometry.rightFingerJointIndices);
+    readArray(in, geometry.leftFingertipJointIndices);
+    readArray(in, geometry.rightFingertipJointIndices);
+
+    in >> geometry.palmDirection >> geometry.neckPivot;
+    readExtents(in, geometry.bindExtents);
+    readExtents(in, geometry.meshExtents);
+
+    geometry.animationFrames.resize(readCount(in));
+    for (int i = 0; i < geometry.animationFrames.size(); i++) {
+        readArray(in, geometry.animationFrames[i].rotations);
+    }
+
+    geometry.attachments.resize(readCount(in));
+    for (int i = 0; i < geometry.attachments.size(); i++) {
+        FBXAttachment& attachment = geometry.attachments[i];
+        qint32 jointIndex;
+        in >> jointIndex >> attachment.url >> attachment.translation >> attachment.rotation >> attachment.scale;
+        attachment.jointIndex = jointIndex;
+    }
+
+    if (in.status() != QDataStream::Ok) {
+        throw QString("Cooked geometry is truncated.");
+    }
+    checkGeometryIndices(geometry);
+    return geometry;
+}
+
+static void addMappingToHash(QCryptographicHash& hash, const QVariant& value) {
+    // hash iteration order isn't stable between runs, so go through the keys in order
+    QVariantHash hashValue = value.toHash();
+    if (!hashValue.isEmpty()) {
+        QStringList keys = hashValue.keys();
+        keys.sort();
+        foreach (const QString& key, keys) {
+            hash.addData(key.toUtf8() + " = ");
+            addMappingToHash(hash, hashValue.value(key));
+        }
+        return;
+    }
+    QVariantList listValue = value.toList();
+    if (!listValue.isEmpty()) {
+        foreach (const QVariant& element, listValue) {
+            addMappingToHash(hash, element);
+        }
+        return;
+    }
+    hash.addData(value.toByteArray() + "\n");
+}
+
+QString getCookedFBXCacheDirectory() {
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath(COOKED_FBX_CACHE_DIRECTORY);
+}
+
+QString getCookedFBXCachePath(const QByteArray& model, const QVariantHash& mapping, const QString& directory) {
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(model);
+    addMappingToHash(hash, mapping);
+    return QDir(directory.isEmpty() ? getCookedFBXCacheDirectory() : directory).filePath(hash.result().toHex() + "-" +
+        QString::number(COOKED_FBX_VERSION) + COOKED_FBX_EXTENSION);
+}
+
+void trimCookedFBXCache(const QString& directory, qint64 maxBytes) {
+    QDir cacheDirectory(directory.isEmpty() ? getCookedFBXCacheDirectory() : directory);
+
+    // files cooked by other versions are never read by this one, so they age out first
+    QFileInfoList files = cacheDirectory.entryInfoList(QStringList("*" + COOKED_FBX_EXTENSION), QDir::Files);
+    QMultiMap<QDateTime, QFileInfo> filesByLastUse;
+    qint64 totalBytes = 0;
+    foreach (const QFileInfo& file, files) {
+        filesByLastUse.insert(qMax(file.lastRead(), file.lastModified()), file);
+        totalBytes += file.size();
+    }
+    for (QMultiMap<QDateTime, QFileInfo>::const_iterator it = filesByLastUse.constBegin();
+            it != filesByLastUse.constEnd() && totalBytes > maxBytes; it++) {
+        // a file still mapped by another loader may not be removable; it'll be tried again next time
+        if (QFile::remove(it.value().absoluteFilePath())) {
+            totalBytes -= it.value().size();
+        }
+    }
+}
+
+FBXGeometry readFBXWithCookedCache(const QByteArray& model, const QVariantHash& mapping) {
+    QString path = getCookedFBXCachePath(model, mapping);
+
+    QFile file(path);
+    if (file.open(QIODevice::ReadOnly)) {
+        // map the file rather than reading it in, since everything gets copied out of it into the geometry anyway
+        uchar* data = file.map(0, file.size());
+        if (data) {
+            try {
+                FBXGeometry geometry = readCookedFBXGeometry(
+                    QByteArray::fromRawData(reinterpret_cast<const char*>(data), file.size()));
+                file.unmap(data);
+                return geometry;
+
+            } catch (const QString& error) {
+                qDebug() << "Recooking" << path << ":" << error;
+                file.unmap(data);
+            }
+        }
+        file.close();
+    }
+
+    FBXGeometry geometry = readFBX(model, mapping);
+
+    // another loader may be writing the same file; each writes to its own temporary file and the last rename wins
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile cookedFile(path);
+    if (cookedFile.open(QIODevice::WriteOnly)) {
+        cookedFile.write(cookFBXGeometry(geometry));
+        if (cookedFile.commit()) {
+            trimCookedFBXCache(QFileInfo(path).absolutePath());
+
+        } else {
+            qDebug() << "Failed to write cooked geometry to" << path;
+        }
+    }
+    return geometry;
+}
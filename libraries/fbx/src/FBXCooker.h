@@ -0,0 +1,47 @@
+//
+//  FBXCooker.h
+//  libraries/fbx/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_FBXCooker_h
+#define hifi_FBXCooker_h
+
+#include "FBXReader.h"
+
+/// Bump this whenever FBXGeometry or the way it's extracted changes, so that stale cooked files are recooked.
+extern const quint32 COOKED_FBX_VERSION;
+
+/// The space that cooked geometry may take up in a cache directory before the least recently used files are removed.
+extern const qint64 MAX_COOKED_FBX_CACHE_BYTES;
+
+/// Writes extracted geometry in the cooked format, which can be read back without parsing FBX again.
+QByteArray cookFBXGeometry(const FBXGeometry& geometry);
+
+/// Reads geometry written by cookFBXGeometry.
+/// \exception QString if the data isn't cooked geometry of the current version
+FBXGeometry readCookedFBXGeometry(const QByteArray& cooked);
+
+/// Returns the directory in which cooked geometry is cached for this application.
+QString getCookedFBXCacheDirectory();
+
+/// Returns the path in a cache directory for the cooked form of the given model and mapping.
+/// \param directory the cache directory, or empty for this application's
+QString getCookedFBXCachePath(const QByteArray& model, const QVariantHash& mapping,
+    const QString& directory = QString());
+
+/// Removes cooked files from a cache directory, least recently used first, until the rest fit in the given size.  Use
+/// is judged by the later of the last read and write times, so reads only count where the file system records them.
+/// \param directory the cache directory, or empty for this application's
+void trimCookedFBXCache(const QString& directory = QString(), qint64 maxBytes = MAX_COOKED_FBX_CACHE_BYTES);
+
+/// Reads FBX geometry from the supplied model and mapping data, loading a cooked copy from the local cache if a
+/// previous load left one there, and leaving one there (and trimming the cache) if not.
+/// \exception QString if an error occurs in parsing
+FBXGeometry readFBXWithCookedCache(const QByteArray& model, const QVariantHash& mapping);
+
+#endif // hifi_FBXCooker_h
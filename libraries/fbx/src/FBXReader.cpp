@@ -9,9 +9,9 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <cstring>
 #include <iostream>
 #include <QBuffer>
-#include <QDataStream>
 #include <QIODevice>
 #include <QStringList>
 #include <QTextStream>
@@ -22,8 +22,11 @@
 #include <glm/gtx/quaternion.hpp>
 #include <glm/gtx/transform.hpp>
 
+#include <zlib.h>
+
 #include <GeometryUtil.h>
 #include <OctalCode.h>
+#include <RegisteredMetaTypes.h>
 #include <Shape.h>
 #include <SharedUtil.h>
 
@@ -84,111 +87,116 @@ static int fbxGeometryMetaTypeId = qRegisterMetaType<FBXGeometry>();
 static int fbxAnimationFrameMetaTypeId = qRegisterMetaType<FBXAnimationFrame>();
 static int fbxAnimationFrameVectorMetaTypeId = qRegisterMetaType<QVector<FBXAnimationFrame> >();
 
-template<class T> QVariant readBinaryArray(QDataStream& in) {
-    quint32 arrayLength;
-    quint32 encoding;
-    quint32 compressedLength;
-
-    in >> arrayLength;
-    in >> encoding;
-    in >> compressedLength;
-
-    QVector<T> values;
-    const unsigned int DEFLATE_ENCODING = 1;
-    if (encoding == DEFLATE_ENCODING) {
-        // preface encoded data with uncompressed length
-        QByteArray compressed(sizeof(quint32) + compressedLength, 0);
-        *((quint32*)compressed.data()) = qToBigEndian<quint32>(arrayLength * sizeof(T));
-        in.readRawData(compressed.data() + sizeof(quint32), compressedLength);
-        QByteArray uncompressed = qUncompress(compressed);
-        QDataStream uncompressedIn(uncompressed);
-        uncompressedIn.setByteOrder(QDataStream::LittleEndian);
-        uncompressedIn.setVersion(QDataStream::Qt_4_5); // for single/double precision switch
-        for (quint32 i = 0; i < arrayLength; i++) {
-            T value;
-            uncompressedIn >> value;
-            values.append(value);
-        }
-    } else {
-        for (quint32 i = 0; i < arrayLength; i++) {
-            T value;
-            in >> value;
-            values.append(value);
+template<class T> T readLittleEndian(const char* data) {
+    return qFromLittleEndian<T>(reinterpret_cast<const uchar*>(data));
+}
+
+template<> float readLittleEndian<float>(const char* data) {
+    quint32 bits = readLittleEndian<quint32>(data);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+template<> double readLittleEndian<double>(const char* data) {
+    quint64 bits = readLittleEndian<quint64>(data);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/// Decodes an array of little-endian values, which may already be sitting in its destination.
+template<class T> void decodeLittleEndianArray(const char* data, T* values, quint32 count) {
+    if (Q_BYTE_ORDER == Q_LITTLE_ENDIAN) {
+        if (data != reinterpret_cast<const char*>(values)) {
+            memcpy(values, data, count * sizeof(T));
         }
+        return;
+    }
+    for (quint32 i = 0; i < count; i++) {
+        values[i] = readLittleEndian<T>(data + i * sizeof(T));
     }
-    return QVariant::fromValue(values);
 }
 
-QVariant parseBinaryFBXProperty(QDataStream& in) {
-    char ch;
-    in.device()->getChar(&ch);
-    switch (ch) {
-        case 'Y': {
-            qint16 value;
-            in >> value;
-            return QVariant::fromValue(value);
-        }
-        case 'C': {
-            bool value;
-            in >> value;
-            return QVariant::fromValue(value);
-        }
-        case 'I': {
-            qint32 value;
-            in >> value;
-            return QVariant::fromValue(value);
-        }
-        case 'F': {
-            float value;
-            in >> value;
-            return QVariant::fromValue(value);
-        }
-        case 'D': {
-            double value;
-            in >> value;
-            return QVariant::fromValue(value);
-        }
-        case 'L': {
-            qint64 value;
-            in >> value;
-            return QVariant::fromValue(value);
-        }
-        case 'f': {
-            return readBinaryArray<float>(in);
-        }
-        case 'd': {
-            return readBinaryArray<double>(in);
-        }
-        case 'l': {
-            return readBinaryArray<qint64>(in);
-        }
-        case 'i': {
-            return readBinaryArray<qint32>(in);
-        }
-        case 'b': {
-            return readBinaryArray<bool>(in);
-        }
-        case 'S':
-        case 'R': {
-            quint32 length;
-            in >> length;
-            return QVariant::fromValue(in.device()->read(length));
+/// Parses a binary FBX document straight out of memory.  Arrays are inflated and decoded directly into the QVectors
+/// that hold them in the node tree, and the double arrays holding vertices, normals and texture coordinates are
+/// converted to the glm vectors that extraction wants as they're decoded, rather than kept as doubles and copied later.
+class BinaryFBXParser {
+public:
+
+    BinaryFBXParser(const QByteArray& data, int offset);
+
+    FBXNode parse();
+
+private:
+
+    FBXNode parseNode();
+    QVariant parseProperty(const QByteArray& nodeName);
+
+    int getPosition() const { return _position - _data.constData(); }
+
+    const char* readBytes(quint32 length);
+    template<class T> T read() { return readLittleEndian<T>(readBytes(sizeof(T))); }
+
+    /// Reads an array header, leaving the position at the array's data.
+    /// \return the number of elements in the array
+    quint32 beginArray(quint32 elementSize);
+
+    /// Reads the data of an array begun with beginArray, inflating it if compressed.
+    /// \param destination where to inflate the data, or NULL to use a scratch buffer
+    /// \return the (little-endian) array data: the destination, the scratch buffer, or the document itself
+    const char* endArray(quint32 byteLength, char* destination);
+
+    template<class T> QVariant readArray();
+    QVariant readBoolArray();
+    QVariant readVec3Array();
+    QVariant readVec2Array();
+
+    QByteArray _data;
+    const char* _position;
+    const char* _end;
+
+    quint32 _arrayEncoding;
+    quint32 _arrayCompressedLength;
+    QByteArray _inflated;
+};
+
+BinaryFBXParser::BinaryFBXParser(const QByteArray& data, int offset) :
+    _data(data),
+    _position(_data.constData() + offset),
+    _end(_data.constData() + _data.size()),
+    _arrayEncoding(0),
+    _arrayCompressedLength(0) {
+}
+
+FBXNode BinaryFBXParser::parse() {
+    // see http://code.blender.org/index.php/2013/08/fbx-binary-file-format-specification/ for an explanation
+    // of the FBX binary format
+
+    // skip the rest of the header
+    const int HEADER_SIZE = 27;
+    readBytes(HEADER_SIZE);
+
+    // parse the top-level node
+    FBXNode top;
+    while (_position < _end) {
+        FBXNode next = parseNode();
+        if (next.name.isNull()) {
+            return top;
+
+        } else {
+            top.children.append(next);
         }
-        default:
-            throw QString("Unknown property type: ") + ch;
     }
-}
 
-FBXNode parseBinaryFBXNode(QDataStream& in) {
-    quint32 endOffset;
-    quint32 propertyCount;
-    quint32 propertyListLength;
-    quint8 nameLength;
+    return top;
+}
 
-    in >> endOffset;
-    in >> propertyCount;
-    in >> propertyListLength;
-    in >> nameLength;
+FBXNode BinaryFBXParser::parseNode() {
+    quint32 endOffset = read<quint32>();
+    quint32 propertyCount = read<quint32>();
+    read<quint32>(); // property list length
+    quint8 nameLength = *readBytes(sizeof(quint8));
 
     FBXNode node;
     const unsigned int MIN_VALID_OFFSET = 40;
@@ -196,14 +204,14 @@ FBXNode parseBinaryFBXNode(QDataStream& in) {
         // use a null name to indicate a null node
         return node;
     }
-    node.name = in.device()->read(nameLength);
+    node.name = QByteArray(readBytes(nameLength), nameLength);
 
     for (quint32 i = 0; i < propertyCount; i++) {
-        node.properties.append(parseBinaryFBXProperty(in));
+        node.properties.append(parseProperty(node.name));
     }
 
-    while (endOffset > in.device()->pos()) {
-        FBXNode child = parseBinaryFBXNode(in);
+    while (endOffset > (quint32)getPosition()) {
+        FBXNode child = parseNode();
         if (child.name.isNull()) {
             return node;
 
@@ -215,6 +223,152 @@ FBXNode parseBinaryFBXNode(QDataStream& in) {
     return node;
 }
 
+QVariant BinaryFBXParser::parseProperty(const QByteArray& nodeName) {
+    char ch = *readBytes(1);
+    switch (ch) {
+        case 'Y':
+            return QVariant::fromValue(read<qint16>());
+
+        case 'C':
+            return QVariant::fromValue(*readBytes(1) != 0);
+
+        case 'I':
+            return QVariant::fromValue(read<qint32>());
+
+        case 'F':
+            return QVariant::fromValue(read<float>());
+
+        case 'D':
+            return QVariant::fromValue(read<double>());
+
+        case 'L':
+            return QVariant::fromValue(read<qint64>());
+
+        case 'f':
+            return readArray<float>();
+
+        case 'd':
+            if (nodeName == "Vertices" || nodeName == "Normals") {
+                return readVec3Array();
+
+            } else if (nodeName == "UV") {
+                return readVec2Array();
+            }
+            return readArray<double>();
+
+        case 'l':
+            return readArray<qint64>();
+
+        case 'i':
+            return readArray<qint32>();
+
+        case 'b':
+            return readBoolArray();
+
+        case 'S':
+        case 'R': {
+            quint32 length = read<quint32>();
+            return QVariant::fromValue(QByteArray(readBytes(length), length));
+        }
+        default:
+            throw QString("Unknown property type: ") + ch;
+    }
+}
+
+const char* BinaryFBXParser::readBytes(quint32 length) {
+    if (length > (quint32)(_end - _position)) {
+        throw QString("Unexpected end of FBX data.");
+    }
+    const char* bytes = _position;
+    _position += length;
+    return bytes;
+}
+
+const unsigned int DEFLATE_ENCODING = 1;
+
+quint32 BinaryFBXParser::beginArray(quint32 elementSize) {
+    quint32 arrayLength = read<quint32>();
+    _arrayEncoding = read<quint32>();
+    _arrayCompressedLength = read<quint32>();
+
+    // make sure the length is plausible before anyone allocates space for it
+    const quint64 MAX_DEFLATE_RATIO = 1032;
+    quint64 maxByteLength = (_arrayEncoding == DEFLATE_ENCODING) ? _arrayCompressedLength * MAX_DEFLATE_RATIO :
+        (quint64)(_end - _position);
+    if ((quint64)arrayLength * elementSize > maxByteLength) {
+        throw QString("Invalid FBX array length: %1").arg(arrayLength);
+    }
+    return arrayLength;
+}
+
+const char* BinaryFBXParser::endArray(quint32 byteLength, char* destination) {
+    if (_arrayEncoding != DEFLATE_ENCODING) {
+        return readBytes(byteLength);
+    }
+    const char* compressed = readBytes(_arrayCompressedLength);
+    if (!destination) {
+        if (_inflated.size() < (int)byteLength) {
+            _inflated.resize(byteLength);
+        }
+        destination = _inflated.data();
+    }
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed));
+    stream.avail_in = _arrayCompressedLength;
+    stream.next_out = reinterpret_cast<Bytef*>(destination);
+    stream.avail_out = byteLength;
+    if (inflateInit(&stream) != Z_OK) {
+        throw QString("Failed to initialize FBX array decompression.");
+    }
+    int result = inflate(&stream, Z_FINISH);
+    inflateEnd(&stream);
+    if (result != Z_STREAM_END || stream.total_out != byteLength) {
+        throw QString("Failed to decompress FBX array.");
+    }
+    return destination;
+}
+
+template<class T> QVariant BinaryFBXParser::readArray() {
+    quint32 arrayLength = beginArray(sizeof(T));
+    QVector<T> values(arrayLength);
+    const char* data = endArray(arrayLength * sizeof(T), reinterpret_cast<char*>(values.data()));
+    decodeLittleEndianArray(data, values.data(), arrayLength);
+    return QVariant::fromValue(values);
+}
+
+QVariant BinaryFBXParser::readBoolArray() {
+    quint32 arrayLength = beginArray(sizeof(quint8));
+    const char* data = endArray(arrayLength, NULL);
+    QVector<bool> values(arrayLength);
+    for (quint32 i = 0; i < arrayLength; i++) {
+        values[i] = (data[i] != 0);
+    }
+    return QVariant::fromValue(values);
+}
+
+QVariant BinaryFBXParser::readVec3Array() {
+    quint32 arrayLength = beginArray(sizeof(double));
+    const char* data = endArray(arrayLength * sizeof(double), NULL);
+    QVector<glm::vec3> values(arrayLength / 3);
+    for (glm::vec3* it = values.data(), *end = it + values.size(); it != end; it++, data += 3 * sizeof(double)) {
+        *it = glm::vec3(readLittleEndian<double>(data), readLittleEndian<double>(data + sizeof(double)),
+            readLittleEndian<double>(data + 2 * sizeof(double)));
+    }
+    return QVariant::fromValue(values);
+}
+
+QVariant BinaryFBXParser::readVec2Array() {
+    quint32 arrayLength = beginArray(sizeof(double));
+    const char* data = endArray(arrayLength * sizeof(double), NULL);
+    QVector<glm::vec2> values(arrayLength / 2);
+    for (glm::vec2* it = values.data(), *end = it + values.size(); it != end; it++, data += 2 * sizeof(double)) {
+        // flip the t coordinate, as createVec2Vector does
+        *it = glm::vec2(readLittleEndian<double>(data), -readLittleEndian<double>(data + sizeof(double)));
+    }
+    return QVariant::fromValue(values);
+}
+
 class Tokenizer {
 public:
 
@@ -352,30 +506,12 @@ FBXNode parseFBX(QIODevice* device) {
         }
         return top;
     }
-    QDataStream in(device);
-    in.setByteOrder(QDataStream::LittleEndian);
-    in.setVersion(QDataStream::Qt_4_5); // for single/double precision switch
-
-    // see http://code.blender.org/index.php/2013/08/fbx-binary-file-format-specification/ for an explanation
-    // of the FBX binary format
-
-    // skip the rest of the header
-    const int HEADER_SIZE = 27;
-    in.skipRawData(HEADER_SIZE);
-
-    // parse the top-level node
-    FBXNode top;
-    while (device->bytesAvailable()) {
-        FBXNode next = parseBinaryFBXNode(in);
-        if (next.name.isNull()) {
-            return top;
-
-        } else {
-            top.children.append(next);
-        }
+    // parse binary documents out of memory, without copying them if they're already there
+    QBuffer* buffer = qobject_cast<QBuffer*>(device);
+    if (buffer) {
+        return BinaryFBXParser(buffer->data(), buffer->pos()).parse();
     }
-
-    return top;
+    return BinaryFBXParser(device->readAll(), 0).parse();
 }
 
 QVariantHash parseMapping(QIODevice* device) {
@@ -415,6 +551,7 @@ QVariantHash parseMapping(QIODevice* device) {
 
 QVector<glm::vec3> createVec3Vector(const QVector<double>& doubleVector) {
     QVector<glm::vec3> values;
+    values.reserve(doubleVector.size() / 3);
     for (const double* it = doubleVector.constData(), *end = it + (doubleVector.size() / 3 * 3); it != end; ) {
         float x = *it++;
         float y = *it++;
@@ -426,6 +563,7 @@ QVector<glm::vec3> createVec3Vector(const QVector<double>& doubleVector) {
 
 QVector<glm::vec2> createVec2Vector(const QVector<double>& doubleVector) {
     QVector<glm::vec2> values;
+    values.reserve(doubleVector.size() / 2);
     for (const double* it = doubleVector.constData(), *end = it + (doubleVector.size() / 2 * 2); it != end; ) {
         float s = *it++;
         float t = *it++;
@@ -498,6 +636,22 @@ QVector<double> getDoubleVector(const FBXNode& node) {
     return vector;
 }
 
+/// Returns the vertices or normals of a node, which the binary parser will have decoded already.
+QVector<glm::vec3> getVec3Vector(const FBXNode& node) {
+    if (!node.properties.isEmpty() && node.properties.at(0).userType() == qMetaTypeId<QVector<glm::vec3> >()) {
+        return node.properties.at(0).value<QVector<glm::vec3> >();
+    }
+    return createVec3Vector(getDoubleVector(node));
+}
+
+/// Returns the texture coordinates of a node, which the binary parser will have decoded already.
+QVector<glm::vec2> getVec2Vector(const FBXNode& node) {
+    if (!node.properties.isEmpty() && node.properties.at(0).userType() == qMetaTypeId<QVector<glm::vec2> >()) {
+        return node.properties.at(0).value<QVector<glm::vec2> >();
+    }
+    return createVec2Vector(getDoubleVector(node));
+}
+
 glm::vec3 getVec3(const QVariantList& properties, int index) {
     return glm::vec3(properties.at(index).value<double>(), properties.at(index + 1).value<double>(),
         properties.at(index + 2).value<double>());
@@ -768,7 +922,7 @@ ExtractedMesh extractMesh(const FBXNode& object) {
     QVector<int> textures;
     foreach (const FBXNode& child, object.children) {
         if (child.name == "Vertices") {
-            data.vertices = createVec3Vector(getDoubleVector(child));
+            data.vertices = getVec3Vector(child);
 
         } else if (child.name == "PolygonVertexIndex") {
             data.polygonIndices = getIntVector(child);
@@ -778,7 +932,7 @@ ExtractedMesh extractMesh(const FBXNode& object) {
             bool indexToDirect = false;
             foreach (const FBXNode& subdata, child.children) {
                 if (subdata.name == "Normals") {
-                    data.normals = createVec3Vector(getDoubleVector(subdata));
+                    data.normals = getVec3Vector(subdata);
 
                 } else if (subdata.name == "NormalsIndex") {
                     data.normalIndices = getIntVector(subdata);
@@ -797,7 +951,7 @@ ExtractedMesh extractMesh(const FBXNode& object) {
         } else if (child.name == "LayerElementUV" && child.properties.at(0).toInt() == 0) {
             foreach (const FBXNode& subdata, child.children) {
                 if (subdata.name == "UV") {
-                    data.texCoords = createVec2Vector(getDoubleVector(subdata));
+                    data.texCoords = getVec2Vector(subdata);
 
                 } else if (subdata.name == "UVIndex") {
                     data.texCoordIndices = getIntVector(subdata);
@@ -864,10 +1018,10 @@ FBXBlendshape extractBlendshape(const FBXNode& object) {
             blendshape.indices = getIntVector(data);
 
         } else if (data.name == "Vertices") {
-            blendshape.vertices = createVec3Vector(getDoubleVector(data));
+            blendshape.vertices = getVec3Vector(data);
 
         } else if (data.name == "Normals") {
-            blendshape.normals = createVec3Vector(getDoubleVector(data));
+            blendshape.normals = getVec3Vector(data);
         }
     }
     return blendshape;
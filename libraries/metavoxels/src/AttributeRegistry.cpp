@@ -502,6 +502,12 @@ AttributeValue SharedObjectSetAttribute::inherit(const AttributeValue& parentVal
     return AttributeValue(parentValue.getAttribute());
 }
 
+int SharedObjectSetAttribute::getValueMemoryUsage(void* value) const {
+    // each entry costs a hash node (next pointer, hash, and key) plus a bucket pointer
+    const int BYTES_PER_ENTRY = sizeof(void*) * 2 + sizeof(uint) + sizeof(SharedObjectPointer);
+    return decodeInline<SharedObjectSet>(value).size() * BYTES_PER_ENTRY;
+}
+
 QWidget* SharedObjectSetAttribute::createEditor(QWidget* parent) const {
     return new SharedObjectEditor(_metaObject, parent);
 }
@@ -229,6 +229,9 @@ public:
 
     virtual void* getDefaultValue() const = 0;
 
+    /// Returns an estimate of the number of bytes allocated for the specified value beyond the pointer that holds it.
+    virtual int getValueMemoryUsage(void* value) const { return 0; }
+
     virtual void* createFromScript(const QScriptValue& value, QScriptEngine* engine) const { return create(); }
     
     virtual void* createFromVariant(const QVariant& value) const { return create(); }
@@ -438,6 +441,8 @@ public:
 
     virtual AttributeValue inherit(const AttributeValue& parentValue) const;
 
+    virtual int getValueMemoryUsage(void* value) const;
+
     virtual QWidget* createEditor(QWidget* parent = NULL) const;
 
 private:
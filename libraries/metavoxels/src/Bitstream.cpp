@@ -16,6 +16,7 @@
 #include <QMetaType>
 #include <QUrl>
 #include <QtDebug>
+#include <QtEndian>
 
 #include <RegisteredMetaTypes.h>
 #include <SharedUtil.h>
@@ -105,6 +106,7 @@ Bitstream::Bitstream(QDataStream& underlying, MetadataType metadataType, QObject
     _byte(0),
     _position(0),
     _metadataType(metadataType),
+    _integerEncoding(FIXED_INTEGERS),
     _metaObjectStreamer(*this),
     _typeStreamerStreamer(*this),
     _attributeStreamer(*this),
@@ -122,8 +124,23 @@ void Bitstream::addTypeSubstitution(const QByteArray& typeName, int type) {
 
 const int LAST_BIT_POSITION = BITS_IN_BYTE - 1;
 
+const int BITS_IN_WORD = 32;
+const int BYTES_IN_WORD = BITS_IN_WORD / BITS_IN_BYTE;
+
 Bitstream& Bitstream::write(const void* data, int bits, int offset) {
     const quint8* source = (const quint8*)data;
+    if (offset == 0) {
+        // write whole words at a time, carrying the partial byte across
+        while (bits >= BITS_IN_WORD) {
+            quint64 accumulated = _byte | ((quint64)qFromLittleEndian<quint32>(source) << _position);
+            uchar buffer[BYTES_IN_WORD];
+            qToLittleEndian<quint32>((quint32)accumulated, buffer);
+            _underlying.writeRawData((const char*)buffer, BYTES_IN_WORD);
+            _byte = (quint8)(accumulated >> BITS_IN_WORD);
+            source += BYTES_IN_WORD;
+            bits -= BITS_IN_WORD;
+        }
+    }
     while (bits > 0) {
         int bitsToWrite = qMin(BITS_IN_BYTE - _position, qMin(BITS_IN_BYTE - offset, bits));
         _byte |= ((*source >> offset) & ((1 << bitsToWrite) - 1)) << _position;
@@ -141,6 +158,21 @@ Bitstream& Bitstream::write(const void* data, int bits, int offset) {
 
 Bitstream& Bitstream::read(void* data, int bits, int offset) {
     quint8* dest = (quint8*)data;
+    if (offset == 0) {
+        // read whole words at a time; the last byte read becomes the partial byte if we're not aligned
+        while (bits >= BITS_IN_WORD) {
+            uchar buffer[BYTES_IN_WORD] = { 0 };
+            _underlying.readRawData((char*)buffer, BYTES_IN_WORD);
+            quint32 word = qFromLittleEndian<quint32>(buffer);
+            if (_position != 0) {
+                word = (quint32)((((quint64)word << BITS_IN_BYTE) | _byte) >> _position);
+                _byte = buffer[BYTES_IN_WORD - 1];
+            }
+            qToLittleEndian<quint32>(word, dest);
+            dest += BYTES_IN_WORD;
+            bits -= BITS_IN_WORD;
+        }
+    }
     while (bits > 0) {
         if (_position == 0) {
             _underlying >> _byte;
@@ -206,6 +238,35 @@ void Bitstream::persistAndResetWriteMappings() {
     persistWriteMappings(getAndResetWriteMappings());
 }
 
+bool Bitstream::hasSameWriteState(const Bitstream& other) const {
+    return _metadataType == other._metadataType && _integerEncoding == other._integerEncoding &&
+        _metaObjectStreamer.hasSameWriteState(other._metaObjectStreamer) &&
+        _typeStreamerStreamer.hasSameWriteState(other._typeStreamerStreamer) &&
+        _attributeStreamer.hasSameWriteState(other._attributeStreamer) &&
+        _scriptStringStreamer.hasSameWriteState(other._scriptStringStreamer) &&
+        _sharedObjectStreamer.hasSameWriteState(other._sharedObjectStreamer) &&
+        _sharedObjectReferences == other._sharedObjectReferences;
+}
+
+void Bitstream::copyWriteState(const Bitstream& other) {
+    _metadataType = other._metadataType;
+    _integerEncoding = other._integerEncoding;
+    _metaObjectStreamer.copyWriteState(other._metaObjectStreamer);
+    _typeStreamerStreamer.copyWriteState(other._typeStreamerStreamer);
+    _attributeStreamer.copyWriteState(other._attributeStreamer);
+    _scriptStringStreamer.copyWriteState(other._scriptStringStreamer);
+    _sharedObjectStreamer.copyWriteState(other._sharedObjectStreamer);
+    _sharedObjectReferences = other._sharedObjectReferences;
+}
+
+void Bitstream::copyTransientWriteMappings(const Bitstream& other) {
+    _metaObjectStreamer.copyTransientOffsets(other._metaObjectStreamer);
+    _typeStreamerStreamer.copyTransientOffsets(other._typeStreamerStreamer);
+    _attributeStreamer.copyTransientOffsets(other._attributeStreamer);
+    _scriptStringStreamer.copyTransientOffsets(other._scriptStringStreamer);
+    _sharedObjectStreamer.copyTransientOffsets(other._sharedObjectStreamer);
+}
+
 Bitstream::ReadMappings Bitstream::getAndResetReadMappings() {
     ReadMappings mappings = { _metaObjectStreamer.getAndResetTransientValues(),
         _typeStreamerStreamer.getAndResetTransientValues(),
@@ -299,6 +360,33 @@ void Bitstream::readRawDelta(QObject*& value, const QObject* reference) {
     value = objectReader.readDelta(*this, reference);
 }
 
+const int VARIABLE_INTEGER_GROUP_BITS = 7;
+const quint32 VARIABLE_INTEGER_GROUP_MASK = (1 << VARIABLE_INTEGER_GROUP_BITS) - 1;
+const int MAX_VARIABLE_INTEGER_GROUPS = (32 + VARIABLE_INTEGER_GROUP_BITS - 1) / VARIABLE_INTEGER_GROUP_BITS;
+
+void Bitstream::writeVariableInteger(quint32 value) {
+    while (value > VARIABLE_INTEGER_GROUP_MASK) {
+        quint8 group = (value & VARIABLE_INTEGER_GROUP_MASK) | (1 << VARIABLE_INTEGER_GROUP_BITS);
+        write(&group, BITS_IN_BYTE);
+        value >>= VARIABLE_INTEGER_GROUP_BITS;
+    }
+    quint8 group = value;
+    write(&group, BITS_IN_BYTE);
+}
+
+quint32 Bitstream::readVariableInteger() {
+    quint32 value = 0;
+    for (int i = 0; i < MAX_VARIABLE_INTEGER_GROUPS; i++) {
+        quint8 group = 0;
+        read(&group, BITS_IN_BYTE);
+        value |= (quint32)(group & VARIABLE_INTEGER_GROUP_MASK) << (i * VARIABLE_INTEGER_GROUP_BITS);
+        if (!(group & (1 << VARIABLE_INTEGER_GROUP_BITS))) {
+            break;
+        }
+    }
+    return value;
+}
+
 Bitstream& Bitstream::operator<<(bool value) {
     if (value) {
         _byte |= (1 << _position);
@@ -319,10 +407,19 @@ Bitstream& Bitstream::operator>>(bool& value) {
 }
 
 Bitstream& Bitstream::operator<<(int value) {
+    if (_integerEncoding == VARIABLE_INTEGERS) {
+        writeVariableInteger(((quint32)value << 1) ^ (quint32)(value >> 31));
+        return *this;
+    }
     return write(&value, 32);
 }
 
 Bitstream& Bitstream::operator>>(int& value) {
+    if (_integerEncoding == VARIABLE_INTEGERS) {
+        quint32 encoded = readVariableInteger();
+        value = (qint32)(encoded >> 1) ^ -(qint32)(encoded & 1);
+        return *this;
+    }
     qint32 sizedValue;
     read(&sizedValue, 32);
     value = sizedValue;
@@ -330,10 +427,18 @@ Bitstream& Bitstream::operator>>(int& value) {
 }
 
 Bitstream& Bitstream::operator<<(uint value) {
+    if (_integerEncoding == VARIABLE_INTEGERS) {
+        writeVariableInteger(value);
+        return *this;
+    }
     return write(&value, 32);
 }
 
 Bitstream& Bitstream::operator>>(uint& value) {
+    if (_integerEncoding == VARIABLE_INTEGERS) {
+        value = readVariableInteger();
+        return *this;
+    }
     quint32 sizedValue;
     read(&sizedValue, 32);
     value = sizedValue;
@@ -53,6 +53,9 @@ public:
     
     void setBitsFromValue(int value);
     
+    int getBits() const { return _bits; }
+    void setBits(int bits) { _bits = bits; }
+    
     IDStreamer& operator<<(int value);
     IDStreamer& operator>>(int& value);
     
@@ -86,6 +89,15 @@ public:
     
     V takePersistentValue(int id) { V value = _persistentValues.take(id); _valueIDs.remove(value); return value; }
     
+    /// Checks whether our write state (persistent IDs and transient offsets) matches that of another streamer.
+    bool hasSameWriteState(const RepeatedValueStreamer& other) const;
+    
+    /// Copies the write state (persistent IDs and transient offsets) of another streamer.
+    void copyWriteState(const RepeatedValueStreamer& other);
+    
+    /// Copies the transient offsets of another streamer whose write state formerly matched ours.
+    void copyTransientOffsets(const RepeatedValueStreamer& other);
+    
     RepeatedValueStreamer& operator<<(K value);
     RepeatedValueStreamer& operator>>(V& value);
     
@@ -144,6 +156,29 @@ template<class K, class P, class V> inline void RepeatedValueStreamer<K, P, V>::
     _idStreamer.setBitsFromValue(_lastPersistentID);
 }
 
+template<class K, class P, class V> inline bool RepeatedValueStreamer<K, P, V>::hasSameWriteState(
+        const RepeatedValueStreamer& other) const {
+    return _idStreamer.getBits() == other._idStreamer.getBits() && _lastPersistentID == other._lastPersistentID &&
+        _lastTransientOffset == other._lastTransientOffset && _persistentIDs == other._persistentIDs &&
+        _transientOffsets == other._transientOffsets;
+}
+
+template<class K, class P, class V> inline void RepeatedValueStreamer<K, P, V>::copyWriteState(
+        const RepeatedValueStreamer& other) {
+    _idStreamer.setBits(other._idStreamer.getBits());
+    _lastPersistentID = other._lastPersistentID;
+    _lastTransientOffset = other._lastTransientOffset;
+    _persistentIDs = other._persistentIDs;
+    _transientOffsets = other._transientOffsets;
+}
+
+template<class K, class P, class V> inline void RepeatedValueStreamer<K, P, V>::copyTransientOffsets(
+        const RepeatedValueStreamer& other) {
+    _idStreamer.setBits(other._idStreamer.getBits());
+    _lastTransientOffset = other._lastTransientOffset;
+    _transientOffsets = other._transientOffsets;
+}
+
 template<class K, class P, class V> inline RepeatedValueStreamer<K, P, V>&
         RepeatedValueStreamer<K, P, V>::operator<<(K value) {
     int id = _persistentIDs.value(value);
@@ -226,9 +261,17 @@ public:
 
     enum MetadataType { NO_METADATA, HASH_METADATA, FULL_METADATA };
 
+    /// Determines how ints and uints are encoded: either as fixed 32-bit values or as variable-length groups of seven bits,
+    /// each followed by a continuation bit (with signed values zigzag-encoded so that small magnitudes stay short).
+    enum IntegerEncoding { FIXED_INTEGERS, VARIABLE_INTEGERS };
+
     /// Creates a new bitstream.  Note: the stream may be used for reading or writing, but not both.
     Bitstream(QDataStream& underlying, MetadataType metadataType = NO_METADATA, QObject* parent = NULL);
 
+    /// Sets the integer encoding.  Both ends of the stream must use the same encoding.
+    void setIntegerEncoding(IntegerEncoding encoding) { _integerEncoding = encoding; }
+    IntegerEncoding getIntegerEncoding() const { return _integerEncoding; }
+
     /// Substitutes the supplied metaobject for the given class name's default mapping.
     void addMetaObjectSubstitution(const QByteArray& className, const QMetaObject* metaObject);
     
@@ -248,6 +291,9 @@ public:
     /// Flushes any unwritten bits to the underlying stream.
     void flush();
 
+    /// Returns the number of bits written to the current (unflushed) byte.
+    int getBitPosition() const { return _position; }
+
     /// Resets to the initial state.
     void reset();
 
@@ -260,6 +306,17 @@ public:
     /// Immediately persists and resets the write mappings.
     void persistAndResetWriteMappings();
 
+    /// Checks whether our write state (persistent and transient mappings) matches that of another stream, in which case
+    /// writing the same values to both streams will produce the same bits.
+    bool hasSameWriteState(const Bitstream& other) const;
+
+    /// Copies the write state (persistent and transient mappings) of another stream.
+    void copyWriteState(const Bitstream& other);
+
+    /// Copies the transient write mappings of another stream.  Used after copying data written to the other stream
+    /// when the write states of the two streams matched before the write.
+    void copyTransientWriteMappings(const Bitstream& other);
+
     /// Returns the set of transient mappings gathered during reading and resets them.
     ReadMappings getAndResetReadMappings();
     
@@ -390,11 +447,15 @@ private slots:
 
 private:
     
+    void writeVariableInteger(quint32 value);
+    quint32 readVariableInteger();
+    
     QDataStream& _underlying;
     quint8 _byte;
     int _position;
 
     MetadataType _metadataType;
+    IntegerEncoding _integerEncoding;
 
     RepeatedValueStreamer<const QMetaObject*, const QMetaObject*, ObjectReader> _metaObjectStreamer;
     RepeatedValueStreamer<const TypeStreamer*, const TypeStreamer*, TypeReader> _typeStreamerStreamer;
@@ -55,6 +55,17 @@ void DatagramSequencer::sendHighPriorityMessage(const QVariant& data) {
     _highPriorityMessages.append(message);
 }
 
+void DatagramSequencer::setIntegerEncoding(Bitstream::IntegerEncoding encoding) {
+    _outputStream.setIntegerEncoding(encoding);
+    _inputStream.setIntegerEncoding(encoding);
+    foreach (ReliableChannel* channel, _reliableOutputChannels) {
+        channel->getBitstream().setIntegerEncoding(encoding);
+    }
+    foreach (ReliableChannel* channel, _reliableInputChannels) {
+        channel->getBitstream().setIntegerEncoding(encoding);
+    }
+}
+
 ReliableChannel* DatagramSequencer::getReliableOutputChannel(int index) {
     ReliableChannel*& channel = _reliableOutputChannels[index];
     if (!channel) {
@@ -623,6 +634,7 @@ ReliableChannel::ReliableChannel(DatagramSequencer* sequencer, int index, bool o
     
     _buffer.open(output ? QIODevice::WriteOnly : QIODevice::ReadOnly);
     _dataStream.setByteOrder(QDataStream::LittleEndian);
+    _bitstream.setIntegerEncoding(sequencer->getIntegerEncoding());
     
     connect(&_bitstream, SIGNAL(sharedObjectCleared(int)), SLOT(sendClearSharedObjectMessage(int)));
     connect(this, SIGNAL(receivedMessage(const QVariant&)), SLOT(handleMessage(const QVariant&)));
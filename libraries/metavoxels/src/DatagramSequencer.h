@@ -61,6 +61,12 @@ public:
     
     int getMaxPacketSize() const { return _maxPacketSize; }
     
+    /// Sets the integer encoding used by the packet streams and the reliable channels.  The wire format must match on
+    /// both sides, so this should be set before any data is sent or received.
+    void setIntegerEncoding(Bitstream::IntegerEncoding encoding);
+    
+    Bitstream::IntegerEncoding getIntegerEncoding() const { return _outputStream.getIntegerEncoding(); }
+    
     /// Returns the output channel at the specified index, creating it if necessary.
     ReliableChannel* getReliableOutputChannel(int index = 0);
     
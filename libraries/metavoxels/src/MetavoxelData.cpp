@@ -10,7 +10,10 @@
 //
 
 #include <QDateTime>
+#include <QRunnable>
 #include <QScriptEngine>
+#include <QSemaphore>
+#include <QThreadPool>
 #include <QtDebug>
 
 #include <GeometryUtil.h>
@@ -34,6 +37,10 @@ MetavoxelLOD::MetavoxelLOD(const glm::vec3& position, float threshold) :
     threshold(threshold) {
 }
 
+MetavoxelLOD MetavoxelLOD::getQuantized(float granularity) const {
+    return MetavoxelLOD(glm::floor(position / granularity + glm::vec3(0.5f, 0.5f, 0.5f)) * granularity, threshold);
+}
+
 bool MetavoxelLOD::shouldSubdivide(const glm::vec3& minimum, float size, float multiplier) const {
     return size >= glm::distance(position, minimum + glm::vec3(size, size, size) * 0.5f) * threshold * multiplier;
 }
@@ -148,6 +155,7 @@ public:
     SpannerUpdateVisitor(const AttributePointer& attribute, const Box& bounds,
         float granularity, const SharedObjectPointer& object);
     
+    virtual bool isThreadSafe() const { return true; }
     virtual int visit(MetavoxelInfo& info);
 
 private:
@@ -229,6 +237,7 @@ public:
     SpannerReplaceVisitor(const AttributePointer& attribute, const Box& bounds,
         float granularity, const SharedObjectPointer& oldObject, const SharedObjectPointer& newObject);
     
+    virtual bool isThreadSafe() const { return true; }
     virtual int visit(MetavoxelInfo& info);
 
 private:
@@ -664,6 +673,176 @@ void MetavoxelStreamState::setMinimum(const glm::vec3& lastMinimum, int index) {
     minimum = getNextMinimum(lastMinimum, size, index);
 }
 
+/// Hands out node storage from large slabs rather than allocating each node separately.  Each thread keeps a small cache of
+/// free nodes and exchanges them with the shared free list in batches, so the lock is rarely taken (and more rarely
+/// contended).  Slabs are never returned to the system; the pool simply reuses them.
+class MetavoxelNodePool {
+public:
+    
+    /// Returns the singleton pool instance.
+    static MetavoxelNodePool& getInstance();
+    
+    MetavoxelNodePool();
+    
+    void* allocate();
+    void free(void* pointer);
+    
+    int getLiveNodeCount() const { return _liveNodeCount.load(); }
+    
+    qint64 getReservedBytes();
+    
+private:
+    
+    /// Free nodes are linked together through their first word.
+    class FreeNode {
+    public:
+        FreeNode* next;
+    };
+    
+    /// The free nodes held by a single thread.
+    class ThreadCache {
+    public:
+        ThreadCache();
+        ~ThreadCache();
+        
+        FreeNode* freeNodes;
+        int count;
+    };
+    
+    ThreadCache& getThreadCache();
+    
+    void refill(ThreadCache& cache);
+    void drain(ThreadCache& cache, int count);
+    
+    QMutex _mutex;
+    FreeNode* _freeNodes;
+    int _slabCount;
+    QAtomicInt _liveNodeCount;
+    
+    QThreadStorage<ThreadCache*> _threadCaches;
+};
+
+const int NODES_PER_SLAB = 1024;
+const int NODE_CACHE_BATCH = 64;
+const int MAX_CACHED_NODES = NODE_CACHE_BATCH * 4;
+
+MetavoxelNodePool& MetavoxelNodePool::getInstance() {
+    // intentionally leaked: nodes may be released by static destructors after this would have been destroyed
+    static MetavoxelNodePool* instance = new MetavoxelNodePool();
+    return *instance;
+}
+
+MetavoxelNodePool::MetavoxelNodePool() :
+    _freeNodes(NULL),
+    _slabCount(0) {
+}
+
+void* MetavoxelNodePool::allocate() {
+    ThreadCache& cache = getThreadCache();
+    if (!cache.freeNodes) {
+        refill(cache);
+    }
+    FreeNode* node = cache.freeNodes;
+    cache.freeNodes = node->next;
+    cache.count--;
+    _liveNodeCount.ref();
+    return node;
+}
+
+void MetavoxelNodePool::free(void* pointer) {
+    ThreadCache& cache = getThreadCache();
+    FreeNode* node = static_cast<FreeNode*>(pointer);
+    node->next = cache.freeNodes;
+    cache.freeNodes = node;
+    _liveNodeCount.deref();
+    if (++cache.count > MAX_CACHED_NODES) {
+        drain(cache, MAX_CACHED_NODES - NODE_CACHE_BATCH);
+    }
+}
+
+qint64 MetavoxelNodePool::getReservedBytes() {
+    QMutexLocker locker(&_mutex);
+    return (qint64)_slabCount * NODES_PER_SLAB * sizeof(MetavoxelNode);
+}
+
+MetavoxelNodePool::ThreadCache::ThreadCache() :
+    freeNodes(NULL),
+    count(0) {
+}
+
+MetavoxelNodePool::ThreadCache::~ThreadCache() {
+    // hand everything back when the thread exits
+    MetavoxelNodePool::getInstance().drain(*this, 0);
+}
+
+MetavoxelNodePool::ThreadCache& MetavoxelNodePool::getThreadCache() {
+    if (!_threadCaches.hasLocalData()) {
+        _threadCaches.setLocalData(new ThreadCache());
+    }
+    return *_threadCaches.localData();
+}
+
+void MetavoxelNodePool::refill(ThreadCache& cache) {
+    QMutexLocker locker(&_mutex);
+    if (!_freeNodes) {
+        // carve a new slab into free nodes for the cache
+        char* slab = new char[NODES_PER_SLAB * sizeof(MetavoxelNode)];
+        _slabCount++;
+        for (int i = NODES_PER_SLAB - 1; i >= 0; i--) {
+            FreeNode* node = reinterpret_cast<FreeNode*>(slab + i * sizeof(MetavoxelNode));
+            node->next = cache.freeNodes;
+            cache.freeNodes = node;
+        }
+        cache.count += NODES_PER_SLAB;
+        return;
+    }
+    for (int i = 0; i < NODE_CACHE_BATCH && _freeNodes; i++) {
+        FreeNode* node = _freeNodes;
+        _freeNodes = node->next;
+        node->next = cache.freeNodes;
+        cache.freeNodes = node;
+        cache.count++;
+    }
+}
+
+void MetavoxelNodePool::drain(ThreadCache& cache, int count) {
+    if (cache.count <= count) {
+        return;
+    }
+    // find the run of nodes to return before taking the lock
+    FreeNode* first = cache.freeNodes;
+    FreeNode* last = first;
+    for (int i = count + 1; i < cache.count; i++) {
+        last = last->next;
+    }
+    cache.freeNodes = last->next;
+    cache.count = count;
+    
+    QMutexLocker locker(&_mutex);
+    last->next = _freeNodes;
+    _freeNodes = first;
+}
+
+void* MetavoxelNode::operator new(size_t size) {
+    return (size == sizeof(MetavoxelNode)) ? MetavoxelNodePool::getInstance().allocate() : ::operator new(size);
+}
+
+void MetavoxelNode::operator delete(void* pointer, size_t size) {
+    if (size == sizeof(MetavoxelNode)) {
+        MetavoxelNodePool::getInstance().free(pointer);
+    } else {
+        ::operator delete(pointer);
+    }
+}
+
+int MetavoxelNode::getLiveNodeCount() {
+    return MetavoxelNodePool::getInstance().getLiveNodeCount();
+}
+
+qint64 MetavoxelNode::getReservedBytes() {
+    return MetavoxelNodePool::getInstance().getReservedBytes();
+}
+
 MetavoxelNode::MetavoxelNode(const AttributeValue& attributeValue, const MetavoxelNode* copyChildren) :
         _referenceCount(1) {
 
@@ -982,7 +1161,7 @@ void MetavoxelNode::writeSpannerSubdivision(MetavoxelStreamState& state) const {
 }
 
 void MetavoxelNode::decrementReferenceCount(const AttributePointer& attribute) {
-    if (--_referenceCount == 0) {
+    if (!_referenceCount.deref()) {
         destroy(attribute);
         delete this;
     }
@@ -1006,6 +1185,34 @@ void MetavoxelNode::clearChildren(const AttributePointer& attribute) {
     }
 }
 
+MetavoxelMemoryUsage::MetavoxelMemoryUsage() :
+    _sharedNodeCount(0) {
+}
+
+void MetavoxelMemoryUsage::add(const MetavoxelData& data) {
+    for (QHash<AttributePointer, MetavoxelNode*>::const_iterator it = data._roots.constBegin();
+            it != data._roots.constEnd(); it++) {
+        add(it.key(), it.value(), _attributeBytes[it.key()]);
+    }
+}
+
+void MetavoxelMemoryUsage::add(const AttributePointer& attribute, const MetavoxelNode* node, qint64& bytes) {
+    if (_visited.contains(node)) {
+        return;
+    }
+    _visited.insert(node);
+    if (node->getReferenceCount() > 1) {
+        _sharedNodeCount++;
+    }
+    bytes += sizeof(MetavoxelNode) + attribute->getValueMemoryUsage(node->getAttributeValue());
+    for (int i = 0; i < MetavoxelNode::CHILD_COUNT; i++) {
+        const MetavoxelNode* child = node->getChild(i);
+        if (child) {
+            add(attribute, child, bytes);
+        }
+    }
+}
+
 int MetavoxelVisitor::encodeOrder(int first, int second, int third, int fourth,
         int fifth, int sixth, int seventh, int eighth) {
     return first | (second << 3) | (third << 6) | (fourth << 9) |
@@ -1195,6 +1402,95 @@ int RaySpannerIntersectionVisitor::visit(MetavoxelInfo& info, float distance) {
 DefaultMetavoxelGuide::DefaultMetavoxelGuide() {
 }
 
+/// A per-thread cache of the vectors used for visitations, so that deep traversals don't reallocate them at every level.
+class VisitationArena {
+public:
+    
+    /// Returns the arena for the current thread.
+    static VisitationArena& getInstance();
+    
+    /// Provides the visitation with vectors of the specified sizes.
+    void acquire(MetavoxelVisitation& visitation, int inputCount, int outputCount);
+    
+    /// Returns the visitation's vectors to the arena.
+    void release(MetavoxelVisitation& visitation);
+
+private:
+    
+    class Buffers {
+    public:
+        QVector<MetavoxelNode*> inputNodes;
+        QVector<MetavoxelNode*> outputNodes;
+        QVector<AttributeValue> inputValues;
+        QVector<OwnedAttributeValue> outputValues;
+    };
+    
+    QList<Buffers> _freeBuffers;
+};
+
+static QThreadStorage<VisitationArena*> visitationArenas;
+
+VisitationArena& VisitationArena::getInstance() {
+    if (!visitationArenas.hasLocalData()) {
+        visitationArenas.setLocalData(new VisitationArena());
+    }
+    return *visitationArenas.localData();
+}
+
+void VisitationArena::acquire(MetavoxelVisitation& visitation, int inputCount, int outputCount) {
+    if (!_freeBuffers.isEmpty()) {
+        Buffers buffers = _freeBuffers.takeLast();
+        visitation.inputNodes.swap(buffers.inputNodes);
+        visitation.outputNodes.swap(buffers.outputNodes);
+        visitation.info.inputValues.swap(buffers.inputValues);
+        visitation.info.outputValues.swap(buffers.outputValues);
+    }
+    visitation.inputNodes.resize(inputCount);
+    visitation.outputNodes.resize(outputCount);
+    visitation.info.inputValues.resize(inputCount);
+    visitation.info.outputValues.resize(outputCount);
+}
+
+void VisitationArena::release(MetavoxelVisitation& visitation) {
+    Buffers buffers;
+    buffers.inputNodes.swap(visitation.inputNodes);
+    buffers.outputNodes.swap(visitation.outputNodes);
+    buffers.inputValues.swap(visitation.info.inputValues);
+    buffers.outputValues.swap(visitation.info.outputValues);
+    
+    // don't hold on to any output values (they may own data)
+    buffers.outputValues.fill(OwnedAttributeValue());
+    _freeBuffers.append(buffers);
+}
+
+/// Borrows the vectors for a visitation from the current thread's arena for the lifetime of the object.
+class VisitationArenaScope {
+public:
+    
+    VisitationArenaScope(MetavoxelVisitation& visitation, int inputCount, int outputCount);
+    ~VisitationArenaScope();
+
+private:
+    
+    VisitationArena& _arena;
+    MetavoxelVisitation& _visitation;
+};
+
+VisitationArenaScope::VisitationArenaScope(MetavoxelVisitation& visitation, int inputCount, int outputCount) :
+    _arena(VisitationArena::getInstance()),
+    _visitation(visitation) {
+    
+    _arena.acquire(visitation, inputCount, outputCount);
+}
+
+VisitationArenaScope::~VisitationArenaScope() {
+    _arena.release(_visitation);
+}
+
+// the encoded order consists of three bits for each child index
+const int ORDER_ELEMENT_BITS = 3;
+const int ORDER_ELEMENT_MASK = (1 << ORDER_ELEMENT_BITS) - 1;
+
 bool DefaultMetavoxelGuide::guide(MetavoxelVisitation& visitation) {
     // save the core of the LOD calculation; we'll reuse it to determine whether to subdivide each attribute
     float lodBase = glm::distance(visitation.visitor.getLOD().position, visitation.info.getCenter()) *
@@ -1221,68 +1517,171 @@ bool DefaultMetavoxelGuide::guide(MetavoxelVisitation& visitation) {
     if (encodedOrder == MetavoxelVisitor::STOP_RECURSION) {
         return true;
     }
-    MetavoxelVisitation nextVisitation = { &visitation, visitation.visitor,
-        QVector<MetavoxelNode*>(visitation.inputNodes.size()), QVector<MetavoxelNode*>(visitation.outputNodes.size()),
-        { &visitation.info, glm::vec3(), visitation.info.size * 0.5f, QVector<AttributeValue>(visitation.inputNodes.size()),
-            QVector<OwnedAttributeValue>(visitation.outputNodes.size()) } };
+    if (!visitation.previous && visitation.visitor.isThreadSafe() &&
+            metaObject() == &DefaultMetavoxelGuide::staticMetaObject) {
+        return guideChildrenInParallel(visitation, encodedOrder, lodBase);
+    }
+    MetavoxelVisitation nextVisitation = { &visitation, visitation.visitor, QVector<MetavoxelNode*>(),
+        QVector<MetavoxelNode*>(), { &visitation.info, glm::vec3(), visitation.info.size * 0.5f,
+            QVector<AttributeValue>(), QVector<OwnedAttributeValue>() } };
+    VisitationArenaScope arenaScope(nextVisitation, visitation.inputNodes.size(), visitation.outputNodes.size());
     for (int i = 0; i < MetavoxelNode::CHILD_COUNT; i++) {
         // the encoded order tells us the child indices for each iteration
-        const int ORDER_ELEMENT_BITS = 3;
-        const int ORDER_ELEMENT_MASK = (1 << ORDER_ELEMENT_BITS) - 1;
         int index = encodedOrder & ORDER_ELEMENT_MASK;
         encodedOrder >>= ORDER_ELEMENT_BITS;
-        for (int j = 0; j < visitation.inputNodes.size(); j++) {
-            MetavoxelNode* node = visitation.inputNodes.at(j);
-            const AttributeValue& parentValue = visitation.info.inputValues.at(j);
-            MetavoxelNode* child = (node && (visitation.info.size >= lodBase *
-                parentValue.getAttribute()->getLODThresholdMultiplier())) ? node->getChild(index) : NULL;
-            nextVisitation.info.inputValues[j] = ((nextVisitation.inputNodes[j] = child)) ?
-                child->getAttributeValue(parentValue.getAttribute()) : parentValue.getAttribute()->inherit(parentValue);
+        setUpChildVisitation(visitation, nextVisitation, index, lodBase);
+        if (!getGuide(nextVisitation)->guide(nextVisitation)) {
+            return false;
         }
-        for (int j = 0; j < visitation.outputNodes.size(); j++) {
-            MetavoxelNode* node = visitation.outputNodes.at(j);
-            MetavoxelNode* child = (node && (visitation.info.size >= lodBase *
-                visitation.visitor.getOutputs().at(j)->getLODThresholdMultiplier())) ? node->getChild(index) : NULL;
-            nextVisitation.outputNodes[j] = child;
+        mergeChildVisitation(visitation, nextVisitation, i, index);
+    }
+    mergeChildren(visitation);
+    return true;
+}
+
+/// Shared state for a set of child visitations guided in parallel.
+class ParallelGuideState {
+public:
+    
+    ParallelGuideState(QList<MetavoxelVisitation>& visitations) : visitations(visitations) { }
+    
+    /// Takes the next unclaimed child visitation and guides it.
+    /// \return false if there were no children left to guide
+    bool guideNext();
+    
+    QList<MetavoxelVisitation>& visitations;
+    bool results[MetavoxelNode::CHILD_COUNT];
+    QAtomicInt nextChild;
+    QSemaphore completed;
+};
+
+bool ParallelGuideState::guideNext() {
+    int child = nextChild.fetchAndAddOrdered(1);
+    if (child >= MetavoxelNode::CHILD_COUNT) {
+        return false;
+    }
+    MetavoxelVisitation& visitation = visitations[child];
+    results[child] = DefaultMetavoxelGuide::getGuide(visitation)->guide(visitation);
+    completed.release();
+    return true;
+}
+
+/// Guides child visitations on a pool thread until there are none left.
+class ParallelGuideTask : public QRunnable {
+public:
+    
+    ParallelGuideTask(const QSharedPointer<ParallelGuideState>& state) : _state(state) { }
+    
+    virtual void run() { while (_state->guideNext()); }
+
+private:
+    
+    QSharedPointer<ParallelGuideState> _state;
+};
+
+bool DefaultMetavoxelGuide::guideChildrenInParallel(MetavoxelVisitation& visitation, int encodedOrder, float lodBase) {
+    // set up all of the child visitations first, since they will be guided simultaneously
+    QList<MetavoxelVisitation> nextVisitations;
+    int indices[MetavoxelNode::CHILD_COUNT];
+    bool allDefault = true;
+    for (int i = 0; i < MetavoxelNode::CHILD_COUNT; i++) {
+        MetavoxelVisitation nextVisitation = { &visitation, visitation.visitor,
+            QVector<MetavoxelNode*>(visitation.inputNodes.size()), QVector<MetavoxelNode*>(visitation.outputNodes.size()),
+            { &visitation.info, glm::vec3(), visitation.info.size * 0.5f,
+                QVector<AttributeValue>(visitation.inputNodes.size()),
+                QVector<OwnedAttributeValue>(visitation.outputNodes.size()) } };
+        nextVisitations.append(nextVisitation);
+        indices[i] = encodedOrder & ORDER_ELEMENT_MASK;
+        encodedOrder >>= ORDER_ELEMENT_BITS;
+        setUpChildVisitation(visitation, nextVisitations[i], indices[i], lodBase);
+        allDefault &= (getGuide(nextVisitations[i])->metaObject() == &DefaultMetavoxelGuide::staticMetaObject);
+    }
+    QSharedPointer<ParallelGuideState> state(new ParallelGuideState(nextVisitations));
+    if (allDefault) {
+        // start tasks on the pool, but also guide on this thread so that we never wait on a task that hasn't started
+        int taskCount = qMin(MetavoxelNode::CHILD_COUNT - 1, QThreadPool::globalInstance()->maxThreadCount());
+        for (int i = 0; i < taskCount; i++) {
+            QThreadPool::globalInstance()->start(new ParallelGuideTask(state));
         }
-        nextVisitation.info.minimum = getNextMinimum(visitation.info.minimum, nextVisitation.info.size, index);
-        if (!static_cast<MetavoxelGuide*>(nextVisitation.info.inputValues.last().getInlineValue<
-                SharedObjectPointer>().data())->guide(nextVisitation)) {
+        while (state->guideNext());
+        state->completed.acquire(MetavoxelNode::CHILD_COUNT);
+        
+    } else {
+        // scripted guides can't run concurrently
+        while (state->guideNext());
+    }
+    
+    // merge the results in order, just as we would have if we had visited them serially
+    for (int i = 0; i < MetavoxelNode::CHILD_COUNT; i++) {
+        if (!state->results[i]) {
             return false;
         }
-        for (int j = 0; j < nextVisitation.outputNodes.size(); j++) {
-            OwnedAttributeValue& value = nextVisitation.info.outputValues[j];
-            if (!value.getAttribute()) {
-                continue;
-            }
-            // replace the child
-            OwnedAttributeValue& parentValue = visitation.info.outputValues[j];
-            if (!parentValue.getAttribute()) {
-                // shallow-copy the parent node on first change
-                parentValue = value;
-                MetavoxelNode*& node = visitation.outputNodes[j];
-                if (node) {
-                    node = new MetavoxelNode(value.getAttribute(), node);
-                } else {
-                    // create leaf with inherited value
-                    node = new MetavoxelNode(value.getAttribute()->inherit(visitation.getInheritedOutputValue(j)));
-                }
-            }
-            MetavoxelNode* node = visitation.outputNodes.at(j);
-            MetavoxelNode* child = node->getChild(i);
-            if (child) {
-                child->decrementReferenceCount(value.getAttribute());
+        mergeChildVisitation(visitation, nextVisitations[i], i, indices[i]);
+    }
+    mergeChildren(visitation);
+    return true;
+}
+
+MetavoxelGuide* DefaultMetavoxelGuide::getGuide(MetavoxelVisitation& visitation) {
+    return static_cast<MetavoxelGuide*>(visitation.info.inputValues.last().getInlineValue<SharedObjectPointer>().data());
+}
+
+void DefaultMetavoxelGuide::setUpChildVisitation(MetavoxelVisitation& visitation,
+        MetavoxelVisitation& nextVisitation, int index, float lodBase) {
+    for (int j = 0; j < visitation.inputNodes.size(); j++) {
+        MetavoxelNode* node = visitation.inputNodes.at(j);
+        const AttributeValue& parentValue = visitation.info.inputValues.at(j);
+        MetavoxelNode* child = (node && (visitation.info.size >= lodBase *
+            parentValue.getAttribute()->getLODThresholdMultiplier())) ? node->getChild(index) : NULL;
+        nextVisitation.info.inputValues[j] = ((nextVisitation.inputNodes[j] = child)) ?
+            child->getAttributeValue(parentValue.getAttribute()) : parentValue.getAttribute()->inherit(parentValue);
+    }
+    for (int j = 0; j < visitation.outputNodes.size(); j++) {
+        MetavoxelNode* node = visitation.outputNodes.at(j);
+        MetavoxelNode* child = (node && (visitation.info.size >= lodBase *
+            visitation.visitor.getOutputs().at(j)->getLODThresholdMultiplier())) ? node->getChild(index) : NULL;
+        nextVisitation.outputNodes[j] = child;
+    }
+    nextVisitation.info.minimum = getNextMinimum(visitation.info.minimum, nextVisitation.info.size, index);
+}
+
+void DefaultMetavoxelGuide::mergeChildVisitation(MetavoxelVisitation& visitation,
+        MetavoxelVisitation& nextVisitation, int i, int index) {
+    for (int j = 0; j < nextVisitation.outputNodes.size(); j++) {
+        OwnedAttributeValue& value = nextVisitation.info.outputValues[j];
+        if (!value.getAttribute()) {
+            continue;
+        }
+        // replace the child
+        OwnedAttributeValue& parentValue = visitation.info.outputValues[j];
+        if (!parentValue.getAttribute()) {
+            // shallow-copy the parent node on first change
+            parentValue = value;
+            MetavoxelNode*& node = visitation.outputNodes[j];
+            if (node) {
+                node = new MetavoxelNode(value.getAttribute(), node);
             } else {
-                // it's a leaf; we need to split it up
-                AttributeValue nodeValue = value.getAttribute()->inherit(node->getAttributeValue(value.getAttribute()));
-                for (int k = 1; k < MetavoxelNode::CHILD_COUNT; k++) {
-                    node->setChild((index + k) % MetavoxelNode::CHILD_COUNT, new MetavoxelNode(nodeValue));
-                }
+                // create leaf with inherited value
+                node = new MetavoxelNode(value.getAttribute()->inherit(visitation.getInheritedOutputValue(j)));
+            }
+        }
+        MetavoxelNode* node = visitation.outputNodes.at(j);
+        MetavoxelNode* child = node->getChild(i);
+        if (child) {
+            child->decrementReferenceCount(value.getAttribute());
+        } else {
+            // it's a leaf; we need to split it up
+            AttributeValue nodeValue = value.getAttribute()->inherit(node->getAttributeValue(value.getAttribute()));
+            for (int k = 1; k < MetavoxelNode::CHILD_COUNT; k++) {
+                node->setChild((index + k) % MetavoxelNode::CHILD_COUNT, new MetavoxelNode(nodeValue));
             }
-            node->setChild(index, nextVisitation.outputNodes.at(j));
-            value = AttributeValue();
         }
+        node->setChild(index, nextVisitation.outputNodes.at(j));
+        value = AttributeValue();
     }
+}
+
+void DefaultMetavoxelGuide::mergeChildren(MetavoxelVisitation& visitation) {
     for (int i = 0; i < visitation.outputNodes.size(); i++) {
         OwnedAttributeValue& value = visitation.info.outputValues[i];
         if (value.getAttribute()) {
@@ -1291,7 +1690,6 @@ bool DefaultMetavoxelGuide::guide(MetavoxelVisitation& visitation) {
             value = node->getAttributeValue(value.getAttribute()); 
         }
     }
-    return true;
 }
 
 ThrobbingMetavoxelGuide::ThrobbingMetavoxelGuide() : _rate(10.0) {
@@ -1455,8 +1853,7 @@ Spanner::Spanner() :
     _renderer(NULL),
     _placementGranularity(DEFAULT_PLACEMENT_GRANULARITY),
     _voxelizationGranularity(DEFAULT_VOXELIZATION_GRANULARITY),
-    _masked(false),
-    _lastVisit(0) {
+    _masked(false) {
 }
 
 void Spanner::setBounds(const Box& bounds) {
@@ -1486,10 +1883,13 @@ bool Spanner::blendAttributeValues(MetavoxelInfo& info, bool force) const {
 }
 
 bool Spanner::testAndSetVisited() {
-    if (_lastVisit == _visit) {
+    // visits may happen concurrently on different threads (as when encoding deltas in parallel), so each thread keeps
+    // its own record; nothing is shared, so nothing needs locking
+    QSet<const Spanner*>& visited = _visited.localData();
+    if (visited.contains(this)) {
         return false;
     }
-    _lastVisit = _visit;
+    visited.insert(this);
     return true;
 }
 
@@ -1517,7 +1917,7 @@ QByteArray Spanner::getRendererClassName() const {
     return "SpannerRendererer";
 }
 
-int Spanner::_visit = 0;
+QThreadStorage<QSet<const Spanner*> > Spanner::_visited;
 
 SpannerRenderer::SpannerRenderer() {
 }
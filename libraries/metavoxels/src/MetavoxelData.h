@@ -12,12 +12,16 @@
 #ifndef hifi_MetavoxelData_h
 #define hifi_MetavoxelData_h
 
+#include <QAtomicInt>
 #include <QBitArray>
 #include <QHash>
+#include <QMutex>
 #include <QSharedData>
 #include <QSharedPointer>
 #include <QScriptString>
 #include <QScriptValue>
+#include <QSet>
+#include <QThreadStorage>
 #include <QVector>
 
 #include <glm/glm.hpp>
@@ -46,6 +50,10 @@ public:
     
     bool isValid() const { return threshold > 0.0f; }
     
+    /// Returns a copy of this LOD with the position snapped to a grid of the specified spacing.  Viewers that send quantized
+    /// LODs to the server are more likely to share encoded deltas with one another.
+    MetavoxelLOD getQuantized(float granularity) const;
+    
     bool shouldSubdivide(const glm::vec3& minimum, float size, float multiplier = 1.0f) const;
     
     /// Checks whether the node or any of the nodes underneath it have had subdivision enabled as compared to the reference.
@@ -116,6 +124,7 @@ public:
 private:
 
     friend class MetavoxelVisitation;
+    friend class MetavoxelMemoryUsage;
    
     void incrementRootReferenceCounts();
     void decrementRootReferenceCounts();
@@ -157,6 +166,18 @@ public:
 
     static const int CHILD_COUNT = 8;
 
+    /// Allocates storage for a node from the shared node pool.
+    static void* operator new(size_t size);
+    
+    /// Returns a node's storage to the shared node pool.
+    static void operator delete(void* pointer, size_t size);
+    
+    /// Returns the number of nodes currently allocated across all threads.
+    static int getLiveNodeCount();
+    
+    /// Returns the number of bytes reserved by the node pool, including the storage of nodes that have been freed.
+    static qint64 getReservedBytes();
+    
     MetavoxelNode(const AttributeValue& attributeValue, const MetavoxelNode* copyChildren = NULL);
     MetavoxelNode(const AttributePointer& attribute, const MetavoxelNode* copy);
     
@@ -187,8 +208,11 @@ public:
     void writeSpannerDelta(const MetavoxelNode& reference, MetavoxelStreamState& state) const;
     void writeSpannerSubdivision(MetavoxelStreamState& state) const;
 
+    /// Returns the node's current reference count.
+    int getReferenceCount() const { return _referenceCount.load(); }
+    
     /// Increments the node's reference count.
-    void incrementReferenceCount() { _referenceCount++; }
+    void incrementReferenceCount() { _referenceCount.ref(); }
 
     /// Decrements the node's reference count.  If the resulting reference count is zero, destroys the node
     /// and calls delete this.
@@ -203,11 +227,39 @@ private:
     
     friend class MetavoxelVisitation;
     
-    int _referenceCount;
+    QAtomicInt _referenceCount;
     void* _attributeValue;
     MetavoxelNode* _children[CHILD_COUNT];
 };
 
+/// Tallies the memory used by one or more sets of metavoxel data.  Nodes shared between trees (or between parents within a
+/// tree) are counted only once.
+class MetavoxelMemoryUsage {
+public:
+    
+    MetavoxelMemoryUsage();
+    
+    /// Adds the nodes of the specified data that haven't already been counted.
+    void add(const MetavoxelData& data);
+    
+    /// Returns the number of distinct nodes counted.
+    int getNodeCount() const { return _visited.size(); }
+    
+    /// Returns the number of distinct nodes that are referenced more than once.
+    int getSharedNodeCount() const { return _sharedNodeCount; }
+    
+    /// Returns the number of bytes used by each attribute's nodes and their values.
+    const QHash<AttributePointer, qint64>& getAttributeBytes() const { return _attributeBytes; }
+    
+private:
+    
+    void add(const AttributePointer& attribute, const MetavoxelNode* node, qint64& bytes);
+    
+    QSet<const MetavoxelNode*> _visited;
+    int _sharedNodeCount;
+    QHash<AttributePointer, qint64> _attributeBytes;
+};
+
 /// Contains information about a metavoxel (explicit or procedural).
 class MetavoxelInfo {
 public:
@@ -261,6 +313,11 @@ public:
     
     float getMinimumLODThresholdMultiplier() const { return _minimumLODThresholdMultiplier; }
     
+    /// Checks whether the visitor may visit separate parts of the tree simultaneously on different threads.  Thread-safe
+    /// visitors must not rely on the order of visitation or on state shared between visits; those that return true
+    /// have the children of the root guided in parallel.
+    virtual bool isThreadSafe() const { return false; }
+    
     /// Prepares for a new tour of the metavoxel data.
     virtual void prepare();
     
@@ -365,7 +422,19 @@ public:
     
     Q_INVOKABLE DefaultMetavoxelGuide();
     
+    /// Returns the guide for the specified visitation (that is, the value of its guide attribute).
+    static MetavoxelGuide* getGuide(MetavoxelVisitation& visitation);
+    
     virtual bool guide(MetavoxelVisitation& visitation);
+
+private:
+    
+    static bool guideChildrenInParallel(MetavoxelVisitation& visitation, int encodedOrder, float lodBase);
+    
+    static void setUpChildVisitation(MetavoxelVisitation& visitation, MetavoxelVisitation& nextVisitation,
+        int index, float lodBase);
+    static void mergeChildVisitation(MetavoxelVisitation& visitation, MetavoxelVisitation& nextVisitation, int i, int index);
+    static void mergeChildren(MetavoxelVisitation& visitation);
 };
 
 /// A temporary test guide that just makes the existing voxels throb with delight.
@@ -448,8 +517,8 @@ class Spanner : public SharedObject {
     
 public:
     
-    /// Increments the value of the global visit counter.
-    static void incrementVisit() { _visit++; }
+    /// Starts a new visit on the current thread, forgetting the spanners visited on its last.
+    static void incrementVisit() { _visited.localData().clear(); }
     
     Spanner();
     
@@ -510,9 +579,8 @@ private:
     float _placementGranularity;
     float _voxelizationGranularity;
     bool _masked;
-    int _lastVisit; ///< the identifier of the last visit
     
-    static int _visit; ///< the global visit counter
+    static QThreadStorage<QSet<const Spanner*> > _visited; ///< the spanners visited on the current visit of each thread
 };
 
 /// Base class for objects that can render spanners.
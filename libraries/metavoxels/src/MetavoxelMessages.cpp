@@ -27,6 +27,7 @@ public:
     
     BoxSetEditVisitor(const BoxSetEdit& edit);
     
+    virtual bool isThreadSafe() const { return true; }
     virtual int visit(MetavoxelInfo& info);
 
 private:
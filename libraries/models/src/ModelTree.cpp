@@ -424,6 +424,7 @@ int ModelTree::processEditPacketData(PacketType packetType, const unsigned char*
             ModelItem newModel = ModelItem::fromEditPacket(editData, maxLength, processedBytes, this, isValid);
             if (isValid) {
                 storeModel(newModel, senderNode);
+                _lastEditPosition = newModel.getPosition();
                 if (newModel.isNewlyCreated()) {
                     notifyNewlyCreatedModel(newModel, senderNode);
                 }
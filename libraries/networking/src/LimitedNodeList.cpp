@@ -63,6 +63,7 @@ LimitedNodeList* LimitedNodeList::getInstance() {
 
 LimitedNodeList::LimitedNodeList(unsigned short socketListenPort, unsigned short dtlsListenPort) :
     _sessionUUID(),
+    _sessionLocalID(NULL_LOCAL_ID),
     _nodeHash(),
     _nodeHashMutex(QMutex::Recursive),
     _nodeSocket(this),
@@ -325,13 +326,36 @@ SharedNodePointer LimitedNodeList::nodeWithUUID(const QUuid& nodeUUID, bool bloc
     return node;
  }
 
+SharedNodePointer LimitedNodeList::nodeWithLocalID(LocalID localID) {
+    QMutexLocker locker(&_nodeHashMutex);
+    return localID < _localIDNodes.size() ? _localIDNodes.at(localID) : SharedNodePointer();
+}
+
 SharedNodePointer LimitedNodeList::sendingNodeForPacket(const QByteArray& packet) {
+    // verified packets carry the sender's local ID, which we can look up directly
+    if (!NON_VERIFIED_PACKETS.contains(packetTypeForPacket(packet))) {
+        return nodeWithLocalID(localIDFromPacketHeader(packet));
+    }
     QUuid nodeUUID = uuidFromPacketHeader(packet);
     
     // return the matching node, or NULL if there is no match
     return nodeWithUUID(nodeUUID);
 }
 
+void LimitedNodeList::setNodeLocalID(const SharedNodePointer& node, LocalID localID) {
+    LocalID oldLocalID = node->getLocalID();
+    if (oldLocalID != NULL_LOCAL_ID && oldLocalID < _localIDNodes.size() && _localIDNodes.at(oldLocalID) == node) {
+        _localIDNodes[oldLocalID].clear();
+    }
+    node->setLocalID(localID);
+    if (localID != NULL_LOCAL_ID) {
+        if (localID >= _localIDNodes.size()) {
+            _localIDNodes.resize(localID + 1);
+        }
+        _localIDNodes[localID] = node;
+    }
+}
+
 NodeHash LimitedNodeList::getNodeHash() {
     QMutexLocker locker(&_nodeHashMutex);
     return NodeHash(_nodeHash);
@@ -365,6 +389,7 @@ void LimitedNodeList::killNodeWithUUID(const QUuid& nodeUUID) {
 
 NodeHash::iterator LimitedNodeList::killNodeAtHashIterator(NodeHash::iterator& nodeItemToKill) {
     qDebug() << "Killed" << *nodeItemToKill.value();
+    setNodeLocalID(nodeItemToKill.value(), NULL_LOCAL_ID);
     emit nodeKilled(nodeItemToKill.value());
     return _nodeHash.erase(nodeItemToKill);
 }
@@ -378,7 +403,8 @@ void LimitedNodeList::processKillNode(const QByteArray& dataByteArray) {
 }
 
 SharedNodePointer LimitedNodeList::addOrUpdateNode(const QUuid& uuid, NodeType_t nodeType,
-                                            const HifiSockAddr& publicSocket, const HifiSockAddr& localSocket) {
+                                            const HifiSockAddr& publicSocket, const HifiSockAddr& localSocket,
+                                            LocalID localID) {
     _nodeHashMutex.lock();
     
     if (!_nodeHash.contains(uuid)) {
@@ -388,6 +414,7 @@ SharedNodePointer LimitedNodeList::addOrUpdateNode(const QUuid& uuid, NodeType_t
         SharedNodePointer newNodeSharedPointer(newNode, &QObject::deleteLater);
         
         _nodeHash.insert(newNode->getUUID(), newNodeSharedPointer);
+        setNodeLocalID(newNodeSharedPointer, localID);
         
         _nodeHashMutex.unlock();
         
@@ -397,6 +424,10 @@ SharedNodePointer LimitedNodeList::addOrUpdateNode(const QUuid& uuid, NodeType_t
 
         return newNodeSharedPointer;
     } else {
+        SharedNodePointer existingNode = _nodeHash.value(uuid);
+        if (localID != NULL_LOCAL_ID && existingNode->getLocalID() != localID) {
+            setNodeLocalID(existingNode, localID);
+        }
         _nodeHashMutex.unlock();
         
         return updateSocketsForNode(uuid, publicSocket, localSocket);
@@ -24,6 +24,7 @@
 #include <QtCore/QSet>
 #include <QtCore/QSettings>
 #include <QtCore/QSharedPointer>
+#include <QtCore/QVector>
 #include <QtNetwork/QHostAddress>
 #include <QtNetwork/QUdpSocket>
 
@@ -59,6 +60,10 @@ public:
     const QUuid& getSessionUUID() const { return _sessionUUID; }
     void setSessionUUID(const QUuid& sessionUUID);
     
+    /// Returns the local ID the domain server assigned to us, which identifies us in verified packet headers.
+    LocalID getSessionLocalID() const { return _sessionLocalID; }
+    void setSessionLocalID(LocalID sessionLocalID) { _sessionLocalID = sessionLocalID; }
+    
     QUdpSocket& getNodeSocket() { return _nodeSocket; }
     QUdpSocket& getDTLSSocket();
     
@@ -83,10 +88,12 @@ public:
     int size() const { return _nodeHash.size(); }
 
     SharedNodePointer nodeWithUUID(const QUuid& nodeUUID, bool blockingLock = true);
+    SharedNodePointer nodeWithLocalID(LocalID localID);
     SharedNodePointer sendingNodeForPacket(const QByteArray& packet);
     
     SharedNodePointer addOrUpdateNode(const QUuid& uuid, NodeType_t nodeType,
-                                      const HifiSockAddr& publicSocket, const HifiSockAddr& localSocket);
+                                      const HifiSockAddr& publicSocket, const HifiSockAddr& localSocket,
+                                      LocalID localID = NULL_LOCAL_ID);
     SharedNodePointer updateSocketsForNode(const QUuid& uuid,
                                            const HifiSockAddr& publicSocket, const HifiSockAddr& localSocket);
 
@@ -124,11 +131,16 @@ protected:
 
     NodeHash::iterator killNodeAtHashIterator(NodeHash::iterator& nodeItemToKill);
 
+    /// Points the local ID lookup at the node (or clears it, if the node has no local ID).  Caller must hold the hash mutex.
+    void setNodeLocalID(const SharedNodePointer& node, LocalID localID);
+
     
     void changeSendSocketBufferSize(int numSendBytes);
 
     QUuid _sessionUUID;
+    LocalID _sessionLocalID;
     NodeHash _nodeHash;
+    QVector<SharedNodePointer> _localIDNodes;
     QMutex _nodeHashMutex;
     QUdpSocket _nodeSocket;
     QUdpSocket* _dtlsSocket;
@@ -22,6 +22,7 @@
 
 #include "HifiSockAddr.h"
 #include "NodeData.h"
+#include "PacketHeaders.h"
 #include "SimpleMovingAverage.h"
 
 typedef quint8 NodeType_t;
@@ -58,6 +59,9 @@ public:
     const QUuid& getUUID() const { return _uuid; }
     void setUUID(const QUuid& uuid) { _uuid = uuid; }
 
+    LocalID getLocalID() const { return _localID; }
+    void setLocalID(LocalID localID) { _localID = localID; }
+
     quint64 getWakeTimestamp() const { return _wakeTimestamp; }
     void setWakeTimestamp(quint64 wakeTimestamp) { _wakeTimestamp = wakeTimestamp; }
 
@@ -107,6 +111,7 @@ private:
 
     NodeType_t _type;
     QUuid _uuid;
+    LocalID _localID;
     quint64 _wakeTimestamp;
     quint64 _lastHeardMicrostamp;
     HifiSockAddr _publicSocket;
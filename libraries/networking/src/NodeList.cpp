@@ -151,6 +151,13 @@ void NodeList::processNodeData(const HifiSockAddr& senderSockAddr, const QByteAr
             _domainHandler.parseDTLSRequirementPacket(packet);
             break;
         }
+        case PacketTypeJurisdictionSplit: {
+            // only the domain server can tell us who has taken over part of our jurisdiction
+            if (senderSockAddr == _domainHandler.getSockAddr()) {
+                emit receivedJurisdictionSplit(packet);
+            }
+            break;
+        }
         case PacketTypePing: {
             // send back a reply
             SharedNodePointer matchingNode = sendingNodeForPacket(packet);
@@ -205,6 +212,7 @@ void NodeList::reset() {
 
     // refresh the owner UUID to the NULL UUID
     setSessionUUID(QUuid());
+    setSessionLocalID(NULL_LOCAL_ID);
     
     // clear the domain connection information
     _domainHandler.clearConnectionInfo();
@@ -441,6 +449,7 @@ int NodeList::processDomainServerList(const QByteArray& packet) {
     qint8 nodeType;
     
     QUuid nodeUUID, connectionUUID;
+    LocalID nodeLocalID;
 
     HifiSockAddr nodePublicSocket;
     HifiSockAddr nodeLocalSocket;
@@ -448,14 +457,16 @@ int NodeList::processDomainServerList(const QByteArray& packet) {
     QDataStream packetStream(packet);
     packetStream.skipRawData(numBytesForPacketHeader(packet));
     
-    // pull our owner UUID from the packet, it's always the first thing
+    // pull our owner UUID and local ID from the packet, they're always the first thing
     QUuid newUUID;
-    packetStream >> newUUID;
+    LocalID newLocalID;
+    packetStream >> newUUID >> newLocalID;
     setSessionUUID(newUUID);
+    setSessionLocalID(newLocalID);
     
     // pull each node in the packet
     while(packetStream.device()->pos() < packet.size()) {
-        packetStream >> nodeType >> nodeUUID >> nodePublicSocket >> nodeLocalSocket;
+        packetStream >> nodeType >> nodeUUID >> nodePublicSocket >> nodeLocalSocket >> nodeLocalID;
 
         // if the public socket address is 0 then it's reachable at the same IP
         // as the domain server
@@ -463,7 +474,7 @@ int NodeList::processDomainServerList(const QByteArray& packet) {
             nodePublicSocket.setAddress(_domainHandler.getIP());
         }
 
-        SharedNodePointer node = addOrUpdateNode(nodeUUID, nodeType, nodePublicSocket, nodeLocalSocket);
+        SharedNodePointer node = addOrUpdateNode(nodeUUID, nodeType, nodePublicSocket, nodeLocalSocket, nodeLocalID);
         
         packetStream >> connectionUUID;
         node->setConnectionSecret(connectionUUID);
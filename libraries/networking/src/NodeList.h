@@ -87,6 +87,9 @@ public slots:
     void processAvailableDTLSDatagrams();
 signals:
     void limitOfSilentDomainCheckInsReached();
+    
+    /// Emitted when the domain server tells an octree server which node has been assigned part of its jurisdiction.
+    void receivedJurisdictionSplit(const QByteArray& packet);
 private:
     static NodeList* _sharedInstance;
 
@@ -12,6 +12,7 @@
 #include <math.h>
 
 #include <QtCore/QDebug>
+#include <QtCore/QtEndian>
 
 #include "NodeList.h"
 
@@ -48,26 +49,29 @@ int packArithmeticallyCodedValue(int value, char* destination) {
 PacketVersion versionForPacketType(PacketType type) {
     switch (type) {
         case PacketTypeAvatarData:
-            return 3;
+            return 4;
         case PacketTypeAvatarIdentity:
-            return 1;
+            return 2;
         case PacketTypeEnvironmentData:
-            return 1;
+            return 2;
         case PacketTypeParticleData:
-            return 1;
+            return 3;
         case PacketTypeDomainList:
         case PacketTypeDomainListRequest:
-            return 3;
+            return 4;
         case PacketTypeCreateAssignment:
         case PacketTypeRequestAssignment:
             return 2;
         case PacketTypeVoxelSet:
         case PacketTypeVoxelSetDestructive:
-            return 1;
+            return 2;
         case PacketTypeOctreeStats:
-            return 1;
+            return 2;
+        case PacketTypeMetavoxelData:
+            return 2;
         default:
-            return 0;
+            // verified packets went from a UUID and full hash to a local ID and auth tag
+            return NON_VERIFIED_PACKETS.contains(type) ? 0 : 1;
     }
 }
 
@@ -91,65 +95,93 @@ int populatePacketHeader(char* packet, PacketType type, const QUuid& connectionU
     
     char* position = packet + numTypeBytes + sizeof(PacketVersion);
     
-    QUuid packUUID = connectionUUID.isNull() ? LimitedNodeList::getInstance()->getSessionUUID() : connectionUUID;
-    
-    QByteArray rfcUUID = packUUID.toRfc4122();
-    memcpy(position, rfcUUID.constData(), NUM_BYTES_RFC4122_UUID);
-    position += NUM_BYTES_RFC4122_UUID;
-    
-    if (!NON_VERIFIED_PACKETS.contains(type)) {
-        // pack 16 bytes of zeros where the md5 hash will be placed one data is packed
-        memset(position, 0, NUM_BYTES_MD5_HASH);
-        position += NUM_BYTES_MD5_HASH;
+    if (NON_VERIFIED_PACKETS.contains(type)) {
+        QUuid packUUID = connectionUUID.isNull() ? LimitedNodeList::getInstance()->getSessionUUID() : connectionUUID;
+        
+        QByteArray rfcUUID = packUUID.toRfc4122();
+        memcpy(position, rfcUUID.constData(), NUM_BYTES_RFC4122_UUID);
+        position += NUM_BYTES_RFC4122_UUID;
+        
+    } else {
+        // verified packets identify us by our local ID, in network order like the domain list that hands it out
+        qToBigEndian(LimitedNodeList::getInstance()->getSessionLocalID(), reinterpret_cast<uchar*>(position));
+        position += sizeof(LocalID);
+        
+        // pack zeros where the authentication tag will be placed once data is packed
+        memset(position, 0, NUM_BYTES_AUTH_TAG);
+        position += NUM_BYTES_AUTH_TAG;
     }
     
     // return the number of bytes written for pointer pushing
     return position - packet;
 }
 
+static int numStaticBytesInPacketHeaderGivenPacketType(PacketType type) {
+    return NON_VERIFIED_PACKETS.contains(type) ? NUM_STATIC_HEADER_BYTES : NUM_VERIFIED_STATIC_HEADER_BYTES;
+}
+
 int numBytesForPacketHeader(const QByteArray& packet) {
-    // returns the number of bytes used for the type, version, and UUID
+    // returns the number of bytes used for the type, version, and UUID or local ID and tag
     return numBytesArithmeticCodingFromBuffer(packet.data())
-    + numHashBytesInPacketHeaderGivenPacketType(packetTypeForPacket(packet))
-    + NUM_STATIC_HEADER_BYTES;
+    + numStaticBytesInPacketHeaderGivenPacketType(packetTypeForPacket(packet));
 }
 
 int numBytesForPacketHeader(const char* packet) {
-    // returns the number of bytes used for the type, version, and UUID
+    // returns the number of bytes used for the type, version, and UUID or local ID and tag
     return numBytesArithmeticCodingFromBuffer(packet)
-    + numHashBytesInPacketHeaderGivenPacketType(packetTypeForPacket(packet))
-    + NUM_STATIC_HEADER_BYTES;
+    + numStaticBytesInPacketHeaderGivenPacketType(packetTypeForPacket(packet));
 }
 
 int numBytesForPacketHeaderGivenPacketType(PacketType type) {
     return (int) ceilf((float)type / 255)
-    + numHashBytesInPacketHeaderGivenPacketType(type)
-    + NUM_STATIC_HEADER_BYTES;
+    + numStaticBytesInPacketHeaderGivenPacketType(type);
 }
 
 int numHashBytesInPacketHeaderGivenPacketType(PacketType type) {
-    return (NON_VERIFIED_PACKETS.contains(type) ? 0 : NUM_BYTES_MD5_HASH);
+    return (NON_VERIFIED_PACKETS.contains(type) ? 0 : NUM_BYTES_AUTH_TAG);
 }
 
 QUuid uuidFromPacketHeader(const QByteArray& packet) {
+    if (!NON_VERIFIED_PACKETS.contains(packetTypeForPacket(packet))) {
+        SharedNodePointer sendingNode = LimitedNodeList::getInstance()->nodeWithLocalID(localIDFromPacketHeader(packet));
+        return sendingNode ? sendingNode->getUUID() : QUuid();
+    }
     return QUuid::fromRfc4122(packet.mid(numBytesArithmeticCodingFromBuffer(packet.data()) + sizeof(PacketVersion),
                                          NUM_BYTES_RFC4122_UUID));
 }
 
+LocalID localIDFromPacketHeader(const QByteArray& packet) {
+    if (NON_VERIFIED_PACKETS.contains(packetTypeForPacket(packet))) {
+        return NULL_LOCAL_ID;
+    }
+    int localIDOffset = numBytesArithmeticCodingFromBuffer(packet.data()) + sizeof(PacketVersion);
+    if (packet.size() < localIDOffset + (int)sizeof(LocalID)) {
+        return NULL_LOCAL_ID;
+    }
+    return qFromBigEndian<LocalID>(reinterpret_cast<const uchar*>(packet.constData()) + localIDOffset);
+}
+
 QByteArray hashFromPacketHeader(const QByteArray& packet) {
-    return packet.mid(numBytesForPacketHeader(packet) - NUM_BYTES_MD5_HASH, NUM_BYTES_MD5_HASH);
+    return packet.mid(numBytesForPacketHeader(packet) - NUM_BYTES_AUTH_TAG, NUM_BYTES_AUTH_TAG);
 }
 
 QByteArray hashForPacketAndConnectionUUID(const QByteArray& packet, const QUuid& connectionUUID) {
     return QCryptographicHash::hash(packet.mid(numBytesForPacketHeader(packet)) + connectionUUID.toRfc4122(),
-                                    QCryptographicHash::Md5);
+                                    QCryptographicHash::Md5).left(NUM_BYTES_AUTH_TAG);
 }
 
 void replaceHashInPacketGivenConnectionUUID(QByteArray& packet, const QUuid& connectionUUID) {
-    packet.replace(numBytesForPacketHeader(packet) - NUM_BYTES_MD5_HASH, NUM_BYTES_MD5_HASH,
+    packet.replace(numBytesForPacketHeader(packet) - NUM_BYTES_AUTH_TAG, NUM_BYTES_AUTH_TAG,
                    hashForPacketAndConnectionUUID(packet, connectionUUID));
 }
 
+void replaceLocalIDInPacketHeader(QByteArray& packet, LocalID localID) {
+    uchar localIDBytes[sizeof(LocalID)];
+    qToBigEndian(localID, localIDBytes);
+    packet.replace(numBytesArithmeticCodingFromBuffer(packet.data()) + sizeof(PacketVersion), sizeof(LocalID),
+                   reinterpret_cast<const char*>(localIDBytes), sizeof(LocalID));
+}
+
 PacketType packetTypeForPacket(const QByteArray& packet) {
     return (PacketType) arithmeticCodingValueFromBuffer(packet.data());
 }
@@ -66,6 +66,11 @@ enum PacketType {
     PacketTypeModelAddOrEdit,
     PacketTypeModelErase,
     PacketTypeModelAddResponse,
+    PacketTypeJurisdictionHandoffRequest,
+    PacketTypeJurisdictionHandoffData,
+    PacketTypeJurisdictionHandoffComplete,
+    PacketTypeOctreeReceiverReport,
+    PacketTypeJurisdictionSplit,
 };
 
 typedef char PacketVersion;
@@ -74,11 +79,23 @@ const QSet<PacketType> NON_VERIFIED_PACKETS = QSet<PacketType>()
     << PacketTypeDomainServerRequireDTLS << PacketTypeDomainConnectRequest
     << PacketTypeDomainList << PacketTypeDomainListRequest << PacketTypeDomainOAuthRequest
     << PacketTypeCreateAssignment << PacketTypeRequestAssignment << PacketTypeStunResponse
-    << PacketTypeNodeJsonStats << PacketTypeVoxelQuery << PacketTypeParticleQuery << PacketTypeModelQuery;
+    << PacketTypeNodeJsonStats << PacketTypeVoxelQuery << PacketTypeParticleQuery << PacketTypeModelQuery
+    << PacketTypeJurisdictionSplit;
+
+/// A short identifier assigned by the domain server to each node for the length of its session.  Verified packets carry
+/// the sender's local ID in place of its UUID, in network byte order.
+typedef quint16 LocalID;
+
+const LocalID NULL_LOCAL_ID = 0;
 
 const int NUM_BYTES_MD5_HASH = 16;
+
+/// Verified packets carry the first bytes of the MD5 hash of their contents and the connection secret.
+const int NUM_BYTES_AUTH_TAG = 8;
+
 const int NUM_STATIC_HEADER_BYTES = sizeof(PacketVersion) + NUM_BYTES_RFC4122_UUID;
-const int MAX_PACKET_HEADER_BYTES = sizeof(PacketType) + NUM_BYTES_MD5_HASH + NUM_STATIC_HEADER_BYTES;
+const int NUM_VERIFIED_STATIC_HEADER_BYTES = sizeof(PacketVersion) + sizeof(LocalID) + NUM_BYTES_AUTH_TAG;
+const int MAX_PACKET_HEADER_BYTES = sizeof(PacketType) + NUM_STATIC_HEADER_BYTES;
 
 PacketVersion versionForPacketType(PacketType type);
 
@@ -94,12 +111,19 @@ int numBytesForPacketHeader(const QByteArray& packet);
 int numBytesForPacketHeader(const char* packet);
 int numBytesForPacketHeaderGivenPacketType(PacketType type);
 
+/// Returns the sender's UUID.  For verified packets, this is looked up from the sender's local ID.
 QUuid uuidFromPacketHeader(const QByteArray& packet);
 
+/// Returns the sender's local ID, or NULL_LOCAL_ID for unverified packets (which carry the UUID instead).
+LocalID localIDFromPacketHeader(const QByteArray& packet);
+
 QByteArray hashFromPacketHeader(const QByteArray& packet);
 QByteArray hashForPacketAndConnectionUUID(const QByteArray& packet, const QUuid& connectionUUID);
 void replaceHashInPacketGivenConnectionUUID(QByteArray& packet, const QUuid& connectionUUID);
 
+/// Overwrites the sender's local ID in a verified packet's header, for a process speaking for more than one node.
+void replaceLocalIDInPacketHeader(QByteArray& packet, LocalID localID);
+
 PacketType packetTypeForPacket(const QByteArray& packet);
 PacketType packetTypeForPacket(const char* packet);
 
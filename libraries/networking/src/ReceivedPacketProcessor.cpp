@@ -13,37 +13,64 @@
 #include "ReceivedPacketProcessor.h"
 #include "SharedUtil.h"
 
+ReceivedPacketProcessor::ReceivedPacketProcessor(const QString& queueTimeMetricName) :
+    _queueTimeHistogram(queueTimeMetricName.isEmpty() ? NULL :
+        MetricsRegistry::getInstance()->getHistogram(queueTimeMetricName)) {
+}
+
 void ReceivedPacketProcessor::terminating() {
     _hasPackets.wakeAll();
 }
 
 void ReceivedPacketProcessor::queueReceivedPacket(const SharedNodePointer& destinationNode, const QByteArray& packet) {
     // Make sure our Node and NodeList knows we've heard from this node.
-    destinationNode->setLastHeardMicrostamp(usecTimestampNow());
+    quint64 now = usecTimestampNow();
+    destinationNode->setLastHeardMicrostamp(now);
 
     NetworkPacket networkPacket(destinationNode, packet);
     lock();
     _packets.push_back(networkPacket);
+    _queuedAt.push_back(now);
     unlock();
     
     // Make sure to  wake our actual processing thread because we  now have packets for it to process.
     _hasPackets.wakeAll();
 }
 
+void ReceivedPacketProcessor::wakeUp() {
+    // taking the mutex means that we can't slip in between the processing thread's check for work and its wait
+    QMutexLocker locker(&_waitingOnPacketsMutex);
+    _hasPackets.wakeAll();
+}
+
 bool ReceivedPacketProcessor::process() {
 
-    if (_packets.size() == 0) {
-        _waitingOnPacketsMutex.lock();
+    _waitingOnPacketsMutex.lock();
+    if (_packets.size() == 0 && !hasOtherWorkToProcess()) {
         _hasPackets.wait(&_waitingOnPacketsMutex);
-        _waitingOnPacketsMutex.unlock();
     }
-    while (_packets.size() > 0) {
-        lock(); // lock to make sure nothing changes on us
-        NetworkPacket& packet = _packets.front(); // get the oldest packet
-        NetworkPacket temporary = packet; // make a copy of the packet in case the vector is resized on us
-        _packets.erase(_packets.begin()); // remove the oldest packet
-        unlock(); // let others add to the packets
-        processPacket(temporary.getDestinationNode(), temporary.getByteArray()); // process our temporary copy
+    _waitingOnPacketsMutex.unlock();
+    // take everything that's queued in one go, so that others can keep adding packets while we process the batch
+    std::vector<NetworkPacket> packets;
+    std::vector<quint64> queuedAt;
+    lock();
+    packets.swap(_packets);
+    queuedAt.swap(_queuedAt);
+    unlock();
+    if (packets.size() > 0) {
+        if (_queueTimeHistogram) {
+            quint64 now = usecTimestampNow();
+            for (std::vector<quint64>::const_iterator it = queuedAt.begin(); it != queuedAt.end(); it++) {
+                _queueTimeHistogram->record(now - *it);
+            }
+        }
+        processPackets(packets);
     }
     return isStillRunning();  // keep running till they terminate us
 }
+
+void ReceivedPacketProcessor::processPackets(const std::vector<NetworkPacket>& packets) {
+    for (std::vector<NetworkPacket>::const_iterator packet = packets.begin(); packet != packets.end(); packet++) {
+        processPacket(packet->getDestinationNode(), packet->getByteArray());
+    }
+}
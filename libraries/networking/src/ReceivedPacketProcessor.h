@@ -14,6 +14,8 @@
 
 #include <QWaitCondition>
 
+#include <Metrics.h>
+
 #include "GenericThread.h"
 #include "NetworkPacket.h"
 
@@ -21,7 +23,9 @@
 class ReceivedPacketProcessor : public GenericThread {
     Q_OBJECT
 public:
-    ReceivedPacketProcessor() { }
+    /// \param queueTimeMetricName the name of the histogram in which to record how long packets wait in the queue, or
+    /// an empty string not to record it.  Each kind of processor uses its own, so that their latencies aren't mixed.
+    ReceivedPacketProcessor(const QString& queueTimeMetricName = QString());
 
     /// Add packet from network receive thread to the processing queue.
     /// \param sockaddr& senderAddress the address of the sender
@@ -44,6 +48,21 @@ protected:
     /// \thread "this" individual processing thread
     virtual void processPacket(const SharedNodePointer& sendingNode, const QByteArray& packet) = 0;
 
+    /// Callback for processing all of the packets drained from the queue at once. The default implementation calls
+    /// processPacket() for each packet in order; override it to share per-packet costs (like locks) across the batch.
+    /// \thread "this" individual processing thread
+    virtual void processPackets(const std::vector<NetworkPacket>& packets);
+
+    /// Returns whether there's work waiting besides packets.  If there is, process() goes ahead without waiting for
+    /// packets.  Override this along with process() to act on work queued some other way, and call wakeUp() when
+    /// queueing it.
+    /// \thread "this" individual processing thread
+    virtual bool hasOtherWorkToProcess() { return false; }
+
+    /// Wakes the processing thread if it's waiting for packets.
+    /// \thread any thread
+    void wakeUp();
+
     /// Implements generic processing behavior for this thread.
     virtual bool process();
 
@@ -52,6 +71,8 @@ protected:
 private:
 
     std::vector<NetworkPacket> _packets;
+    std::vector<quint64> _queuedAt; ///< when each of the packets was queued, in usecs
+    MetricsHistogram* _queueTimeHistogram; ///< NULL if not recording queue times
     QWaitCondition _hasPackets;
     QMutex _waitingOnPacketsMutex;
 };
@@ -10,9 +10,13 @@
 //
 
 #include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
 #include <QtCore/QJsonObject>
 #include <QtCore/QTimer>
 
+#include <Metrics.h>
+#include <Trace.h>
+
 #include "Logging.h"
 #include "ThreadedAssignment.h"
 
@@ -50,6 +54,13 @@ void ThreadedAssignment::commonInit(const QString& targetName, NodeType_t nodeTy
     connect(silentNodeRemovalTimer, SIGNAL(timeout()), nodeList, SLOT(removeSilentNodes()));
     silentNodeRemovalTimer->start(NODE_SILENCE_THRESHOLD_MSECS);
     
+    // write out the trace of recent frames when asked to by signal (kill -USR1)
+    Trace::dumpOnSignal(QDir::temp().filePath(targetName + "-trace.json"));
+    const int TRACE_DUMP_CHECK_MSECS = 1000;
+    QTimer* traceDumpTimer = new QTimer(this);
+    connect(traceDumpTimer, &QTimer::timeout, &Trace::dumpIfRequested);
+    traceDumpTimer->start(TRACE_DUMP_CHECK_MSECS);
+    
     if (shouldSendStats) {
         // send a stats packet every 1 second
         QTimer* statsTimer = new QTimer(this);
@@ -68,6 +79,8 @@ void ThreadedAssignment::addPacketStatsAndSendStatsPacket(QJsonObject &statsObje
     statsObject["packets_per_second"] = packetsPerSecond;
     statsObject["bytes_per_second"] = bytesPerSecond;
     
+    MetricsRegistry::getInstance()->addToStats(statsObject);
+    
     nodeList->sendStatsToDomainServer(statsObject);
 }
 
@@ -72,6 +72,13 @@ void JurisdictionMap::copyContents(unsigned char* rootCodeIn, const std::vector<
     init(rootCode, endNodes);
 }
 
+void JurisdictionMap::addEndNode(const unsigned char* octalCode) {
+    size_t bytes = bytesRequiredForCodeLength(numberOfThreeBitSectionsInCode(octalCode));
+    unsigned char* endNodeCode = new unsigned char[bytes];
+    memcpy(endNodeCode, octalCode, bytes);
+    _endNodes.push_back(endNodeCode);
+}
+
 void JurisdictionMap::copyContents(const JurisdictionMap& other) {
     _nodeType = other._nodeType;
     copyContents(other._rootOctalCode, other._endNodes);
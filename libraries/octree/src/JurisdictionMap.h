@@ -59,6 +59,9 @@ public:
 
     void copyContents(unsigned char* rootCodeIn, const std::vector<unsigned char*>& endNodesIn);
 
+    /// Adds a copy of the given octal code to our end nodes, carving its subtree out of this jurisdiction.
+    void addEndNode(const unsigned char* octalCode);
+
     int unpackFromMessage(const unsigned char* sourceBuffer, int availableBytes);
     int packIntoMessage(unsigned char* destinationBuffer, int availableBytes);
     
@@ -28,12 +28,42 @@ JurisdictionSender::JurisdictionSender(JurisdictionMap* map, NodeType_t type) :
 JurisdictionSender::~JurisdictionSender() {
 }
 
+void JurisdictionSender::setJurisdiction(JurisdictionMap* map) {
+    QMutexLocker locker(&_jurisdictionMutex);
+    _jurisdictionMap = map;
+}
+
+void JurisdictionSender::addEndNode(const unsigned char* octalCode) {
+    _jurisdictionMutex.lock();
+    if (_jurisdictionMap) {
+        _jurisdictionMap->addEndNode(octalCode);
+    }
+    _jurisdictionMutex.unlock();
+    
+    lockRequestingNodes();
+    foreach (const QUuid& nodeUUID, _nodesThatRequestedJurisdictions) {
+        _nodesRequestingJurisdictions.push(nodeUUID);
+    }
+    unlockRequestingNodes();
+    
+    // the sender thread may be waiting for a request; have it send the new map now
+    wakeUp();
+}
+
+bool JurisdictionSender::hasOtherWorkToProcess() {
+    lockRequestingNodes();
+    bool hasRequestingNodes = !_nodesRequestingJurisdictions.empty();
+    unlockRequestingNodes();
+    return hasRequestingNodes;
+}
+
 
 void JurisdictionSender::processPacket(const SharedNodePointer& sendingNode, const QByteArray& packet) {
     if (packetTypeForPacket(packet) == PacketTypeJurisdictionRequest) {
         if (sendingNode) {
             lockRequestingNodes();
             _nodesRequestingJurisdictions.push(sendingNode->getUUID());
+            _nodesThatRequestedJurisdictions.insert(sendingNode->getUUID());
             unlockRequestingNodes();
         }
     }
@@ -49,11 +79,13 @@ bool JurisdictionSender::process() {
         unsigned char* bufferOut = &buffer[0];
         ssize_t sizeOut = 0;
 
+        _jurisdictionMutex.lock();
         if (_jurisdictionMap) {
             sizeOut = _jurisdictionMap->packIntoMessage(bufferOut, MAX_PACKET_SIZE);
         } else {
             sizeOut = JurisdictionMap::packEmptyJurisdictionIntoMessage(getNodeType(), bufferOut, MAX_PACKET_SIZE);
         }
+        _jurisdictionMutex.unlock();
         int nodeCount = 0;
 
         lockRequestingNodes();
@@ -66,6 +98,8 @@ bool JurisdictionSender::process() {
             if (node && node->getActiveSocket()) {
                 _packetSender.queuePacketForSending(node, QByteArray(reinterpret_cast<char *>(bufferOut), sizeOut));
                 nodeCount++;
+            } else if (!node) {
+                _nodesThatRequestedJurisdictions.remove(nodeUUID);
             }
         }
         unlockRequestingNodes();
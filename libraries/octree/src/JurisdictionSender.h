@@ -14,6 +14,7 @@
 
 #include <queue>
 #include <QMutex>
+#include <QSet>
 
 #include <PacketSender.h>
 #include <ReceivedPacketProcessor.h>
@@ -30,7 +31,12 @@ public:
     JurisdictionSender(JurisdictionMap* map, NodeType_t type = NodeType::VoxelServer);
     ~JurisdictionSender();
 
-    void setJurisdiction(JurisdictionMap* map) { _jurisdictionMap = map; }
+    void setJurisdiction(JurisdictionMap* map);
+    
+    /// Carves the subtree at the given octal code out of our jurisdiction and pushes the updated jurisdiction to every
+    /// node that has asked for it, rather than waiting for their next request.
+    /// \thread any thread, typically the application thread
+    void addEndNode(const unsigned char* octalCode);
 
     virtual bool process();
 
@@ -39,6 +45,7 @@ public:
 
 protected:
     virtual void processPacket(const SharedNodePointer& sendingNode, const QByteArray& packet);
+    virtual bool hasOtherWorkToProcess();
 
     /// Locks all the resources of the thread.
     void lockRequestingNodes() { _requestingNodeMutex.lock(); }
@@ -49,8 +56,10 @@ protected:
 
 private:
     QMutex _requestingNodeMutex;
+    QMutex _jurisdictionMutex;
     JurisdictionMap* _jurisdictionMap;
     std::queue<QUuid> _nodesRequestingJurisdictions;
+    QSet<QUuid> _nodesThatRequestedJurisdictions;
     NodeType_t _nodeType;
     
     PacketSender _packetSender;
@@ -0,0 +1,138 @@
+//
+//  OcclusionBuffer.cpp
+//  libraries/octree/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <cfloat>
+
+#include "OcclusionBuffer.h"
+#include "ViewFrustum.h"
+
+OcclusionBuffer::OcclusionBuffer() {
+    int offset = 0;
+    for (int level = 0; level < LEVEL_COUNT; level++) {
+        _levelOffsets[level] = offset;
+        int size = RESOLUTION >> level;
+        offset += size * size;
+    }
+    clear();
+}
+
+void OcclusionBuffer::clear() {
+    const int CELL_COUNT = sizeof(_depths) / sizeof(_depths[0]);
+    for (int i = 0; i < CELL_COUNT; i++) {
+        _depths[i] = FLT_MAX;
+    }
+}
+
+/// Returns the cell of the finest level containing a projected coordinate, clamped to the screen.
+static int getCellCoordinate(float projected) {
+    return glm::clamp((int)((projected + 1.0f) * 0.5f * OcclusionBuffer::RESOLUTION), 0,
+        OcclusionBuffer::RESOLUTION - 1);
+}
+
+/// Returns the projected coordinate of the lower edge of a cell of the finest level.
+static float getCellEdge(int cell) {
+    return cell * (2.0f / OcclusionBuffer::RESOLUTION) - 1.0f;
+}
+
+bool OcclusionBuffer::checkBox(const ViewFrustum& viewFrustum, const AABox& box, bool addIfVisible) {
+    OctreeProjectedPolygon polygon = viewFrustum.getProjectedPolygon(box);
+    if (!polygon.getAllInView() || polygon.getVertexCount() == 0) {
+        return false;
+    }
+    int minX = getCellCoordinate(polygon.getMinX());
+    int minY = getCellCoordinate(polygon.getMinY());
+    int maxX = getCellCoordinate(polygon.getMaxX());
+    int maxY = getCellCoordinate(polygon.getMaxY());
+
+    // find the level at which the bounds fit within a two by two block of cells, and check that block; if that fails,
+    // the level below (at most four by four) may still show the box to be hidden
+    const glm::vec3& position = viewFrustum.getPosition();
+    float nearestDistance = glm::distance(position, glm::clamp(position, box.getCorner(), box.calcTopFarLeft()));
+    int level = 0;
+    while ((maxX >> level) - (minX >> level) > 1 || (maxY >> level) - (minY >> level) > 1) {
+        level++;
+    }
+    if (allCellsNearer(level, minX >> level, minY >> level, maxX >> level, maxY >> level, nearestDistance) ||
+            (level > 0 && allCellsNearer(level - 1, minX >> (level - 1), minY >> (level - 1),
+                maxX >> (level - 1), maxY >> (level - 1), nearestDistance))) {
+        return true;
+    }
+    if (!addIfVisible) {
+        return false;
+    }
+
+    // the box covers the cells whose corners are all within its projection, out to its furthest point
+    glm::vec3 furthestPoint;
+    viewFrustum.getFurthestPointFromCamera(box, furthestPoint);
+    float furthestDistance = glm::distance(position, furthestPoint);
+    const int MAX_CORNERS = RESOLUTION + 1;
+    bool rowInside[2][MAX_CORNERS];
+    int coveredMinX = RESOLUTION, coveredMinY = RESOLUTION, coveredMaxX = -1, coveredMaxY = -1;
+    for (int y = minY; y <= maxY + 1; y++) {
+        bool* inside = rowInside[y & 1];
+        bool* insideBelow = rowInside[(y - 1) & 1];
+        for (int x = minX; x <= maxX + 1; x++) {
+            inside[x - minX] = polygon.pointInside(glm::vec2(getCellEdge(x), getCellEdge(y)));
+        }
+        if (y == minY) {
+            continue;
+        }
+        for (int x = minX; x <= maxX; x++) {
+            int corner = x - minX;
+            if (inside[corner] && inside[corner + 1] && insideBelow[corner] && insideBelow[corner + 1]) {
+                float& depth = getCell(0, x, y - 1);
+                depth = glm::min(depth, furthestDistance);
+                coveredMinX = glm::min(coveredMinX, x);
+                coveredMinY = glm::min(coveredMinY, y - 1);
+                coveredMaxX = glm::max(coveredMaxX, x);
+                coveredMaxY = glm::max(coveredMaxY, y - 1);
+            }
+        }
+    }
+    if (coveredMaxX != -1) {
+        updatePyramid(coveredMinX, coveredMinY, coveredMaxX, coveredMaxY);
+    }
+    return false;
+}
+
+bool OcclusionBuffer::allCellsNearer(int level, int minX, int minY, int maxX, int maxY, float distance) {
+    // the usual case is a two by two block, which we compare all at once
+    if (maxX - minX <= 1 && maxY - minY <= 1) {
+        glm::vec4 depths(getCell(level, minX, minY), getCell(level, maxX, minY),
+            getCell(level, minX, maxY), getCell(level, maxX, maxY));
+        return glm::all(glm::lessThan(depths, glm::vec4(distance)));
+    }
+    for (int y = minY; y <= maxY; y++) {
+        for (int x = minX; x <= maxX; x++) {
+            if (!(getCell(level, x, y) < distance)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void OcclusionBuffer::updatePyramid(int minX, int minY, int maxX, int maxY) {
+    for (int level = 1; level < LEVEL_COUNT; level++) {
+        minX >>= 1;
+        minY >>= 1;
+        maxX >>= 1;
+        maxY >>= 1;
+        for (int y = minY; y <= maxY; y++) {
+            for (int x = minX; x <= maxX; x++) {
+                int childX = x << 1;
+                int childY = y << 1;
+                getCell(level, x, y) = glm::max(
+                    glm::max(getCell(level - 1, childX, childY), getCell(level - 1, childX + 1, childY)),
+                    glm::max(getCell(level - 1, childX, childY + 1), getCell(level - 1, childX + 1, childY + 1)));
+            }
+        }
+    }
+}
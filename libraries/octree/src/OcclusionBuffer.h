@@ -0,0 +1,56 @@
+//
+//  OcclusionBuffer.h
+//  libraries/octree/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_OcclusionBuffer_h
+#define hifi_OcclusionBuffer_h
+
+#include "AABox.h"
+
+class ViewFrustum;
+
+/// A low resolution hierarchical depth buffer for occlusion culling octree elements while they're encoded nearest
+/// first.  Each cell holds the furthest distance at which something added so far fully covers it, and each level of
+/// the pyramid holds the maximum of the four cells below it, so that whether a box is hidden can usually be decided by
+/// comparing its nearest distance against the two-by-two block of cells at the level where its screen bounds fit.
+class OcclusionBuffer {
+public:
+
+    static const int RESOLUTION_BITS = 6;
+    static const int RESOLUTION = 1 << RESOLUTION_BITS; ///< cells across the finest level
+    static const int LEVEL_COUNT = RESOLUTION_BITS + 1;
+
+    OcclusionBuffer();
+
+    /// Forgets everything added so far.
+    void clear();
+
+    /// Checks whether a box is hidden by what's been added.  Boxes that aren't entirely in front of the camera are
+    /// never considered hidden, nor added.
+    /// \param box the box, in meters
+    /// \param addIfVisible if true and the box isn't hidden, add it (as a solid box) to hide what's behind it
+    /// \return true if the box is hidden
+    bool checkBox(const ViewFrustum& viewFrustum, const AABox& box, bool addIfVisible);
+
+private:
+
+    float& getCell(int level, int x, int y) {
+        return _depths[_levelOffsets[level] + (y << (RESOLUTION_BITS - level)) + x]; }
+
+    /// Checks whether all the cells in a range at the given level are nearer than a distance.
+    bool allCellsNearer(int level, int minX, int minY, int maxX, int maxY, float distance);
+
+    /// Recomputes the coarser levels over a range of cells at the finest level.
+    void updatePyramid(int minX, int minY, int maxX, int maxY);
+
+    int _levelOffsets[LEVEL_COUNT];
+    float _depths[(((1 << (2 * LEVEL_COUNT)) - 1) / 3)];
+};
+
+#endif // hifi_OcclusionBuffer_h
@@ -29,7 +29,7 @@
 
 //#include "Tags.h"
 
-#include "CoverageMap.h"
+#include "OcclusionBuffer.h"
 #include "OctreeConstants.h"
 #include "OctreeElementBag.h"
 #include "Octree.h"
@@ -45,7 +45,8 @@ Octree::Octree(bool shouldReaverage) :
     _shouldReaverage(shouldReaverage),
     _stopImport(false),
     _lock(),
-    _isViewing(false) 
+    _isViewing(false),
+    _lastEditPosition(0.0f, 0.0f, 0.0f)
 {
 }
 
@@ -915,9 +916,13 @@ int Octree::encodeTreeBitstream(OctreeElement* element,
     }
 
     // If we're at a element that is out of view, then we can return, because no nodes below us will be in view!
-    if (params.viewFrustum && !element->isInView(*params.viewFrustum)) {
-        params.stopReason = EncodeBitstreamParams::OUT_OF_VIEW;
-        return bytesWritten;
+    ViewFrustum::location locationThisView = ViewFrustum::INSIDE; // caller can pass NULL if they want everything
+    if (params.viewFrustum) {
+        locationThisView = element->inFrustum(*params.viewFrustum);
+        if (locationThisView == ViewFrustum::OUTSIDE) {
+            params.stopReason = EncodeBitstreamParams::OUT_OF_VIEW;
+            return bytesWritten;
+        }
     }
 
     // write the octal code
@@ -955,10 +960,8 @@ int Octree::encodeTreeBitstream(OctreeElement* element,
         params.stats->traversed(element);
     }
 
-    ViewFrustum::location parentLocationThisView = ViewFrustum::INTERSECT; // assume parent is in view, but not fully
-
     int childBytesWritten = encodeTreeBitstreamRecursion(element, packetData, bag, params,
-                                                            currentEncodeLevel, parentLocationThisView);
+                                                            currentEncodeLevel, locationThisView, ALL_FRUSTUM_PLANES);
 
     // if childBytesWritten == 1 then something went wrong... that's not possible
     assert(childBytesWritten != 1);
@@ -991,7 +994,7 @@ int Octree::encodeTreeBitstream(OctreeElement* element,
 int Octree::encodeTreeBitstreamRecursion(OctreeElement* element,
                                             OctreePacketData* packetData, OctreeElementBag& bag,
                                             EncodeBitstreamParams& params, int& currentEncodeLevel,
-                                            const ViewFrustum::location& parentLocationThisView) const {
+                                            ViewFrustum::location nodeLocationThisView, unsigned char planeMask) const {
     // How many bytes have we written so far at this level;
     int bytesAtThisLevel = 0;
 
@@ -1022,8 +1025,6 @@ int Octree::encodeTreeBitstreamRecursion(OctreeElement* element,
             return bytesAtThisLevel;
         }
     }
-    
-    ViewFrustum::location nodeLocationThisView = ViewFrustum::INSIDE; // assume we're inside
 
     // caller can pass NULL as viewFrustum if they want everything
     if (params.viewFrustum) {
@@ -1040,14 +1041,8 @@ int Octree::encodeTreeBitstreamRecursion(OctreeElement* element,
             return bytesAtThisLevel;
         }
 
-        // if the parent isn't known to be INSIDE, then it must be INTERSECT, and we should double check to see
-        // if we are INSIDE, INTERSECT, or OUTSIDE
-        if (parentLocationThisView != ViewFrustum::INSIDE) {
-            assert(parentLocationThisView != ViewFrustum::OUTSIDE); // we shouldn't be here if our parent was OUTSIDE!
-            nodeLocationThisView = element->inFrustum(*params.viewFrustum);
-        }
-
-        // If we're at a element that is out of view, then we can return, because no nodes below us will be in view!
+        // our location was found by our caller, along with those of our siblings (or by encodeTreeBitstream, for the
+        // top element); if we're out of view, then we can return, because no nodes below us will be in view!
         // although technically, we really shouldn't ever be here, because our callers shouldn't be calling us if
         // we're out of view
         if (nodeLocationThisView == ViewFrustum::OUTSIDE) {
@@ -1114,24 +1109,12 @@ int Octree::encodeTreeBitstreamRecursion(OctreeElement* element,
         if (params.wantOcclusionCulling && !element->isLeaf()) {
             AABox voxelBox = element->getAABox();
             voxelBox.scale(TREE_SCALE);
-            OctreeProjectedPolygon* voxelPolygon = new OctreeProjectedPolygon(params.viewFrustum->getProjectedPolygon(voxelBox));
-
-            // In order to check occlusion culling, the shadow has to be "all in view" otherwise, we will ignore occlusion
-            // culling and proceed as normal
-            if (voxelPolygon->getAllInView()) {
-                CoverageMapStorageResult result = params.map->checkMap(voxelPolygon, false);
-                delete voxelPolygon; // cleanup
-                if (result == OCCLUDED) {
-                    if (params.stats) {
-                        params.stats->skippedOccluded(element);
-                    }
-                    params.stopReason = EncodeBitstreamParams::OCCLUDED;
-                    return bytesAtThisLevel;
+            if (params.occlusionBuffer->checkBox(*params.viewFrustum, voxelBox, false)) {
+                if (params.stats) {
+                    params.stats->skippedOccluded(element);
                 }
-            } else {
-                // If this shadow wasn't "all in view" then we ignored it for occlusion culling, but
-                // we do need to clean up memory and proceed as normal...
-                delete voxelPolygon;
+                params.stopReason = EncodeBitstreamParams::OCCLUDED;
+                return bytesAtThisLevel;
             }
         }
     }
@@ -1146,6 +1129,7 @@ int Octree::encodeTreeBitstreamRecursion(OctreeElement* element,
     unsigned char childrenExistInTreeBits = 0;
     unsigned char childrenExistInPacketBits = 0;
     unsigned char childrenColoredBits = 0;
+    unsigned char childrenWereInViewBits = 0;
 
     // Make our local buffer large enough to handle writing at this level in case we need to.
     LevelDetails thisLevelKey = packetData->startLevel();
@@ -1159,6 +1143,16 @@ int Octree::encodeTreeBitstreamRecursion(OctreeElement* element,
     int indexOfChildren[NUMBER_OF_CHILDREN] = { 0, 0, 0, 0, 0, 0, 0, 0 };
     int currentCount = 0;
 
+    // find the locations and distances of all the children at once; if we're fully in view, then there are no planes
+    // left to test, and they all come out fully in view too
+    ChildrenInView children;
+    if (params.viewFrustum) {
+        AABox box = element->getAABox();
+        box.scale(TREE_SCALE);
+        params.viewFrustum->classifyChildren(box, (nodeLocationThisView == ViewFrustum::INSIDE) ? 0 : planeMask,
+            children);
+    }
+
     for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
         OctreeElement* childElement = element->getChildAtIndex(i);
 
@@ -1178,7 +1172,7 @@ int Octree::encodeTreeBitstreamRecursion(OctreeElement* element,
 
         if (params.wantOcclusionCulling) {
             if (childElement) {
-                float distance = params.viewFrustum ? childElement->distanceToCamera(*params.viewFrustum) : 0;
+                float distance = params.viewFrustum ? children.distances[i] : 0;
 
                 currentCount = insertIntoSortedArrays((void*)childElement, distance, i,
                                                       (void**)&sortedChildren, (float*)&distancesToChildren,
@@ -1206,9 +1200,7 @@ int Octree::encodeTreeBitstreamRecursion(OctreeElement* element,
 
         bool childIsInView  = (childElement && 
                 ( !params.viewFrustum || // no view frustum was given, everything is assumed in view
-                  (nodeLocationThisView == ViewFrustum::INSIDE) || // parent was fully in view, we can assume ALL children are
-                  (nodeLocationThisView == ViewFrustum::INTERSECT && 
-                        childElement->isInView(*params.viewFrustum)) // the parent intersects and the child is in view
+                  children.locations[originalIndex] != ViewFrustum::OUTSIDE // classified with its siblings, above
                 ));
 
         if (!childIsInView) {
@@ -1243,38 +1235,18 @@ int Octree::encodeTreeBitstreamRecursion(OctreeElement* element,
 
                 // If the user also asked for occlusion culling, check if this element is occluded
                 if (params.wantOcclusionCulling && childElement->isLeaf()) {
-                    // Don't check occlusion here, just add them to our distance ordered array...
-
+                    // leaves that aren't hidden are added to the buffer, to hide what's behind them; since children
+                    // are visited nearest first, what they hide is mostly still to come
                     AABox voxelBox = childElement->getAABox();
                     voxelBox.scale(TREE_SCALE);
-                    OctreeProjectedPolygon* voxelPolygon = new OctreeProjectedPolygon(
-                                params.viewFrustum->getProjectedPolygon(voxelBox));
-
-                    // In order to check occlusion culling, the shadow has to be "all in view" otherwise, we ignore occlusion
-                    // culling and proceed as normal
-                    if (voxelPolygon->getAllInView()) {
-                        CoverageMapStorageResult result = params.map->checkMap(voxelPolygon, true);
-
-                        // In all cases where the shadow wasn't stored, we need to free our own memory.
-                        // In the case where it is stored, the CoverageMap will free memory for us later.
-                        if (result != STORED) {
-                            delete voxelPolygon;
-                        }
-
-                        // If while attempting to add this voxel's shadow, we determined it was occluded, then
-                        // we don't need to process it further and we can exit early.
-                        if (result == OCCLUDED) {
-                            childIsOccluded = true;
-                        }
-                    } else {
-                        delete voxelPolygon;
-                    }
+                    childIsOccluded = params.occlusionBuffer->checkBox(*params.viewFrustum, voxelBox, true);
                 } // wants occlusion culling & isLeaf()
 
 
                 bool shouldRender = !params.viewFrustum
                                     ? true
-                                    : childElement->calculateShouldRender(params.viewFrustum,
+                                    : childElement->shouldRenderAtDistance(
+                                                    children.furthestDistances[originalIndex],
                                                     params.octreeElementSizeScale, params.boundaryLevelAdjust);
 
                 // track some stats
@@ -1313,6 +1285,9 @@ int Octree::encodeTreeBitstreamRecursion(OctreeElement* element,
 
                         childrenColoredBits += (1 << (7 - originalIndex));
                         inViewWithColorCount++;
+                        if (childWasInView) {
+                            childrenWereInViewBits += (1 << (7 - originalIndex));
+                        }
                     } else {
                         // otherwise just track stats of the items we discarded
                         // don't need to check childElement here, because we can't get here with no childElement
@@ -1346,6 +1321,7 @@ int Octree::encodeTreeBitstreamRecursion(OctreeElement* element,
                 OctreeElement* childElement = element->getChildAtIndex(i);
                 if (childElement) {
                     int bytesBeforeChild = packetData->getUncompressedSize();
+                    params.elementWasInView = oneAtBit(childrenWereInViewBits, i);
                     continueThisLevel = childElement->appendElementData(packetData, params);
                     int bytesAfterChild = packetData->getUncompressedSize();
 
@@ -1436,8 +1412,9 @@ int Octree::encodeTreeBitstreamRecursion(OctreeElement* element,
                 // This only applies in the view frustum case, in other cases, like file save and copy/past where
                 // no viewFrustum was requested, we still want to recurse the child tree.
                 if (!params.viewFrustum || !oneAtBit(childrenColoredBits, originalIndex)) {
-                    childTreeBytesOut = encodeTreeBitstreamRecursion(childElement, packetData, bag, params, 
-                                                                            thisLevel, nodeLocationThisView);
+                    childTreeBytesOut = encodeTreeBitstreamRecursion(childElement, packetData, bag, params, thisLevel,
+                        params.viewFrustum ? children.locations[originalIndex] : ViewFrustum::INSIDE,
+                        params.viewFrustum ? children.planeMasks[originalIndex] : 0);
                 }
 
                 // remember this for reshuffling
@@ -1588,7 +1565,7 @@ bool Octree::readFromSVOFile(const char* fileName) {
                 dataLength -= sizeof(expectedType);
                 PacketVersion expectedVersion = versionForPacketType(expectedType);
                 PacketVersion gotVersion = *dataAt;
-                if (gotVersion == expectedVersion) {
+                if (canProcessVersion(gotVersion)) {
                     dataAt += sizeof(expectedVersion);
                     dataLength -= sizeof(expectedVersion);
                     fileOk = true;
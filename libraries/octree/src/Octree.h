@@ -15,7 +15,7 @@
 #include <set>
 #include <SimpleMovingAverage.h>
 
-class CoverageMap;
+class OcclusionBuffer;
 class ReadBitstreamToTreeParams;
 class Octree;
 class OctreeElement;
@@ -63,7 +63,7 @@ const quint64 IGNORE_LAST_SENT  = 0;
 
 #define IGNORE_SCENE_STATS       NULL
 #define IGNORE_VIEW_FRUSTUM      NULL
-#define IGNORE_COVERAGE_MAP      NULL
+#define IGNORE_OCCLUSION_BUFFER  NULL
 #define IGNORE_JURISDICTION_MAP  NULL
 
 class EncodeBitstreamParams {
@@ -82,9 +82,13 @@ public:
     quint64 lastViewFrustumSent;
     bool forceSendScene;
     OctreeSceneStats* stats;
-    CoverageMap* map;
+    OcclusionBuffer* occlusionBuffer;
     JurisdictionMap* jurisdictionMap;
 
+    // set by the encode process before appending an element's data: whether the element was in the last view frustum,
+    // so that a delta encoding client was already sent its contents as of lastViewFrustumSent
+    bool elementWasInView;
+
     // output hints from the encode process
     typedef enum {
         UNKNOWN,
@@ -109,7 +113,7 @@ public:
         bool deltaViewFrustum = false,
         const ViewFrustum* lastViewFrustum = IGNORE_VIEW_FRUSTUM,
         bool wantOcclusionCulling = NO_OCCLUSION_CULLING,
-        CoverageMap* map = IGNORE_COVERAGE_MAP,
+        OcclusionBuffer* occlusionBuffer = IGNORE_OCCLUSION_BUFFER,
         int boundaryLevelAdjust = NO_BOUNDARY_ADJUST,
         float octreeElementSizeScale = DEFAULT_OCTREE_SIZE_SCALE,
         quint64 lastViewFrustumSent = IGNORE_LAST_SENT,
@@ -130,8 +134,9 @@ public:
             lastViewFrustumSent(lastViewFrustumSent),
             forceSendScene(forceSendScene),
             stats(stats),
-            map(map),
+            occlusionBuffer(occlusionBuffer),
             jurisdictionMap(jurisdictionMap),
+            elementWasInView(false),
             stopReason(UNKNOWN)
     {}
 
@@ -200,10 +205,16 @@ public:
     // own definition. Implement these to allow your octree based server to support editing
     virtual bool getWantSVOfileVersions() const { return false; }
     virtual PacketType expectedDataPacketType() const { return PacketTypeUnknown; }
+    /// Checks whether SVO files written with the given version of the data packet type can be read.
+    virtual bool canProcessVersion(PacketVersion thisVersion) const {
+        return thisVersion == versionForPacketType(expectedDataPacketType()); }
     virtual bool handlesEditPacketType(PacketType packetType) const { return false; }
     virtual int processEditPacketData(PacketType packetType, const unsigned char* packetData, int packetLength,
                     const unsigned char* editData, int maxLength, const SharedNodePointer& sourceNode) { return 0; }
 
+    /// Returns the position (in tree units) of the most recent edit applied by processEditPacketData(), which servers use
+    /// to attribute edit load to the regions of their jurisdiction.
+    const glm::vec3& getLastEditPosition() const { return _lastEditPosition; }
 
     virtual void update() { }; // nothing to do by default
 
@@ -318,7 +329,7 @@ protected:
     int encodeTreeBitstreamRecursion(OctreeElement* element,
                                      OctreePacketData* packetData, OctreeElementBag& bag,
                                      EncodeBitstreamParams& params, int& currentEncodeLevel,
-                                     const ViewFrustum::location& parentLocationThisView) const;
+                                     ViewFrustum::location nodeLocationThisView, unsigned char planeMask) const;
 
     static bool countOctreeElementsOperation(OctreeElement* element, void* extraData);
 
@@ -337,6 +348,8 @@ protected:
     
     /// This tree is receiving inbound viewer datagrams.
     bool _isViewing;
+    
+    glm::vec3 _lastEditPosition;
 };
 
 float boundaryDistanceForRenderLevel(unsigned int renderLevel, float voxelSizeScale);
@@ -123,6 +123,11 @@ public:
 
     bool calculateShouldRender(const ViewFrustum* viewFrustum, 
                 float voxelSizeScale = DEFAULT_OCTREE_SIZE_SCALE, int boundaryLevelAdjust = 0) const;
+
+    /// Like calculateShouldRender, given the distance from the camera to the furthest corner (in meters), as found for
+    /// all the children of an element at once by ViewFrustum::classifyChildren.
+    bool shouldRenderAtDistance(float furthestDistance,
+                float voxelSizeScale = DEFAULT_OCTREE_SIZE_SCALE, int boundaryLevelAdjust = 0) const;
     
     // points are assumed to be in Voxel Coordinates (not TREE_SCALE'd)
     float distanceSquareToPoint(const glm::vec3& point) const; // when you don't need the actual distance, use this.
@@ -239,5 +239,7 @@ int OctreeHeadlessViewer::parseOctreeStats(const QByteArray& packet, const Share
 
 void OctreeHeadlessViewer::trackIncomingOctreePacket(const QByteArray& packet, 
                                 const SharedNodePointer& sendingNode, bool wasStatsPacket) {
-                                
+    // one reporter covers all the viewers, since it keeps its reports by server
+    static OctreeReceiverReporter receiverReporter;
+    receiverReporter.trackIncomingOctreePacket(packet, sendingNode);
 }
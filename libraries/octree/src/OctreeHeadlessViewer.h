@@ -19,6 +19,7 @@
 #include "Octree.h"
 #include "OctreeConstants.h"
 #include "OctreeQuery.h"
+#include "OctreeReceiverReport.h"
 #include "OctreeRenderer.h"
 #include "OctreeSceneStats.h"
 #include "Octree.h"
@@ -0,0 +1,125 @@
+//
+//  OctreeReceiverReport.cpp
+//  libraries/octree/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <algorithm>
+#include <limits>
+
+#include <QtCore/QDataStream>
+
+#include <PacketHeaders.h>
+#include <SharedUtil.h>
+
+#include "OctreeReceiverReport.h"
+
+const quint64 OctreeReceiverReport::REPORT_INTERVAL_USECS = 250 * 1000;
+
+OctreeReceiverReport::OctreeReceiverReport() :
+    _intervalStart(usecTimestampNow()),
+    _intervalUsecs(0),
+    _bytesReceived(0),
+    _receivedRanges(),
+    _minFlightTimeUsecs(std::numeric_limits<int>::max()),
+    _averageFlightTimeUsecs(0),
+    _totalFlightTimeUsecs(0),
+    _flightTimeSamples(0)
+{
+}
+
+void OctreeReceiverReport::packetReceived(OCTREE_PACKET_SEQUENCE sequence, int flightTimeUsecs, int packetSize) {
+    _bytesReceived += packetSize;
+
+    _minFlightTimeUsecs = std::min(_minFlightTimeUsecs, flightTimeUsecs);
+    _totalFlightTimeUsecs += flightTimeUsecs;
+    _flightTimeSamples++;
+
+    // the common case is the next packet in order, which extends the last range
+    if (!_receivedRanges.isEmpty() && (OCTREE_PACKET_SEQUENCE)(sequence - _receivedRanges.last().second) == 1) {
+        _receivedRanges.last().second = sequence;
+        return;
+    }
+
+    // the server resends a sequence number when it suppresses a duplicate packet, so ignore anything we already have
+    foreach (const OctreeSequenceRange& range, _receivedRanges) {
+        if ((OCTREE_PACKET_SEQUENCE)(sequence - range.first) <= (OCTREE_PACKET_SEQUENCE)(range.second - range.first)) {
+            return;
+        }
+    }
+    _receivedRanges.append(OctreeSequenceRange(sequence, sequence));
+}
+
+bool OctreeReceiverReport::isReadyToSend(quint64 now) const {
+    return !_receivedRanges.isEmpty()
+        && (now - _intervalStart >= REPORT_INTERVAL_USECS || _receivedRanges.size() >= MAX_SEQUENCE_RANGES);
+}
+
+QByteArray OctreeReceiverReport::packAndReset(quint64 now) {
+    _intervalUsecs = now - _intervalStart;
+    _averageFlightTimeUsecs = _flightTimeSamples > 0 ? _totalFlightTimeUsecs / _flightTimeSamples : 0;
+
+    QByteArray reportPacket = byteArrayWithPopulatedHeader(PacketTypeOctreeReceiverReport);
+    QDataStream reportStream(&reportPacket, QIODevice::Append);
+    reportStream << _intervalUsecs << _bytesReceived << (qint32)_minFlightTimeUsecs << (qint32)_averageFlightTimeUsecs
+        << _receivedRanges;
+
+    _intervalStart = now;
+    _bytesReceived = 0;
+    _receivedRanges.clear();
+    _minFlightTimeUsecs = std::numeric_limits<int>::max();
+    _totalFlightTimeUsecs = 0;
+    _flightTimeSamples = 0;
+
+    return reportPacket;
+}
+
+bool OctreeReceiverReport::unpackFromPacket(const QByteArray& packet) {
+    QDataStream packetStream(packet);
+    packetStream.skipRawData(numBytesForPacketHeader(packet));
+
+    qint32 minFlightTimeUsecs, averageFlightTimeUsecs;
+    packetStream >> _intervalUsecs >> _bytesReceived >> minFlightTimeUsecs >> averageFlightTimeUsecs >> _receivedRanges;
+    _minFlightTimeUsecs = minFlightTimeUsecs;
+    _averageFlightTimeUsecs = averageFlightTimeUsecs;
+
+    return packetStream.status() == QDataStream::Ok && _intervalUsecs > 0 && !_receivedRanges.isEmpty();
+}
+
+void OctreeReceiverReporter::trackIncomingOctreePacket(const QByteArray& packet, const SharedNodePointer& sendingNode) {
+    PacketType packetType = packetTypeForPacket(packet);
+    if (!sendingNode || (packetType != PacketTypeVoxelData && packetType != PacketTypeParticleData
+            && packetType != PacketTypeModelData)) {
+        return;
+    }
+    int numBytesPacketHeader = numBytesForPacketHeader(packet);
+    if (packet.size() < numBytesPacketHeader + (int)OCTREE_PACKET_EXTRA_HEADERS_SIZE) {
+        return;
+    }
+
+    const unsigned char* dataAt = reinterpret_cast<const unsigned char*>(packet.data()) + numBytesPacketHeader;
+    dataAt += sizeof(OCTREE_PACKET_FLAGS);
+    OCTREE_PACKET_SEQUENCE sequence = (*(OCTREE_PACKET_SEQUENCE*)dataAt);
+    dataAt += sizeof(OCTREE_PACKET_SEQUENCE);
+    OCTREE_PACKET_SENT_TIME sentAt = (*(OCTREE_PACKET_SENT_TIME*)dataAt);
+
+    quint64 arrivedAt = usecTimestampNow();
+    int flightTime = arrivedAt - sentAt + sendingNode->getClockSkewUsec();
+
+    QByteArray reportPacket;
+    _mutex.lock();
+    OctreeReceiverReport& report = _reports[sendingNode->getUUID()];
+    report.packetReceived(sequence, flightTime, packet.size());
+    if (report.isReadyToSend(arrivedAt)) {
+        reportPacket = report.packAndReset(arrivedAt);
+    }
+    _mutex.unlock();
+
+    if (!reportPacket.isEmpty()) {
+        NodeList::getInstance()->writeDatagram(reportPacket, sendingNode);
+    }
+}
@@ -0,0 +1,81 @@
+//
+//  OctreeReceiverReport.h
+//  libraries/octree/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_OctreeReceiverReport_h
+#define hifi_OctreeReceiverReport_h
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QPair>
+#include <QtCore/QUuid>
+
+#include <NodeList.h>
+
+#include "OctreePacketData.h"
+
+typedef QPair<OCTREE_PACKET_SEQUENCE, OCTREE_PACKET_SEQUENCE> OctreeSequenceRange;
+
+/// Summarizes the octree data packets a client received from one server over a short interval: which sequence numbers
+/// arrived, how many bytes they carried and how long they took to get here.  The client sends these back to the server,
+/// which uses them to estimate how fast it can send without overflowing the path between them.
+class OctreeReceiverReport {
+public:
+    /// How often the client reports to each server it is receiving from.
+    static const quint64 REPORT_INTERVAL_USECS;
+
+    /// A report is sent early if the received packets fragment into this many ranges.
+    static const int MAX_SEQUENCE_RANGES = 32;
+
+    OctreeReceiverReport();
+
+    /// Records an octree data packet from the server.  Flight time is corrected for clock skew, but the server only
+    /// compares flight times against each other, so a constant error in the skew doesn't matter.
+    void packetReceived(OCTREE_PACKET_SEQUENCE sequence, int flightTimeUsecs, int packetSize);
+
+    bool isReadyToSend(quint64 now) const;
+
+    /// Builds the report packet for what was received since the last one, and starts a new interval.
+    QByteArray packAndReset(quint64 now);
+
+    /// Reads a report sent by a client.  Returns false if the packet is malformed.
+    bool unpackFromPacket(const QByteArray& packet);
+
+    quint64 getIntervalUsecs() const { return _intervalUsecs; }
+    quint32 getBytesReceived() const { return _bytesReceived; }
+    const QList<OctreeSequenceRange>& getReceivedRanges() const { return _receivedRanges; }
+    int getMinFlightTimeUsecs() const { return _minFlightTimeUsecs; }
+    int getAverageFlightTimeUsecs() const { return _averageFlightTimeUsecs; }
+
+private:
+    quint64 _intervalStart;
+    quint64 _intervalUsecs;
+    quint32 _bytesReceived;
+    QList<OctreeSequenceRange> _receivedRanges;
+    int _minFlightTimeUsecs;
+    int _averageFlightTimeUsecs;
+    qint64 _totalFlightTimeUsecs;
+    int _flightTimeSamples;
+};
+
+/// Keeps a receiver report for each octree server a client is receiving from, and sends each server its report as it
+/// comes due.  Reports only go out while data is arriving; the server treats a long silence as congestion.
+class OctreeReceiverReporter {
+public:
+    /// Call with each octree data packet received, after any piggybacked stats have been stripped off.
+    /// \thread any thread
+    void trackIncomingOctreePacket(const QByteArray& packet, const SharedNodePointer& sendingNode);
+
+private:
+    QMutex _mutex;
+    QHash<QUuid, OctreeReceiverReport> _reports;
+};
+
+#endif // hifi_OctreeReceiverReport_h
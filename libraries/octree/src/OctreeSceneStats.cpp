@@ -707,7 +707,7 @@ OctreeSceneStats::ItemInfo OctreeSceneStats::_ITEMS[] = {
     { "Skipped - Out of View", YELLOWISH, 3, "Total,Internal,Leaves" },
     { "Skipped - Was in View", GREYISH, 3, "Total,Internal,Leaves" },
     { "Skipped - No Change", GREENISH, 3, "Total,Internal,Leaves" },
-    { "Skipped - Occluded", YELLOWISH, 3, "Total,Internal,Leaves" },
+    { "Skipped - Occluded", YELLOWISH, 4, "Total,Internal,Leaves,Culled vs Sent" },
     { "Didn't fit in packet", GREYISH, 4, "Total,Internal,Leaves,Removed" },
     { "Mode", GREENISH, 4, "Moving,Stationary,Partial,Full" },
 };
@@ -800,10 +800,15 @@ const char* OctreeSceneStats::getItemValue(Item item) {
             break;
         }
         case ITEM_SKIPPED_OCCLUDED: {
-            sprintf(_itemValueBuffer, "%lu total %lu internal %lu leaves", 
+            // the share of the elements that passed every other test that occlusion culling kept from being sent
+            unsigned long sent = _existsInPacketBitsWritten + _colorSent;
+            float culledPercent = (_skippedOccluded + sent) == 0 ? 0.0f :
+                ((float)_skippedOccluded / (float)(_skippedOccluded + sent)) * 100.0f;
+            sprintf(_itemValueBuffer, "%lu total %lu internal %lu leaves %5.2f%% culled", 
                     (long unsigned int)_skippedOccluded,
                     (long unsigned int)_internalSkippedOccluded,
-                    (long unsigned int)_leavesSkippedOccluded);
+                    (long unsigned int)_leavesSkippedOccluded,
+                    culledPercent);
             break;
         }
         case ITEM_COLORS: {
@@ -354,6 +354,110 @@ ViewFrustum::location ViewFrustum::boxInFrustum(const AABox& box) const {
     return regularResult;
 }
 
+// The offsets of the children of a cube, in halves of its size, for the first four children and the last four; the
+// children are ordered by their x, y and z offsets as the bits of their index, from high to low.
+const glm::vec4 LOW_CHILDREN_X_OFFSETS(0.0f, 0.0f, 0.0f, 0.0f);
+const glm::vec4 HIGH_CHILDREN_X_OFFSETS(1.0f, 1.0f, 1.0f, 1.0f);
+const glm::vec4 CHILDREN_Y_OFFSETS(0.0f, 0.0f, 1.0f, 1.0f);
+const glm::vec4 CHILDREN_Z_OFFSETS(0.0f, 1.0f, 0.0f, 1.0f);
+
+void ViewFrustum::classifyChildren(const AABox& box, unsigned char planeMask, ChildrenInView& children) const {
+    // work on four children at a time: the distances from the camera to the child centers along each axis...
+    float childScale = box.getScale() * 0.5f;
+    float childExtent = childScale * 0.5f;
+    glm::vec3 firstCenter = box.getCorner() + glm::vec3(childExtent);
+    glm::vec4 lowDeltaX = glm::vec4(firstCenter.x - _position.x) + LOW_CHILDREN_X_OFFSETS * childScale;
+    glm::vec4 highDeltaX = glm::vec4(firstCenter.x - _position.x) + HIGH_CHILDREN_X_OFFSETS * childScale;
+    glm::vec4 deltaY = glm::vec4(firstCenter.y - _position.y) + CHILDREN_Y_OFFSETS * childScale;
+    glm::vec4 deltaZ = glm::vec4(firstCenter.z - _position.z) + CHILDREN_Z_OFFSETS * childScale;
+
+    // ...which give the distances to the centers and (adding the extent on each axis) the furthest corners...
+    glm::vec4 deltaYZSquared = deltaY * deltaY + deltaZ * deltaZ;
+    glm::vec4 lowDistances = glm::sqrt(lowDeltaX * lowDeltaX + deltaYZSquared);
+    glm::vec4 highDistances = glm::sqrt(highDeltaX * highDeltaX + deltaYZSquared);
+    glm::vec4 lowFurthestX = glm::abs(lowDeltaX) + childExtent;
+    glm::vec4 highFurthestX = glm::abs(highDeltaX) + childExtent;
+    glm::vec4 furthestY = glm::abs(deltaY) + childExtent;
+    glm::vec4 furthestZ = glm::abs(deltaZ) + childExtent;
+    glm::vec4 furthestYZSquared = furthestY * furthestY + furthestZ * furthestZ;
+    glm::vec4 lowFurthestSquared = lowFurthestX * lowFurthestX + furthestYZSquared;
+    glm::vec4 highFurthestSquared = highFurthestX * highFurthestX + furthestYZSquared;
+    for (int i = 0; i < NUMBER_OF_CHILDREN / 2; i++) {
+        children.distances[i] = lowDistances[i];
+        children.distances[i + 4] = highDistances[i];
+        children.furthestDistances[i] = glm::sqrt(lowFurthestSquared[i]);
+        children.furthestDistances[i + 4] = glm::sqrt(highFurthestSquared[i]);
+    }
+
+    // ...and the nearest points, for the keyhole: like boxInKeyhole, a child is only in the keyhole if it's within the
+    // keyhole's bounding box, and is inside if its furthest corner is
+    ViewFrustum::location keyholeResults[NUMBER_OF_CHILDREN];
+    if (_keyholeRadius >= 0.0f) {
+        glm::vec4 nearestY = glm::max(glm::abs(deltaY) - childExtent, 0.0f);
+        glm::vec4 nearestZ = glm::max(glm::abs(deltaZ) - childExtent, 0.0f);
+        glm::vec4 nearestYZSquared = nearestY * nearestY + nearestZ * nearestZ;
+        glm::vec4 lowNearestX = glm::max(glm::abs(lowDeltaX) - childExtent, 0.0f);
+        glm::vec4 highNearestX = glm::max(glm::abs(highDeltaX) - childExtent, 0.0f);
+        glm::vec4 lowNearestSquared = lowNearestX * lowNearestX + nearestYZSquared;
+        glm::vec4 highNearestSquared = highNearestX * highNearestX + nearestYZSquared;
+        glm::vec4 lowMaxFurthest = glm::max(lowFurthestX, glm::max(furthestY, furthestZ));
+        glm::vec4 highMaxFurthest = glm::max(highFurthestX, glm::max(furthestY, furthestZ));
+        float radiusSquared = _keyholeRadius * _keyholeRadius;
+        for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+            int quad = i & 3;
+            bool low = (i < NUMBER_OF_CHILDREN / 2);
+            float maxFurthest = low ? lowMaxFurthest[quad] : highMaxFurthest[quad];
+            float nearestSquared = low ? lowNearestSquared[quad] : highNearestSquared[quad];
+            if (maxFurthest > _keyholeRadius || nearestSquared >= radiusSquared) {
+                keyholeResults[i] = OUTSIDE;
+            } else {
+                keyholeResults[i] = children.furthestDistances[i] < _keyholeRadius ? INSIDE : INTERSECT;
+            }
+        }
+    } else {
+        for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+            keyholeResults[i] = OUTSIDE;
+        }
+    }
+
+    // test the planes: each child's center distance, plus or minus its "radius" along the plane's normal
+    bool outside[NUMBER_OF_CHILDREN] = { false, false, false, false, false, false, false, false };
+    for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+        children.planeMasks[i] = 0;
+    }
+    for (int plane = 0; plane < 6; plane++) {
+        if (!(planeMask & (1 << plane))) {
+            continue;
+        }
+        const glm::vec3& normal = _planes[plane].getNormal();
+        float firstDistance = _planes[plane].distance(firstCenter);
+        float radius = childExtent * (glm::abs(normal.x) + glm::abs(normal.y) + glm::abs(normal.z));
+        glm::vec4 yzDistances = glm::vec4(firstDistance) + (CHILDREN_Y_OFFSETS * normal.y +
+            CHILDREN_Z_OFFSETS * normal.z) * childScale;
+        glm::vec4 lowPlaneDistances = yzDistances + LOW_CHILDREN_X_OFFSETS * (normal.x * childScale);
+        glm::vec4 highPlaneDistances = yzDistances + HIGH_CHILDREN_X_OFFSETS * (normal.x * childScale);
+        for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+            float distance = (i < NUMBER_OF_CHILDREN / 2) ? lowPlaneDistances[i & 3] : highPlaneDistances[i & 3];
+            if (distance + radius < 0.0f) {
+                outside[i] = true;
+            }
+            if (distance - radius < 0.0f) {
+                children.planeMasks[i] |= (1 << plane);
+            }
+        }
+    }
+
+    for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+        if (keyholeResults[i] == INSIDE) {
+            children.locations[i] = INSIDE;
+        } else if (outside[i]) {
+            children.locations[i] = keyholeResults[i];
+        } else {
+            children.locations[i] = children.planeMasks[i] ? INTERSECT : INSIDE;
+        }
+    }
+}
+
 bool testMatches(glm::quat lhs, glm::quat rhs, float epsilon = EPSILON) {
     return (fabs(lhs.x - rhs.x) <= epsilon && fabs(lhs.y - rhs.y) <= epsilon && fabs(lhs.z - rhs.z) <= epsilon
             && fabs(lhs.w - rhs.w) <= epsilon);
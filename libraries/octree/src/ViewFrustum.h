@@ -29,6 +29,10 @@ const float DEFAULT_ASPECT_RATIO = 16.f/9.f;
 const float DEFAULT_NEAR_CLIP = 0.08f;
 const float DEFAULT_FAR_CLIP = 50.0f * TREE_SCALE;
 
+const unsigned char ALL_FRUSTUM_PLANES = 0x3F; ///< a plane mask with a bit for each of the six planes
+
+class ChildrenInView;
+
 class ViewFrustum {
 public:
     // setters for camera attributes
@@ -96,6 +100,12 @@ public:
     ViewFrustum::location sphereInFrustum(const glm::vec3& center, float radius) const;
     ViewFrustum::location boxInFrustum(const AABox& box) const;
 
+    /// Classifies the eight children of a cube all at once: their locations (the same as boxInFrustum would give) and
+    /// their distances from the camera.
+    /// \param box the parent cube, in meters
+    /// \param planeMask the planes the parent may cross (ALL_FRUSTUM_PLANES if not known); the others are skipped
+    void classifyChildren(const AABox& box, unsigned char planeMask, ChildrenInView& children) const;
+
     // some frustum comparisons
     bool matches(const ViewFrustum& compareTo, bool debug = false) const;
     bool matches(const ViewFrustum* compareTo, bool debug = false) const { return matches(*compareTo, debug); }
@@ -174,5 +184,14 @@ private:
     glm::mat4 _ourModelViewProjectionMatrix;
 };
 
+/// The eight children of a cube as classified by ViewFrustum::classifyChildren, in the order OctreeElement keeps them.
+class ChildrenInView {
+public:
+    ViewFrustum::location locations[NUMBER_OF_CHILDREN];
+    unsigned char planeMasks[NUMBER_OF_CHILDREN]; ///< the planes each child may cross, for classifying its own children
+    float distances[NUMBER_OF_CHILDREN]; ///< from the camera to each child's center, in meters
+    float furthestDistances[NUMBER_OF_CHILDREN]; ///< from the camera to each child's furthest corner, in meters
+};
+
 
 #endif // hifi_ViewFrustum_h
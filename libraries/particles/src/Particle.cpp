@@ -26,6 +26,7 @@
 
 #include "ParticlesScriptingInterface.h"
 #include "Particle.h"
+#include "ParticleScriptHost.h"
 #include "ParticleTree.h"
 
 uint32_t Particle::_nextID = 0;
@@ -80,6 +81,8 @@ Particle::Particle(const ParticleID& particleID, const ParticleProperties& prope
     uint64_t now = usecTimestampNow();
     _lastEdited = now;
     _lastUpdated = now;
+    _lastMoved = now;
+    _lastPropertiesChanged = now;
     _created = now; // will get updated as appropriate in setAge()
 
     _position = glm::vec3(0,0,0);
@@ -117,6 +120,8 @@ void Particle::init(glm::vec3 position, float radius, rgbColor color, glm::vec3
     quint64 now = usecTimestampNow();
     _lastEdited = now;
     _lastUpdated = now;
+    _lastMoved = now;
+    _lastPropertiesChanged = now;
     _created = now; // will get updated as appropriate in setAge()
 
     _position = position;
@@ -217,6 +222,57 @@ bool Particle::appendParticleData(OctreePacketData* packetData) const {
     return success;
 }
 
+bool Particle::appendParticleDelta(OctreePacketData* packetData, ParticleDelta delta) const {
+    bool success = packetData->appendValue((quint8)delta);
+    if (success) {
+        if (delta == PARTICLE_CHANGED) {
+            success = appendParticleData(packetData);
+
+        } else {
+            success = packetData->appendValue(getID());
+            if (success && delta == PARTICLE_MOVED) {
+                success = packetData->appendValue(getLastUpdated());
+                if (success) {
+                    success = packetData->appendPosition(getPosition());
+                }
+                if (success) {
+                    success = packetData->appendValue(getVelocity());
+                }
+            }
+        }
+    }
+    return success;
+}
+
+int Particle::readParticleMotionFromBuffer(const unsigned char* data, int bytesLeftToRead,
+        ReadBitstreamToTreeParams& args) {
+    int bytesRead = 0;
+    if (bytesLeftToRead >= (int)(sizeof(_lastUpdated) + sizeof(_position) + sizeof(_velocity))) {
+        int clockSkew = args.sourceNode ? args.sourceNode->getClockSkewUsec() : 0;
+
+        const unsigned char* dataAt = data;
+
+        // _lastUpdated
+        memcpy(&_lastUpdated, dataAt, sizeof(_lastUpdated));
+        dataAt += sizeof(_lastUpdated);
+        bytesRead += sizeof(_lastUpdated);
+        _lastUpdated -= clockSkew;
+
+        // position
+        memcpy(&_position, dataAt, sizeof(_position));
+        dataAt += sizeof(_position);
+        bytesRead += sizeof(_position);
+
+        // velocity
+        memcpy(&_velocity, dataAt, sizeof(_velocity));
+        dataAt += sizeof(_velocity);
+        bytesRead += sizeof(_velocity);
+
+        _lastMoved = usecTimestampNow();
+    }
+    return bytesRead;
+}
+
 int Particle::expectedBytes() {
     int expectedBytes = sizeof(uint32_t) // id
                 + sizeof(float) // age
@@ -345,6 +401,8 @@ int Particle::readParticleDataFromBuffer(const unsigned char* data, int bytesLef
         dataAt += bytes;
         bytesRead += bytes;
 
+        markChanged();
+
         //printf("Particle::readParticleDataFromBuffer()... "); debugDump();
     }
     return bytesRead;
@@ -817,90 +875,69 @@ void Particle::applyHardCollision(const CollisionInfo& collisionInfo) {
     setVelocity(velocity);
 }
 
-void Particle::update(const quint64& now) {
-    float timeElapsed = (float)(now - _lastUpdated) / (float)(USECS_PER_SECOND);
+bool Particle::beginUpdate(const quint64& now, float& timeElapsed) {
+    timeElapsed = (float)(now - _lastUpdated) / (float)(USECS_PER_SECOND);
     _lastUpdated = now;
 
     // calculate our default shouldDie state... then allow script to change it if it wants...
-    bool isInHand = getInHand();
     bool shouldDie = (getAge() > getLifetime()) || getShouldDie();
+    bool propertiesChanged = (shouldDie != getShouldDie());
     setShouldDie(shouldDie);
 
-    executeUpdateScripts(); // allow the javascript to alter our state
-
-    // If the ball is in hand, it doesn't move or have gravity effect it
-    if (!isInHand) {
-        _position += _velocity * timeElapsed;
-
-        // handle bounces off the ground...
-        if (_position.y <= 0) {
-            _velocity = _velocity * glm::vec3(1,-1,1);
-            _position.y = 0;
-        }
-
-        // handle gravity....
-        _velocity += _gravity * timeElapsed;
-
-        // handle damping
-        glm::vec3 dampingResistance = _velocity * _damping;
-        _velocity -= dampingResistance * timeElapsed;
-        //qDebug("applying damping to Particle timeElapsed=%f",timeElapsed);
+    // allow the javascript to alter our state, keeping a copy to tell whether it did
+    if (!_script.isEmpty()) {
+        Particle beforeScripts(*this);
+        executeUpdateScripts();
+        propertiesChanged = propertiesChanged || !hasSamePropertiesAs(beforeScripts);
     }
+    return propertiesChanged;
 }
 
-void Particle::startParticleScriptContext(ScriptEngine& engine, ParticleScriptObject& particleScriptable) {
-    if (_voxelEditSender) {
-        engine.getVoxelsScriptingInterface()->setPacketSender(_voxelEditSender);
+bool Particle::finishUpdate(const quint64& now, const glm::vec3& oldPosition, const glm::vec3& oldVelocity,
+        bool propertiesChanged) {
+    bool moved = (_position != oldPosition || _velocity != oldVelocity);
+    if (moved) {
+        _lastMoved = now;
     }
-    if (_particleEditSender) {
-        engine.getParticlesScriptingInterface()->setPacketSender(_particleEditSender);
+    if (propertiesChanged) {
+        _lastPropertiesChanged = now;
     }
+    return moved || propertiesChanged;
+}
 
-    // Add the "this" Particle object
-    engine.registerGlobalObject("Particle", &particleScriptable);
-    engine.evaluate();
+bool Particle::hasSamePropertiesAs(const Particle& other) const {
+    return _radius == other._radius && _mass == other._mass && memcmp(_color, other._color, sizeof(_color)) == 0 &&
+        _gravity == other._gravity && _damping == other._damping && _lifetime == other._lifetime &&
+        _inHand == other._inHand && _shouldDie == other._shouldDie && _script == other._script &&
+        _modelURL == other._modelURL && _modelScale == other._modelScale &&
+        _modelTranslation == other._modelTranslation && _modelRotation == other._modelRotation;
 }
 
-void Particle::endParticleScriptContext(ScriptEngine& engine, ParticleScriptObject& particleScriptable) {
-    if (_voxelEditSender) {
-        _voxelEditSender->releaseQueuedMessages();
-    }
-    if (_particleEditSender) {
-        _particleEditSender->releaseQueuedMessages();
+ParticleDelta Particle::getDeltaSince(quint64 time) const {
+    if (_lastPropertiesChanged > time) {
+        return PARTICLE_CHANGED;
     }
+    return (_lastMoved > time) ? PARTICLE_MOVED : PARTICLE_UNCHANGED;
 }
 
 void Particle::executeUpdateScripts() {
     // Only run this particle script if there's a script attached directly to the particle.
     if (!_script.isEmpty()) {
-        ScriptEngine engine(_script);
-        ParticleScriptObject particleScriptable(this);
-        startParticleScriptContext(engine, particleScriptable);
-        particleScriptable.emitUpdate();
-        endParticleScriptContext(engine, particleScriptable);
+        ParticleScriptHost::getInstance()->runUpdate(this);
     }
 }
 
 void Particle::collisionWithParticle(Particle* other, const glm::vec3& penetration) {
     // Only run this particle script if there's a script attached directly to the particle.
     if (!_script.isEmpty()) {
-        ScriptEngine engine(_script);
-        ParticleScriptObject particleScriptable(this);
-        startParticleScriptContext(engine, particleScriptable);
-        ParticleScriptObject otherParticleScriptable(other);
-        particleScriptable.emitCollisionWithParticle(&otherParticleScriptable, penetration);
-        endParticleScriptContext(engine, particleScriptable);
+        ParticleScriptHost::getInstance()->runCollisionWithParticle(this, other, penetration);
     }
 }
 
 void Particle::collisionWithVoxel(VoxelDetail* voxelDetails, const glm::vec3& penetration) {
     // Only run this particle script if there's a script attached directly to the particle.
     if (!_script.isEmpty()) {
-        ScriptEngine engine(_script);
-        ParticleScriptObject particleScriptable(this);
-        startParticleScriptContext(engine, particleScriptable);
-        particleScriptable.emitCollisionWithVoxel(*voxelDetails, penetration);
-        endParticleScriptContext(engine, particleScriptable);
+        ParticleScriptHost::getInstance()->runCollisionWithVoxel(this, *voxelDetails, penetration);
     }
 }
 
@@ -913,6 +950,7 @@ void Particle::copyChangedProperties(const Particle& other) {
     float age = getAge();
     *this = other;
     setAge(age);
+    markChanged();
 }
 
 ParticleProperties Particle::getProperties() const {
@@ -923,6 +961,7 @@ ParticleProperties Particle::getProperties() const {
 
 void Particle::setProperties(const ParticleProperties& properties) {
     properties.copyToParticle(*this);
+    markChanged();
 }
 
 ParticleProperties::ParticleProperties() :
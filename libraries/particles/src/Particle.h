@@ -37,6 +37,13 @@ const uint32_t NEW_PARTICLE = 0xFFFFFFFF;
 const uint32_t UNKNOWN_TOKEN = 0xFFFFFFFF;
 const uint32_t UNKNOWN_PARTICLE_ID = 0xFFFFFFFF;
 
+/// How much of a particle a delta encoding includes, for clients that already hold an earlier version of it.
+enum ParticleDelta {
+    PARTICLE_UNCHANGED = 0, ///< just the ID
+    PARTICLE_MOVED = 1, ///< the ID and motion
+    PARTICLE_CHANGED = 2 ///< everything
+};
+
 const uint16_t CONTAINS_RADIUS = 1;
 const uint16_t CONTAINS_POSITION = 2;
 const uint16_t CONTAINS_COLOR = 4;
@@ -243,6 +250,18 @@ public:
     quint64 getLastEdited() const { return _lastEdited; }
     void setLastEdited(quint64 lastEdited) { _lastEdited = lastEdited; }
 
+    /// The last time this particle's position or velocity changed, from the time perspective of this node
+    quint64 getLastMoved() const { return _lastMoved; }
+
+    /// The last time any of this particle's other properties changed, from the time perspective of this node
+    quint64 getLastPropertiesChanged() const { return _lastPropertiesChanged; }
+
+    /// Notes that the particle may have changed in any way, so that deltas include all of it.
+    void markChanged() { _lastMoved = _lastPropertiesChanged = usecTimestampNow(); }
+
+    /// Returns how much of the particle a client that was sent it at the given time needs to be sent now.
+    ParticleDelta getDeltaSince(quint64 time) const;
+
     /// lifetime of the particle in seconds
     float getAge() const { return static_cast<float>(usecTimestampNow() - _created) / static_cast<float>(USECS_PER_SECOND); }
     float getEditedAgo() const { return static_cast<float>(usecTimestampNow() - _lastEdited) / static_cast<float>(USECS_PER_SECOND); }
@@ -287,6 +306,12 @@ public:
 
     bool appendParticleData(OctreePacketData* packetData) const;
     int readParticleDataFromBuffer(const unsigned char* data, int bytesLeftToRead, ReadBitstreamToTreeParams& args);
+
+    /// Appends a delta record: the delta type followed by as much of the particle as it calls for.
+    bool appendParticleDelta(OctreePacketData* packetData, ParticleDelta delta) const;
+
+    /// Reads the motion that follows the ID in a PARTICLE_MOVED delta record.
+    int readParticleMotionFromBuffer(const unsigned char* data, int bytesLeftToRead, ReadBitstreamToTreeParams& args);
     static int expectedBytes();
 
     static bool encodeParticleEditMessageDetails(PacketType command, ParticleID id, const ParticleProperties& details,
@@ -296,7 +321,20 @@ public:
     
     void applyHardCollision(const CollisionInfo& collisionInfo);
 
-    void update(const quint64& now);
+    /// Starts simulating the particle up to the given time: ages it and runs its update script.  Its motion is then
+    /// integrated along with that of its neighbors (see ParticleSimulationStore), unless it's in hand, and the update
+    /// finished with finishUpdate.
+    /// \param timeElapsed[out] the time since the particle was last updated, in seconds
+    /// \return whether the particle's properties (other than its motion) changed
+    bool beginUpdate(const quint64& now, float& timeElapsed);
+
+    /// Finishes an update begun with beginUpdate, noting when the particle last moved or changed.
+    /// \param oldPosition the particle's position before beginUpdate
+    /// \param oldVelocity the particle's velocity before beginUpdate
+    /// \param propertiesChanged what beginUpdate returned
+    /// \return whether the particle moved or otherwise changed
+    bool finishUpdate(const quint64& now, const glm::vec3& oldPosition, const glm::vec3& oldVelocity,
+        bool propertiesChanged);
     void collisionWithParticle(Particle* other, const glm::vec3& penetration);
     void collisionWithVoxel(VoxelDetail* voxel, const glm::vec3& penetration);
 
@@ -324,10 +362,11 @@ protected:
     static VoxelEditPacketSender* _voxelEditSender;
     static ParticleEditPacketSender* _particleEditSender;
 
-    void startParticleScriptContext(ScriptEngine& engine, ParticleScriptObject& particleScriptable);
-    void endParticleScriptContext(ScriptEngine& engine, ParticleScriptObject& particleScriptable);
     void executeUpdateScripts();
 
+    /// Checks whether the particle's properties, other than its motion, are the same as another's.
+    bool hasSamePropertiesAs(const Particle& other) const;
+
     void setAge(float age);
 
     glm::vec3 _position;
@@ -355,6 +394,8 @@ protected:
 
     quint64 _lastUpdated;
     quint64 _lastEdited;
+    quint64 _lastMoved;
+    quint64 _lastPropertiesChanged;
 
     // this doesn't go on the wire, we send it as lifetime
     quint64 _created;
@@ -372,6 +413,8 @@ public:
     ParticleScriptObject(Particle* particle) { _particle = particle; }
     //~ParticleScriptObject() { qDebug() << "~ParticleScriptObject() this=" << this; }
 
+    void setParticle(Particle* particle) { _particle = particle; }
+
     void emitUpdate() { emit update(); }
     void emitCollisionWithParticle(QObject* other, const glm::vec3& penetration) 
                 { emit collisionWithParticle(other, penetration); }
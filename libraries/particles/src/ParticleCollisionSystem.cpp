@@ -10,7 +10,15 @@
 //
 
 #include <algorithm>
+
+#include <QAtomicInt>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QSharedPointer>
+#include <QThreadPool>
+
 #include <AbstractAudioInterface.h>
+#include <GeometryUtil.h>
 #include <VoxelTree.h>
 #include <AvatarData.h>
 #include <HeadData.h>
@@ -23,6 +31,70 @@
 
 const int MAX_COLLISIONS_PER_PARTICLE = 16;
 
+// broadphase groups
+const int PARTICLE_COLLISION_GROUP = 1;
+const int AVATAR_COLLISION_GROUP = 2;
+
+// avatars are given very generous bounds, since the arms can stretch
+const float AVATAR_BOUNDING_RADIUS_SCALE = 2.0f;
+
+// particles are searched against the voxel tree in batches of this many, and only in parallel when there are enough
+const int PARTICLES_PER_VOXEL_BATCH = 32;
+const int MIN_PARTICLES_TO_CHECK_IN_PARALLEL = 256;
+
+/// Shared state for searching the voxel tree for the penetrations of a set of particles in parallel.
+class VoxelCollisionSearch {
+public:
+
+    VoxelCollisionSearch(VoxelTree* voxels, const QVector<Particle*>& particles, VoxelDetail** voxelDetails,
+            glm::vec3* penetrations) :
+        voxels(voxels),
+        particles(particles),
+        particleCount(particles.size()),
+        voxelDetails(voxelDetails),
+        penetrations(penetrations) { }
+
+    /// Takes the next unclaimed batch of particles and searches for their penetrations.
+    /// \return false if there were no batches left to search
+    bool searchNext();
+
+    VoxelTree* voxels;
+    const QVector<Particle*>& particles;
+    int particleCount; ///< copied, so that a task starting late sees there's nothing left even if particles changed
+    VoxelDetail** voxelDetails; ///< written by index, so that each thread writes only its own batches
+    glm::vec3* penetrations;
+    QAtomicInt nextBatch;
+    QSemaphore completed;
+};
+
+bool VoxelCollisionSearch::searchNext() {
+    int start = nextBatch.fetchAndAddOrdered(1) * PARTICLES_PER_VOXEL_BATCH;
+    if (start >= particleCount) {
+        return false;
+    }
+    for (int i = start, end = qMin(start + PARTICLES_PER_VOXEL_BATCH, particleCount); i < end; i++) {
+        const Particle* particle = particles.at(i);
+        glm::vec3 center = particle->getPosition() * (float)(TREE_SCALE);
+        float radius = particle->getRadius() * (float)(TREE_SCALE);
+        voxels->findSpherePenetration(center, radius, penetrations[i], (void**)&voxelDetails[i]);
+    }
+    completed.release();
+    return true;
+}
+
+/// Searches batches on a pool thread until there are none left.
+class VoxelCollisionSearchTask : public QRunnable {
+public:
+
+    VoxelCollisionSearchTask(const QSharedPointer<VoxelCollisionSearch>& search) : _search(search) { }
+
+    virtual void run() { while (_search->searchNext()); }
+
+private:
+
+    QSharedPointer<VoxelCollisionSearch> _search;
+};
+
 ParticleCollisionSystem::ParticleCollisionSystem(ParticleEditPacketSender* packetSender,
     ParticleTree* particles, VoxelTree* voxels, AbstractAudioInterface* audio,
     AvatarHashMap* avatars) : _collisions(MAX_COLLISIONS_PER_PARTICLE) {
@@ -42,7 +114,7 @@ void ParticleCollisionSystem::init(ParticleEditPacketSender* packetSender,
 ParticleCollisionSystem::~ParticleCollisionSystem() {
 }
 
-bool ParticleCollisionSystem::updateOperation(OctreeElement* element, void* extraData) {
+bool ParticleCollisionSystem::gatherOperation(OctreeElement* element, void* extraData) {
     ParticleCollisionSystem* system = static_cast<ParticleCollisionSystem*>(extraData);
     ParticleTreeElement* particleTreeElement = static_cast<ParticleTreeElement*>(element);
 
@@ -50,8 +122,7 @@ bool ParticleCollisionSystem::updateOperation(OctreeElement* element, void* extr
     QList<Particle>& particles = particleTreeElement->getParticles();
     uint16_t numberOfParticles = particles.size();
     for (uint16_t i = 0; i < numberOfParticles; i++) {
-        Particle* particle = &particles[i];
-        system->checkParticle(particle);
+        system->_particlesToCheck.append(&particles[i]);
     }
 
     return true;
@@ -60,10 +131,80 @@ bool ParticleCollisionSystem::updateOperation(OctreeElement* element, void* extr
 
 void ParticleCollisionSystem::update() {
     // update all particles
-    if (_particles->tryLockForRead()) {
-        _particles->recurseTreeWithOperation(updateOperation, this);
-        _particles->unlock();
+    if (!_particles->tryLockForRead()) {
+        return;
+    }
+    _particlesToCheck.clear();
+    _particles->recurseTreeWithOperation(gatherOperation, this);
+
+    // the broadphase works in world scale, as the avatars do; the particles come first, so that the first of each
+    // pair is always a particle
+    _broadphase.clear();
+    foreach (Particle* particle, _particlesToCheck) {
+        glm::vec3 center = particle->getPosition() * (float)(TREE_SCALE);
+        glm::vec3 extent(particle->getRadius() * (float)(TREE_SCALE));
+        _broadphase.addBox(center - extent, center + extent, PARTICLE_COLLISION_GROUP,
+            PARTICLE_COLLISION_GROUP | AVATAR_COLLISION_GROUP);
+    }
+    _avatarsToCheck.clear();
+    if (_avatars) {
+        foreach (const AvatarSharedPointer& avatarPointer, _avatars->getAvatarHash()) {
+            AvatarData* avatar = avatarPointer.data();
+            glm::vec3 extent(AVATAR_BOUNDING_RADIUS_SCALE * avatar->getBoundingRadius());
+            _broadphase.addBox(avatar->getPosition() - extent, avatar->getPosition() + extent,
+                AVATAR_COLLISION_GROUP, 0);
+            _avatarsToCheck.append(avatar);
+        }
+    }
+    _broadphase.findPairs(_pairs);
+
+    // the voxel tree is the same for every particle, so it's searched in parallel; the collisions it finds are then
+    // applied here, in order, as are all the rest (they run scripts, send edits and emit signals)
+    findVoxelCollisions();
+    for (int i = 0; i < _particlesToCheck.size(); i++) {
+        if (_voxelDetails.at(i)) {
+            updateCollisionWithVoxel(_particlesToCheck.at(i), _voxelDetails.at(i), _voxelPenetrations.at(i));
+            delete _voxelDetails.at(i); // cleanup returned details
+        }
     }
+
+    int particleCount = _particlesToCheck.size();
+    foreach (const BoxPair& pair, _pairs) {
+        Particle* particle = _particlesToCheck.at(pair.first);
+        if (pair.second >= particleCount) {
+            updateCollisionWithAvatar(particle, _avatarsToCheck.at(pair.second - particleCount));
+            continue;
+        }
+        Particle* otherParticle = _particlesToCheck.at(pair.second);
+        glm::vec3 penetration;
+        if (findSphereSpherePenetration(particle->getPosition() * (float)(TREE_SCALE),
+                particle->getRadius() * (float)(TREE_SCALE), otherParticle->getPosition() * (float)(TREE_SCALE),
+                otherParticle->getRadius() * (float)(TREE_SCALE), penetration)) {
+            updateCollisionWithParticle(particle, otherParticle, penetration);
+        }
+    }
+    _particles->unlock();
+}
+
+void ParticleCollisionSystem::findVoxelCollisions() {
+    int particleCount = _particlesToCheck.size();
+    _voxelDetails.fill(NULL, particleCount);
+    _voxelPenetrations.resize(particleCount);
+    if (!_voxels || particleCount == 0) {
+        return;
+    }
+    QSharedPointer<VoxelCollisionSearch> search(new VoxelCollisionSearch(_voxels, _particlesToCheck,
+        _voxelDetails.data(), _voxelPenetrations.data()));
+    int batchCount = (particleCount + PARTICLES_PER_VOXEL_BATCH - 1) / PARTICLES_PER_VOXEL_BATCH;
+    if (particleCount >= MIN_PARTICLES_TO_CHECK_IN_PARALLEL) {
+        // start tasks on the pool, but also search on this thread so that we never wait on a task that hasn't started
+        int taskCount = qMin(batchCount - 1, QThreadPool::globalInstance()->maxThreadCount());
+        for (int i = 0; i < taskCount; i++) {
+            QThreadPool::globalInstance()->start(new VoxelCollisionSearchTask(search));
+        }
+    }
+    while (search->searchNext());
+    search->completed.acquire(batchCount);
 }
 
 
@@ -90,94 +231,105 @@ void ParticleCollisionSystem::emitGlobalParticleCollisionWithParticle(Particle*
 void ParticleCollisionSystem::updateCollisionWithVoxels(Particle* particle) {
     glm::vec3 center = particle->getPosition() * (float)(TREE_SCALE);
     float radius = particle->getRadius() * (float)(TREE_SCALE);
+    VoxelDetail* voxelDetails = NULL;
+    glm::vec3 penetration;
+    if (_voxels->findSpherePenetration(center, radius, penetration, (void**)&voxelDetails)) {
+        updateCollisionWithVoxel(particle, voxelDetails, penetration);
+        delete voxelDetails; // cleanup returned details
+    }
+}
+
+void ParticleCollisionSystem::updateCollisionWithVoxel(Particle* particle, VoxelDetail* voxelDetails,
+        const glm::vec3& penetration) {
     const float ELASTICITY = 0.4f;
     const float DAMPING = 0.05f;
     const float COLLISION_FREQUENCY = 0.5f;
     CollisionInfo collisionInfo;
     collisionInfo._damping = DAMPING;
     collisionInfo._elasticity = ELASTICITY;
-    VoxelDetail* voxelDetails = NULL;
-    if (_voxels->findSpherePenetration(center, radius, collisionInfo._penetration, (void**)&voxelDetails)) {
-
-        // let the particles run their collision scripts if they have them
-        particle->collisionWithVoxel(voxelDetails, collisionInfo._penetration);
-
-        // findSpherePenetration() only computes the penetration but we also want some other collision info
-        // so we compute it ourselves here.  Note that we must multiply scale by TREE_SCALE when feeding 
-        // the results to systems outside of this octree reference frame.
-        updateCollisionSound(particle, collisionInfo._penetration, COLLISION_FREQUENCY);
-        collisionInfo._contactPoint = (float)TREE_SCALE * (particle->getPosition() + particle->getRadius() * glm::normalize(collisionInfo._penetration));
-        // let the global script run their collision scripts for particles if they have them
-        emitGlobalParticleCollisionWithVoxel(particle, voxelDetails, collisionInfo);
-
-        // we must scale back down to the octree reference frame before updating the particle properties
-        collisionInfo._penetration /= (float)(TREE_SCALE);
-        collisionInfo._contactPoint /= (float)(TREE_SCALE);
-        particle->applyHardCollision(collisionInfo);
-        queueParticlePropertiesUpdate(particle);
-
-        delete voxelDetails; // cleanup returned details
-    }
+    collisionInfo._penetration = penetration;
+
+    // let the particles run their collision scripts if they have them
+    particle->collisionWithVoxel(voxelDetails, collisionInfo._penetration);
+
+    // findSpherePenetration() only computes the penetration but we also want some other collision info
+    // so we compute it ourselves here.  Note that we must multiply scale by TREE_SCALE when feeding 
+    // the results to systems outside of this octree reference frame.
+    updateCollisionSound(particle, collisionInfo._penetration, COLLISION_FREQUENCY);
+    collisionInfo._contactPoint = (float)TREE_SCALE * (particle->getPosition() + particle->getRadius() * glm::normalize(collisionInfo._penetration));
+    // let the global script run their collision scripts for particles if they have them
+    emitGlobalParticleCollisionWithVoxel(particle, voxelDetails, collisionInfo);
+
+    // we must scale back down to the octree reference frame before updating the particle properties
+    collisionInfo._penetration /= (float)(TREE_SCALE);
+    collisionInfo._contactPoint /= (float)(TREE_SCALE);
+    particle->applyHardCollision(collisionInfo);
+    queueParticlePropertiesUpdate(particle);
 }
 
 void ParticleCollisionSystem::updateCollisionWithParticles(Particle* particleA) {
     glm::vec3 center = particleA->getPosition() * (float)(TREE_SCALE);
     float radius = particleA->getRadius() * (float)(TREE_SCALE);
-    //const float ELASTICITY = 0.4f;
-    //const float DAMPING = 0.0f;
-    const float COLLISION_FREQUENCY = 0.5f;
     glm::vec3 penetration;
     Particle* particleB;
     if (_particles->findSpherePenetration(center, radius, penetration, (void**)&particleB, Octree::NoLock)) {
-        // NOTE: 'penetration' is the depth that 'particleA' overlaps 'particleB'.  It points from A into B.
-
-        // Even if the particles overlap... when the particles are already moving appart
-        // we don't want to count this as a collision.
-        glm::vec3 relativeVelocity = particleA->getVelocity() - particleB->getVelocity();
-        if (glm::dot(relativeVelocity, penetration) > 0.0f) {
-            particleA->collisionWithParticle(particleB, penetration);
-            particleB->collisionWithParticle(particleA, penetration * -1.0f); // the penetration is reversed
-
-            CollisionInfo collision;
-            collision._penetration = penetration;
-            // for now the contactPoint is the average between the the two paricle centers
-            collision._contactPoint = (0.5f * (float)TREE_SCALE) * (particleA->getPosition() + particleB->getPosition());
-            emitGlobalParticleCollisionWithParticle(particleA, particleB, collision);
-
-            glm::vec3 axis = glm::normalize(penetration);
-            glm::vec3 axialVelocity = glm::dot(relativeVelocity, axis) * axis;
-
-            // particles that are in hand are assigned an ureasonably large mass for collisions
-            // which effectively makes them immovable but allows the other ball to reflect correctly.
-            const float MAX_MASS = 1.0e6f;
-            float massA = (particleA->getInHand()) ? MAX_MASS : particleA->getMass();
-            float massB = (particleB->getInHand()) ? MAX_MASS : particleB->getMass();
-            float totalMass = massA + massB;
-
-            // handle particle A
-            particleA->setVelocity(particleA->getVelocity() - axialVelocity * (2.0f * massB / totalMass));
-            particleA->setPosition(particleA->getPosition() - 0.5f * penetration);
-            ParticleProperties propertiesA;
-            ParticleID idA(particleA->getID());
-            propertiesA.copyFromParticle(*particleA);
-            propertiesA.setVelocity(particleA->getVelocity() * (float)TREE_SCALE);
-            propertiesA.setPosition(particleA->getPosition() * (float)TREE_SCALE);
-            _packetSender->queueParticleEditMessage(PacketTypeParticleAddOrEdit, idA, propertiesA);
-
-            // handle particle B
-            particleB->setVelocity(particleB->getVelocity() + axialVelocity * (2.0f * massA / totalMass));
-            particleA->setPosition(particleB->getPosition() + 0.5f * penetration);
-            ParticleProperties propertiesB;
-            ParticleID idB(particleB->getID());
-            propertiesB.copyFromParticle(*particleB);
-            propertiesB.setVelocity(particleB->getVelocity() * (float)TREE_SCALE);
-            propertiesB.setPosition(particleB->getPosition() * (float)TREE_SCALE);
-            _packetSender->queueParticleEditMessage(PacketTypeParticleAddOrEdit, idB, propertiesB);
-
-            _packetSender->releaseQueuedMessages();
-
-            updateCollisionSound(particleA, penetration, COLLISION_FREQUENCY);
-        }
+        updateCollisionWithParticle(particleA, particleB, penetration);
+    }
+}
+
+void ParticleCollisionSystem::updateCollisionWithParticle(Particle* particleA, Particle* particleB,
+        const glm::vec3& penetration) {
+    //const float ELASTICITY = 0.4f;
+    //const float DAMPING = 0.0f;
+    const float COLLISION_FREQUENCY = 0.5f;
+    // NOTE: 'penetration' is the depth that 'particleA' overlaps 'particleB'.  It points from A into B.
+
+    // Even if the particles overlap... when the particles are already moving appart
+    // we don't want to count this as a collision.
+    glm::vec3 relativeVelocity = particleA->getVelocity() - particleB->getVelocity();
+    if (glm::dot(relativeVelocity, penetration) > 0.0f) {
+        particleA->collisionWithParticle(particleB, penetration);
+        particleB->collisionWithParticle(particleA, penetration * -1.0f); // the penetration is reversed
+
+        CollisionInfo collision;
+        collision._penetration = penetration;
+        // for now the contactPoint is the average between the the two paricle centers
+        collision._contactPoint = (0.5f * (float)TREE_SCALE) * (particleA->getPosition() + particleB->getPosition());
+        emitGlobalParticleCollisionWithParticle(particleA, particleB, collision);
+
+        glm::vec3 axis = glm::normalize(penetration);
+        glm::vec3 axialVelocity = glm::dot(relativeVelocity, axis) * axis;
+
+        // particles that are in hand are assigned an ureasonably large mass for collisions
+        // which effectively makes them immovable but allows the other ball to reflect correctly.
+        const float MAX_MASS = 1.0e6f;
+        float massA = (particleA->getInHand()) ? MAX_MASS : particleA->getMass();
+        float massB = (particleB->getInHand()) ? MAX_MASS : particleB->getMass();
+        float totalMass = massA + massB;
+
+        // handle particle A
+        particleA->setVelocity(particleA->getVelocity() - axialVelocity * (2.0f * massB / totalMass));
+        particleA->setPosition(particleA->getPosition() - 0.5f * penetration);
+        ParticleProperties propertiesA;
+        ParticleID idA(particleA->getID());
+        propertiesA.copyFromParticle(*particleA);
+        propertiesA.setVelocity(particleA->getVelocity() * (float)TREE_SCALE);
+        propertiesA.setPosition(particleA->getPosition() * (float)TREE_SCALE);
+        _packetSender->queueParticleEditMessage(PacketTypeParticleAddOrEdit, idA, propertiesA);
+
+        // handle particle B
+        particleB->setVelocity(particleB->getVelocity() + axialVelocity * (2.0f * massA / totalMass));
+        particleA->setPosition(particleB->getPosition() + 0.5f * penetration);
+        ParticleProperties propertiesB;
+        ParticleID idB(particleB->getID());
+        propertiesB.copyFromParticle(*particleB);
+        propertiesB.setVelocity(particleB->getVelocity() * (float)TREE_SCALE);
+        propertiesB.setPosition(particleB->getPosition() * (float)TREE_SCALE);
+        _packetSender->queueParticleEditMessage(PacketTypeParticleAddOrEdit, idB, propertiesB);
+
+        _packetSender->releaseQueuedMessages();
+
+        updateCollisionSound(particleA, penetration, COLLISION_FREQUENCY);
     }
 }
 
@@ -186,8 +338,17 @@ const float MIN_EXPECTED_FRAME_PERIOD = 0.0167f;  // 1/60th of a second
 const float HALTING_SPEED = 9.8 * MIN_EXPECTED_FRAME_PERIOD / (float)(TREE_SCALE);
 
 void ParticleCollisionSystem::updateCollisionWithAvatars(Particle* particle) {
+    if (!_avatars) {
+        return;
+    }
+    foreach (const AvatarSharedPointer& avatarPointer, _avatars->getAvatarHash()) {
+        updateCollisionWithAvatar(particle, avatarPointer.data());
+    }
+}
+
+void ParticleCollisionSystem::updateCollisionWithAvatar(Particle* particle, AvatarData* avatar) {
     // particles that are in hand, don't collide with avatars
-    if (!_avatars || particle->getInHand()) {
+    if (particle->getInHand()) {
         return;
     }
 
@@ -196,56 +357,51 @@ void ParticleCollisionSystem::updateCollisionWithAvatars(Particle* particle) {
     const float ELASTICITY = 0.9f;
     const float DAMPING = 0.1f;
     const float COLLISION_FREQUENCY = 0.5f;
-    glm::vec3 penetration;
 
-    _collisions.clear();
-    foreach (const AvatarSharedPointer& avatarPointer, _avatars->getAvatarHash()) {
-        AvatarData* avatar = avatarPointer.data();
-
-        // use a very generous bounding radius since the arms can stretch
-        float totalRadius = 2.f * avatar->getBoundingRadius() + radius;
-        glm::vec3 relativePosition = center - avatar->getPosition();
-        if (glm::dot(relativePosition, relativePosition) > (totalRadius * totalRadius)) {
-            continue;
-        }
+    // use a very generous bounding radius since the arms can stretch
+    float totalRadius = AVATAR_BOUNDING_RADIUS_SCALE * avatar->getBoundingRadius() + radius;
+    glm::vec3 relativePosition = center - avatar->getPosition();
+    if (glm::dot(relativePosition, relativePosition) > (totalRadius * totalRadius)) {
+        return;
+    }
 
-        if (avatar->findParticleCollisions(center, radius, _collisions)) {
-            int numCollisions = _collisions.size();
-            for (int i = 0; i < numCollisions; ++i) {
-                CollisionInfo* collision = _collisions.getCollision(i);
-                collision->_damping = DAMPING;
-                collision->_elasticity = ELASTICITY;
-    
-                collision->_addedVelocity /= (float)(TREE_SCALE);
-                glm::vec3 relativeVelocity = collision->_addedVelocity - particle->getVelocity();
-    
-                if (glm::dot(relativeVelocity, collision->_penetration) <= 0.f) {
-                    // only collide when particle and collision point are moving toward each other
-                    // (doing this prevents some "collision snagging" when particle penetrates the object)
-    
-                    // HACK BEGIN: to allow paddle hands to "hold" particles we attenuate soft collisions against them.
-                    if (collision->_type == COLLISION_TYPE_PADDLE_HAND) {
-                        // NOTE: the physics are wrong (particles cannot roll) but it IS possible to catch a slow moving particle.
-                        // TODO: make this less hacky when we have more per-collision details
-                        float elasticity = ELASTICITY;
-                        float attenuationFactor = glm::length(collision->_addedVelocity) / HALTING_SPEED;
-                        float damping = DAMPING;
-                        if (attenuationFactor < 1.f) {
-                            collision->_addedVelocity *= attenuationFactor;
-                            elasticity *= attenuationFactor;
-                            // NOTE: the math below keeps the damping piecewise continuous,
-                            // while ramping it up to 1 when attenuationFactor = 0
-                            damping = DAMPING + (1.f - attenuationFactor) * (1.f - DAMPING);
-                        }
-                        collision->_damping = damping;
+    _collisions.clear();
+    if (avatar->findParticleCollisions(center, radius, _collisions)) {
+        int numCollisions = _collisions.size();
+        for (int i = 0; i < numCollisions; ++i) {
+            CollisionInfo* collision = _collisions.getCollision(i);
+            collision->_damping = DAMPING;
+            collision->_elasticity = ELASTICITY;
+
+            collision->_addedVelocity /= (float)(TREE_SCALE);
+            glm::vec3 relativeVelocity = collision->_addedVelocity - particle->getVelocity();
+
+            if (glm::dot(relativeVelocity, collision->_penetration) <= 0.f) {
+                // only collide when particle and collision point are moving toward each other
+                // (doing this prevents some "collision snagging" when particle penetrates the object)
+
+                // HACK BEGIN: to allow paddle hands to "hold" particles we attenuate soft collisions against them.
+                if (collision->_type == COLLISION_TYPE_PADDLE_HAND) {
+                    // NOTE: the physics are wrong (particles cannot roll) but it IS possible to catch a slow moving particle.
+                    // TODO: make this less hacky when we have more per-collision details
+                    float elasticity = ELASTICITY;
+                    float attenuationFactor = glm::length(collision->_addedVelocity) / HALTING_SPEED;
+                    float damping = DAMPING;
+                    if (attenuationFactor < 1.f) {
+                        collision->_addedVelocity *= attenuationFactor;
+                        elasticity *= attenuationFactor;
+                        // NOTE: the math below keeps the damping piecewise continuous,
+                        // while ramping it up to 1 when attenuationFactor = 0
+                        damping = DAMPING + (1.f - attenuationFactor) * (1.f - DAMPING);
                     }
-                    // HACK END
-    
-                    updateCollisionSound(particle, collision->_penetration, COLLISION_FREQUENCY);
-                    collision->_penetration /= (float)(TREE_SCALE);
-                    particle->applyHardCollision(*collision);
-                    queueParticlePropertiesUpdate(particle);
+                    collision->_damping = damping;
                 }
+                // HACK END
+
+                updateCollisionSound(particle, collision->_penetration, COLLISION_FREQUENCY);
+                collision->_penetration /= (float)(TREE_SCALE);
+                particle->applyHardCollision(*collision);
+                queueParticlePropertiesUpdate(particle);
             }
         }
     }
@@ -21,6 +21,7 @@
 #include <AvatarHashMap.h>
 #include <CollisionInfo.h>
 #include <SharedUtil.h>
+#include <SweepAndPrune.h>
 #include <OctreePacketData.h>
 
 #include "Particle.h"
@@ -30,6 +31,7 @@ class AvatarData;
 class ParticleEditPacketSender;
 class ParticleTree;
 class VoxelTree;
+struct VoxelDetail;
 
 const glm::vec3 NO_ADDED_VELOCITY = glm::vec3(0);
 
@@ -45,12 +47,17 @@ public:
                                 
     ~ParticleCollisionSystem();
 
+    /// Collides all the particles.  A broadphase over the bounds of the particles and avatars finds the pairs that
+    /// might touch, so that only those are checked; the voxel tree is searched for each particle, in parallel.
     void update();
 
     void checkParticle(Particle* particle);
     void updateCollisionWithVoxels(Particle* particle);
     void updateCollisionWithParticles(Particle* particle);
     void updateCollisionWithAvatars(Particle* particle);
+    void updateCollisionWithVoxel(Particle* particle, VoxelDetail* voxelDetails, const glm::vec3& penetration);
+    void updateCollisionWithParticle(Particle* particleA, Particle* particleB, const glm::vec3& penetration);
+    void updateCollisionWithAvatar(Particle* particle, AvatarData* avatar);
     void queueParticlePropertiesUpdate(Particle* particle);
     void updateCollisionSound(Particle* particle, const glm::vec3 &penetration, float frequency);
 
@@ -59,7 +66,8 @@ signals:
     void particleCollisionWithParticle(const ParticleID& idA, const ParticleID& idB, const CollisionInfo& penetration);
 
 private:
-    static bool updateOperation(OctreeElement* element, void* extraData);
+    static bool gatherOperation(OctreeElement* element, void* extraData);
+    void findVoxelCollisions();
     void emitGlobalParticleCollisionWithVoxel(Particle* particle, VoxelDetail* voxelDetails, const CollisionInfo& penetration);
     void emitGlobalParticleCollisionWithParticle(Particle* particleA, Particle* particleB, const CollisionInfo& penetration);
 
@@ -69,6 +77,13 @@ private:
     AbstractAudioInterface* _audio;
     AvatarHashMap* _avatars;
     CollisionList _collisions;
+
+    QVector<Particle*> _particlesToCheck;
+    QVector<AvatarData*> _avatarsToCheck;
+    SweepAndPrune _broadphase;
+    QVector<BoxPair> _pairs;
+    QVector<VoxelDetail*> _voxelDetails; ///< for each particle checked, the voxel it penetrates, if any
+    QVector<glm::vec3> _voxelPenetrations;
 };
 
 #endif // hifi_ParticleCollisionSystem_h
@@ -0,0 +1,273 @@
+//
+//  ParticleScriptHost.cpp
+//  libraries/particles/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QMutexLocker>
+#include <QTextStream>
+
+#include <SharedUtil.h>
+#include <VoxelDetail.h>
+#include <VoxelsScriptingInterface.h>
+
+// see Particle.cpp on including the script-engine header without linking to it
+#include "../../script-engine/src/ScriptEngine.h"
+
+#include "Particle.h"
+#include "ParticlesScriptingInterface.h"
+#include "ParticleScriptHost.h"
+
+// scripts beyond this many are evicted, least recently used first, along with their engines
+const int MAX_CACHED_PARTICLE_SCRIPTS = 64;
+
+// a script needs more than one engine only if it's reentered; there's no point holding on to many
+const int MAX_IDLE_CONTEXTS_PER_SCRIPT = 4;
+
+const int MAX_REPORTED_SCRIPT_NAME_LENGTH = 40;
+
+/// An initialized engine for a particle script, along with the objects the script sees.
+class ParticleScriptContext {
+public:
+
+    ParticleScriptContext(const QString& script);
+    ~ParticleScriptContext();
+
+    /// Evaluates the script afresh for a particle, as a new engine would: in a new scope, with a new Particle object
+    /// (so that no handler connected for another particle is left), letting the script act on the particle in its top
+    /// level code and connect its handlers.
+    void bind(Particle* particle);
+
+    /// Stops whatever timers the script set and drops its Particle object, so that nothing runs between calls.
+    void unbind();
+
+    QString script;
+    QScriptProgram program; ///< compiled on first evaluation, and reused thereafter
+    Particle placeholder;
+    ParticleScriptObject* particleScriptable;
+    ParticleScriptObject otherParticleScriptable;
+    ScriptEngine engine;
+};
+
+ParticleScriptContext::ParticleScriptContext(const QString& script) :
+    script(script),
+    program(script),
+    placeholder(ParticleID(UNKNOWN_PARTICLE_ID, UNKNOWN_TOKEN, false), ParticleProperties()),
+    particleScriptable(NULL),
+    otherParticleScriptable(&placeholder),
+    engine(script) {
+
+    // initializing the engine and compiling the script are the expensive parts, and are what we save by pooling
+    engine.init();
+}
+
+ParticleScriptContext::~ParticleScriptContext() {
+    unbind();
+}
+
+void ParticleScriptContext::bind(Particle* particle) {
+    engine.resetScope();
+    particleScriptable = new ParticleScriptObject(particle);
+    engine.registerGlobalObject("Particle", particleScriptable);
+    engine.evaluate(program);
+}
+
+void ParticleScriptContext::unbind() {
+    engine.stopAllTimers();
+    delete particleScriptable;
+    particleScriptable = NULL;
+}
+
+ParticleScriptHost* ParticleScriptHost::getInstance() {
+    static ParticleScriptHost instance;
+    return &instance;
+}
+
+ParticleScriptHost::ScriptRecord::ScriptRecord() :
+    lastUsed(0),
+    compiles(0),
+    calls(0),
+    totalUsecs(0),
+    maxUsecs(0) {
+}
+
+ParticleScriptHost::ParticleScriptHost() :
+    _useCounter(0),
+    _tickBudget(0),
+    _tickUsecsSpent(0),
+    _tickUpdates(0),
+    _tickFirstUpdate(0),
+    _budgetSpentAtUpdate(0),
+    _skippedUpdates(0) {
+}
+
+ParticleScriptHost::~ParticleScriptHost() {
+    foreach (const ScriptRecord& record, _scripts) {
+        qDeleteAll(record.idleContexts);
+    }
+}
+
+void ParticleScriptHost::beginTick() {
+    QMutexLocker locker(&_mutex);
+    _tickUsecsSpent = 0;
+    _tickUpdates = 0;
+
+    // pick up where the budget ran out last tick, so that the particles late in the tree get their turn
+    _tickFirstUpdate = _budgetSpentAtUpdate;
+    _budgetSpentAtUpdate = 0;
+}
+
+void ParticleScriptHost::runUpdate(Particle* particle) {
+    {
+        QMutexLocker locker(&_mutex);
+        int update = _tickUpdates++;
+        if (_tickBudget != 0) {
+            if (update < _tickFirstUpdate) {
+                // these had their turn last tick
+                _skippedUpdates++;
+                return;
+            }
+            if (_tickUsecsSpent >= _tickBudget) {
+                if (_budgetSpentAtUpdate == 0) {
+                    _budgetSpentAtUpdate = update;
+                }
+                _skippedUpdates++;
+                return;
+            }
+        }
+    }
+    quint64 startedAt = usecTimestampNow();
+    ParticleScriptContext* context = acquireContext(particle);
+    context->particleScriptable->emitUpdate();
+    releaseContext(context, startedAt);
+}
+
+void ParticleScriptHost::runCollisionWithParticle(Particle* particle, Particle* other, const glm::vec3& penetration) {
+    quint64 startedAt = usecTimestampNow();
+    ParticleScriptContext* context = acquireContext(particle);
+    context->otherParticleScriptable.setParticle(other);
+    context->particleScriptable->emitCollisionWithParticle(&context->otherParticleScriptable, penetration);
+    context->otherParticleScriptable.setParticle(&context->placeholder);
+    releaseContext(context, startedAt);
+}
+
+void ParticleScriptHost::runCollisionWithVoxel(Particle* particle, const VoxelDetail& voxel,
+        const glm::vec3& penetration) {
+    quint64 startedAt = usecTimestampNow();
+    ParticleScriptContext* context = acquireContext(particle);
+    context->particleScriptable->emitCollisionWithVoxel(voxel, penetration);
+    releaseContext(context, startedAt);
+}
+
+QString ParticleScriptHost::takeReport() {
+    QMutexLocker locker(&_mutex);
+    bool anyCalls = (_skippedUpdates > 0);
+    foreach (const ScriptRecord& record, _scripts) {
+        anyCalls = anyCalls || (record.calls > 0);
+    }
+    if (!anyCalls) {
+        return QString();
+    }
+    QString report;
+    QTextStream stream(&report);
+    stream << "particle scripts: " << _scripts.size() << " cached, " << _skippedUpdates
+        << " updates skipped over budget";
+    for (QHash<QString, ScriptRecord>::iterator it = _scripts.begin(); it != _scripts.end(); it++) {
+        ScriptRecord& record = it.value();
+        if (record.calls == 0) {
+            continue;
+        }
+        QString name = it.key().simplified().left(MAX_REPORTED_SCRIPT_NAME_LENGTH);
+        stream << "\n    [" << name << "] calls: " << record.calls << " compiles: " << record.compiles
+            << " average usecs: " << record.totalUsecs / record.calls << " max usecs: " << record.maxUsecs;
+        record.compiles = 0;
+        record.calls = 0;
+        record.totalUsecs = 0;
+        record.maxUsecs = 0;
+    }
+    _skippedUpdates = 0;
+    stream.flush();
+    return report;
+}
+
+ParticleScriptContext* ParticleScriptHost::acquireContext(Particle* particle) {
+    ParticleScriptContext* context = NULL;
+    {
+        QMutexLocker locker(&_mutex);
+        QHash<QString, ScriptRecord>::iterator it = _scripts.find(particle->getScript());
+        if (it == _scripts.end()) {
+            if (_scripts.size() >= MAX_CACHED_PARTICLE_SCRIPTS) {
+                evictLeastRecentlyUsed();
+            }
+            it = _scripts.insert(particle->getScript(), ScriptRecord());
+        }
+        it.value().lastUsed = ++_useCounter;
+        if (!it.value().idleContexts.isEmpty()) {
+            context = it.value().idleContexts.takeLast();
+        } else {
+            // each new context compiles the script once, for its own engine
+            it.value().compiles++;
+        }
+    }
+    if (!context) {
+        // initializing the engine is the expensive part; do it outside the lock
+        context = new ParticleScriptContext(particle->getScript());
+    }
+
+    VoxelEditPacketSender* voxelEditSender = Particle::getVoxelEditPacketSender();
+    if (voxelEditSender) {
+        context->engine.getVoxelsScriptingInterface()->setPacketSender(voxelEditSender);
+    }
+    ParticleEditPacketSender* particleEditSender = Particle::getParticleEditPacketSender();
+    if (particleEditSender) {
+        context->engine.getParticlesScriptingInterface()->setPacketSender(particleEditSender);
+    }
+    context->bind(particle);
+    return context;
+}
+
+void ParticleScriptHost::releaseContext(ParticleScriptContext* context, quint64 startedAt) {
+    if (Particle::getVoxelEditPacketSender()) {
+        Particle::getVoxelEditPacketSender()->releaseQueuedMessages();
+    }
+    if (Particle::getParticleEditPacketSender()) {
+        Particle::getParticleEditPacketSender()->releaseQueuedMessages();
+    }
+    context->unbind();
+
+    quint64 elapsed = usecTimestampNow() - startedAt;
+    QMutexLocker locker(&_mutex);
+    _tickUsecsSpent += elapsed;
+    QHash<QString, ScriptRecord>::iterator it = _scripts.find(context->script);
+    if (it == _scripts.end()) {
+        // evicted while we were using it
+        delete context;
+        return;
+    }
+    ScriptRecord& record = it.value();
+    record.calls++;
+    record.totalUsecs += elapsed;
+    record.maxUsecs = qMax(record.maxUsecs, elapsed);
+    if (record.idleContexts.size() < MAX_IDLE_CONTEXTS_PER_SCRIPT) {
+        record.idleContexts.append(context);
+    } else {
+        delete context;
+    }
+}
+
+void ParticleScriptHost::evictLeastRecentlyUsed() {
+    QHash<QString, ScriptRecord>::iterator leastRecentlyUsed = _scripts.end();
+    for (QHash<QString, ScriptRecord>::iterator it = _scripts.begin(); it != _scripts.end(); it++) {
+        if (leastRecentlyUsed == _scripts.end() || it.value().lastUsed < leastRecentlyUsed.value().lastUsed) {
+            leastRecentlyUsed = it;
+        }
+    }
+    if (leastRecentlyUsed != _scripts.end()) {
+        qDeleteAll(leastRecentlyUsed.value().idleContexts);
+        _scripts.erase(leastRecentlyUsed);
+    }
+}
@@ -0,0 +1,87 @@
+//
+//  ParticleScriptHost.h
+//  libraries/particles/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ParticleScriptHost_h
+#define hifi_ParticleScriptHost_h
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+#include <glm/glm.hpp>
+
+class Particle;
+class ParticleScriptContext;
+struct VoxelDetail;
+
+/// Runs the scripts attached to particles.  Rather than building and initializing a new engine for every call, the
+/// engines for each distinct script are pooled and reused, each with the script compiled once for it.  Each call
+/// still runs the compiled script afresh for the particle at hand, in a new scope with a new Particle object, and stops
+/// the script's timers when it returns, so scripts see what they would in a new engine: neither globals nor handlers
+/// carry over from one call to the next.
+class ParticleScriptHost {
+public:
+
+    static ParticleScriptHost* getInstance();
+
+    ParticleScriptHost();
+    ~ParticleScriptHost();
+
+    /// Sets the time that update scripts may take in each tick.  Once it's spent, the rest of the tick's update
+    /// scripts are skipped, and the next tick starts with the first of those skipped, so that every particle gets its
+    /// turn.  Collision scripts always run, since they report events that won't recur.
+    /// \param usecs the budget, or zero for no limit
+    void setTickBudget(quint64 usecs) { _tickBudget = usecs; }
+    quint64 getTickBudget() const { return _tickBudget; }
+
+    /// Starts a new tick, resetting the time spent against the budget.
+    void beginTick();
+
+    void runUpdate(Particle* particle);
+    void runCollisionWithParticle(Particle* particle, Particle* other, const glm::vec3& penetration);
+    void runCollisionWithVoxel(Particle* particle, const VoxelDetail& voxel, const glm::vec3& penetration);
+
+    /// Returns a summary of the calls to, compiles of and time spent in each script since the last report (or an empty
+    /// string, if there were none), and starts counting anew.
+    QString takeReport();
+
+private:
+
+    class ScriptRecord {
+    public:
+        ScriptRecord();
+
+        QList<ParticleScriptContext*> idleContexts;
+        quint64 lastUsed;
+        int compiles; ///< the number of times the script was compiled, once for each new engine
+        int calls;
+        quint64 totalUsecs;
+        quint64 maxUsecs;
+    };
+
+    ParticleScriptContext* acquireContext(Particle* particle);
+    void releaseContext(ParticleScriptContext* context, quint64 startedAt);
+
+    void evictLeastRecentlyUsed();
+
+    QMutex _mutex;
+    QHash<QString, ScriptRecord> _scripts;
+    quint64 _useCounter;
+
+    quint64 _tickBudget;
+    quint64 _tickUsecsSpent;
+    int _tickUpdates;
+    int _tickFirstUpdate;
+    int _budgetSpentAtUpdate;
+    int _skippedUpdates;
+};
+
+#endif // hifi_ParticleScriptHost_h
@@ -0,0 +1,90 @@
+//
+//  ParticleSimulationStore.cpp
+//  libraries/particles/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "Particle.h"
+#include "ParticleSimulationStore.h"
+
+void ParticleSimulationStore::clear() {
+    _positionX.clear();
+    _positionY.clear();
+    _positionZ.clear();
+    _velocityX.clear();
+    _velocityY.clear();
+    _velocityZ.clear();
+    _gravityX.clear();
+    _gravityY.clear();
+    _gravityZ.clear();
+    _damping.clear();
+    _timeElapsed.clear();
+}
+
+int ParticleSimulationStore::add(const Particle& particle, float timeElapsed) {
+    const glm::vec3& position = particle.getPosition();
+    _positionX.push_back(position.x);
+    _positionY.push_back(position.y);
+    _positionZ.push_back(position.z);
+
+    const glm::vec3& velocity = particle.getVelocity();
+    _velocityX.push_back(velocity.x);
+    _velocityY.push_back(velocity.y);
+    _velocityZ.push_back(velocity.z);
+
+    const glm::vec3& gravity = particle.getGravity();
+    _gravityX.push_back(gravity.x);
+    _gravityY.push_back(gravity.y);
+    _gravityZ.push_back(gravity.z);
+
+    _damping.push_back(particle.getDamping());
+    _timeElapsed.push_back(timeElapsed);
+    return _timeElapsed.size() - 1;
+}
+
+void ParticleSimulationStore::integrate() {
+    int count = size();
+    if (count == 0) {
+        return;
+    }
+    float* positionX = &_positionX[0];
+    float* positionY = &_positionY[0];
+    float* positionZ = &_positionZ[0];
+    float* velocityX = &_velocityX[0];
+    float* velocityY = &_velocityY[0];
+    float* velocityZ = &_velocityZ[0];
+    const float* gravityX = &_gravityX[0];
+    const float* gravityY = &_gravityY[0];
+    const float* gravityZ = &_gravityZ[0];
+    const float* damping = &_damping[0];
+    const float* timeElapsed = &_timeElapsed[0];
+
+    // the arrays don't alias and there are no branches, so this loop vectorizes
+    for (int i = 0; i < count; i++) {
+        float seconds = timeElapsed[i];
+        float x = positionX[i] + velocityX[i] * seconds;
+        float y = positionY[i] + velocityY[i] * seconds;
+        float z = positionZ[i] + velocityZ[i] * seconds;
+
+        // handle bounces off the ground...
+        bool bounced = (y <= 0.0f);
+        float velocityAfterBounceY = bounced ? -velocityY[i] : velocityY[i];
+        positionX[i] = x;
+        positionY[i] = bounced ? 0.0f : y;
+        positionZ[i] = z;
+
+        // handle gravity....
+        float vx = velocityX[i] + gravityX[i] * seconds;
+        float vy = velocityAfterBounceY + gravityY[i] * seconds;
+        float vz = velocityZ[i] + gravityZ[i] * seconds;
+
+        // handle damping
+        velocityX[i] = vx - (vx * damping[i]) * seconds;
+        velocityY[i] = vy - (vy * damping[i]) * seconds;
+        velocityZ[i] = vz - (vz * damping[i]) * seconds;
+    }
+}
@@ -0,0 +1,61 @@
+//
+//  ParticleSimulationStore.h
+//  libraries/particles/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ParticleSimulationStore_h
+#define hifi_ParticleSimulationStore_h
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class Particle;
+
+/// The fields that integration reads and writes for a batch of particles: position, velocity, gravity, damping and the
+/// time to integrate over.  Rather than leaving them spread through the (large) particles, the store keeps each
+/// component in its own contiguous array, so that the integration loop walks memory linearly and can be vectorized.
+/// Particles are gathered in, integrated together, and their motion read back out.
+class ParticleSimulationStore {
+public:
+
+    /// Empties the store, keeping the capacity of its arrays for the next batch.
+    void clear();
+
+    int size() const { return _timeElapsed.size(); }
+
+    /// Adds a particle's motion to the batch.
+    /// \param timeElapsed the time to integrate over, in seconds
+    /// \return the particle's index in the batch
+    int add(const Particle& particle, float timeElapsed);
+
+    /// Integrates the motion of every particle in the batch: moves it by its velocity, bounces it off the ground, and
+    /// applies gravity and damping to its velocity.
+    void integrate();
+
+    glm::vec3 getPosition(int index) const {
+        return glm::vec3(_positionX[index], _positionY[index], _positionZ[index]); }
+    glm::vec3 getVelocity(int index) const {
+        return glm::vec3(_velocityX[index], _velocityY[index], _velocityZ[index]); }
+
+private:
+
+    std::vector<float> _positionX;
+    std::vector<float> _positionY;
+    std::vector<float> _positionZ;
+    std::vector<float> _velocityX;
+    std::vector<float> _velocityY;
+    std::vector<float> _velocityZ;
+    std::vector<float> _gravityX;
+    std::vector<float> _gravityY;
+    std::vector<float> _gravityZ;
+    std::vector<float> _damping;
+    std::vector<float> _timeElapsed;
+};
+
+#endif // hifi_ParticleSimulationStore_h
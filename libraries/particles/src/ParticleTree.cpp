@@ -9,12 +9,19 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include "ParticleScriptHost.h"
 #include "ParticleTree.h"
 
 ParticleTree::ParticleTree(bool shouldReaverage) : Octree(shouldReaverage) {
     _rootElement = createNewElement();
 }
 
+ParticleTree::~ParticleTree() {
+    // delete the elements while the map they update on the way out still exists
+    delete _rootElement;
+    _rootElement = NULL;
+}
+
 ParticleTreeElement* ParticleTree::createNewElement(unsigned char * octalCode) {
     ParticleTreeElement* newElement = new ParticleTreeElement(octalCode);
     newElement->setTree(this);
@@ -32,49 +39,6 @@ bool ParticleTree::handlesEditPacketType(PacketType packetType) const {
     }
 }
 
-class FindAndDeleteParticlesArgs {
-public:
-    QList<uint32_t> _idsToDelete;
-};
-
-bool ParticleTree::findAndDeleteOperation(OctreeElement* element, void* extraData) {
-    //qDebug() << "findAndDeleteOperation()";
-
-    FindAndDeleteParticlesArgs* args = static_cast< FindAndDeleteParticlesArgs*>(extraData);
-
-    // if we've found and deleted all our target particles, then we can stop looking
-    if (args->_idsToDelete.size() <= 0) {
-        return false;
-    }
-
-    ParticleTreeElement* particleTreeElement = static_cast<ParticleTreeElement*>(element);
-
-    //qDebug() << "findAndDeleteOperation() args->_idsToDelete.size():" << args->_idsToDelete.size();
-
-    for (QList<uint32_t>::iterator it = args->_idsToDelete.begin(); it != args->_idsToDelete.end(); it++) {
-        uint32_t particleID = *it;
-        //qDebug() << "findAndDeleteOperation() particleID:" << particleID;
-
-        if (particleTreeElement->removeParticleWithID(particleID)) {
-            // if the particle was in this element, then remove it from our search list.
-            //qDebug() << "findAndDeleteOperation() it = args->_idsToDelete.erase(it)";
-            it = args->_idsToDelete.erase(it);
-        }
-
-        if (it == args->_idsToDelete.end()) {
-            //qDebug() << "findAndDeleteOperation() breaking";
-            break;
-        }
-    }
-
-    // if we've found and deleted all our target particles, then we can stop looking
-    if (args->_idsToDelete.size() <= 0) {
-        return false;
-    }
-    return true;
-}
-
-
 class FindAndUpdateParticleArgs {
 public:
     const Particle& searchParticle;
@@ -93,9 +57,15 @@ bool ParticleTree::findAndUpdateOperation(OctreeElement* element, void* extraDat
 }
 
 void ParticleTree::storeParticle(const Particle& particle, const SharedNodePointer& senderNode) {
-    // First, look for the existing particle in the tree..
+    // First, look for the existing particle in the tree: by ID if it has one, otherwise by searching
     FindAndUpdateParticleArgs args = { particle, false };
-    recurseTreeWithOperation(findAndUpdateOperation, &args);
+    if (particle.getID() == UNKNOWN_PARTICLE_ID) {
+        recurseTreeWithOperation(findAndUpdateOperation, &args);
+
+    } else {
+        ParticleTreeElement* containingElement = getContainingElement(particle.getID());
+        args.found = containingElement && containingElement->updateParticle(particle);
+    }
 
     // if we didn't find it in the tree, then store it...
     if (!args.found) {
@@ -160,9 +130,10 @@ void ParticleTree::addParticle(const ParticleID& particleID, const ParticlePrope
 
 void ParticleTree::deleteParticle(const ParticleID& particleID) {
     if (particleID.isKnownID) {
-        FindAndDeleteParticlesArgs args;
-        args._idsToDelete.push_back(particleID.id);
-        recurseTreeWithOperation(findAndDeleteOperation, &args);
+        ParticleTreeElement* containingElement = getContainingElement(particleID.id);
+        if (containingElement) {
+            containingElement->removeParticleWithID(particleID.id);
+        }
     }
 }
 
@@ -378,7 +349,13 @@ const Particle* ParticleTree::findParticleByID(uint32_t id, bool alreadyLocked)
     if (!alreadyLocked) {
         lockForRead();
     }
-    recurseTreeWithOperation(findByIDOperation, &args);
+    if (id == UNKNOWN_PARTICLE_ID) {
+        recurseTreeWithOperation(findByIDOperation, &args);
+
+    } else {
+        ParticleTreeElement* containingElement = getContainingElement(id);
+        args.foundParticle = containingElement ? containingElement->getParticleWithID(id) : NULL;
+    }
     if (!alreadyLocked) {
         unlock();
     }
@@ -386,6 +363,21 @@ const Particle* ParticleTree::findParticleByID(uint32_t id, bool alreadyLocked)
 }
 
 
+void ParticleTree::setContainingElement(uint32_t particleID, ParticleTreeElement* element) {
+    // particles without IDs yet can only be found by searching
+    if (particleID != UNKNOWN_PARTICLE_ID) {
+        _particleToElementMap.insert(particleID, element);
+    }
+}
+
+void ParticleTree::clearContainingElement(uint32_t particleID, ParticleTreeElement* element) {
+    // a viewing tree can briefly hold two particles with the same ID; only forget the one being removed
+    QHash<uint32_t, ParticleTreeElement*>::iterator it = _particleToElementMap.find(particleID);
+    if (it != _particleToElementMap.end() && it.value() == element) {
+        _particleToElementMap.erase(it);
+    }
+}
+
 int ParticleTree::processEditPacketData(PacketType packetType, const unsigned char* packetData, int packetLength,
                     const unsigned char* editData, int maxLength, const SharedNodePointer& senderNode) {
 
@@ -397,6 +389,7 @@ int ParticleTree::processEditPacketData(PacketType packetType, const unsigned ch
             Particle newParticle = Particle::fromEditPacket(editData, maxLength, processedBytes, this, isValid);
             if (isValid) {
                 storeParticle(newParticle, senderNode);
+                _lastEditPosition = newParticle.getPosition();
                 if (newParticle.isNewlyCreated()) {
                     notifyNewlyCreatedParticle(newParticle, senderNode);
                 }
@@ -464,6 +457,9 @@ void ParticleTree::update() {
     lockForWrite();
     _isDirty = true;
 
+    // each update is a tick as far as the particle scripts' time budget is concerned
+    ParticleScriptHost::getInstance()->beginTick();
+
     ParticleTreeUpdateArgs args = { };
     recurseTreeWithOperation(updateOperation, &args);
 
@@ -615,8 +611,6 @@ void ParticleTree::processEraseMessage(const QByteArray& dataByteArray, const Sh
     processedBytes += sizeof(numberOfIds);
 
     if (numberOfIds > 0) {
-        FindAndDeleteParticlesArgs args;
-
         for (size_t i = 0; i < numberOfIds; i++) {
             if (processedBytes + sizeof(uint32_t) > packetLength) {
                 break; // bail to prevent buffer overflow
@@ -627,10 +621,7 @@ void ParticleTree::processEraseMessage(const QByteArray& dataByteArray, const Sh
             dataAt += sizeof(particleID);
             processedBytes += sizeof(particleID);
 
-            args._idsToDelete.push_back(particleID);
+            deleteParticle(ParticleID(particleID));
         }
-
-        // calling recurse to actually delete the particles
-        recurseTreeWithOperation(findAndDeleteOperation, &args);
     }
 }
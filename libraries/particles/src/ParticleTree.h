@@ -12,6 +12,8 @@
 #ifndef hifi_ParticleTree_h
 #define hifi_ParticleTree_h
 
+#include <QHash>
+
 #include <Octree.h>
 #include "ParticleTreeElement.h"
 
@@ -24,6 +26,7 @@ class ParticleTree : public Octree {
     Q_OBJECT
 public:
     ParticleTree(bool shouldReaverage = false);
+    virtual ~ParticleTree();
 
     /// Implements our type specific root element factory
     virtual ParticleTreeElement* createNewElement(unsigned char * octalCode = NULL);
@@ -36,6 +39,8 @@ public:
     // own definition. Implement these to allow your octree based server to support editing
     virtual bool getWantSVOfileVersions() const { return true; }
     virtual PacketType expectedDataPacketType() const { return PacketTypeParticleData; }
+    // version 2 added delta records, which are only sent to viewers; the SVO format is the same as version 1's
+    virtual bool canProcessVersion(PacketVersion thisVersion) const { return thisVersion == 1 || thisVersion == 2; }
     virtual bool handlesEditPacketType(PacketType packetType) const;
     virtual int processEditPacketData(PacketType packetType, const unsigned char* packetData, int packetLength,
                     const unsigned char* editData, int maxLength, const SharedNodePointer& senderNode);
@@ -73,6 +78,17 @@ public:
     void processEraseMessage(const QByteArray& dataByteArray, const SharedNodePointer& sourceNode);
     void handleAddParticleResponse(const QByteArray& packet);
 
+    /// Notes that an element now holds the particle with the given ID.  Elements keep this up to date, so that
+    /// particles can be found by ID without searching the tree.
+    void setContainingElement(uint32_t particleID, ParticleTreeElement* element);
+
+    /// Notes that an element no longer holds the particle with the given ID.
+    void clearContainingElement(uint32_t particleID, ParticleTreeElement* element);
+
+    /// Returns the element holding the particle with the given (known) ID, or NULL if there is none.
+    ParticleTreeElement* getContainingElement(uint32_t particleID) const {
+        return _particleToElementMap.value(particleID); }
+
 private:
 
     static bool updateOperation(OctreeElement* element, void* extraData);
@@ -82,7 +98,6 @@ private:
     static bool findInSphereOperation(OctreeElement* element, void* extraData);
     static bool pruneOperation(OctreeElement* element, void* extraData);
     static bool findByIDOperation(OctreeElement* element, void* extraData);
-    static bool findAndDeleteOperation(OctreeElement* element, void* extraData);
     static bool findAndUpdateParticleIDOperation(OctreeElement* element, void* extraData);
     static bool findInBoxForUpdateOperation(OctreeElement* element, void* extraData);
 
@@ -94,6 +109,8 @@ private:
 
     QReadWriteLock _recentlyDeletedParticlesLock;
     QMultiMap<quint64, uint32_t> _recentlyDeletedParticleIDs;
+
+    QHash<uint32_t, ParticleTreeElement*> _particleToElementMap;
 };
 
 #endif // hifi_ParticleTree_h
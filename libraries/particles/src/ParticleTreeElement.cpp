@@ -14,12 +14,17 @@
 #include "ParticleTree.h"
 #include "ParticleTreeElement.h"
 
-ParticleTreeElement::ParticleTreeElement(unsigned char* octalCode) : OctreeElement(), _particles(NULL) {
+ParticleTreeElement::ParticleTreeElement(unsigned char* octalCode) : OctreeElement(), _myTree(NULL), _particles(NULL) {
     init(octalCode);
 };
 
 ParticleTreeElement::~ParticleTreeElement() {
     _voxelMemoryUsage -= sizeof(ParticleTreeElement);
+    if (_myTree) {
+        foreach (const Particle& particle, *_particles) {
+            _myTree->clearContainingElement(particle.getID(), this);
+        }
+    }
     delete _particles;
     _particles = NULL;
 }
@@ -50,14 +55,20 @@ ParticleTreeElement* ParticleTreeElement::addChildAtIndex(int index) {
 bool ParticleTreeElement::appendElementData(OctreePacketData* packetData, EncodeBitstreamParams& params) const {
     bool success = true; // assume the best...
 
+    // if the client was already sent this element, it only needs what changed in each particle since then
+    bool sendDeltas = params.deltaViewFrustum && params.elementWasInView && params.lastViewFrustumSent > CHANGE_FUDGE;
+    quint64 deltasSince = sendDeltas ? params.lastViewFrustumSent - CHANGE_FUDGE : 0;
+
     // write our particles out...
     uint16_t numberOfParticles = _particles->size();
-    success = packetData->appendValue(numberOfParticles);
+    success = packetData->appendValue((uint16_t)(sendDeltas ? numberOfParticles | PARTICLE_DELTAS_FLAG :
+        numberOfParticles));
 
     if (success) {
         for (uint16_t i = 0; i < numberOfParticles; i++) {
             const Particle& particle = (*_particles)[i];
-            success = particle.appendParticleData(packetData);
+            success = sendDeltas ? particle.appendParticleDelta(packetData, particle.getDeltaSince(deltasSince)) :
+                particle.appendParticleData(packetData);
             if (!success) {
                 break;
             }
@@ -67,14 +78,45 @@ bool ParticleTreeElement::appendElementData(OctreePacketData* packetData, Encode
 }
 
 void ParticleTreeElement::update(ParticleTreeUpdateArgs& args) {
-    markWithChangedTime();
-    // TODO: early exit when _particles is empty
+    if (_particles->isEmpty()) {
+        return;
+    }
+
+    // age our contained particles and run their scripts, which may change anything about them, then integrate the
+    // motion of all those not in hand together
+    quint64 now = usecTimestampNow();
+    int numberOfParticles = _particles->size();
+    ParticleSimulationStore& simulation = args._simulation;
+    simulation.clear();
+    std::vector<ParticleUpdateState>& states = args._updateStates;
+    states.resize(numberOfParticles);
+    for (int i = 0; i < numberOfParticles; i++) {
+        Particle& particle = (*_particles)[i];
+        ParticleUpdateState& state = states[i];
+        state.oldPosition = particle.getPosition();
+        state.oldVelocity = particle.getVelocity();
+
+        // If the ball is in hand, it doesn't move or have gravity effect it
+        bool isInHand = particle.getInHand();
+        float timeElapsed;
+        state.propertiesChanged = particle.beginUpdate(now, timeElapsed);
+        state.simulationIndex = isInHand ? -1 : simulation.add(particle, timeElapsed);
+    }
+    simulation.integrate();
 
-    // update our contained particles
+    // note whether any of them changed; if none did (they're all at rest, say), the element needn't be resent
+    bool changed = false;
     QList<Particle>::iterator particleItr = _particles->begin();
-    while(particleItr != _particles->end()) {
+    for (int i = 0; i < numberOfParticles; i++) {
         Particle& particle = (*particleItr);
-        particle.update(_lastChanged);
+        const ParticleUpdateState& state = states[i];
+        if (state.simulationIndex != -1) {
+            particle.setPosition(simulation.getPosition(state.simulationIndex));
+            particle.setVelocity(simulation.getVelocity(state.simulationIndex));
+        }
+        if (particle.finishUpdate(now, state.oldPosition, state.oldVelocity, state.propertiesChanged)) {
+            changed = true;
+        }
 
         // If the particle wants to die, or if it's left our bounding box, then move it
         // into the arguments moving particles. These will be added back or deleted completely
@@ -82,11 +124,16 @@ void ParticleTreeElement::update(ParticleTreeUpdateArgs& args) {
             args._movingParticles.push_back(particle);
 
             // erase this particle
+            _myTree->clearContainingElement(particle.getID(), this);
             particleItr = _particles->erase(particleItr);
+            changed = true;
         } else {
             ++particleItr;
         }
     }
+    if (changed) {
+        markWithChangedTime();
+    }
     // TODO: if _particles is empty after while loop consider freeing memory in _particles if
     // internal array is too big (QList internal array does not decrease size except in dtor and
     // assignment operator).  Otherwise _particles could become a "resource leak" for large
@@ -148,6 +195,7 @@ bool ParticleTreeElement::updateParticle(const Particle& particle) {
                             difference, debug::valueOf(particle.isNewlyCreated()) );
                 }
                 thisParticle.copyChangedProperties(particle);
+                markWithChangedTime();
             } else {
                 if (wantDebug) {
                     qDebug(">>> IGNORING SERVER!!! Would've caused jutter! <<<  "
@@ -178,6 +226,7 @@ bool ParticleTreeElement::updateParticle(const ParticleID& particleID, const Par
         }
         if (found) {
             thisParticle.setProperties(properties);
+            markWithChangedTime();
 
             const bool wantDebug = false;
             if (wantDebug) {
@@ -194,6 +243,7 @@ bool ParticleTreeElement::updateParticle(const ParticleID& particleID, const Par
 }
 
 void ParticleTreeElement::updateParticleID(FindAndUpdateParticleIDArgs* args) {
+    bool creatorTokenFoundHere = false;
     uint16_t numberOfParticles = _particles->size();
     for (uint16_t i = 0; i < numberOfParticles; i++) {
         Particle& thisParticle = (*_particles)[i];
@@ -203,12 +253,14 @@ void ParticleTreeElement::updateParticleID(FindAndUpdateParticleIDArgs* args) {
             if (thisParticle.getCreatorTokenID() == args->creatorTokenID) {
                 thisParticle.setID(args->particleID);
                 args->creatorTokenFound = true;
+                creatorTokenFoundHere = true;
             }
         }
         
         // if we're in an isViewing tree, we also need to look for an kill any viewed particles
         if (!args->viewedParticleFound && args->isViewing) {
             if (thisParticle.getCreatorTokenID() == UNKNOWN_TOKEN && thisParticle.getID() == args->particleID) {
+                _myTree->clearContainingElement(thisParticle.getID(), this);
                 _particles->removeAt(i); // remove the particle at this index
                 numberOfParticles--; // this means we have 1 fewer particle in this list
                 i--; // and we actually want to back up i as well.
@@ -216,6 +268,11 @@ void ParticleTreeElement::updateParticleID(FindAndUpdateParticleIDArgs* args) {
             }
         }
     }
+
+    // index the particle we gave its ID only now, since removing a viewed particle here would have unindexed it
+    if (creatorTokenFoundHere) {
+        _myTree->setContainingElement(args->particleID, this);
+    }
 }
 
 
@@ -281,6 +338,7 @@ bool ParticleTreeElement::removeParticleWithID(uint32_t id) {
     for (uint16_t i = 0; i < numberOfParticles; i++) {
         if ((*_particles)[i].getID() == id) {
             foundParticle = true;
+            _myTree->clearContainingElement(id, this);
             _particles->removeAt(i);
             break;
         }
@@ -303,7 +361,11 @@ int ParticleTreeElement::readElementDataFromBuffer(const unsigned char* data, in
         bytesLeftToRead -= (int)sizeof(numberOfParticles);
         bytesRead += sizeof(numberOfParticles);
 
-        if (bytesLeftToRead >= (int)(numberOfParticles * expectedBytesPerParticle)) {
+        if (numberOfParticles & PARTICLE_DELTAS_FLAG) {
+            numberOfParticles &= ~PARTICLE_DELTAS_FLAG;
+            bytesRead += readParticleDeltasFromBuffer(dataAt, bytesLeftToRead, numberOfParticles, args);
+
+        } else if (bytesLeftToRead >= (int)(numberOfParticles * expectedBytesPerParticle)) {
             for (uint16_t i = 0; i < numberOfParticles; i++) {
                 Particle tempParticle;
                 int bytesForThisParticle = tempParticle.readParticleDataFromBuffer(dataAt, bytesLeftToRead, args);
@@ -318,6 +380,57 @@ int ParticleTreeElement::readElementDataFromBuffer(const unsigned char* data, in
     return bytesRead;
 }
 
+int ParticleTreeElement::readParticleDeltasFromBuffer(const unsigned char* data, int bytesLeftToRead,
+        uint16_t numberOfParticles, ReadBitstreamToTreeParams& args) {
+    const unsigned char* dataAt = data;
+    int bytesRead = 0;
+    for (uint16_t i = 0; i < numberOfParticles; i++) {
+        if (bytesLeftToRead < (int)(sizeof(quint8) + sizeof(uint32_t))) {
+            break;
+        }
+        quint8 delta = *dataAt;
+        dataAt += sizeof(delta);
+        bytesLeftToRead -= (int)sizeof(delta);
+        bytesRead += sizeof(delta);
+
+        int bytesForThisParticle = 0;
+        if (delta == PARTICLE_CHANGED) {
+            if (bytesLeftToRead < Particle::expectedBytes()) {
+                break;
+            }
+            Particle tempParticle;
+            bytesForThisParticle = tempParticle.readParticleDataFromBuffer(dataAt, bytesLeftToRead, args);
+            _myTree->storeParticle(tempParticle);
+
+        } else {
+            uint32_t id;
+            memcpy(&id, dataAt, sizeof(id));
+            bytesForThisParticle = sizeof(id);
+
+            // we already have everything but (perhaps) the motion; apply it to a copy of what we have
+            if (delta == PARTICLE_MOVED) {
+                int bytesOfMotion = 0;
+                const Particle* existingParticle = _myTree->findParticleByID(id, true);
+                Particle tempParticle = existingParticle ? *existingParticle :
+                    Particle(ParticleID(id, UNKNOWN_TOKEN, true), ParticleProperties());
+                bytesOfMotion = tempParticle.readParticleMotionFromBuffer(dataAt + bytesForThisParticle,
+                    bytesLeftToRead - bytesForThisParticle, args);
+                if (bytesOfMotion == 0) {
+                    break;
+                }
+                bytesForThisParticle += bytesOfMotion;
+                if (existingParticle) {
+                    _myTree->storeParticle(tempParticle);
+                }
+            }
+        }
+        dataAt += bytesForThisParticle;
+        bytesLeftToRead -= bytesForThisParticle;
+        bytesRead += bytesForThisParticle;
+    }
+    return bytesRead;
+}
+
 // will average a "common reduced LOD view" from the the child elements...
 void ParticleTreeElement::calculateAverageFromChildren() {
     // nothing to do here yet...
@@ -335,6 +448,11 @@ bool ParticleTreeElement::collapseChildren() {
 
 void ParticleTreeElement::storeParticle(const Particle& particle) {
     _particles->push_back(particle);
+
+    // a viewer that was sent this element before the particle arrived has never been sent the particle, so deltas
+    // against anything older than now have to carry all of it
+    _particles->back().markChanged();
+    _myTree->setContainingElement(particle.getID(), this);
     markWithChangedTime();
 }
 
@@ -12,20 +12,38 @@
 #ifndef hifi_ParticleTreeElement_h
 #define hifi_ParticleTreeElement_h
 
-//#include <vector>
+#include <vector>
 
 #include <OctreeElement.h>
 #include <QList>
 
 #include "Particle.h"
+#include "ParticleSimulationStore.h"
 #include "ParticleTree.h"
 
 class ParticleTree;
 class ParticleTreeElement;
 
+/// Set in an element's particle count when the particles that follow are delta records
+/// (see Particle::appendParticleDelta)
+const uint16_t PARTICLE_DELTAS_FLAG = 0x8000;
+
+/// What ParticleTreeElement::update notes about a particle before its motion is integrated.
+class ParticleUpdateState {
+public:
+    glm::vec3 oldPosition;
+    glm::vec3 oldVelocity;
+    bool propertiesChanged;
+    int simulationIndex; // the particle's index in the simulation store, or -1 if it's in hand and doesn't move
+};
+
 class ParticleTreeUpdateArgs {
 public:
     QList<Particle> _movingParticles;
+
+    // scratch space for the elements' updates, kept here so that its capacity carries from element to element
+    ParticleSimulationStore _simulation;
+    std::vector<ParticleUpdateState> _updateStates;
 };
 
 class FindAndUpdateParticleIDArgs {
@@ -125,6 +143,9 @@ protected:
 
     void storeParticle(const Particle& particle);
 
+    int readParticleDeltasFromBuffer(const unsigned char* data, int bytesLeftToRead, uint16_t numberOfParticles,
+        ReadBitstreamToTreeParams& args);
+
     ParticleTree* _myTree;
     QList<Particle>* _particles;
 };
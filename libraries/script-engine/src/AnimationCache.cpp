@@ -12,6 +12,8 @@
 #include <QRunnable>
 #include <QThreadPool>
 
+#include <FBXCooker.h>
+
 #include "AnimationCache.h"
 
 static int animationPointerMetaTypeId = qRegisterMetaType<AnimationPointer>();
@@ -61,7 +63,7 @@ void AnimationReader::run() {
     QSharedPointer<Resource> animation = _animation.toStrongRef();
     if (!animation.isNull()) {
         QMetaObject::invokeMethod(animation.data(), "setGeometry",
-            Q_ARG(const FBXGeometry&, readFBX(_reply->readAll(), QVariantHash())));
+            Q_ARG(const FBXGeometry&, readFBXWithCookedCache(_reply->readAll(), QVariantHash())));
     }
     _reply->deleteLater();
 }
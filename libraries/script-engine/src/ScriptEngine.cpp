@@ -69,6 +69,7 @@ ScriptEngine::ScriptEngine(const QString& scriptContents, const QString& fileNam
     _isRunning(false),
     _isInitialized(false),
     _engine(),
+    _initialGlobalObject(),
     _isAvatar(false),
     _avatarIdentityTimer(NULL),
     _avatarBillboardTimer(NULL),
@@ -94,6 +95,7 @@ ScriptEngine::ScriptEngine(const QUrl& scriptURL,
     _isRunning(false),
     _isInitialized(false),
     _engine(),
+    _initialGlobalObject(),
     _isAvatar(false),
     _avatarIdentityTimer(NULL),
     _avatarBillboardTimer(NULL),
@@ -294,8 +296,18 @@ void ScriptEngine::evaluate() {
         init();
     }
 
-    QScriptValue result = _engine.evaluate(_scriptContents);
+    reportUncaughtException(_engine.evaluate(_scriptContents));
+}
 
+void ScriptEngine::evaluate(const QScriptProgram& program) {
+    if (!_isInitialized) {
+        init();
+    }
+
+    reportUncaughtException(_engine.evaluate(program));
+}
+
+void ScriptEngine::reportUncaughtException(const QScriptValue& result) {
     if (_engine.hasUncaughtException()) {
         int line = _engine.uncaughtExceptionLineNumber();
         qDebug() << "Uncaught exception at line" << line << ":" << result.toString();
@@ -303,6 +315,27 @@ void ScriptEngine::evaluate() {
     }
 }
 
+void ScriptEngine::resetScope() {
+    if (!_isInitialized) {
+        init();
+    }
+    stopAllTimers();
+
+    // names the script defines land in the new object; everything else is found in the original behind it
+    if (!_initialGlobalObject.isValid()) {
+        _initialGlobalObject = _engine.globalObject();
+    }
+    QScriptValue scopeObject = _engine.newObject();
+    scopeObject.setPrototype(_initialGlobalObject);
+    _engine.setGlobalObject(scopeObject);
+}
+
+void ScriptEngine::stopAllTimers() {
+    foreach (QTimer* timer, _timerFunctionMap.keys()) {
+        stopTimer(timer);
+    }
+}
+
 void ScriptEngine::sendAvatarIdentityPacket() {
     if (_isAvatar && _avatarData) {
         _avatarData->sendIdentityPacket();
@@ -17,6 +17,7 @@
 #include <QtCore/QObject>
 #include <QtCore/QUrl>
 #include <QtScript/QScriptEngine>
+#include <QtScript/QScriptProgram>
 
 #include <AudioScriptingInterface.h>
 #include <VoxelsScriptingInterface.h>
@@ -83,6 +84,16 @@ public:
     void run(); /// runs continuously until Agent.stop() is called
     void evaluate(); /// initializes the engine, and evaluates the script, but then returns control to caller
 
+    /// Like evaluate(), but evaluates a program compiled from the script, so that evaluating it again doesn't parse
+    /// and compile the source again.
+    void evaluate(const QScriptProgram& program);
+
+    /// Initializes the engine if need be, stops any timers, and puts a new, empty global object in front of the one
+    /// init() set up, so that what earlier evaluations defined is out of sight.  Lets an engine be reused as if new.
+    void resetScope();
+
+    void stopAllTimers();
+
     void timerFired();
 
     bool hasScript() const { return !_scriptContents.isEmpty(); }
@@ -115,6 +126,7 @@ protected:
     bool _isRunning;
     bool _isInitialized;
     QScriptEngine _engine;
+    QScriptValue _initialGlobalObject;
     bool _isAvatar;
     QTimer* _avatarIdentityTimer;
     QTimer* _avatarBillboardTimer;
@@ -125,6 +137,7 @@ protected:
 
 private:
     QUrl resolveInclude(const QString& include) const;
+    void reportUncaughtException(const QScriptValue& result);
     void sendAvatarIdentityPacket();
     void sendAvatarBillboardPacket();
 
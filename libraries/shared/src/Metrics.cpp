@@ -0,0 +1,196 @@
+//
+//  Metrics.cpp
+//  libraries/shared/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <cstring>
+
+#include <QMutexLocker>
+#include <QStringList>
+
+#include "SharedUtil.h"
+#include "Metrics.h"
+
+void MetricsGauge::set(float value) {
+    int bits;
+    memcpy(&bits, &value, sizeof(bits));
+    _bits.store(bits);
+}
+
+float MetricsGauge::get() const {
+    int bits = _bits.load();
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+MetricsHistogramSnapshot::MetricsHistogramSnapshot() :
+    count(0),
+    mean(0.0f),
+    p50(0),
+    p99(0),
+    p999(0),
+    max(0) {
+}
+
+void MetricsHistogram::record(qint64 value) {
+    int clamped = (int)qBound((qint64)0, value, (qint64)0x7FFFFFFF);
+    _counts[getBucket(clamped)].fetchAndAddRelaxed(1);
+
+    int max = _max.load();
+    while (clamped > max && !_max.testAndSetRelaxed(max, clamped)) {
+        max = _max.load();
+    }
+}
+
+MetricsHistogramSnapshot MetricsHistogram::take() {
+    int counts[BUCKET_COUNT];
+    MetricsHistogramSnapshot snapshot;
+    qint64 total = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        counts[i] = _counts[i].fetchAndStoreRelaxed(0);
+        snapshot.count += counts[i];
+        total += (qint64)counts[i] * getBucketValue(i);
+    }
+    snapshot.max = _max.fetchAndStoreRelaxed(0);
+    if (snapshot.count == 0) {
+        return snapshot;
+    }
+    snapshot.mean = (float)total / snapshot.count;
+
+    // the rank of each percentile, rounded up, so that with a hundred values the 99th percentile is the 99th value
+    qint64 rank50 = ((qint64)snapshot.count * 50 + 99) / 100;
+    qint64 rank99 = ((qint64)snapshot.count * 99 + 99) / 100;
+    qint64 rank999 = ((qint64)snapshot.count * 999 + 999) / 1000;
+    qint64 seen = 0;
+    for (int i = 0; i < BUCKET_COUNT && seen < rank999; i++) {
+        if (counts[i] == 0) {
+            continue;
+        }
+        seen += counts[i];
+        int value = qMin(getBucketValue(i), snapshot.max);
+        if (seen >= rank50 && seen - counts[i] < rank50) {
+            snapshot.p50 = value;
+        }
+        if (seen >= rank99 && seen - counts[i] < rank99) {
+            snapshot.p99 = value;
+        }
+        if (seen >= rank999) {
+            snapshot.p999 = value;
+        }
+    }
+    return snapshot;
+}
+
+int MetricsHistogram::getBucket(int value) {
+    if (value < SUB_BUCKET_COUNT) {
+        return value;
+    }
+    int highestBit = SUB_BUCKET_BITS;
+    while ((value >> (highestBit + 1)) != 0) {
+        highestBit++;
+    }
+    int shift = highestBit - SUB_BUCKET_BITS;
+    return SUB_BUCKET_COUNT * (shift + 1) + ((value >> shift) & (SUB_BUCKET_COUNT - 1));
+}
+
+int MetricsHistogram::getBucketValue(int bucket) {
+    if (bucket < SUB_BUCKET_COUNT) {
+        return bucket;
+    }
+    int shift = bucket / SUB_BUCKET_COUNT - 1;
+    int lowest = (SUB_BUCKET_COUNT + bucket % SUB_BUCKET_COUNT) << shift;
+    return lowest + ((1 << shift) >> 1);
+}
+
+MetricsRegistry* MetricsRegistry::getInstance() {
+    static MetricsRegistry registry;
+    return &registry;
+}
+
+MetricsRegistry::MetricsRegistry() :
+    _lastSnapshotAt(0) {
+}
+
+MetricsCounter* MetricsRegistry::getCounter(const QString& name) {
+    QMutexLocker locker(&_mutex);
+    MetricsCounter*& counter = _counters[name];
+    if (!counter) {
+        counter = new MetricsCounter();
+    }
+    return counter;
+}
+
+MetricsGauge* MetricsRegistry::getGauge(const QString& name) {
+    QMutexLocker locker(&_mutex);
+    MetricsGauge*& gauge = _gauges[name];
+    if (!gauge) {
+        gauge = new MetricsGauge();
+    }
+    return gauge;
+}
+
+MetricsHistogram* MetricsRegistry::getHistogram(const QString& name) {
+    QMutexLocker locker(&_mutex);
+    MetricsHistogram*& histogram = _histograms[name];
+    if (!histogram) {
+        histogram = new MetricsHistogram();
+    }
+    return histogram;
+}
+
+void MetricsRegistry::addToStats(QJsonObject& statsObject) {
+    const quint64 MIN_SNAPSHOT_INTERVAL_USECS = 100 * 1000;
+
+    QMutexLocker locker(&_mutex);
+    quint64 now = usecTimestampNow();
+    if (now - _lastSnapshotAt >= MIN_SNAPSHOT_INTERVAL_USECS) {
+        takeSnapshot();
+        _lastSnapshotAt = now;
+    }
+    for (QJsonObject::const_iterator it = _lastSnapshot.constBegin(); it != _lastSnapshot.constEnd(); it++) {
+        statsObject[it.key()] = it.value();
+    }
+}
+
+QString MetricsRegistry::getLastSnapshotReport() {
+    QMutexLocker locker(&_mutex);
+    QStringList names = _lastHistogramSnapshots.keys();
+    names.sort();
+    QString report;
+    foreach (const QString& name, names) {
+        const MetricsHistogramSnapshot& snapshot = _lastHistogramSnapshots.value(name);
+        report += QString("        %1: count %2, mean %3, p50 %4, p99 %5, p99.9 %6, max %7\r\n").arg(name)
+            .arg(snapshot.count).arg(snapshot.mean, 0, 'f', 1).arg(snapshot.p50).arg(snapshot.p99)
+            .arg(snapshot.p999).arg(snapshot.max);
+    }
+    return report;
+}
+
+void MetricsRegistry::takeSnapshot() {
+    _lastSnapshot = QJsonObject();
+    for (QHash<QString, MetricsCounter*>::const_iterator it = _counters.constBegin();
+            it != _counters.constEnd(); it++) {
+        _lastSnapshot[it.key()] = it.value()->take();
+    }
+    for (QHash<QString, MetricsGauge*>::const_iterator it = _gauges.constBegin(); it != _gauges.constEnd(); it++) {
+        _lastSnapshot[it.key()] = it.value()->get();
+    }
+    _lastHistogramSnapshots.clear();
+    for (QHash<QString, MetricsHistogram*>::const_iterator it = _histograms.constBegin();
+            it != _histograms.constEnd(); it++) {
+        MetricsHistogramSnapshot snapshot = it.value()->take();
+        _lastHistogramSnapshots.insert(it.key(), snapshot);
+        _lastSnapshot[it.key() + ".count"] = snapshot.count;
+        _lastSnapshot[it.key() + ".mean"] = snapshot.mean;
+        _lastSnapshot[it.key() + ".p50"] = snapshot.p50;
+        _lastSnapshot[it.key() + ".p99"] = snapshot.p99;
+        _lastSnapshot[it.key() + ".p999"] = snapshot.p999;
+        _lastSnapshot[it.key() + ".max"] = snapshot.max;
+    }
+}
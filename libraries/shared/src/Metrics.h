@@ -0,0 +1,124 @@
+//
+//  Metrics.h
+//  libraries/shared/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_Metrics_h
+#define hifi_Metrics_h
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QJsonObject>
+#include <QMutex>
+#include <QString>
+
+/// A count of events, reset with each snapshot.  Safe to increment from any thread without locking.
+class MetricsCounter {
+public:
+
+    void increment(int amount = 1) { _count.fetchAndAddRelaxed(amount); }
+
+    /// Returns the count since the last call and resets it.
+    int take() { return _count.fetchAndStoreRelaxed(0); }
+
+private:
+
+    QAtomicInt _count;
+};
+
+/// A value that's set from time to time (a queue length, say), reported as the latest value set.  Safe to set from
+/// any thread without locking.
+class MetricsGauge {
+public:
+
+    void set(float value);
+    float get() const;
+
+private:
+
+    QAtomicInt _bits;
+};
+
+/// The distribution of the values recorded in a histogram over some interval.
+class MetricsHistogramSnapshot {
+public:
+
+    MetricsHistogramSnapshot();
+
+    int count;
+    float mean;
+    int p50;
+    int p99;
+    int p999;
+    int max;
+};
+
+/// A histogram of non-negative integer values (usually durations in microseconds), in the manner of HDR histograms:
+/// values below 16 are counted exactly, and each power of two above that is split into sixteen buckets, so that any
+/// percentile read back is within about 6% of the true value however large the values get.  Safe to record into from
+/// any thread without locking.
+class MetricsHistogram {
+public:
+
+    static const int SUB_BUCKET_BITS = 4;
+    static const int SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+    static const int MAX_VALUE_BITS = 31;
+    static const int BUCKET_COUNT = SUB_BUCKET_COUNT * (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1);
+
+    void record(qint64 value);
+
+    /// Returns the distribution of the values recorded since the last call and resets the histogram.
+    MetricsHistogramSnapshot take();
+
+    static int getBucket(int value);
+
+    /// Returns the value in the middle of a bucket's range.
+    static int getBucketValue(int bucket);
+
+private:
+
+    QAtomicInt _counts[BUCKET_COUNT];
+    QAtomicInt _max;
+};
+
+/// The named metrics of this process.  Metrics are created on first request and live as long as the process, so
+/// callers should look them up once and hold on to them; recording into them never takes a lock.
+class MetricsRegistry {
+public:
+
+    static MetricsRegistry* getInstance();
+
+    MetricsCounter* getCounter(const QString& name);
+    MetricsGauge* getGauge(const QString& name);
+    MetricsHistogram* getHistogram(const QString& name);
+
+    /// Adds the metrics to a stats object (histograms as <name>.count, <name>.p50, <name>.p99 and so on).  Counters
+    /// and histograms cover the time since the last snapshot; a new one is taken unless the last is very recent, so
+    /// that an assignment sending several stats objects at once sends the same interval with each.
+    void addToStats(QJsonObject& statsObject);
+
+    /// Returns the histograms of the last snapshot as lines of text, for status pages.
+    QString getLastSnapshotReport();
+
+private:
+
+    MetricsRegistry();
+
+    void takeSnapshot();
+
+    QMutex _mutex; ///< guards creating metrics and taking snapshots
+    QHash<QString, MetricsCounter*> _counters;
+    QHash<QString, MetricsGauge*> _gauges;
+    QHash<QString, MetricsHistogram*> _histograms;
+
+    quint64 _lastSnapshotAt;
+    QJsonObject _lastSnapshot;
+    QHash<QString, MetricsHistogramSnapshot> _lastHistogramSnapshots;
+};
+
+#endif // hifi_Metrics_h
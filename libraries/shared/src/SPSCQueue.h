@@ -0,0 +1,92 @@
+//
+//  SPSCQueue.h
+//  libraries/shared/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_SPSCQueue_h
+#define hifi_SPSCQueue_h
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QVector>
+
+/// A fixed capacity queue with one producing thread and one consuming thread that hand items over without locking.
+/// Pushing onto a full queue fails rather than blocking the producer.
+template<typename T> class SPSCQueue {
+public:
+    /// \param capacity the most items the queue will hold, rounded up to a power of two
+    SPSCQueue(int capacity);
+
+    /// Adds an item to the back of the queue.
+    /// \return false if the queue was full and the item was not added
+    /// \thread the producing thread
+    bool push(const T& item);
+
+    /// Takes the item at the front of the queue.
+    /// \return false if the queue was empty
+    /// \thread the consuming thread
+    bool pop(T& item);
+
+    /// Returns a snapshot of the number of items in the queue, which may be stale by the time the caller looks at it.
+    int size() const { return (unsigned int)_tail.loadAcquire() - (unsigned int)_head.loadAcquire(); }
+
+    bool isEmpty() const { return size() == 0; }
+
+    int getCapacity() const { return _items.size(); }
+
+private:
+    SPSCQueue(const SPSCQueue& other);
+    SPSCQueue& operator=(const SPSCQueue& other);
+
+    QVector<T> _items;
+    unsigned int _mask;
+
+    // positions only ever increase (wrapping); each is written by one thread, so only its reads need ordering
+    QAtomicInt _head; ///< written by the consumer
+    QAtomicInt _tail; ///< written by the producer
+};
+
+template<typename T> inline SPSCQueue<T>::SPSCQueue(int capacity) :
+    _head(0),
+    _tail(0)
+{
+    int roundedCapacity = 1;
+    while (roundedCapacity < capacity) {
+        roundedCapacity <<= 1;
+    }
+    _items.resize(roundedCapacity);
+    _mask = roundedCapacity - 1;
+}
+
+template<typename T> inline bool SPSCQueue<T>::push(const T& item) {
+    unsigned int tail = _tail.load();
+    if (tail - (unsigned int)_head.loadAcquire() == (unsigned int)_items.size()) {
+        return false;
+    }
+    _items[tail & _mask] = item;
+
+    // publish the item only once it's in place
+    _tail.storeRelease(tail + 1);
+    return true;
+}
+
+template<typename T> inline bool SPSCQueue<T>::pop(T& item) {
+    unsigned int head = _head.load();
+    if (head == (unsigned int)_tail.loadAcquire()) {
+        return false;
+    }
+    T& slot = _items[head & _mask];
+    item = slot;
+
+    // don't hold on to what the item refers to until the slot is next written
+    slot = T();
+
+    _head.storeRelease(head + 1);
+    return true;
+}
+
+#endif // hifi_SPSCQueue_h
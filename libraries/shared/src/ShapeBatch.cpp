@@ -0,0 +1,87 @@
+//
+//  ShapeBatch.cpp
+//  libraries/shared/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <cfloat>
+
+#include "ShapeBatch.h"
+
+void ShapeBounds::clear() {
+    x.clear();
+    y.clear();
+    z.clear();
+    radii.clear();
+    indices.clear();
+}
+
+void ShapeBounds::append(const glm::vec3& center, float radius, int index) {
+    x.append(center.x);
+    y.append(center.y);
+    z.append(center.z);
+    radii.append(radius);
+    indices.append(index);
+}
+
+ShapeBatch::ShapeBatch() :
+    _minimum(FLT_MAX),
+    _maximum(-FLT_MAX) {
+}
+
+void ShapeBatch::clear() {
+    _shapes.clear();
+    _sphereBounds.clear();
+    _capsuleBounds.clear();
+    _unboundedIndices.clear();
+    _minimum = glm::vec3(FLT_MAX);
+    _maximum = glm::vec3(-FLT_MAX);
+}
+
+void ShapeBatch::addShape(const Shape* shape) {
+    int index = _shapes.size();
+    _shapes.append(shape);
+
+    ShapeBounds* bounds;
+    switch (shape->getType()) {
+        case Shape::SPHERE_SHAPE:
+            bounds = &_sphereBounds;
+            break;
+
+        case Shape::CAPSULE_SHAPE:
+            bounds = &_capsuleBounds;
+            break;
+
+        case Shape::PLANE_SHAPE:
+        case Shape::LIST_SHAPE:
+            _unboundedIndices.append(index);
+            return;
+
+        default:
+            return; // ShapeCollider doesn't collide anything else
+    }
+    // a capsule lies within its half height plus its radius of its center, which is its bounding radius
+    float radius = shape->getBoundingRadius();
+    bounds->append(shape->getPosition(), radius, index);
+    _minimum = glm::min(_minimum, shape->getPosition() - glm::vec3(radius));
+    _maximum = glm::max(_maximum, shape->getPosition() + glm::vec3(radius));
+}
+
+void ShapeBatch::addShapes(const QVector<const Shape*>& shapes) {
+    foreach (const Shape* shape, shapes) {
+        addShape(shape);
+    }
+}
+
+bool ShapeBatch::mayTouch(const ShapeBatch& other) const {
+    if (!(_unboundedIndices.isEmpty() && other._unboundedIndices.isEmpty())) {
+        return true;
+    }
+    return _minimum.x <= other._maximum.x && other._minimum.x <= _maximum.x &&
+        _minimum.y <= other._maximum.y && other._minimum.y <= _maximum.y &&
+        _minimum.z <= other._maximum.z && other._minimum.z <= _maximum.z;
+}
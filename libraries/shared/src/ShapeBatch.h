@@ -0,0 +1,79 @@
+//
+//  ShapeBatch.h
+//  libraries/shared/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ShapeBatch_h
+#define hifi_ShapeBatch_h
+
+#include <QVector>
+
+#include <glm/glm.hpp>
+
+#include "Shape.h"
+
+/// The bounding spheres of a set of shapes, kept as separate arrays of coordinates so that they can be tested against
+/// another shape's several at a time.
+class ShapeBounds {
+public:
+
+    void clear();
+    void append(const glm::vec3& center, float radius, int index);
+    int size() const { return indices.size(); }
+
+    QVector<float> x;
+    QVector<float> y;
+    QVector<float> z;
+    QVector<float> radii;
+    QVector<int> indices; ///< of the shapes in their batch
+};
+
+/// A set of shapes prepared for colliding against other sets with ShapeCollider::collideShapeBatches: the spheres and
+/// capsules are kept apart, each with contiguous arrays of bounding spheres, and the whole set has a bounding box, so
+/// that most pairs that can't touch are rejected without looking at the shapes themselves.  A batch holds pointers to
+/// the shapes, so it has to be rebuilt (or at least re-added) whenever they move.
+class ShapeBatch {
+public:
+
+    ShapeBatch();
+
+    /// Removes all the shapes, keeping the memory allocated for them.
+    void clear();
+
+    /// Adds a shape.  Planes and lists have no useful bounds; they're kept aside and tested against everything.
+    void addShape(const Shape* shape);
+
+    void addShapes(const QVector<const Shape*>& shapes);
+
+    int getShapeCount() const { return _shapes.size(); }
+    const Shape* getShape(int index) const { return _shapes.at(index); }
+
+    const ShapeBounds& getSphereBounds() const { return _sphereBounds; }
+    const ShapeBounds& getCapsuleBounds() const { return _capsuleBounds; }
+
+    /// Returns the indices of the shapes without bounds.
+    const QVector<int>& getUnboundedIndices() const { return _unboundedIndices; }
+
+    /// Returns the box containing all the bounded shapes (with the minimum above the maximum if there are none).
+    const glm::vec3& getMinimum() const { return _minimum; }
+    const glm::vec3& getMaximum() const { return _maximum; }
+
+    /// Checks whether this batch's bounding box overlaps another's (or either batch has shapes without bounds).
+    bool mayTouch(const ShapeBatch& other) const;
+
+private:
+
+    QVector<const Shape*> _shapes;
+    ShapeBounds _sphereBounds;
+    ShapeBounds _capsuleBounds;
+    QVector<int> _unboundedIndices;
+    glm::vec3 _minimum;
+    glm::vec3 _maximum;
+};
+
+#endif // hifi_ShapeBatch_h
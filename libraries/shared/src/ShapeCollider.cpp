@@ -9,8 +9,12 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <algorithm>
 #include <iostream>
 
+#include <QPair>
+#include <QThreadStorage>
+
 #include <glm/gtx/norm.hpp>
 
 #include "GeometryUtil.h"
@@ -68,15 +72,40 @@ bool collideShapes(const Shape* shapeA, const Shape* shapeB, CollisionList& coll
     return false;
 }
 
-static CollisionList tempCollisions(32);
+/// Storage reused from one call to the next, so that we don't allocate for every collision test.  Shapes may be
+/// collided on several threads at once (as when simulating avatars in parallel), so each thread has its own.
+class CollisionScratch {
+public:
+    CollisionScratch() : collisions(32) { }
+
+    CollisionList collisions;
+    ShapeBatch batchA;
+    ShapeBatch batchB;
+    QVector<QPair<int, int> > candidatePairs;
+};
+
+static CollisionScratch& getCollisionScratch() {
+    static QThreadStorage<CollisionScratch*> threadScratch;
+    CollisionScratch*& scratch = threadScratch.localData();
+    if (!scratch) {
+        scratch = new CollisionScratch();
+    }
+    return *scratch;
+}
 
 bool collideShapesCoarse(const QVector<const Shape*>& shapesA, const QVector<const Shape*>& shapesB, CollisionInfo& collision) {
+    CollisionScratch& scratch = getCollisionScratch();
+    scratch.batchA.clear();
+    scratch.batchA.addShapes(shapesA);
+    scratch.batchB.clear();
+    scratch.batchB.addShapes(shapesB);
+    return collideShapesCoarse(scratch.batchA, scratch.batchB, collision);
+}
+
+bool collideShapesCoarse(const ShapeBatch& batchA, const ShapeBatch& batchB, CollisionInfo& collision) {
+    CollisionList& tempCollisions = getCollisionScratch().collisions;
     tempCollisions.clear();
-    foreach (const Shape* shapeA, shapesA) {
-        foreach (const Shape* shapeB, shapesB) {
-            ShapeCollider::collideShapes(shapeA, shapeB, tempCollisions);
-        }
-    }
+    collideShapeBatches(batchA, batchB, tempCollisions);
     if (tempCollisions.size() > 0) {
         glm::vec3 totalPenetration(0.0f);
         glm::vec3 averageContactPoint(0.0f);
@@ -92,6 +121,101 @@ bool collideShapesCoarse(const QVector<const Shape*>& shapesA, const QVector<con
     return false;
 }
 
+// bounds are compared with a little room to spare, so that rounding never drops a pair that would collide
+const float BOUNDS_MARGIN_SCALE = 1.001f;
+
+/// Finds the pairs of overlapping bounding spheres in two sets, comparing each sphere of the first against four of the
+/// second at a time.
+static void findOverlappingBounds(const ShapeBounds& boundsA, const ShapeBounds& boundsB,
+        QVector<QPair<int, int> >& pairs) {
+    const float* x = boundsB.x.constData();
+    const float* y = boundsB.y.constData();
+    const float* z = boundsB.z.constData();
+    const float* radii = boundsB.radii.constData();
+    int countB = boundsB.size();
+    int groupedCountB = countB & ~3;
+    for (int i = 0; i < boundsA.size(); i++) {
+        glm::vec3 centerA(boundsA.x.at(i), boundsA.y.at(i), boundsA.z.at(i));
+        float radiusA = boundsA.radii.at(i);
+        int indexA = boundsA.indices.at(i);
+        for (int j = 0; j < groupedCountB; j += 4) {
+            glm::vec4 deltaX = glm::vec4(x[j], x[j + 1], x[j + 2], x[j + 3]) - centerA.x;
+            glm::vec4 deltaY = glm::vec4(y[j], y[j + 1], y[j + 2], y[j + 3]) - centerA.y;
+            glm::vec4 deltaZ = glm::vec4(z[j], z[j + 1], z[j + 2], z[j + 3]) - centerA.z;
+            glm::vec4 reach = (glm::vec4(radii[j], radii[j + 1], radii[j + 2], radii[j + 3]) + radiusA) *
+                BOUNDS_MARGIN_SCALE;
+            glm::bvec4 overlapping = glm::lessThanEqual(deltaX * deltaX + deltaY * deltaY + deltaZ * deltaZ,
+                reach * reach);
+            if (glm::any(overlapping)) {
+                for (int k = 0; k < 4; k++) {
+                    if (overlapping[k]) {
+                        pairs.append(QPair<int, int>(indexA, boundsB.indices.at(j + k)));
+                    }
+                }
+            }
+        }
+        for (int j = groupedCountB; j < countB; j++) {
+            glm::vec3 delta = glm::vec3(x[j], y[j], z[j]) - centerA;
+            float reach = (radii[j] + radiusA) * BOUNDS_MARGIN_SCALE;
+            if (glm::dot(delta, delta) <= reach * reach) {
+                pairs.append(QPair<int, int>(indexA, boundsB.indices.at(j)));
+            }
+        }
+    }
+}
+
+bool collideShapeBatches(const ShapeBatch& batchA, const ShapeBatch& batchB, CollisionList& collisions) {
+    if (!batchA.mayTouch(batchB)) {
+        return false;
+    }
+    QVector<QPair<int, int> >& candidatePairs = getCollisionScratch().candidatePairs;
+    candidatePairs.clear();
+
+    // the bounded shapes, type by type
+    const ShapeBounds* boundsA[] = { &batchA.getSphereBounds(), &batchA.getCapsuleBounds() };
+    const ShapeBounds* boundsB[] = { &batchB.getSphereBounds(), &batchB.getCapsuleBounds() };
+    for (unsigned int i = 0; i < sizeof(boundsA) / sizeof(boundsA[0]); i++) {
+        for (unsigned int j = 0; j < sizeof(boundsB) / sizeof(boundsB[0]); j++) {
+            findOverlappingBounds(*boundsA[i], *boundsB[j], candidatePairs);
+        }
+    }
+
+    // the shapes without bounds, against everything (but only once against each other)
+    const QVector<int>& unboundedA = batchA.getUnboundedIndices();
+    const QVector<int>& unboundedB = batchB.getUnboundedIndices();
+    foreach (int indexA, unboundedA) {
+        for (int indexB = 0; indexB < batchB.getShapeCount(); indexB++) {
+            candidatePairs.append(QPair<int, int>(indexA, indexB));
+        }
+    }
+    foreach (int indexB, unboundedB) {
+        for (int indexA = 0; indexA < batchA.getShapeCount(); indexA++) {
+            if (!unboundedA.contains(indexA)) {
+                candidatePairs.append(QPair<int, int>(indexA, indexB));
+            }
+        }
+    }
+
+    // collide the candidates in the order of the shapes, as collideShapes would be called on every pair
+    std::sort(candidatePairs.begin(), candidatePairs.end());
+    bool touching = false;
+    for (int i = 0; i < candidatePairs.size() && !collisions.isFull(); i++) {
+        const QPair<int, int>& pair = candidatePairs.at(i);
+        touching = collideShapes(batchA.getShape(pair.first), batchB.getShape(pair.second), collisions) || touching;
+    }
+    return touching;
+}
+
+bool collideShapeLists(const QVector<const Shape*>& shapesA, const QVector<const Shape*>& shapesB,
+        CollisionList& collisions) {
+    CollisionScratch& scratch = getCollisionScratch();
+    scratch.batchA.clear();
+    scratch.batchA.addShapes(shapesA);
+    scratch.batchB.clear();
+    scratch.batchB.addShapes(shapesB);
+    return collideShapeBatches(scratch.batchA, scratch.batchB, collisions);
+}
+
 bool collideShapeWithAACube(const Shape* shapeA, const glm::vec3& cubeCenter, float cubeSide, CollisionList& collisions) {
     int typeA = shapeA->getType();
     if (typeA == Shape::SPHERE_SHAPE) {
@@ -16,6 +16,7 @@
 #include "CollisionInfo.h"
 #include "ListShape.h"
 #include "PlaneShape.h"
+#include "ShapeBatch.h"
 #include "SharedUtil.h" 
 #include "SphereShape.h"
 
@@ -33,6 +34,28 @@ namespace ShapeCollider {
     /// \return true if any shapes collide
     bool collideShapesCoarse(const QVector<const Shape*>& shapesA, const QVector<const Shape*>& shapesB, CollisionInfo& collision);
 
+    /// \param batchA first set of shapes
+    /// \param batchB second set of shapes
+    /// \param collisions[out] average collision details
+    /// \return true if any shapes collide
+    bool collideShapesCoarse(const ShapeBatch& batchA, const ShapeBatch& batchB, CollisionInfo& collision);
+
+    /// Collides every shape in one batch against every shape in another, skipping the pairs whose bounds don't touch.
+    /// The collisions found are the same, in the same order, as calling collideShapes on each pair in turn.
+    /// \param batchA first set of shapes
+    /// \param batchB second set of shapes
+    /// \param[out] collisions where to append collision details
+    /// \return true if any shapes collide
+    bool collideShapeBatches(const ShapeBatch& batchA, const ShapeBatch& batchB, CollisionList& collisions);
+
+    /// Batches two lists of shapes and collides them with collideShapeBatches.
+    /// \param shapesA list of shapes
+    /// \param shapesB list of shapes
+    /// \param[out] collisions where to append collision details
+    /// \return true if any shapes collide
+    bool collideShapeLists(const QVector<const Shape*>& shapesA, const QVector<const Shape*>& shapesB,
+        CollisionList& collisions);
+
     /// \param shapeA a pointer to a shape
     /// \param cubeCenter center of cube
     /// \param cubeSide lenght of side of cube
@@ -0,0 +1,78 @@
+//
+//  SweepAndPrune.cpp
+//  libraries/shared/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <algorithm>
+
+#include "SweepAndPrune.h"
+
+int SweepAndPrune::addBox(const glm::vec3& minimum, const glm::vec3& maximum, int group, int collidesWith) {
+    Box box;
+    box.minimum = minimum;
+    box.maximum = maximum;
+    box.group = group;
+    box.collidesWith = collidesWith;
+    _boxes.append(box);
+    return _boxes.size() - 1;
+}
+
+void SweepAndPrune::findPairs(QVector<BoxPair>& pairs) {
+    pairs.clear();
+    int boxCount = _boxes.size();
+    if (boxCount < 2) {
+        return;
+    }
+
+    // sweep along the axis on which the box centers are most spread out, so that the fewest boxes overlap on it
+    glm::vec3 lowestCenter = _boxes.at(0).minimum + _boxes.at(0).maximum;
+    glm::vec3 highestCenter = lowestCenter;
+    for (int i = 1; i < boxCount; i++) {
+        glm::vec3 center = _boxes.at(i).minimum + _boxes.at(i).maximum;
+        lowestCenter = glm::min(lowestCenter, center);
+        highestCenter = glm::max(highestCenter, center);
+    }
+    glm::vec3 spread = highestCenter - lowestCenter;
+    int axis = (spread.x >= spread.y && spread.x >= spread.z) ? 0 : (spread.y >= spread.z ? 1 : 2);
+    int otherAxis = (axis + 1) % 3;
+    int lastAxis = (axis + 2) % 3;
+
+    _sorted.resize(boxCount);
+    for (int i = 0; i < boxCount; i++) {
+        _sorted[i] = i;
+    }
+    std::sort(_sorted.begin(), _sorted.end(), BoxStartsBefore(_boxes, axis));
+
+    _active.clear();
+    for (int i = 0; i < boxCount; i++) {
+        int index = _sorted.at(i);
+        const Box& box = _boxes.at(index);
+
+        // drop the boxes that end before this one starts; they can't overlap it or any box after it
+        int activeCount = 0;
+        for (int j = 0; j < _active.size(); j++) {
+            if (_boxes.at(_active.at(j)).maximum[axis] >= box.minimum[axis]) {
+                _active[activeCount++] = _active.at(j);
+            }
+        }
+        _active.resize(activeCount);
+
+        for (int j = 0; j < activeCount; j++) {
+            int otherIndex = _active.at(j);
+            const Box& other = _boxes.at(otherIndex);
+            if (!((box.collidesWith & other.group) || (other.collidesWith & box.group))) {
+                continue;
+            }
+            if (overlapOnAxis(box, other, otherAxis) && overlapOnAxis(box, other, lastAxis)) {
+                pairs.append(BoxPair(qMin(index, otherIndex), qMax(index, otherIndex)));
+            }
+        }
+        _active.append(index);
+    }
+    std::sort(pairs.begin(), pairs.end());
+}
@@ -0,0 +1,68 @@
+//
+//  SweepAndPrune.h
+//  libraries/shared/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_SweepAndPrune_h
+#define hifi_SweepAndPrune_h
+
+#include <QPair>
+#include <QVector>
+
+#include <glm/glm.hpp>
+
+typedef QPair<int, int> BoxPair;
+
+/// A collision broadphase: finds the pairs of overlapping boxes among a set of axis-aligned boxes by sorting them
+/// along the axis on which they're most spread out and sweeping across them, so that only boxes that already overlap
+/// on that axis are compared.  Each box belongs to a group (a bit) and has a mask of the groups it collides with; a
+/// pair is only reported if either box's mask includes the other's group.
+class SweepAndPrune {
+public:
+
+    /// Removes all the boxes, keeping the memory allocated for them.
+    void clear() { _boxes.clear(); }
+
+    /// Adds a box.
+    /// \return the index by which pairs refer to the box, which is the number of boxes added before it
+    int addBox(const glm::vec3& minimum, const glm::vec3& maximum, int group, int collidesWith);
+
+    int getBoxCount() const { return _boxes.size(); }
+
+    /// Finds the pairs of overlapping boxes, each with the lower index first, in order of their indices.
+    void findPairs(QVector<BoxPair>& pairs);
+
+private:
+
+    class Box {
+    public:
+        glm::vec3 minimum;
+        glm::vec3 maximum;
+        int group;
+        int collidesWith;
+    };
+
+    static bool overlapOnAxis(const Box& first, const Box& second, int axis) {
+        return first.minimum[axis] <= second.maximum[axis] && second.minimum[axis] <= first.maximum[axis]; }
+
+    class BoxStartsBefore {
+    public:
+        BoxStartsBefore(const QVector<Box>& boxes, int axis) : _boxes(boxes), _axis(axis) { }
+        bool operator()(int first, int second) const {
+            return _boxes.at(first).minimum[_axis] < _boxes.at(second).minimum[_axis]; }
+    private:
+        const QVector<Box>& _boxes;
+        int _axis;
+    };
+
+    QVector<Box> _boxes;
+    QVector<int> _sorted;
+    QVector<int> _active;
+};
+
+#endif // hifi_SweepAndPrune_h
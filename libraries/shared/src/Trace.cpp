@@ -0,0 +1,156 @@
+//
+//  Trace.cpp
+//  libraries/shared/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <csignal>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QMutexLocker>
+#include <QThread>
+#include <QThreadStorage>
+#include <QtDebug>
+
+#include "Trace.h"
+
+static QMutex& getBuffersMutex() {
+    static QMutex mutex;
+    return mutex;
+}
+
+/// The buffers of the live threads, guarded by the buffers mutex.
+static QList<TraceBuffer*>& getBuffers() {
+    static QList<TraceBuffer*> buffers;
+    return buffers;
+}
+
+TraceBuffer::TraceBuffer(int threadID, const QString& threadName) :
+    _threadID(threadID),
+    _threadName(threadName) {
+
+    QMutexLocker locker(&getBuffersMutex());
+    getBuffers().append(this);
+}
+
+TraceBuffer::~TraceBuffer() {
+    QMutexLocker locker(&getBuffersMutex());
+    getBuffers().removeOne(this);
+}
+
+void TraceBuffer::getEvents(QVector<TraceEvent>& events) const {
+    int count = _count.loadAcquire();
+    for (int i = qMax(0, count - CAPACITY); i < count; i++) {
+        events.append(_events[i % CAPACITY]);
+    }
+}
+
+/// Starts the trace clock before anything can be traced.
+class TraceClock {
+public:
+    TraceClock() { timer.start(); }
+    QElapsedTimer timer;
+};
+
+static TraceClock traceClock;
+
+qint64 Trace::now() {
+    return traceClock.timer.nsecsElapsed();
+}
+
+QByteArray Trace::toChromeTraceJSON() {
+    const double USECS_PER_NSEC = 0.001;
+    int pid = (int)QCoreApplication::applicationPid();
+
+    QJsonArray traceEvents;
+    QVector<TraceEvent> events;
+    QMutexLocker locker(&getBuffersMutex());
+    foreach (TraceBuffer* buffer, getBuffers()) {
+        QJsonObject threadName;
+        threadName.insert("name", QString("thread_name"));
+        threadName.insert("ph", QString("M"));
+        threadName.insert("pid", pid);
+        threadName.insert("tid", buffer->getThreadID());
+        QJsonObject args;
+        args.insert("name", buffer->getThreadName());
+        threadName.insert("args", args);
+        traceEvents.append(threadName);
+
+        events.clear();
+        buffer->getEvents(events);
+        foreach (const TraceEvent& event, events) {
+            QJsonObject object;
+            object.insert("name", QString(event.name));
+            object.insert("ph", QString("X"));
+            object.insert("ts", event.start * USECS_PER_NSEC);
+            object.insert("dur", event.duration * USECS_PER_NSEC);
+            object.insert("pid", pid);
+            object.insert("tid", buffer->getThreadID());
+            traceEvents.append(object);
+        }
+    }
+    locker.unlock();
+
+    QJsonObject root;
+    root.insert("traceEvents", traceEvents);
+    root.insert("displayTimeUnit", QString("ms"));
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+bool Trace::writeChromeTrace(const QString& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Failed to open trace file" << path;
+        return false;
+    }
+    file.write(toChromeTraceJSON());
+    qDebug() << "Wrote trace to" << path;
+    return true;
+}
+
+static volatile sig_atomic_t dumpRequested = 0;
+
+static QString& getDumpPath() {
+    static QString path;
+    return path;
+}
+
+static void requestDump(int) {
+    dumpRequested = 1;
+}
+
+void Trace::dumpOnSignal(const QString& path) {
+    getDumpPath() = path;
+#ifdef SIGUSR1
+    signal(SIGUSR1, requestDump);
+#endif
+}
+
+void Trace::dumpIfRequested() {
+    if (dumpRequested) {
+        dumpRequested = 0;
+        writeChromeTrace(getDumpPath());
+    }
+}
+
+TraceBuffer* Trace::getThreadBuffer() {
+    static QThreadStorage<TraceBuffer*> threadBuffers;
+    static QAtomicInt nextThreadID;
+    TraceBuffer*& buffer = threadBuffers.localData();
+    if (!buffer) {
+        QString name = QThread::currentThread()->objectName();
+        int threadID = nextThreadID.fetchAndAddRelaxed(1);
+        buffer = new TraceBuffer(threadID, name.isEmpty() ? QString("thread %1").arg(threadID) : name);
+    }
+    return buffer;
+}
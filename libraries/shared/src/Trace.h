@@ -0,0 +1,104 @@
+//
+//  Trace.h
+//  libraries/shared/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_Trace_h
+#define hifi_Trace_h
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+/// A timed span on one thread.
+class TraceEvent {
+public:
+    const char* name;
+    qint64 start; ///< nsecs since tracing began
+    qint64 duration; ///< in nsecs
+};
+
+/// The most recent events of one thread.  Only the owning thread appends; a dump may read concurrently, in which case
+/// the oldest events (those being overwritten) may come out garbled.
+class TraceBuffer {
+public:
+
+    static const int CAPACITY = 8192;
+
+    TraceBuffer(int threadID, const QString& threadName);
+    ~TraceBuffer();
+
+    void append(const char* name, qint64 start, qint64 duration) {
+        int count = _count.load();
+        TraceEvent& event = _events[count % CAPACITY];
+        event.name = name;
+        event.start = start;
+        event.duration = duration;
+        _count.storeRelease(count + 1);
+    }
+
+    int getThreadID() const { return _threadID; }
+    const QString& getThreadName() const { return _threadName; }
+
+    /// Copies out the buffered events, oldest first.
+    void getEvents(QVector<TraceEvent>& events) const;
+
+private:
+
+    int _threadID;
+    QString _threadName;
+    QAtomicInt _count;
+    TraceEvent _events[CAPACITY];
+};
+
+/// Keeps a timeline of where each thread spends its time, to be viewed in Chrome's about:tracing.  Events go into
+/// per-thread ring buffers without locking, so recording one costs two clock reads and a few stores.
+class Trace {
+public:
+
+    /// Returns the time in nsecs since tracing began.
+    static qint64 now();
+
+    /// Records a span on the current thread.  The name must outlive the trace (in practice, be a string literal).
+    static void record(const char* name, qint64 start, qint64 duration) {
+        getThreadBuffer()->append(name, start, duration); }
+
+    /// Returns the buffered events of every thread in Chrome's trace_event JSON format.
+    static QByteArray toChromeTraceJSON();
+
+    /// Writes the buffered events to a file in Chrome's trace_event JSON format.
+    static bool writeChromeTrace(const QString& path);
+
+    /// Requests that the trace be written to the given path when the process receives SIGUSR1 (where supported).  The
+    /// signal only sets a flag; the file is written by the next call to dumpIfRequested.
+    static void dumpOnSignal(const QString& path);
+
+    /// Writes the trace if a dump has been requested by signal since the last call.
+    static void dumpIfRequested();
+
+private:
+
+    static TraceBuffer* getThreadBuffer();
+};
+
+/// Records a span from its construction to its destruction on the current thread's trace.
+class TraceScope {
+public:
+
+    /// \param name the name of the span, which must outlive the trace (in practice, be a string literal)
+    TraceScope(const char* name) : _name(name), _start(Trace::now()) { }
+    ~TraceScope() { Trace::record(_name, _start, Trace::now() - _start); }
+
+private:
+
+    const char* _name;
+    qint64 _start;
+};
+
+#endif // hifi_Trace_h
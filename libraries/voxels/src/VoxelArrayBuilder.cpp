@@ -0,0 +1,162 @@
+//
+//  VoxelArrayBuilder.cpp
+//  libraries/voxels/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <algorithm>
+#include <cstring>
+
+#include <QAtomicInt>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QSharedPointer>
+#include <QThreadPool>
+
+#include "VoxelArrayBuilder.h"
+
+const float IDENTITY_VERTICES_GLOBAL_NORMALS[] = { 0,0,0, 1,0,0, 1,1,0, 0,1,0, 0,0,1, 1,0,1, 1,1,1, 0,1,1 };
+
+// below this, handing chunks to the pool costs more than writing them here
+const int MIN_WRITES_TO_BUILD_IN_PARALLEL = 2048;
+
+/// Shared state for a set of chunks built in parallel.
+class VoxelArrayBuildState {
+public:
+
+    VoxelArrayBuildState(const VoxelArrayBuilder& builder, const std::vector<VoxelArrayWrite>& writes,
+            const std::vector<int>& chunkStarts) :
+        builder(builder),
+        writes(writes),
+        chunkStarts(chunkStarts) { }
+
+    /// Takes the next unclaimed chunk and writes it.
+    /// \return false if there were no chunks left to write
+    bool buildNext();
+
+    const VoxelArrayBuilder& builder;
+    const std::vector<VoxelArrayWrite>& writes;
+    std::vector<int> chunkStarts; ///< where each chunk's writes start, followed by the end of the last chunk's
+    QAtomicInt nextChunk;
+    QSemaphore completed;
+};
+
+bool VoxelArrayBuildState::buildNext() {
+    int chunk = nextChunk.fetchAndAddOrdered(1);
+    if (chunk >= (int)chunkStarts.size() - 1) {
+        return false;
+    }
+    for (int i = chunkStarts[chunk], end = chunkStarts[chunk + 1]; i < end; i++) {
+        builder.write(writes[i]);
+    }
+    completed.release();
+    return true;
+}
+
+/// Builds chunks on a pool thread until there are none left.
+class VoxelArrayBuildTask : public QRunnable {
+public:
+
+    VoxelArrayBuildTask(const QSharedPointer<VoxelArrayBuildState>& state) : _state(state) { }
+
+    virtual void run() { while (_state->buildNext()); }
+
+private:
+
+    QSharedPointer<VoxelArrayBuildState> _state;
+};
+
+VoxelArrayBuilder::VoxelArrayBuilder() :
+    _vertices(NULL),
+    _colors(NULL),
+    _shaderData(NULL)
+{
+}
+
+void VoxelArrayBuilder::setArrays(float* vertices, unsigned char* colors, VoxelShaderVBOData* shaderData) {
+    _vertices = vertices;
+    _colors = colors;
+    _shaderData = shaderData;
+}
+
+void VoxelArrayBuilder::queueWrite(glBufferIndex slot, const glm::vec3& corner, float scale, const nodeColor& color) {
+    VoxelArrayWrite write;
+    write.slot = slot;
+    write.corner = corner;
+    write.scale = scale;
+    memcpy(write.color, color, BYTES_PER_COLOR);
+    _queuedWrites.push_back(write);
+}
+
+void VoxelArrayBuilder::build() {
+    if ((int)_queuedWrites.size() < MIN_WRITES_TO_BUILD_IN_PARALLEL) {
+        for (std::vector<VoxelArrayWrite>::const_iterator it = _queuedWrites.begin(); it != _queuedWrites.end(); it++) {
+            write(*it);
+        }
+        _queuedWrites.clear();
+        return;
+    }
+
+    // sort the writes by chunk, keeping their order within each chunk so that the last write to a slot still wins
+    glBufferIndex highestSlot = 0;
+    for (std::vector<VoxelArrayWrite>::const_iterator it = _queuedWrites.begin(); it != _queuedWrites.end(); it++) {
+        highestSlot = std::max(highestSlot, it->slot);
+    }
+    _chunkWriteCounts.assign(getChunk(highestSlot) + 1, 0);
+    for (std::vector<VoxelArrayWrite>::const_iterator it = _queuedWrites.begin(); it != _queuedWrites.end(); it++) {
+        _chunkWriteCounts[getChunk(it->slot)]++;
+    }
+    std::vector<int> chunkStarts;
+    int offset = 0;
+    for (int chunk = 0; chunk < (int)_chunkWriteCounts.size(); chunk++) {
+        int count = _chunkWriteCounts[chunk];
+        if (count > 0) {
+            chunkStarts.push_back(offset);
+        }
+        _chunkWriteCounts[chunk] = offset; // from here on, where the chunk's next write goes
+        offset += count;
+    }
+    chunkStarts.push_back(offset);
+
+    _chunkedWrites.resize(_queuedWrites.size());
+    for (std::vector<VoxelArrayWrite>::const_iterator it = _queuedWrites.begin(); it != _queuedWrites.end(); it++) {
+        _chunkedWrites[_chunkWriteCounts[getChunk(it->slot)]++] = *it;
+    }
+    _queuedWrites.clear();
+
+    // start tasks on the pool, but also build on this thread so that we never wait on a task that hasn't started
+    int chunkCount = chunkStarts.size() - 1;
+    QSharedPointer<VoxelArrayBuildState> state(new VoxelArrayBuildState(*this, _chunkedWrites, chunkStarts));
+    int taskCount = qMin(chunkCount - 1, QThreadPool::globalInstance()->maxThreadCount());
+    for (int i = 0; i < taskCount; i++) {
+        QThreadPool::globalInstance()->start(new VoxelArrayBuildTask(state));
+    }
+    while (state->buildNext());
+    state->completed.acquire(chunkCount);
+}
+
+void VoxelArrayBuilder::write(const VoxelArrayWrite& write) const {
+    if (_shaderData) {
+        VoxelShaderVBOData* writeVerticesAt = &_shaderData[write.slot];
+        writeVerticesAt->x = write.corner.x * TREE_SCALE;
+        writeVerticesAt->y = write.corner.y * TREE_SCALE;
+        writeVerticesAt->z = write.corner.z * TREE_SCALE;
+        writeVerticesAt->s = write.scale * TREE_SCALE;
+        writeVerticesAt->r = write.color[RED_INDEX];
+        writeVerticesAt->g = write.color[GREEN_INDEX];
+        writeVerticesAt->b = write.color[BLUE_INDEX];
+
+    } else if (_vertices && _colors) {
+        int vertexPointsPerVoxel = GLOBAL_NORMALS_VERTEX_POINTS_PER_VOXEL;
+        float* writeVerticesAt = _vertices + (write.slot * vertexPointsPerVoxel);
+        unsigned char* writeColorsAt = _colors + (write.slot * vertexPointsPerVoxel);
+        for (int j = 0; j < vertexPointsPerVoxel; j++) {
+            writeVerticesAt[j] = write.corner[j % 3] + (IDENTITY_VERTICES_GLOBAL_NORMALS[j] * write.scale);
+            writeColorsAt[j] = write.color[j % 3];
+        }
+    }
+}
@@ -0,0 +1,76 @@
+//
+//  VoxelArrayBuilder.h
+//  libraries/voxels/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_VoxelArrayBuilder_h
+#define hifi_VoxelArrayBuilder_h
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <SharedUtil.h>
+
+#include "VoxelConstants.h"
+
+/// The per voxel layout of the vertex buffer used when drawing voxels with the voxel shader.
+struct VoxelShaderVBOData
+{
+    float x, y, z; // position
+    float s; // size
+    unsigned char r,g,b; // color
+};
+
+/// The geometry of one voxel, to be written to a slot in the vertex arrays.
+class VoxelArrayWrite {
+public:
+    glBufferIndex slot;
+    glm::vec3 corner;
+    float scale;
+    unsigned char color[BYTES_PER_COLOR];
+};
+
+/// Writes voxel geometry into the client side vertex and color arrays that back the voxel VBOs.  Writes are queued up
+/// during a pass over the tree and then built together: the arrays are split into chunks of consecutive slots, and the
+/// chunks with writes in them are filled in parallel on the global thread pool.  Doesn't touch GL, so it can be run and
+/// timed without a context.
+class VoxelArrayBuilder {
+public:
+    static const glBufferIndex SLOTS_PER_CHUNK = 4096;
+
+    static int getChunkCount(glBufferIndex slotCount) { return (slotCount + SLOTS_PER_CHUNK - 1) / SLOTS_PER_CHUNK; }
+    static int getChunk(glBufferIndex slot) { return slot / SLOTS_PER_CHUNK; }
+
+    VoxelArrayBuilder();
+
+    /// Sets the arrays to write into: either vertices and colors in the global normals layout, or voxel shader data.
+    void setArrays(float* vertices, unsigned char* colors, VoxelShaderVBOData* shaderData);
+
+    /// Queues the geometry for a slot, to be written by the next build().  Later writes to a slot win.
+    void queueWrite(glBufferIndex slot, const glm::vec3& corner, float scale, const nodeColor& color);
+
+    int getQueuedWriteCount() const { return _queuedWrites.size(); }
+
+    /// Writes everything queued and empties the queue.
+    void build();
+
+    /// Writes the geometry for a single slot right away.
+    void write(const VoxelArrayWrite& write) const;
+
+private:
+    float* _vertices;
+    unsigned char* _colors;
+    VoxelShaderVBOData* _shaderData;
+
+    std::vector<VoxelArrayWrite> _queuedWrites;
+    std::vector<VoxelArrayWrite> _chunkedWrites;
+    std::vector<int> _chunkWriteCounts;
+};
+
+#endif // hifi_VoxelArrayBuilder_h
@@ -556,6 +556,11 @@ int VoxelTree::processEditPacketData(PacketType packetType, const unsigned char*
             }
 
             readCodeColorBufferToTree(editData, destructive);
+            
+            VoxelPositionSize editDetails;
+            voxelDetailsForCode(editData, editDetails);
+            float halfSize = editDetails.s * 0.5f;
+            _lastEditPosition = glm::vec3(editDetails.x + halfSize, editDetails.y + halfSize, editDetails.z + halfSize);
 
             return voxelDataSize;
         } break;
@@ -0,0 +1,261 @@
+//
+//  FBXCookerTests.cpp
+//  tests/fbx/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <iostream>
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <FBXCooker.h>
+
+#include "FBXCookerTests.h"
+
+static FBXJoint makeJoint(const QString& name, int parentIndex) {
+    FBXJoint joint;
+    joint.isFree = (parentIndex != -1);
+    if (joint.isFree) {
+        joint.freeLineage.append(parentIndex);
+    }
+    joint.parentIndex = parentIndex;
+    joint.distanceToParent = 0.5f;
+    joint.boneRadius = 0.1f;
+    joint.translation = glm::vec3(0.0f, 0.5f, 0.0f);
+    joint.preRotation = glm::quat(glm::vec3(0.1f, 0.0f, 0.0f));
+    joint.rotation = glm::quat(glm::vec3(0.0f, 0.2f, 0.0f));
+    joint.postRotation = glm::quat(glm::vec3(0.0f, 0.0f, 0.3f));
+    joint.rotationMin = glm::vec3(-1.0f);
+    joint.rotationMax = glm::vec3(1.0f);
+    joint.inverseDefaultRotation = glm::inverse(joint.rotation);
+    joint.inverseBindRotation = glm::inverse(joint.preRotation);
+    joint.name = name;
+    joint.shapePosition = glm::vec3(0.0f, 0.25f, 0.0f);
+    joint.shapeType = Shape::CAPSULE_SHAPE;
+    return joint;
+}
+
+/// Makes a small skinned, blended model with everything that the cooked format carries.
+static FBXGeometry makeGeometry() {
+    FBXGeometry geometry;
+    geometry.author = "author";
+    geometry.applicationName = "application";
+    geometry.joints.append(makeJoint("Hips", -1));
+    geometry.joints.append(makeJoint("Spine", 0));
+    geometry.joints.append(makeJoint("Head", 1));
+    for (int i = 0; i < geometry.joints.size(); i++) {
+        geometry.jointIndices.insert(geometry.joints.at(i).name, i + 1);
+    }
+
+    FBXMesh mesh;
+    FBXMeshPart part;
+    part.quadIndices << 0 << 1 << 2 << 3;
+    part.triangleIndices << 0 << 1 << 2;
+    part.diffuseColor = glm::vec3(1.0f, 0.5f, 0.25f);
+    part.specularColor = glm::vec3(1.0f);
+    part.shininess = 10.0f;
+    part.diffuseTexture.filename = "diffuse.png";
+    mesh.parts.append(part);
+    mesh.vertices << glm::vec3(0.0f) << glm::vec3(1.0f, 0.0f, 0.0f) << glm::vec3(1.0f, 1.0f, 0.0f)
+        << glm::vec3(0.0f, 1.0f, 0.0f);
+    mesh.normals.fill(glm::vec3(0.0f, 0.0f, 1.0f), mesh.vertices.size());
+    mesh.texCoords.fill(glm::vec2(0.5f), mesh.vertices.size());
+    mesh.clusterIndices.fill(glm::vec4(0.0f, 1.0f, 0.0f, 0.0f), mesh.vertices.size());
+    mesh.clusterWeights.fill(glm::vec4(0.75f, 0.25f, 0.0f, 0.0f), mesh.vertices.size());
+    FBXCluster cluster;
+    cluster.jointIndex = 1;
+    mesh.clusters.append(cluster);
+    cluster.jointIndex = 2;
+    cluster.inverseBindMatrix = glm::mat4(2.0f);
+    mesh.clusters.append(cluster);
+    mesh.isEye = false;
+    FBXBlendshape blendshape;
+    blendshape.indices << 1 << 3;
+    blendshape.vertices << glm::vec3(0.0f, 0.0f, 0.1f) << glm::vec3(0.0f, 0.0f, -0.1f);
+    blendshape.normals << glm::vec3(0.0f, 0.1f, 0.0f) << glm::vec3(0.0f, -0.1f, 0.0f);
+    mesh.blendshapes.append(blendshape);
+    geometry.meshes.append(mesh);
+
+    geometry.offset = glm::mat4(0.5f);
+    geometry.leftEyeJointIndex = -1;
+    geometry.rightEyeJointIndex = -1;
+    geometry.neckJointIndex = 1;
+    geometry.rootJointIndex = 0;
+    geometry.leanJointIndex = 1;
+    geometry.headJointIndex = 2;
+    geometry.leftHandJointIndex = -1;
+    geometry.rightHandJointIndex = -1;
+    geometry.palmDirection = glm::vec3(0.0f, -1.0f, 0.0f);
+    geometry.neckPivot = glm::vec3(0.0f, 1.0f, 0.0f);
+    geometry.bindExtents.minimum = glm::vec3(-1.0f);
+    geometry.bindExtents.maximum = glm::vec3(1.0f);
+    geometry.meshExtents = geometry.bindExtents;
+
+    FBXAnimationFrame frame;
+    frame.rotations.fill(glm::quat(), geometry.joints.size());
+    geometry.animationFrames.append(frame);
+
+    FBXAttachment attachment;
+    attachment.jointIndex = 2;
+    attachment.url = QUrl("http://example.com/hat.fst");
+    attachment.translation = glm::vec3(0.0f, 0.1f, 0.0f);
+    attachment.scale = glm::vec3(1.0f);
+    geometry.attachments.append(attachment);
+    return geometry;
+}
+
+static bool readsBack(const QByteArray& cooked, FBXGeometry& geometry) {
+    try {
+        geometry = readCookedFBXGeometry(cooked);
+        return true;
+
+    } catch (const QString&) {
+        return false;
+    }
+}
+
+void FBXCookerTests::roundTrip() {
+    FBXGeometry original = makeGeometry();
+    FBXGeometry geometry;
+    if (!readsBack(cookFBXGeometry(original), geometry)) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: couldn't read back cooked geometry" << std::endl;
+        return;
+    }
+    if (geometry.author != original.author || geometry.applicationName != original.applicationName) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: names differ" << std::endl;
+    }
+    if (geometry.joints.size() != original.joints.size() || geometry.jointIndices != original.jointIndices) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: joints differ" << std::endl;
+
+    } else {
+        for (int i = 0; i < geometry.joints.size(); i++) {
+            const FBXJoint& joint = geometry.joints.at(i);
+            const FBXJoint& originalJoint = original.joints.at(i);
+            if (joint.name != originalJoint.name || joint.parentIndex != originalJoint.parentIndex ||
+                    joint.freeLineage != originalJoint.freeLineage || joint.rotation != originalJoint.rotation ||
+                    joint.translation != originalJoint.translation || joint.shapeType != originalJoint.shapeType) {
+                std::cout << __FILE__ << ":" << __LINE__ << " ERROR: joint " << i << " differs" << std::endl;
+            }
+        }
+    }
+    if (geometry.meshes.size() != 1) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: expected one mesh but read "
+            << geometry.meshes.size() << std::endl;
+
+    } else {
+        const FBXMesh& mesh = geometry.meshes.at(0);
+        const FBXMesh& originalMesh = original.meshes.at(0);
+        if (mesh.parts.size() != 1 || mesh.parts.at(0).quadIndices != originalMesh.parts.at(0).quadIndices ||
+                mesh.parts.at(0).triangleIndices != originalMesh.parts.at(0).triangleIndices ||
+                mesh.parts.at(0).diffuseTexture.filename != originalMesh.parts.at(0).diffuseTexture.filename) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: mesh parts differ" << std::endl;
+        }
+        if (mesh.vertices != originalMesh.vertices || mesh.normals != originalMesh.normals ||
+                mesh.texCoords != originalMesh.texCoords || mesh.clusterIndices != originalMesh.clusterIndices ||
+                mesh.clusterWeights != originalMesh.clusterWeights) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: mesh vertex data differs" << std::endl;
+        }
+        if (mesh.clusters.size() != 2 || mesh.clusters.at(1).jointIndex != 2 ||
+                mesh.clusters.at(1).inverseBindMatrix != originalMesh.clusters.at(1).inverseBindMatrix) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: mesh clusters differ" << std::endl;
+        }
+        if (mesh.blendshapes.size() != 1 || mesh.blendshapes.at(0).indices != originalMesh.blendshapes.at(0).indices ||
+                mesh.blendshapes.at(0).vertices != originalMesh.blendshapes.at(0).vertices ||
+                mesh.blendshapes.at(0).normals != originalMesh.blendshapes.at(0).normals) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: mesh blendshapes differ" << std::endl;
+        }
+    }
+    if (geometry.offset != original.offset || geometry.neckJointIndex != original.neckJointIndex ||
+            geometry.headJointIndex != original.headJointIndex || geometry.leftEyeJointIndex != -1 ||
+            geometry.neckPivot != original.neckPivot || geometry.meshExtents.maximum != original.meshExtents.maximum) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: geometry properties differ" << std::endl;
+    }
+    if (geometry.animationFrames.size() != 1 || geometry.animationFrames.at(0).rotations.size() != 3) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: animation frames differ" << std::endl;
+    }
+    if (geometry.attachments.size() != 1 || geometry.attachments.at(0).jointIndex != 2 ||
+            geometry.attachments.at(0).url != original.attachments.at(0).url) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: attachments differ" << std::endl;
+    }
+}
+
+void FBXCookerTests::rejectsBadData() {
+    const int BAD_GEOMETRY_COUNT = 6;
+    for (int i = 0; i < BAD_GEOMETRY_COUNT; i++) {
+        FBXGeometry bad = makeGeometry();
+        FBXMesh& mesh = bad.meshes[0];
+        switch (i) {
+            case 0:
+                mesh.clusters[0].jointIndex = bad.joints.size();
+                break;
+            case 1:
+                mesh.clusterIndices[0].y = mesh.clusters.size();
+                break;
+            case 2:
+                bad.joints[1].parentIndex = -2;
+                break;
+            case 3:
+                bad.jointIndices.insert("Extra", bad.joints.size() + 1);
+                break;
+            case 4:
+                mesh.parts[0].triangleIndices.append(mesh.vertices.size());
+                break;
+            case 5:
+                mesh.blendshapes[0].indices.append(0); // one more index than deltas
+                break;
+        }
+        FBXGeometry geometry;
+        if (readsBack(cookFBXGeometry(bad), geometry)) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: accepted bad geometry " << i << std::endl;
+        }
+    }
+
+    QByteArray cooked = cookFBXGeometry(makeGeometry());
+    FBXGeometry geometry;
+    if (readsBack(cooked.left(cooked.size() / 2), geometry)) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: accepted truncated geometry" << std::endl;
+    }
+}
+
+void FBXCookerTests::trimsCache() {
+    QTemporaryDir directory;
+    if (!directory.isValid()) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: couldn't create a temporary directory" << std::endl;
+        return;
+    }
+    const int FILE_COUNT = 8;
+    const int FILE_SIZE = 1024;
+    for (int i = 0; i < FILE_COUNT; i++) {
+        QFile file(QDir(directory.path()).filePath(QString("%1-%2.cooked").arg(i).arg(COOKED_FBX_VERSION)));
+        file.open(QIODevice::WriteOnly);
+        file.write(QByteArray(FILE_SIZE, 0));
+    }
+    QFile other(QDir(directory.path()).filePath("other.txt"));
+    other.open(QIODevice::WriteOnly);
+    other.write(QByteArray(FILE_SIZE * FILE_COUNT, 0));
+    other.close();
+
+    const int MAX_BYTES = FILE_SIZE * 3 + FILE_SIZE / 2;
+    trimCookedFBXCache(directory.path(), MAX_BYTES);
+
+    QFileInfoList remaining = QDir(directory.path()).entryInfoList(QStringList("*.cooked"), QDir::Files);
+    if (remaining.size() != 3) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: expected 3 cooked files left but found "
+            << remaining.size() << std::endl;
+    }
+    if (!other.exists()) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: trimming removed a file that wasn't cooked" << std::endl;
+    }
+}
+
+void FBXCookerTests::runAllTests() {
+    roundTrip();
+    rejectsBadData();
+    trimsCache();
+}
@@ -0,0 +1,28 @@
+//
+//  FBXCookerTests.h
+//  tests/fbx/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_FBXCookerTests_h
+#define hifi_FBXCookerTests_h
+
+namespace FBXCookerTests {
+
+    /// Checks that geometry read back from its cooked form matches what was cooked.
+    void roundTrip();
+
+    /// Checks that cooked geometry with out of range joint, cluster or vertex indices, or cut short, is rejected.
+    void rejectsBadData();
+
+    /// Checks that trimming a cache directory brings the cooked files in it under the size limit.
+    void trimsCache();
+
+    void runAllTests();
+}
+
+#endif // hifi_FBXCookerTests_h
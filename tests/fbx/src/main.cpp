@@ -0,0 +1,16 @@
+//
+//  main.cpp
+//  tests/fbx/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "FBXCookerTests.h"
+
+int main(int argc, char** argv) {
+    FBXCookerTests::runAllTests();
+    return 0;
+}
@@ -9,8 +9,11 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <limits.h>
 #include <stdlib.h>
 
+#include <QElapsedTimer>
+
 #include <SharedUtil.h>
 
 #include <MetavoxelMessages.h>
@@ -60,22 +63,31 @@ static TestMessageC createRandomMessageC() {
     return message;
 }
 
-static bool testSerialization(Bitstream::MetadataType metadataType) {
+static const int TEST_INTEGERS[] = { 0, 1, -1, 63, -64, 127, 128, 16383, 16384, INT_MAX, INT_MIN };
+static const int TEST_INTEGER_COUNT = sizeof(TEST_INTEGERS) / sizeof(TEST_INTEGERS[0]);
+
+static bool testSerialization(Bitstream::MetadataType metadataType, Bitstream::IntegerEncoding integerEncoding) {
     QByteArray array;
     QDataStream outStream(&array, QIODevice::WriteOnly);
     Bitstream out(outStream, metadataType);
+    out.setIntegerEncoding(integerEncoding);
     SharedObjectPointer testObjectWrittenA = new TestSharedObjectA(randFloat());
     out << testObjectWrittenA;
     SharedObjectPointer testObjectWrittenB = new TestSharedObjectB(randFloat(), createRandomBytes());
     out << testObjectWrittenB;
     TestMessageC messageWritten = createRandomMessageC();
     out << QVariant::fromValue(messageWritten);
+    for (int i = 0; i < TEST_INTEGER_COUNT; i++) {
+        // offset each integer by a bit to exercise the unaligned paths
+        out << (i % 2 == 0) << TEST_INTEGERS[i] << (uint)TEST_INTEGERS[i];
+    }
     QByteArray endWritten = "end";
     out << endWritten;
     out.flush();
     
     QDataStream inStream(array);
     Bitstream in(inStream, metadataType);
+    in.setIntegerEncoding(integerEncoding);
     in.addMetaObjectSubstitution("TestSharedObjectA", &TestSharedObjectB::staticMetaObject);
     in.addMetaObjectSubstitution("TestSharedObjectB", &TestSharedObjectA::staticMetaObject);
     in.addTypeSubstitution("TestMessageC", TestMessageA::Type);
@@ -120,6 +132,17 @@ static bool testSerialization(Bitstream::MetadataType metadataType) {
         return true;
     }
     
+    for (int i = 0; i < TEST_INTEGER_COUNT; i++) {
+        bool flag;
+        int signedValue;
+        uint unsignedValue;
+        in >> flag >> signedValue >> unsignedValue;
+        if (flag != (i % 2 == 0) || signedValue != TEST_INTEGERS[i] || unsignedValue != (uint)TEST_INTEGERS[i]) {
+            qDebug() << "Integer mismatch." << TEST_INTEGERS[i] << signedValue << unsignedValue << integerEncoding;
+            return true;
+        }
+    }
+    
     QByteArray endRead;
     in >> endRead;
     if (endWritten != endRead) {
@@ -130,6 +153,98 @@ static bool testSerialization(Bitstream::MetadataType metadataType) {
     return false;
 }
 
+static void applyRandomBoxEdits(MetavoxelData& data, int count) {
+    const float EDIT_GRANULARITY = 1.0f / 64.0f;
+    const float MAX_BOX_SIZE = 0.25f;
+    for (int i = 0; i < count; i++) {
+        glm::vec3 minimum(randFloat(), randFloat(), randFloat());
+        glm::vec3 maximum = minimum + glm::vec3(randFloat(), randFloat(), randFloat()) * MAX_BOX_SIZE;
+        AttributePointer attribute = AttributeRegistry::getInstance()->getColorAttribute();
+        BoxSetEdit(Box(minimum, maximum), EDIT_GRANULARITY, OwnedAttributeValue(attribute,
+            encodeInline(qRgb(randIntInRange(0, 255), randIntInRange(0, 255), randIntInRange(0, 255))))).apply(
+                data, SharedObject::getWeakHash());
+    }
+}
+
+static QByteArray writeFully(const MetavoxelData& data, Bitstream::IntegerEncoding integerEncoding) {
+    QByteArray array;
+    QDataStream outStream(&array, QIODevice::WriteOnly);
+    Bitstream out(outStream);
+    out.setIntegerEncoding(integerEncoding);
+    out << data;
+    out.flush();
+    return array;
+}
+
+static bool testDeltaThroughput(Bitstream::IntegerEncoding integerEncoding) {
+    MetavoxelData reference;
+    const int REFERENCE_EDITS = 32;
+    applyRandomBoxEdits(reference, REFERENCE_EDITS);
+    MetavoxelData data = reference;
+    const int DELTA_EDITS = 8;
+    applyRandomBoxEdits(data, DELTA_EDITS);
+    
+    // make sure that a full round trip reproduces the same bits
+    QByteArray fullArray = writeFully(data, integerEncoding);
+    MetavoxelData dataRead;
+    {
+        QDataStream inStream(fullArray);
+        Bitstream in(inStream);
+        in.setIntegerEncoding(integerEncoding);
+        in >> dataRead;
+    }
+    if (fullArray != writeFully(dataRead, integerEncoding)) {
+        qDebug() << "Metavoxel data round trip mismatch." << integerEncoding;
+        return true;
+    }
+    
+    const int DELTA_ITERATIONS = 200;
+    QByteArray deltaArray;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < DELTA_ITERATIONS; i++) {
+        deltaArray.clear();
+        QDataStream outStream(&deltaArray, QIODevice::WriteOnly);
+        Bitstream out(outStream);
+        out.setIntegerEncoding(integerEncoding);
+        out.writeDelta(data, reference);
+        out.flush();
+    }
+    qint64 writeTime = timer.nsecsElapsed();
+    
+    timer.restart();
+    for (int i = 0; i < DELTA_ITERATIONS; i++) {
+        QDataStream inStream(deltaArray);
+        Bitstream in(inStream);
+        in.setIntegerEncoding(integerEncoding);
+        MetavoxelData deltaRead;
+        in.readDelta(deltaRead, reference);
+    }
+    qint64 readTime = timer.nsecsElapsed();
+    
+    // make sure that the delta applied to the reference reproduces the data it was written from
+    MetavoxelData deltaRead;
+    {
+        QDataStream inStream(deltaArray);
+        Bitstream in(inStream);
+        in.setIntegerEncoding(integerEncoding);
+        in.readDelta(deltaRead, reference);
+    }
+    if (fullArray != writeFully(deltaRead, integerEncoding)) {
+        qDebug() << "Metavoxel delta round trip mismatch." << integerEncoding;
+        return true;
+    }
+    
+    const float NSECS_PER_SEC = 1000000000.0f;
+    const float BYTES_PER_MEGABYTE = 1024.0f * 1024.0f;
+    float totalMegabytes = deltaArray.size() * DELTA_ITERATIONS / BYTES_PER_MEGABYTE;
+    qDebug() << (integerEncoding == Bitstream::VARIABLE_INTEGERS ? "Variable integers:" : "Fixed integers:") <<
+        "delta of" << deltaArray.size() << "bytes," <<
+        "writeDelta" << totalMegabytes * NSECS_PER_SEC / qMax(writeTime, (qint64)1) << "MB/s," <<
+        "readDelta" << totalMegabytes * NSECS_PER_SEC / qMax(readTime, (qint64)1) << "MB/s";
+    return false;
+}
+
 bool MetavoxelTests::run() {
     
     qDebug() << "Running transmission tests...";
@@ -164,10 +279,21 @@ bool MetavoxelTests::run() {
     qDebug() << "Running serialization tests...";
     qDebug();
     
-    if (testSerialization(Bitstream::HASH_METADATA) || testSerialization(Bitstream::FULL_METADATA)) {
+    if (testSerialization(Bitstream::HASH_METADATA, Bitstream::FIXED_INTEGERS) ||
+            testSerialization(Bitstream::FULL_METADATA, Bitstream::FIXED_INTEGERS) ||
+            testSerialization(Bitstream::HASH_METADATA, Bitstream::VARIABLE_INTEGERS) ||
+            testSerialization(Bitstream::FULL_METADATA, Bitstream::VARIABLE_INTEGERS)) {
         return true;
     }
     
+    qDebug() << "Running delta benchmarks...";
+    qDebug();
+    
+    if (testDeltaThroughput(Bitstream::FIXED_INTEGERS) || testDeltaThroughput(Bitstream::VARIABLE_INTEGERS)) {
+        return true;
+    }
+    qDebug();
+    
     qDebug() << "All tests passed!";
     
     return false;
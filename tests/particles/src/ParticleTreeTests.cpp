@@ -0,0 +1,265 @@
+//
+//  ParticleTreeTests.cpp
+//  tests/particles/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <iostream>
+
+#include <glm/glm.hpp>
+
+#include <PacketHeaders.h>
+#include <ParticleSimulationStore.h>
+#include <ParticleTree.h>
+#include <SharedUtil.h>
+
+#include "ParticleTreeTests.h"
+
+const float TEST_PARTICLE_RADIUS = 0.001f;
+
+static Particle makeParticle(uint32_t id, const glm::vec3& position, uint32_t creatorTokenID = UNKNOWN_TOKEN) {
+    Particle particle;
+    rgbColor color = { 255, 255, 255 };
+    particle.init(position, TEST_PARTICLE_RADIUS, color, glm::vec3(0.0f), glm::vec3(0.0f), 0.0f, DEFAULT_LIFETIME,
+        NOT_IN_HAND, DEFAULT_SCRIPT, id);
+    particle.setCreatorTokenID(creatorTokenID);
+    return particle;
+}
+
+class CheckIndexArgs {
+public:
+    ParticleTree* tree;
+    int particles;
+    int mismatches;
+};
+
+static bool checkIndexOperation(OctreeElement* element, void* extraData) {
+    CheckIndexArgs* args = static_cast<CheckIndexArgs*>(extraData);
+    ParticleTreeElement* particleTreeElement = static_cast<ParticleTreeElement*>(element);
+    foreach (const Particle& particle, particleTreeElement->getParticles()) {
+        args->particles++;
+        if (particle.getID() != UNKNOWN_PARTICLE_ID &&
+                args->tree->getContainingElement(particle.getID()) != particleTreeElement) {
+            args->mismatches++;
+        }
+    }
+    return true;
+}
+
+/// Checks that every particle in the tree is indexed to the element holding it, and that the tree holds the expected
+/// number of particles.
+static void checkIndex(ParticleTree& tree, int expectedParticles, int line) {
+    CheckIndexArgs args = { &tree, 0, 0 };
+    tree.recurseTreeWithOperation(checkIndexOperation, &args);
+    if (args.mismatches > 0) {
+        std::cout << __FILE__ << ":" << line << " ERROR: " << args.mismatches
+            << " particles not indexed to the elements holding them" << std::endl;
+    }
+    if (args.particles != expectedParticles) {
+        std::cout << __FILE__ << ":" << line << " ERROR: expected " << expectedParticles
+            << " particles in the tree but found " << args.particles << std::endl;
+    }
+}
+
+/// Checks that the particle with the given ID is indexed to an element that holds it at the given position.
+static void checkIndexed(ParticleTree& tree, uint32_t id, const glm::vec3& position, int line) {
+    ParticleTreeElement* element = tree.getContainingElement(id);
+    const Particle* particle = element ? element->getParticleWithID(id) : NULL;
+    if (!particle) {
+        std::cout << __FILE__ << ":" << line << " ERROR: particle " << id << " not indexed" << std::endl;
+
+    } else if (particle->getPosition() != position || !element->getAABox().contains(position)) {
+        std::cout << __FILE__ << ":" << line << " ERROR: particle " << id << " indexed to the wrong element"
+            << std::endl;
+
+    } else if (tree.findParticleByID(id) != particle) {
+        std::cout << __FILE__ << ":" << line << " ERROR: findParticleByID didn't find particle " << id << std::endl;
+    }
+}
+
+/// Returns the particle with the given ID for editing in place, as scripts and the collision system do.
+static Particle* findParticleForEdit(ParticleTree& tree, uint32_t id, int line) {
+    ParticleTreeElement* element = tree.getContainingElement(id);
+    if (element) {
+        QList<Particle>& particles = element->getParticles();
+        for (int i = 0; i < particles.size(); i++) {
+            if (particles[i].getID() == id) {
+                return &particles[i];
+            }
+        }
+    }
+    std::cout << __FILE__ << ":" << line << " ERROR: particle " << id << " not found" << std::endl;
+    return NULL;
+}
+
+/// Builds the server's answer to a locally created particle, giving it its ID.
+static QByteArray makeAddResponse(uint32_t creatorTokenID, uint32_t particleID) {
+    QByteArray packet(numBytesForPacketHeaderGivenPacketType(PacketTypeParticleAddResponse), 0);
+    packet[0] = PacketTypeParticleAddResponse;
+    packet[1] = versionForPacketType(PacketTypeParticleAddResponse);
+    packet.append(reinterpret_cast<const char*>(&creatorTokenID), sizeof(creatorTokenID));
+    packet.append(reinterpret_cast<const char*>(&particleID), sizeof(particleID));
+    return packet;
+}
+
+void ParticleTreeTests::indexFollowsAdd() {
+    ParticleTree tree;
+    const int PARTICLE_COUNT = 20;
+    const uint32_t FIRST_ID = 100;
+    for (int i = 0; i < PARTICLE_COUNT; i++) {
+        tree.storeParticle(makeParticle(FIRST_ID + i, glm::vec3(0.05f + 0.045f * i, 0.5f, 0.5f)));
+    }
+    checkIndex(tree, PARTICLE_COUNT, __LINE__);
+    for (int i = 0; i < PARTICLE_COUNT; i++) {
+        checkIndexed(tree, FIRST_ID + i, glm::vec3(0.05f + 0.045f * i, 0.5f, 0.5f), __LINE__);
+    }
+
+    // storing a particle again updates it where it is, rather than adding another
+    tree.storeParticle(makeParticle(FIRST_ID, glm::vec3(0.05f, 0.5f, 0.5f)));
+    checkIndex(tree, PARTICLE_COUNT, __LINE__);
+}
+
+void ParticleTreeTests::indexFollowsMove() {
+    ParticleTree tree;
+    const uint32_t MOVING_ID = 1;
+    const uint32_t STAYING_ID = 2;
+    const glm::vec3 START_POSITION(0.1f, 0.1f, 0.1f);
+    const glm::vec3 END_POSITION(0.9f, 0.6f, 0.9f);
+    tree.storeParticle(makeParticle(MOVING_ID, START_POSITION));
+    tree.storeParticle(makeParticle(STAYING_ID, START_POSITION + glm::vec3(TEST_PARTICLE_RADIUS)));
+
+    // move the particle across the tree, as a script or an edit would, and let the update carry it to its new element
+    Particle* movingParticle = findParticleForEdit(tree, MOVING_ID, __LINE__);
+    if (!movingParticle) {
+        return;
+    }
+    movingParticle->setPosition(END_POSITION);
+    tree.update();
+
+    checkIndex(tree, 2, __LINE__);
+    checkIndexed(tree, MOVING_ID, END_POSITION, __LINE__);
+    checkIndexed(tree, STAYING_ID, START_POSITION + glm::vec3(TEST_PARTICLE_RADIUS), __LINE__);
+    if (tree.getContainingElement(MOVING_ID) == tree.getContainingElement(STAYING_ID)) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: moved particle still indexed to its old element"
+            << std::endl;
+    }
+}
+
+void ParticleTreeTests::indexFollowsDelete() {
+    ParticleTree tree;
+    tree.storeParticle(makeParticle(1, glm::vec3(0.2f, 0.2f, 0.2f)));
+    tree.storeParticle(makeParticle(2, glm::vec3(0.2f, 0.2f, 0.2f)));
+    tree.storeParticle(makeParticle(3, glm::vec3(0.7f, 0.7f, 0.7f)));
+
+    tree.deleteParticle(ParticleID(2));
+    checkIndex(tree, 2, __LINE__);
+    if (tree.getContainingElement(2) || tree.findParticleByID(2)) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: deleted particle still indexed" << std::endl;
+    }
+    checkIndexed(tree, 1, glm::vec3(0.2f, 0.2f, 0.2f), __LINE__);
+
+    // a particle that dies is deleted by the update
+    tree.deleteParticle(ParticleID(1));
+    Particle* dyingParticle = findParticleForEdit(tree, 3, __LINE__);
+    if (!dyingParticle) {
+        return;
+    }
+    dyingParticle->setShouldDie(true);
+    tree.update();
+    checkIndex(tree, 0, __LINE__);
+    if (tree.getContainingElement(1) || tree.getContainingElement(3)) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: deleted particles still indexed" << std::endl;
+    }
+}
+
+void ParticleTreeTests::indexFollowsIDChange() {
+    const uint32_t CREATOR_TOKEN = 42;
+    const uint32_t ASSIGNED_ID = 7;
+    const glm::vec3 LOCAL_POSITION(0.3f, 0.3f, 0.3f);
+    const glm::vec3 ELSEWHERE(0.8f, 0.8f, 0.8f);
+
+    // a particle created locally has no ID, and so isn't indexed, until the server answers with one
+    {
+        ParticleTree tree;
+        tree.storeParticle(makeParticle(UNKNOWN_PARTICLE_ID, LOCAL_POSITION, CREATOR_TOKEN));
+        if (tree.getContainingElement(ASSIGNED_ID)) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: particle indexed before it has an ID" << std::endl;
+        }
+        tree.handleAddParticleResponse(makeAddResponse(CREATOR_TOKEN, ASSIGNED_ID));
+        checkIndex(tree, 1, __LINE__);
+        checkIndexed(tree, ASSIGNED_ID, LOCAL_POSITION, __LINE__);
+    }
+
+    // a viewing tree may also hold the copy the server sent, which is dropped in favor of the local one; try it both
+    // in another element and in the same one
+    const glm::vec3 VIEWED_POSITIONS[] = { ELSEWHERE, LOCAL_POSITION };
+    for (int i = 0; i < 2; i++) {
+        ParticleTree tree;
+        tree.setIsViewing(true);
+        tree.storeParticle(makeParticle(ASSIGNED_ID, VIEWED_POSITIONS[i]));
+        tree.storeParticle(makeParticle(UNKNOWN_PARTICLE_ID, LOCAL_POSITION, CREATOR_TOKEN));
+        tree.handleAddParticleResponse(makeAddResponse(CREATOR_TOKEN, ASSIGNED_ID));
+        checkIndex(tree, 1, __LINE__);
+        checkIndexed(tree, ASSIGNED_ID, LOCAL_POSITION, __LINE__);
+    }
+}
+
+void ParticleTreeTests::simulationStoreMatchesScalarIntegration() {
+    const int PARTICLE_COUNT = 100;
+    const float TIME_ELAPSED = 1.0f / 60.0f;
+    QVector<Particle> particles;
+    for (int i = 0; i < PARTICLE_COUNT; i++) {
+        Particle particle = makeParticle(i, glm::vec3(randFloat(), randFloatInRange(-0.01f, 0.5f), randFloat()));
+        particle.setVelocity(glm::vec3(randFloatInRange(-1.0f, 1.0f), randFloatInRange(-1.0f, 1.0f),
+            randFloatInRange(-1.0f, 1.0f)));
+        particle.setGravity(glm::vec3(0.0f, -randFloat(), 0.0f));
+        particle.setDamping(randFloat());
+        particles.append(particle);
+    }
+    ParticleSimulationStore store;
+    foreach (const Particle& particle, particles) {
+        store.add(particle, TIME_ELAPSED);
+    }
+    store.integrate();
+
+    const float EPSILON = 0.00001f;
+    int mismatches = 0;
+    for (int i = 0; i < PARTICLE_COUNT; i++) {
+        const Particle& particle = particles.at(i);
+        glm::vec3 position = particle.getPosition() + particle.getVelocity() * TIME_ELAPSED;
+        glm::vec3 velocity = particle.getVelocity();
+        if (position.y <= 0) {
+            velocity = velocity * glm::vec3(1,-1,1);
+            position.y = 0;
+        }
+        velocity += particle.getGravity() * TIME_ELAPSED;
+        velocity -= velocity * particle.getDamping() * TIME_ELAPSED;
+
+        if (glm::distance(store.getPosition(i), position) > EPSILON ||
+                glm::distance(store.getVelocity(i), velocity) > EPSILON) {
+            mismatches++;
+        }
+    }
+    if (mismatches > 0) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: " << mismatches
+            << " particles integrated differently by the simulation store" << std::endl;
+    }
+
+    // the store keeps nothing from one batch to the next
+    store.clear();
+    if (store.size() != 0) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: store not empty after clear" << std::endl;
+    }
+}
+
+void ParticleTreeTests::runAllTests() {
+    indexFollowsAdd();
+    indexFollowsMove();
+    indexFollowsDelete();
+    indexFollowsIDChange();
+    simulationStoreMatchesScalarIntegration();
+}
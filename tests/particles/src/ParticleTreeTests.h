@@ -0,0 +1,29 @@
+//
+//  ParticleTreeTests.h
+//  tests/particles/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ParticleTreeTests_h
+#define hifi_ParticleTreeTests_h
+
+namespace ParticleTreeTests {
+
+    /// Checks that the index from particle IDs to their elements stays consistent as particles are added, move between
+    /// elements, are deleted and are given their IDs.
+    void indexFollowsAdd();
+    void indexFollowsMove();
+    void indexFollowsDelete();
+    void indexFollowsIDChange();
+
+    /// Checks the simulation store's integration against integrating each particle on its own.
+    void simulationStoreMatchesScalarIntegration();
+
+    void runAllTests();
+}
+
+#endif // hifi_ParticleTreeTests_h
@@ -0,0 +1,185 @@
+//
+//  BroadphaseTests.cpp
+//  tests/physics/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <iostream>
+
+#include <glm/glm.hpp>
+
+#include <GeometryUtil.h>
+#include <SharedUtil.h>
+#include <SweepAndPrune.h>
+
+#include "BroadphaseTests.h"
+
+const int PARTICLE_GROUP = 1;
+const int AVATAR_GROUP = 2;
+
+class Sphere {
+public:
+    glm::vec3 center;
+    float radius;
+};
+
+static void addSphere(SweepAndPrune& broadphase, const Sphere& sphere, int group, int collidesWith) {
+    glm::vec3 extent(sphere.radius);
+    broadphase.addBox(sphere.center - extent, sphere.center + extent, group, collidesWith);
+}
+
+static void makeScene(QVector<Sphere>& particles, QVector<Sphere>& avatars, int particleCount, int avatarCount) {
+    const float ROOM_SIZE = 50.0f;
+    const float MIN_PARTICLE_RADIUS = 0.05f;
+    const float MAX_PARTICLE_RADIUS = 0.5f;
+    const float AVATAR_RADIUS = 2.0f;
+    particles.resize(particleCount);
+    for (int i = 0; i < particleCount; i++) {
+        particles[i].center = glm::vec3(randFloatInRange(0.0f, ROOM_SIZE), randFloatInRange(0.0f, ROOM_SIZE * 0.1f),
+            randFloatInRange(0.0f, ROOM_SIZE));
+        particles[i].radius = randFloatInRange(MIN_PARTICLE_RADIUS, MAX_PARTICLE_RADIUS);
+    }
+    avatars.resize(avatarCount);
+    for (int i = 0; i < avatarCount; i++) {
+        avatars[i].center = glm::vec3(randFloatInRange(0.0f, ROOM_SIZE), AVATAR_RADIUS,
+            randFloatInRange(0.0f, ROOM_SIZE));
+        avatars[i].radius = AVATAR_RADIUS;
+    }
+}
+
+/// Adds the spheres of a scene as the particle system does: particles first, colliding with particles and avatars.
+static void addScene(SweepAndPrune& broadphase, const QVector<Sphere>& particles, const QVector<Sphere>& avatars) {
+    broadphase.clear();
+    foreach (const Sphere& particle, particles) {
+        addSphere(broadphase, particle, PARTICLE_GROUP, PARTICLE_GROUP | AVATAR_GROUP);
+    }
+    foreach (const Sphere& avatar, avatars) {
+        addSphere(broadphase, avatar, AVATAR_GROUP, 0);
+    }
+}
+
+static bool spheresTouch(const Sphere& first, const Sphere& second) {
+    glm::vec3 penetration;
+    return findSphereSpherePenetration(first.center, first.radius, second.center, second.radius, penetration);
+}
+
+void BroadphaseTests::findsTouchingBoxes() {
+    SweepAndPrune broadphase;
+    broadphase.addBox(glm::vec3(0.0f), glm::vec3(1.0f), PARTICLE_GROUP, PARTICLE_GROUP);
+    broadphase.addBox(glm::vec3(5.0f), glm::vec3(6.0f), PARTICLE_GROUP, PARTICLE_GROUP);
+    broadphase.addBox(glm::vec3(0.5f), glm::vec3(2.0f), PARTICLE_GROUP, PARTICLE_GROUP);
+    broadphase.addBox(glm::vec3(2.0f, 0.0f, 0.0f), glm::vec3(3.0f, 1.0f, 1.0f), PARTICLE_GROUP, PARTICLE_GROUP);
+
+    QVector<BoxPair> pairs;
+    broadphase.findPairs(pairs);
+    if (pairs.size() != 2 || pairs.at(0) != BoxPair(0, 2) || pairs.at(1) != BoxPair(2, 3)) {
+        std::cout << __FILE__ << ":" << __LINE__
+            << " ERROR: expected pairs (0, 2) and (2, 3) but found " << pairs.size() << " pairs" << std::endl;
+    }
+}
+
+void BroadphaseTests::skipsGroupsThatDontCollide() {
+    SweepAndPrune broadphase;
+    broadphase.addBox(glm::vec3(0.0f), glm::vec3(1.0f), AVATAR_GROUP, 0);
+    broadphase.addBox(glm::vec3(0.0f), glm::vec3(1.0f), AVATAR_GROUP, 0);
+    broadphase.addBox(glm::vec3(0.0f), glm::vec3(1.0f), PARTICLE_GROUP, AVATAR_GROUP);
+
+    QVector<BoxPair> pairs;
+    broadphase.findPairs(pairs);
+    if (pairs.size() != 2 || pairs.at(0) != BoxPair(0, 2) || pairs.at(1) != BoxPair(1, 2)) {
+        std::cout << __FILE__ << ":" << __LINE__
+            << " ERROR: expected only the avatar/particle pairs but found " << pairs.size() << " pairs" << std::endl;
+    }
+}
+
+void BroadphaseTests::matchesBruteForce() {
+    const int PARTICLE_COUNT = 500;
+    const int AVATAR_COUNT = 5;
+    QVector<Sphere> particles, avatars;
+    makeScene(particles, avatars, PARTICLE_COUNT, AVATAR_COUNT);
+    SweepAndPrune broadphase;
+    addScene(broadphase, particles, avatars);
+    QVector<BoxPair> pairs;
+    broadphase.findPairs(pairs);
+
+    // every touching pair of spheres must be among the candidates
+    QVector<Sphere> spheres = particles + avatars;
+    int missed = 0;
+    for (int i = 0; i < PARTICLE_COUNT; i++) {
+        for (int j = i + 1; j < spheres.size(); j++) {
+            if (spheresTouch(spheres.at(i), spheres.at(j)) && !pairs.contains(BoxPair(i, j))) {
+                missed++;
+            }
+        }
+    }
+    if (missed > 0) {
+        std::cout << __FILE__ << ":" << __LINE__
+            << " ERROR: broadphase missed " << missed << " touching pairs" << std::endl;
+    }
+    foreach (const BoxPair& pair, pairs) {
+        if (pair.first >= PARTICLE_COUNT) {
+            std::cout << __FILE__ << ":" << __LINE__
+                << " ERROR: broadphase paired avatars " << pair.first << " and " << pair.second << std::endl;
+            break;
+        }
+    }
+}
+
+void BroadphaseTests::benchmarkParticleScene() {
+    const int PARTICLE_COUNTS[] = { 100, 1000, 5000 };
+    const int AVATAR_COUNT = 10;
+    const int ITERATIONS = 10;
+    for (unsigned int i = 0; i < sizeof(PARTICLE_COUNTS) / sizeof(PARTICLE_COUNTS[0]); i++) {
+        int particleCount = PARTICLE_COUNTS[i];
+        QVector<Sphere> particles, avatars;
+        makeScene(particles, avatars, particleCount, AVATAR_COUNT);
+        QVector<Sphere> spheres = particles + avatars;
+
+        int bruteForceTouching = 0;
+        quint64 startedAt = usecTimestampNow();
+        for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+            for (int j = 0; j < particleCount; j++) {
+                for (int k = j + 1; k < spheres.size(); k++) {
+                    if (spheresTouch(spheres.at(j), spheres.at(k))) {
+                        bruteForceTouching++;
+                    }
+                }
+            }
+        }
+        quint64 bruteForceUsecs = (usecTimestampNow() - startedAt) / ITERATIONS;
+
+        SweepAndPrune broadphase;
+        QVector<BoxPair> pairs;
+        int broadphaseTouching = 0;
+        startedAt = usecTimestampNow();
+        for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+            addScene(broadphase, particles, avatars);
+            broadphase.findPairs(pairs);
+            foreach (const BoxPair& pair, pairs) {
+                if (spheresTouch(spheres.at(pair.first), spheres.at(pair.second))) {
+                    broadphaseTouching++;
+                }
+            }
+        }
+        quint64 broadphaseUsecs = (usecTimestampNow() - startedAt) / ITERATIONS;
+
+        if (broadphaseTouching != bruteForceTouching) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: broadphase found " << broadphaseTouching
+                << " touching pairs but checking every pair found " << bruteForceTouching << std::endl;
+        }
+        std::cout << "broadphase: " << particleCount << " particles, " << AVATAR_COUNT << " avatars: "
+            << bruteForceUsecs << " usecs checking every pair, " << broadphaseUsecs << " usecs with broadphase ("
+            << pairs.size() << " candidate pairs)" << std::endl;
+    }
+}
+
+void BroadphaseTests::runAllTests() {
+    findsTouchingBoxes();
+    skipsGroupsThatDontCollide();
+    matchesBruteForce();
+    benchmarkParticleScene();
+}
@@ -0,0 +1,27 @@
+//
+//  BroadphaseTests.h
+//  tests/physics/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_BroadphaseTests_h
+#define hifi_BroadphaseTests_h
+
+namespace BroadphaseTests {
+
+    void findsTouchingBoxes();
+    void skipsGroupsThatDontCollide();
+    void matchesBruteForce();
+
+    /// Times a scene laid out like a busy particle server's (many particles, a few avatars, in a room) through the
+    /// broadphase and narrowphase, against checking every pair.
+    void benchmarkParticleScene();
+
+    void runAllTests();
+}
+
+#endif // hifi_BroadphaseTests_h
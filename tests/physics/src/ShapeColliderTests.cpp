@@ -16,6 +16,8 @@
 #include <glm/gtx/quaternion.hpp>
 
 #include <CollisionInfo.h>
+#include <PlaneShape.h>
+#include <ShapeBatch.h>
 #include <ShapeCollider.h>
 #include <SharedUtil.h>
 #include <SphereShape.h>
@@ -897,6 +899,155 @@ void ShapeColliderTests::sphereMissesAACube() {
     }
 }
 
+/// Adds a cluster of randomly placed spheres and capsules (about half and half) around a center.
+static void addCluster(QVector<Shape*>& ownedShapes, QVector<const Shape*>& shapes, const glm::vec3& center,
+        float size, int shapeCount) {
+    const float MIN_RADIUS = 0.02f;
+    const float MAX_RADIUS = 0.2f;
+    for (int i = 0; i < shapeCount; i++) {
+        glm::vec3 position = center + glm::vec3(randFloatInRange(-size, size), randFloatInRange(-size, size),
+            randFloatInRange(-size, size)) * 0.5f;
+        float radius = randFloatInRange(MIN_RADIUS, MAX_RADIUS);
+        Shape* shape;
+        if (i % 2 == 0) {
+            shape = new SphereShape(radius, position);
+        } else {
+            glm::vec3 halfAxis = glm::vec3(randFloatInRange(-1.0f, 1.0f), randFloatInRange(-1.0f, 1.0f),
+                randFloatInRange(-1.0f, 1.0f)) * (size * 0.25f);
+            shape = new CapsuleShape(radius, position - halfAxis, position + halfAxis);
+        }
+        ownedShapes.append(shape);
+        shapes.append(shape);
+    }
+}
+
+static bool collideEveryPair(const QVector<const Shape*>& shapesA, const QVector<const Shape*>& shapesB,
+        CollisionList& collisions) {
+    bool touching = false;
+    foreach (const Shape* shapeA, shapesA) {
+        foreach (const Shape* shapeB, shapesB) {
+            touching = ShapeCollider::collideShapes(shapeA, shapeB, collisions) || touching;
+        }
+    }
+    return touching;
+}
+
+static bool collisionsMatch(CollisionList& expected, CollisionList& actual) {
+    if (expected.size() != actual.size()) {
+        return false;
+    }
+    for (int i = 0; i < expected.size(); i++) {
+        const CollisionInfo* expectedCollision = expected.getCollision(i);
+        const CollisionInfo* actualCollision = actual.getCollision(i);
+        if (expectedCollision->_penetration != actualCollision->_penetration ||
+                expectedCollision->_contactPoint != actualCollision->_contactPoint) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ShapeColliderTests::batchesMatchPairs() {
+    const int SHAPE_COUNT = 60;
+    const float CLUSTER_SIZE = 2.0f;
+    QVector<Shape*> ownedShapes;
+    QVector<const Shape*> shapesA, shapesB;
+    addCluster(ownedShapes, shapesA, glm::vec3(0.0f, 1.0f, 0.0f), CLUSTER_SIZE, SHAPE_COUNT);
+    addCluster(ownedShapes, shapesB, glm::vec3(0.5f, 1.0f, 0.0f), CLUSTER_SIZE, SHAPE_COUNT);
+
+    // a floor, which has no bounds, on each side
+    PlaneShape floor;
+    shapesA.append(&floor);
+    shapesB.insert(SHAPE_COUNT / 2, &floor);
+
+    ShapeBatch batchA, batchB;
+    batchA.addShapes(shapesA);
+    batchB.addShapes(shapesB);
+
+    // once with room for all the collisions, and once with a list that fills up
+    const int COLLISION_LIST_SIZES[] = { 4096, 16 };
+    for (unsigned int i = 0; i < sizeof(COLLISION_LIST_SIZES) / sizeof(COLLISION_LIST_SIZES[0]); i++) {
+        CollisionList expected(COLLISION_LIST_SIZES[i]);
+        bool expectedTouching = collideEveryPair(shapesA, shapesB, expected);
+        CollisionList actual(COLLISION_LIST_SIZES[i]);
+        bool actualTouching = ShapeCollider::collideShapeBatches(batchA, batchB, actual);
+
+        if (expected.size() == 0) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: expected the clusters to touch" << std::endl;
+        }
+        if (actualTouching != expectedTouching || !collisionsMatch(expected, actual)) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: batches found " << actual.size()
+                << " collisions but checking every pair found " << expected.size() << std::endl;
+        }
+    }
+
+    // clusters far apart are rejected by their bounds
+    QVector<const Shape*> farShapes;
+    addCluster(ownedShapes, farShapes, glm::vec3(100.0f, 1.0f, 0.0f), CLUSTER_SIZE, SHAPE_COUNT);
+    ShapeBatch farBatch;
+    farBatch.addShapes(farShapes);
+    ShapeBatch nearBatch;
+    nearBatch.addShapes(shapesA.mid(0, SHAPE_COUNT));
+    CollisionList collisions(16);
+    if (nearBatch.mayTouch(farBatch) || ShapeCollider::collideShapeBatches(nearBatch, farBatch, collisions)) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: distant clusters should NOT touch" << std::endl;
+    }
+
+    qDeleteAll(ownedShapes);
+}
+
+void ShapeColliderTests::benchmarkBatches() {
+    const int CLUSTER_COUNT = 20;
+    const int SHAPES_PER_CLUSTER = 40;
+    const float CLUSTER_SIZE = 2.0f;
+    const float ROOM_SIZE = 20.0f;
+    const int ITERATIONS = 100;
+    QVector<Shape*> ownedShapes;
+    QVector<QVector<const Shape*> > clusters(CLUSTER_COUNT);
+    for (int i = 0; i < CLUSTER_COUNT; i++) {
+        glm::vec3 center(randFloatInRange(0.0f, ROOM_SIZE), 1.0f, randFloatInRange(0.0f, ROOM_SIZE));
+        addCluster(ownedShapes, clusters[i], center, CLUSTER_SIZE, SHAPES_PER_CLUSTER);
+    }
+
+    const int MAX_COLLISIONS = 4096;
+    CollisionList collisions(MAX_COLLISIONS);
+    int pairCollisionCount = 0;
+    quint64 startedAt = usecTimestampNow();
+    for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+        for (int i = 1; i < CLUSTER_COUNT; i++) {
+            collisions.clear();
+            collideEveryPair(clusters.at(0), clusters.at(i), collisions);
+            pairCollisionCount += collisions.size();
+        }
+    }
+    quint64 pairUsecs = (usecTimestampNow() - startedAt) / ITERATIONS;
+
+    // rebuild the batches every time, as a caller whose shapes move would
+    ShapeBatch batchA, batchB;
+    int batchCollisionCount = 0;
+    startedAt = usecTimestampNow();
+    for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+        batchA.clear();
+        batchA.addShapes(clusters.at(0));
+        for (int i = 1; i < CLUSTER_COUNT; i++) {
+            batchB.clear();
+            batchB.addShapes(clusters.at(i));
+            collisions.clear();
+            ShapeCollider::collideShapeBatches(batchA, batchB, collisions);
+            batchCollisionCount += collisions.size();
+        }
+    }
+    quint64 batchUsecs = (usecTimestampNow() - startedAt) / ITERATIONS;
+
+    if (batchCollisionCount != pairCollisionCount) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: batches found " << batchCollisionCount
+            << " collisions but checking every pair found " << pairCollisionCount << std::endl;
+    }
+    std::cout << "shape batches: " << CLUSTER_COUNT << " clusters of " << SHAPES_PER_CLUSTER << " shapes: "
+        << pairUsecs << " usecs checking every pair, " << batchUsecs << " usecs in batches" << std::endl;
+
+    qDeleteAll(ownedShapes);
+}
 
 void ShapeColliderTests::runAllTests() {
     sphereMissesSphere();
@@ -911,4 +1062,7 @@ void ShapeColliderTests::runAllTests() {
     sphereTouchesAACubeFaces();
     sphereTouchesAACubeEdges();
     sphereMissesAACube();
+
+    batchesMatchPairs();
+    benchmarkBatches();
 }
@@ -27,6 +27,12 @@ namespace ShapeColliderTests {
     void sphereTouchesAACubeEdges();
     void sphereMissesAACube();
 
+    void batchesMatchPairs();
+
+    /// Times colliding one avatar-sized cluster of spheres and capsules against others spread around a room, in batches
+    /// and by checking every pair.
+    void benchmarkBatches();
+
     void runAllTests(); 
 }
 
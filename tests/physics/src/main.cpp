@@ -8,9 +8,11 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include "BroadphaseTests.h"
 #include "ShapeColliderTests.h"
 
 int main(int argc, char** argv) {
     ShapeColliderTests::runAllTests();
+    BroadphaseTests::runAllTests();
     return 0;
 }
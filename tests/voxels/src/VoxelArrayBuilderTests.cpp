@@ -0,0 +1,208 @@
+//
+//  VoxelArrayBuilderTests.cpp
+//  tests/voxels/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <SharedUtil.h>
+#include <VoxelArrayBuilder.h>
+
+#include "VoxelArrayBuilderTests.h"
+
+/// A set of the arrays that back the voxel VBOs, in both layouts.
+class VoxelArrays {
+public:
+    VoxelArrays(int slots) :
+        shaderData(slots),
+        vertices(slots * GLOBAL_NORMALS_VERTEX_POINTS_PER_VOXEL),
+        colors(slots * GLOBAL_NORMALS_VERTEX_POINTS_PER_VOXEL) { }
+
+    void setShaderArrays(VoxelArrayBuilder& builder) { builder.setArrays(NULL, NULL, &shaderData[0]); }
+    void setGlobalNormalsArrays(VoxelArrayBuilder& builder) { builder.setArrays(&vertices[0], &colors[0], NULL); }
+
+    /// Returns the number of slots that differ from those of another set of arrays.
+    int countDifferences(const VoxelArrays& other) const;
+
+    std::vector<VoxelShaderVBOData> shaderData;
+    std::vector<float> vertices;
+    std::vector<unsigned char> colors;
+};
+
+int VoxelArrays::countDifferences(const VoxelArrays& other) const {
+    int differences = 0;
+    for (int i = 0; i < (int)shaderData.size(); i++) {
+        const VoxelShaderVBOData& data = shaderData[i];
+        const VoxelShaderVBOData& otherData = other.shaderData[i];
+        bool same = data.x == otherData.x && data.y == otherData.y && data.z == otherData.z && data.s == otherData.s &&
+            data.r == otherData.r && data.g == otherData.g && data.b == otherData.b;
+        int offset = i * GLOBAL_NORMALS_VERTEX_POINTS_PER_VOXEL;
+        same = same && memcmp(&vertices[offset], &other.vertices[offset],
+            GLOBAL_NORMALS_VERTEX_POINTS_PER_VOXEL * sizeof(float)) == 0;
+        same = same && memcmp(&colors[offset], &other.colors[offset], GLOBAL_NORMALS_VERTEX_POINTS_PER_VOXEL) == 0;
+        if (!same) {
+            differences++;
+        }
+    }
+    return differences;
+}
+
+static VoxelArrayWrite makeWrite(glBufferIndex slot) {
+    VoxelArrayWrite write;
+    write.slot = slot;
+    write.corner = glm::vec3(randFloat(), randFloat(), randFloat());
+    write.scale = randFloatInRange(0.0001f, 0.01f);
+    write.color[RED_INDEX] = randIntInRange(0, 255);
+    write.color[GREEN_INDEX] = randIntInRange(0, 255);
+    write.color[BLUE_INDEX] = randIntInRange(0, 255);
+    return write;
+}
+
+/// Makes writes to random slots, some of them to the same slot.
+static void makeWrites(std::vector<VoxelArrayWrite>& writes, int count, int slots) {
+    writes.clear();
+    for (int i = 0; i < count; i++) {
+        writes.push_back(makeWrite(randIntInRange(0, slots - 1)));
+    }
+}
+
+static void writeDirectly(VoxelArrayBuilder& builder, const std::vector<VoxelArrayWrite>& writes) {
+    for (int i = 0; i < (int)writes.size(); i++) {
+        builder.write(writes[i]);
+    }
+}
+
+static void queueAndBuild(VoxelArrayBuilder& builder, const std::vector<VoxelArrayWrite>& writes) {
+    for (int i = 0; i < (int)writes.size(); i++) {
+        const VoxelArrayWrite& write = writes[i];
+        nodeColor color = { write.color[RED_INDEX], write.color[GREEN_INDEX], write.color[BLUE_INDEX], 0 };
+        builder.queueWrite(write.slot, write.corner, write.scale, color);
+    }
+    builder.build();
+}
+
+void VoxelArrayBuilderTests::chunksCoverSlots() {
+    const glBufferIndex SLOTS = VoxelArrayBuilder::SLOTS_PER_CHUNK;
+    const glBufferIndex SLOT_COUNTS[] = { 1, SLOTS - 1, SLOTS, SLOTS + 1, SLOTS * 2 };
+    const int CHUNK_COUNTS[] = { 1, 1, 1, 2, 2 };
+    for (unsigned int i = 0; i < sizeof(SLOT_COUNTS) / sizeof(SLOT_COUNTS[0]); i++) {
+        glBufferIndex slotCount = SLOT_COUNTS[i];
+        int chunkCount = VoxelArrayBuilder::getChunkCount(slotCount);
+        if (chunkCount != CHUNK_COUNTS[i]) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: expected " << CHUNK_COUNTS[i] << " chunks for "
+                << slotCount << " slots but got " << chunkCount << std::endl;
+        }
+        // the last slot must fall in the last chunk, not past it
+        if (VoxelArrayBuilder::getChunk(slotCount - 1) != chunkCount - 1) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: last of " << slotCount
+                << " slots is in chunk " << VoxelArrayBuilder::getChunk(slotCount - 1) << std::endl;
+        }
+    }
+}
+
+void VoxelArrayBuilderTests::buildMatchesDirectWrites() {
+    const int SLOTS = 100000;
+    const int WRITE_COUNTS[] = { 100, 50000 }; // below and above the point where the builder goes parallel
+    for (unsigned int i = 0; i < sizeof(WRITE_COUNTS) / sizeof(WRITE_COUNTS[0]); i++) {
+        std::vector<VoxelArrayWrite> writes;
+        makeWrites(writes, WRITE_COUNTS[i], SLOTS);
+
+        VoxelArrays direct(SLOTS), built(SLOTS);
+        VoxelArrayBuilder builder;
+        direct.setShaderArrays(builder);
+        writeDirectly(builder, writes);
+        direct.setGlobalNormalsArrays(builder);
+        writeDirectly(builder, writes);
+
+        built.setShaderArrays(builder);
+        queueAndBuild(builder, writes);
+        built.setGlobalNormalsArrays(builder);
+        queueAndBuild(builder, writes);
+
+        if (builder.getQueuedWriteCount() != 0) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: " << builder.getQueuedWriteCount()
+                << " writes still queued after build" << std::endl;
+        }
+        int differences = built.countDifferences(direct);
+        if (differences > 0) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: " << differences << " of " << SLOTS
+                << " slots differ after building " << WRITE_COUNTS[i] << " writes" << std::endl;
+        }
+    }
+}
+
+void VoxelArrayBuilderTests::lastWriteWins() {
+    const int SLOTS = VoxelArrayBuilder::SLOTS_PER_CHUNK * 16;
+    const glBufferIndex CONTESTED_SLOTS[] = { 0, VoxelArrayBuilder::SLOTS_PER_CHUNK * 3 + 5, SLOTS - 1 };
+    const int CONTESTED_SLOT_COUNT = sizeof(CONTESTED_SLOTS) / sizeof(CONTESTED_SLOTS[0]);
+
+    // first writes to the contested slots, then enough others to build in parallel, then the writes that should win
+    std::vector<VoxelArrayWrite> writes;
+    for (int i = 0; i < CONTESTED_SLOT_COUNT; i++) {
+        writes.push_back(makeWrite(CONTESTED_SLOTS[i]));
+    }
+    std::vector<VoxelArrayWrite> others;
+    makeWrites(others, 20000, SLOTS);
+    writes.insert(writes.end(), others.begin(), others.end());
+    std::vector<VoxelArrayWrite> winners;
+    for (int i = 0; i < CONTESTED_SLOT_COUNT; i++) {
+        winners.push_back(makeWrite(CONTESTED_SLOTS[i]));
+    }
+    writes.insert(writes.end(), winners.begin(), winners.end());
+
+    VoxelArrays built(SLOTS);
+    VoxelArrayBuilder builder;
+    built.setShaderArrays(builder);
+    queueAndBuild(builder, writes);
+    for (int i = 0; i < CONTESTED_SLOT_COUNT; i++) {
+        const VoxelShaderVBOData& data = built.shaderData[CONTESTED_SLOTS[i]];
+        const VoxelArrayWrite& winner = winners[i];
+        if (data.x != winner.corner.x * TREE_SCALE || data.s != winner.scale * TREE_SCALE ||
+                data.r != winner.color[RED_INDEX]) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: slot " << CONTESTED_SLOTS[i]
+                << " doesn't hold the last write queued for it" << std::endl;
+        }
+    }
+}
+
+void VoxelArrayBuilderTests::benchmarkBuild() {
+    const int SLOT_COUNTS[] = { 10000, 200000, 1000000 };
+    const int ITERATIONS = 5;
+    for (unsigned int i = 0; i < sizeof(SLOT_COUNTS) / sizeof(SLOT_COUNTS[0]); i++) {
+        int slots = SLOT_COUNTS[i];
+        std::vector<VoxelArrayWrite> writes;
+        makeWrites(writes, slots, slots);
+        VoxelArrays arrays(slots);
+        VoxelArrayBuilder builder;
+        arrays.setGlobalNormalsArrays(builder);
+
+        quint64 startedAt = usecTimestampNow();
+        for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+            writeDirectly(builder, writes);
+        }
+        quint64 directUsecs = (usecTimestampNow() - startedAt) / ITERATIONS;
+
+        startedAt = usecTimestampNow();
+        for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+            queueAndBuild(builder, writes);
+        }
+        quint64 builtUsecs = (usecTimestampNow() - startedAt) / ITERATIONS;
+
+        std::cout << "voxel array builder: " << slots << " writes: " << directUsecs << " usecs writing directly, "
+            << builtUsecs << " usecs queued and built in chunks" << std::endl;
+    }
+}
+
+void VoxelArrayBuilderTests::runAllTests() {
+    chunksCoverSlots();
+    buildMatchesDirectWrites();
+    lastWriteWins();
+    benchmarkBuild();
+}
@@ -0,0 +1,31 @@
+//
+//  VoxelArrayBuilderTests.h
+//  tests/voxels/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_VoxelArrayBuilderTests_h
+#define hifi_VoxelArrayBuilderTests_h
+
+namespace VoxelArrayBuilderTests {
+
+    void chunksCoverSlots();
+
+    /// Checks that building queued writes, serially and in parallel, fills the arrays just as writing each one right
+    /// away does, in both the voxel shader and the global normals layouts.
+    void buildMatchesDirectWrites();
+
+    /// Checks that the last write queued for a slot wins, even when the writes are built in parallel.
+    void lastWriteWins();
+
+    /// Times building a full pass's worth of writes against writing each one right away.
+    void benchmarkBuild();
+
+    void runAllTests();
+}
+
+#endif // hifi_VoxelArrayBuilderTests_h
@@ -0,0 +1,245 @@
+//
+//  main.cpp
+//  tools/fbx-cooker/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <cmath>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QStringList>
+#include <QtDebug>
+
+#include <BlendshapeEvaluator.h>
+#include <FBXCooker.h>
+#include <SharedUtil.h>
+
+const int DEFAULT_BENCHMARK_ITERATIONS = 10;
+
+static void printUsage() {
+    qDebug() << "Usage: fbx-cooker [options] <model.fbx>";
+    qDebug() << "  -m <mapping.fst>          cook with the given FST mapping";
+    qDebug() << "  -o <file>                 write the cooked geometry to the given file (default <model>.cooked)";
+    qDebug() << "  --cacheDirectory <dir>    write the cooked geometry into a cache directory, named as a client";
+    qDebug() << "                            loading the same model and mapping would look for it";
+    qDebug() << "  --benchmark [iterations]  time loading the model from FBX against loading it cooked, and time";
+    qDebug() << "                            blendshape evaluation if the model has blendshapes";
+}
+
+static bool readFile(const QString& path, QByteArray& contents) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "Couldn't open" << path;
+        return false;
+    }
+    contents = file.readAll();
+    return true;
+}
+
+static bool writeFile(const QString& path, const QByteArray& contents) {
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(contents) != contents.size()) {
+        qDebug() << "Couldn't write" << path;
+        return false;
+    }
+    return true;
+}
+
+/// Blends the way Interface did before BlendshapeEvaluator: copying the base meshes and applying every nonzero
+/// coefficient, every time.
+static void blendFromScratch(const FBXGeometry& geometry, const QVector<float>& coefficients,
+        QVector<glm::vec3>& vertices, QVector<glm::vec3>& normals) {
+    vertices.clear();
+    normals.clear();
+    int offset = 0;
+    foreach (const FBXMesh& mesh, geometry.meshes) {
+        if (mesh.blendshapes.isEmpty()) {
+            continue;
+        }
+        vertices += mesh.vertices;
+        normals += mesh.normals;
+        glm::vec3* meshVertices = vertices.data() + offset;
+        glm::vec3* meshNormals = normals.data() + offset;
+        offset += mesh.vertices.size();
+        const float NORMAL_COEFFICIENT_SCALE = 0.01f;
+        for (int i = 0, n = qMin(coefficients.size(), mesh.blendshapes.size()); i < n; i++) {
+            float vertexCoefficient = coefficients.at(i);
+            if (vertexCoefficient < EPSILON) {
+                continue;
+            }
+            float normalCoefficient = vertexCoefficient * NORMAL_COEFFICIENT_SCALE;
+            const FBXBlendshape& blendshape = mesh.blendshapes.at(i);
+            for (int j = 0; j < blendshape.indices.size(); j++) {
+                int index = blendshape.indices.at(j);
+                meshVertices[index] += blendshape.vertices.at(j) * vertexCoefficient;
+                meshNormals[index] += blendshape.normals.at(j) * normalCoefficient;
+            }
+        }
+    }
+}
+
+/// Fills in coefficients for an animation frame in which every coefficient (or, if sparse, every fourth) moves.
+static void animateCoefficients(QVector<float>& coefficients, int frame, bool sparse) {
+    const float FRAME_PHASE = 0.1f;
+    const float MAX_COEFFICIENT = 0.5f;
+    const int SPARSE_STRIDE = 4;
+    for (int i = 0; i < coefficients.size(); i++) {
+        if (!sparse || i % SPARSE_STRIDE == 0) {
+            coefficients[i] = qMax(0.0f, sinf(frame * FRAME_PHASE + i) * MAX_COEFFICIENT);
+        }
+    }
+}
+
+static void benchmarkBlendshapes(const FBXGeometry& geometry, int frames) {
+    int coefficientCount = 0;
+    foreach (const FBXMesh& mesh, geometry.meshes) {
+        coefficientCount = qMax(coefficientCount, mesh.blendshapes.size());
+    }
+    const bool SPARSE_OPTIONS[] = { false, true };
+    for (unsigned int i = 0; i < sizeof(SPARSE_OPTIONS) / sizeof(SPARSE_OPTIONS[0]); i++) {
+        bool sparse = SPARSE_OPTIONS[i];
+        QVector<float> coefficients(coefficientCount, 0.0f);
+        QVector<glm::vec3> vertices, normals;
+        QElapsedTimer timer;
+        timer.start();
+        for (int frame = 0; frame < frames; frame++) {
+            animateCoefficients(coefficients, frame, sparse);
+            blendFromScratch(geometry, coefficients, vertices, normals);
+        }
+        qint64 scratchNsecs = timer.nsecsElapsed();
+
+        coefficients.fill(0.0f);
+        BlendshapeEvaluator evaluator(QSharedPointer<BlendshapeDeltas>(new BlendshapeDeltas(geometry.meshes)));
+        timer.restart();
+        for (int frame = 0; frame < frames; frame++) {
+            animateCoefficients(coefficients, frame, sparse);
+            evaluator.evaluate(coefficients);
+        }
+        qint64 evaluatorNsecs = timer.nsecsElapsed();
+
+        const double NSECS_PER_USEC = 1000.0;
+        double scratchUsecs = scratchNsecs / NSECS_PER_USEC / frames;
+        double evaluatorUsecs = evaluatorNsecs / NSECS_PER_USEC / frames;
+        qDebug("Blendshapes (%d coefficients, %s changes): %.1f us per frame from scratch, %.1f us incrementally",
+            coefficientCount, sparse ? "sparse" : "dense", scratchUsecs, evaluatorUsecs);
+    }
+}
+
+static void benchmark(const QByteArray& model, const QVariantHash& mapping, const QString& cookedPath, int iterations) {
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; i++) {
+        readFBX(model, mapping);
+    }
+    qint64 fbxNsecs = timer.nsecsElapsed();
+
+    QFile file(cookedPath);
+    file.open(QIODevice::ReadOnly);
+    timer.restart();
+    for (int i = 0; i < iterations; i++) {
+        uchar* data = file.map(0, file.size());
+        readCookedFBXGeometry(QByteArray::fromRawData(reinterpret_cast<const char*>(data), file.size()));
+        file.unmap(data);
+    }
+    qint64 cookedNsecs = timer.nsecsElapsed();
+
+    const double NSECS_PER_MSEC = 1000.0 * 1000.0;
+    double fbxMsecs = fbxNsecs / NSECS_PER_MSEC / iterations;
+    double cookedMsecs = cookedNsecs / NSECS_PER_MSEC / iterations;
+    qDebug("FBX:    %.2f ms per load (%d bytes)", fbxMsecs, model.size());
+    qDebug("Cooked: %.2f ms per load (%lld bytes)", cookedMsecs, file.size());
+    if (cookedMsecs > 0.0) {
+        qDebug("%.1fx faster", fbxMsecs / cookedMsecs);
+    }
+
+    FBXGeometry geometry = readFBX(model, mapping);
+    if (geometry.hasBlendedMeshes()) {
+        const int BLENDSHAPE_FRAMES_PER_ITERATION = 100;
+        benchmarkBlendshapes(geometry, iterations * BLENDSHAPE_FRAMES_PER_ITERATION);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QStringList arguments = app.arguments();
+
+    QString modelPath;
+    QString mappingPath;
+    QString outputPath;
+    QString cacheDirectory;
+    int benchmarkIterations = 0;
+    for (int i = 1; i < arguments.size(); i++) {
+        const QString& argument = arguments.at(i);
+        if (argument == "-m" && i + 1 < arguments.size()) {
+            mappingPath = arguments.at(++i);
+
+        } else if (argument == "-o" && i + 1 < arguments.size()) {
+            outputPath = arguments.at(++i);
+
+        } else if (argument == "--cacheDirectory" && i + 1 < arguments.size()) {
+            cacheDirectory = arguments.at(++i);
+
+        } else if (argument == "--benchmark") {
+            benchmarkIterations = DEFAULT_BENCHMARK_ITERATIONS;
+            bool ok;
+            int iterations = (i + 1 < arguments.size()) ? arguments.at(i + 1).toInt(&ok) : 0;
+            if (i + 1 < arguments.size() && ok && iterations > 0) {
+                benchmarkIterations = iterations;
+                i++;
+            }
+        } else if (modelPath.isEmpty() && !argument.startsWith("-")) {
+            modelPath = argument;
+
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (modelPath.isEmpty()) {
+        printUsage();
+        return 1;
+    }
+
+    QByteArray model;
+    if (!readFile(modelPath, model)) {
+        return 1;
+    }
+    QVariantHash mapping;
+    if (!mappingPath.isEmpty()) {
+        QByteArray mappingContents;
+        if (!readFile(mappingPath, mappingContents)) {
+            return 1;
+        }
+        mapping = readMapping(mappingContents);
+    }
+
+    if (outputPath.isEmpty()) {
+        outputPath = cacheDirectory.isEmpty() ? modelPath + ".cooked" :
+            getCookedFBXCachePath(model, mapping, cacheDirectory);
+    }
+
+    try {
+        QByteArray cooked = cookFBXGeometry(readFBX(model, mapping));
+        if (!writeFile(outputPath, cooked)) {
+            return 1;
+        }
+        qDebug() << "Cooked" << modelPath << "to" << outputPath;
+
+        if (benchmarkIterations > 0) {
+            benchmark(model, mapping, outputPath, benchmarkIterations);
+        }
+    } catch (const QString& error) {
+        qDebug() << "Error reading" << modelPath << ":" << error;
+        return 1;
+    }
+    return 0;
+}